@@ -60,6 +60,17 @@ enum aom_com_control_id {
   AV1_SET_REFERENCE = 129, /**< write a frame into a reference buffer */
   AV1_COPY_REFERENCE =
       130, /**< get a copy of reference frame from the decoder */
+
+  /*!\brief Codec control function to run the parallel work of the codec on a
+   * thread pool of the application, aom_thread_pool_t* parameter
+   *
+   * Must be called before the first frame is encoded or decoded. A NULL
+   * pointer restores the codec's own threads. The decoder returns
+   * AOM_CODEC_INCAPABLE if it was initialized with
+   * AOM_CODEC_USE_FRAME_THREADING, since frame parallel decoding runs its
+   * filter stage on a thread of its own.
+   */
+  AOM_SET_THREAD_POOL = 131,
   AOM_COMMON_CTRL_ID_MAX,
 
   AV1_GET_NEW_FRAME_IMAGE = 192, /**< get a pointer to the new frame */
@@ -108,6 +119,41 @@ typedef struct av1_ref_frame {
   aom_image_t img; /**< img structure to populate (output) */
 } av1_ref_frame_t;
 
+/*!\brief Task run by an application thread pool
+ *
+ * Defines the function the codec passes to aom_thread_pool_t::submit().
+ */
+typedef void (*aom_thread_pool_task_fn_t)(void *arg);
+
+/*!\brief Application thread pool
+ *
+ * Describes a thread pool of the application, set with the
+ * AOM_SET_THREAD_POOL control. The encoder and decoder then run their tile,
+ * row and loop filter workers as tasks on this pool instead of creating
+ * threads of their own. The number of tasks is still set by the threads
+ * setting of the codec. The structure is copied by the control.
+ *
+ * The codec calls submit() and wait() from the thread which encodes or
+ * decodes, never from a task. Some tasks wait on each other, so the pool
+ * must eventually run the submitted tasks on a thread other than the one
+ * which called submit().
+ */
+typedef struct aom_thread_pool {
+  void *priv; /**< application data passed to submit() and wait() */
+
+  /*!\brief the number of threads of the pool */
+  int num_threads;
+
+  /*!\brief queues a call of task(arg) on a thread of the pool
+   *
+   * Returns 0 on success. The codec runs tasks the pool did not take itself.
+   */
+  int (*submit)(void *priv, aom_thread_pool_task_fn_t task, void *arg);
+
+  /*!\brief blocks until all the tasks submitted by the codec have returned */
+  void (*wait)(void *priv);
+} aom_thread_pool_t;
+
 /*!\cond */
 /*!\brief aom decoder control function parameter type
  *
@@ -129,6 +175,8 @@ AOM_CTRL_USE_TYPE(AV1_SET_REFERENCE, av1_ref_frame_t *)
 #define AOM_CTRL_AV1_SET_REFERENCE
 AOM_CTRL_USE_TYPE(AV1_COPY_REFERENCE, av1_ref_frame_t *)
 #define AOM_CTRL_AV1_COPY_REFERENCE
+AOM_CTRL_USE_TYPE(AOM_SET_THREAD_POOL, aom_thread_pool_t *)
+#define AOM_CTRL_AOM_SET_THREAD_POOL
 AOM_CTRL_USE_TYPE(AV1_GET_NEW_FRAME_IMAGE, aom_image_t *)
 #define AOM_CTRL_AV1_GET_NEW_FRAME_IMAGE
 
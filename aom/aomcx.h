@@ -595,6 +595,16 @@ enum aome_enc_control_id {
    * 0 : off, 1 : MAX_EXTREME_MV, 2 : MIN_EXTREME_MV
    */
   AV1E_ENABLE_MOTION_VECTOR_UNIT_TEST,
+
+  /*!\brief Codec control function to enable row based multi-threading of the
+   * encoder.
+   *
+   * When enabled, superblock rows of a tile are encoded concurrently, so more
+   * threads than tile columns can be used. Each superblock row starts from
+   * the frame's probability context, which makes the output independent of
+   * the number of threads. The default value is 0 (off).
+   */
+  AV1E_SET_ROW_MT,
 };
 
 /*!\brief aom 1-D scaling mode
@@ -829,6 +839,9 @@ AOM_CTRL_USE_TYPE(AV1E_SET_ANS_WINDOW_SIZE_LOG2, unsigned int)
 AOM_CTRL_USE_TYPE(AV1E_SET_SINGLE_TILE_DECODING, unsigned int)
 #define AOM_CTRL_AV1E_SET_SINGLE_TILE_DECODING
 
+AOM_CTRL_USE_TYPE(AV1E_SET_ROW_MT, unsigned int)
+#define AOM_CTRL_AV1E_SET_ROW_MT
+
 AOM_CTRL_USE_TYPE(AV1E_ENABLE_MOTION_VECTOR_UNIT_TEST, unsigned int)
 #define AOM_CTRL_AV1E_ENABLE_MOTION_VECTOR_UNIT_TEST
 
@@ -154,6 +154,32 @@ enum aom_dec_control_id {
    */
   AV1_SET_INSPECTION_CALLBACK,
 
+  /** control function to enable row-based multi-threading within a tile.
+   * When the stream has a single tile column, the decoding threads
+   * reconstruct superblock rows in parallel while one thread parses the
+   * tile. Valid values are 0 (disabled) and 1 (enabled). The default value
+   * is 1.
+   */
+  AV1D_SET_ROW_MT,
+
+  /** control function to allocate the internal frame buffers for frames up
+   * to the given size, so that the decoder does not allocate when the stream
+   * switches to a larger resolution up to it. Takes an array of two ints, the
+   * maximum width and height. The buffers are sized for 4:2:0 frames with
+   * the decoder's internal sample size: 16 bits per sample when
+   * CONFIG_HIGHBITDEPTH is enabled and aom_codec_dec_cfg_t.allow_lowbitdepth
+   * is 0, and 8 bits otherwise. The frames of 4:2:2 and 4:4:4 streams do not
+   * fit, so the decoder still allocates for them. Has no effect when external
+   * frame buffers are in use.
+   */
+  AV1D_SET_MAX_FRAME_BUFFER_SIZE,
+
+  /** control function to get the number of frame buffer requests the
+   * internal frame buffers served without allocating (first element) and by
+   * allocating (second element). Takes an array of two unsigned ints.
+   */
+  AV1D_GET_FRAME_BUFFER_POOL_STATS,
+
   AOM_DECODER_CTRL_ID_MAX,
 };
 
@@ -211,6 +237,12 @@ AOM_CTRL_USE_TYPE(AV1_SET_DECODE_TILE_COL, int)
 #define AOM_CTRL_AV1_SET_DECODE_TILE_COL
 AOM_CTRL_USE_TYPE(AV1_SET_INSPECTION_CALLBACK, aom_inspect_init *)
 #define AOM_CTRL_AV1_SET_INSPECTION_CALLBACK
+AOM_CTRL_USE_TYPE(AV1D_SET_ROW_MT, unsigned int)
+#define AOM_CTRL_AV1D_SET_ROW_MT
+AOM_CTRL_USE_TYPE(AV1D_SET_MAX_FRAME_BUFFER_SIZE, int *)
+#define AOM_CTRL_AV1D_SET_MAX_FRAME_BUFFER_SIZE
+AOM_CTRL_USE_TYPE(AV1D_GET_FRAME_BUFFER_POOL_STATS, unsigned int *)
+#define AOM_CTRL_AV1D_GET_FRAME_BUFFER_POOL_STATS
 /*!\endcond */
 /*! @} - end defgroup aom_decoder */
 
@@ -50,6 +50,7 @@ set(AOM_DSP_COMMON_INTRIN_SSE2
     "${AOM_ROOT}/aom_dsp/x86/loopfilter_sse2.c"
     "${AOM_ROOT}/aom_dsp/x86/lpf_common_sse2.h"
     "${AOM_ROOT}/aom_dsp/x86/mem_sse2.h"
+    "${AOM_ROOT}/aom_dsp/x86/prob_sse2.c"
     "${AOM_ROOT}/aom_dsp/x86/txfm_common_sse2.h")
 
 set(AOM_DSP_COMMON_ASM_SSSE3
@@ -81,6 +82,7 @@ set(AOM_DSP_COMMON_INTRIN_AVX2
     "${AOM_ROOT}/aom_dsp/x86/aom_subpixel_8t_intrin_avx2.c"
     "${AOM_ROOT}/aom_dsp/x86/intrapred_avx2.c"
     "${AOM_ROOT}/aom_dsp/x86/inv_txfm_avx2.c"
+    "${AOM_ROOT}/aom_dsp/x86/prob_avx2.c"
     "${AOM_ROOT}/aom_dsp/x86/common_avx2.h"
     "${AOM_ROOT}/aom_dsp/x86/inv_txfm_common_avx2.h"
     "${AOM_ROOT}/aom_dsp/x86/txfm_common_avx2.h")
@@ -304,6 +306,14 @@ if (CONFIG_AV1_DECODER)
       "${AOM_ROOT}/aom_dsp/daalaboolreader.h"
       "${AOM_ROOT}/aom_dsp/entdec.c"
       "${AOM_ROOT}/aom_dsp/entdec.h")
+
+  set(AOM_DSP_COMMON_INTRIN_SSE2
+      ${AOM_DSP_COMMON_INTRIN_SSE2}
+      "${AOM_ROOT}/aom_dsp/x86/entdec_sse2.c")
+
+  set(AOM_DSP_COMMON_INTRIN_AVX2
+      ${AOM_DSP_COMMON_INTRIN_AVX2}
+      "${AOM_ROOT}/aom_dsp/x86/entdec_avx2.c")
 endif ()
 
 if (CONFIG_AV1_ENCODER)
@@ -445,10 +455,18 @@ if (CONFIG_LOOP_RESTORATION)
       ${AOM_DSP_COMMON_INTRIN_SSE2}
       "${AOM_ROOT}/aom_dsp/x86/aom_convolve_hip_sse2.c")
 
+  set(AOM_DSP_COMMON_INTRIN_AVX2
+      ${AOM_DSP_COMMON_INTRIN_AVX2}
+      "${AOM_ROOT}/aom_dsp/x86/aom_convolve_hip_avx2.c")
+
   if (CONFIG_HIGHBITDEPTH)
     set(AOM_DSP_COMMON_INTRIN_SSSE3
       ${AOM_DSP_COMMON_INTRIN_SSSE3}
         "${AOM_ROOT}/aom_dsp/x86/aom_highbd_convolve_hip_ssse3.c")
+
+    set(AOM_DSP_COMMON_INTRIN_AVX2
+        ${AOM_DSP_COMMON_INTRIN_AVX2}
+        "${AOM_ROOT}/aom_dsp/x86/aom_highbd_convolve_hip_avx2.c")
   endif ()
 endif ()
 
@@ -20,6 +20,8 @@ DSP_SRCS-$(ARCH_X86)$(ARCH_X86_64)   += x86/synonyms.h
 # bit reader
 DSP_SRCS-yes += prob.h
 DSP_SRCS-yes += prob.c
+DSP_SRCS-$(HAVE_SSE2) += x86/prob_sse2.c
+DSP_SRCS-$(HAVE_AVX2) += x86/prob_avx2.c
 
 ifeq ($(CONFIG_AV1_ENCODER),yes)
 DSP_SRCS-yes += entenc.c
@@ -44,6 +46,8 @@ DSP_SRCS-yes += entdec.c
 DSP_SRCS-yes += entdec.h
 DSP_SRCS-yes += daalaboolreader.c
 DSP_SRCS-yes += daalaboolreader.h
+DSP_SRCS-$(HAVE_SSE2) += x86/entdec_sse2.c
+DSP_SRCS-$(HAVE_AVX2) += x86/entdec_avx2.c
 DSP_SRCS-yes += bitreader.h
 DSP_SRCS-yes += bitreader_buffer.c
 DSP_SRCS-yes += bitreader_buffer.h
@@ -286,8 +290,10 @@ endif  # CONFIG_HIGHBITDEPTH
 
 ifeq ($(CONFIG_LOOP_RESTORATION),yes)
 DSP_SRCS-$(HAVE_SSE2)   += x86/aom_convolve_hip_sse2.c
+DSP_SRCS-$(HAVE_AVX2)   += x86/aom_convolve_hip_avx2.c
 ifeq ($(CONFIG_HIGHBITDEPTH),yes)
 DSP_SRCS-$(HAVE_SSSE3)  += x86/aom_highbd_convolve_hip_ssse3.c
+DSP_SRCS-$(HAVE_AVX2)   += x86/aom_highbd_convolve_hip_avx2.c
 endif
 endif  # CONFIG_LOOP_RESTORATION
 endif  # CONFIG_AV1
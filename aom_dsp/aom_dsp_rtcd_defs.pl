@@ -376,7 +376,7 @@ if (aom_config("CONFIG_LOOP_RESTORATION") eq "yes") {
   specialize qw/aom_convolve8_add_src ssse3/;
   specialize qw/aom_convolve8_add_src_horiz ssse3/;
   specialize qw/aom_convolve8_add_src_vert ssse3/;
-  specialize qw/aom_convolve8_add_src_hip sse2/;
+  specialize qw/aom_convolve8_add_src_hip sse2 avx2/;
 }  # CONFIG_LOOP_RESTORATION
 
 # TODO(any): These need to be extended to up to 128x128 block sizes
@@ -421,7 +421,7 @@ if (aom_config("CONFIG_HIGHBITDEPTH") eq "yes") {
     add_proto qw/void aom_highbd_convolve8_add_src_hip/, "const uint8_t *src, ptrdiff_t src_stride, uint8_t *dst, ptrdiff_t dst_stride, const int16_t *filter_x, int x_step_q4, const int16_t *filter_y, int y_step_q4, int w, int h, int bps";
 
     specialize qw/aom_highbd_convolve8_add_src/, "$sse2_x86_64";
-    specialize qw/aom_highbd_convolve8_add_src_hip ssse3/;
+    specialize qw/aom_highbd_convolve8_add_src_hip ssse3 avx2/;
   }  # CONFIG_LOOP_RESTORATION
 }  # CONFIG_HIGHBITDEPTH
 
@@ -550,6 +550,20 @@ if (aom_config("CONFIG_HIGHBITDEPTH") eq "yes") {
 add_proto qw/void av1_round_shift_array/, "int32_t *arr, int size, int bit";
 specialize "av1_round_shift_array", qw/sse4_1/;
 
+#
+# CDF adaptation
+#
+add_proto qw/void aom_update_cdf/, "uint16_t *cdf, int val, int nsymbs";
+specialize qw/aom_update_cdf sse2 avx2/;
+
+#
+# Entropy decoder
+#
+if (aom_config("CONFIG_AV1_DECODER") eq "yes") {
+  add_proto qw/int od_ec_cdf_search/, "unsigned c, unsigned r, const uint16_t *icdf, int nsyms";
+  specialize qw/od_ec_cdf_search sse2 avx2/;
+}
+
 #
 # Encoder functions.
 #
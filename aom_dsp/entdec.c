@@ -13,6 +13,7 @@
 #include "./config.h"
 #endif
 
+#include "./aom_dsp_rtcd.h"
 #include "aom_dsp/entdec.h"
 
 /*A range decoder.
@@ -75,9 +76,18 @@
   Even relatively modest values like 100 would work fine.*/
 #define OD_EC_LOTS_OF_BITS (0x4000)
 
+/*Reads a window's worth of the stream as a big-endian value.*/
+static od_ec_dec_window od_ec_dec_load_window(const unsigned char *bptr) {
+  od_ec_dec_window w;
+  int i;
+  w = 0;
+  for (i = 0; i < (int)sizeof(w); i++) w = w << 8 | bptr[i];
+  return w;
+}
+
 static void od_ec_dec_refill(od_ec_dec *dec) {
   int s;
-  od_ec_window dif;
+  od_ec_dec_window dif;
   int16_t cnt;
   const unsigned char *bptr;
   const unsigned char *end;
@@ -85,11 +95,23 @@ static void od_ec_dec_refill(od_ec_dec *dec) {
   cnt = dec->cnt;
   bptr = dec->bptr;
   end = dec->end;
-  s = OD_EC_WINDOW_SIZE - 9 - (cnt + 15);
-  for (; s >= 0 && bptr < end; s -= 8, bptr++) {
-    OD_ASSERT(s <= OD_EC_WINDOW_SIZE - 8);
-    dif ^= (od_ec_window)bptr[0] << s;
-    cnt += 8;
+  s = OD_EC_DEC_WINDOW_SIZE - 9 - (cnt + 15);
+  if (end - bptr >= (ptrdiff_t)sizeof(od_ec_dec_window)) {
+    /*Away from the end of the stream, take all the bytes that fit in one go:
+       the same bytes the loop below stores at s, s - 8, ..., s & 7.*/
+    int n;
+    OD_ASSERT(s >= 0);
+    n = (s >> 3) + 1;
+    dif ^= od_ec_dec_load_window(bptr) >> (OD_EC_DEC_WINDOW_SIZE - 8 * n)
+                                          << (s & 7);
+    bptr += n;
+    cnt += 8 * n;
+  } else {
+    for (; s >= 0 && bptr < end; s -= 8, bptr++) {
+      OD_ASSERT(s <= OD_EC_DEC_WINDOW_SIZE - 8);
+      dif ^= (od_ec_dec_window)bptr[0] << s;
+      cnt += 8;
+    }
   }
   if (bptr >= end) {
     dec->tell_offs += OD_EC_LOTS_OF_BITS - cnt;
@@ -108,8 +130,8 @@ static void od_ec_dec_refill(od_ec_dec *dec) {
   ret: The value to return.
   Return: ret.
           This allows the compiler to jump to this function via a tail-call.*/
-static int od_ec_dec_normalize(od_ec_dec *dec, od_ec_window dif, unsigned rng,
-                               int ret) {
+static int od_ec_dec_normalize(od_ec_dec *dec, od_ec_dec_window dif,
+                               unsigned rng, int ret) {
   int d;
   OD_ASSERT(rng <= 65535U);
   d = 16 - OD_ILOG_NZ(rng);
@@ -133,7 +155,7 @@ void od_ec_dec_init(od_ec_dec *dec, const unsigned char *buf,
   dec->tell_offs = 10 - (OD_EC_WINDOW_SIZE - 8);
   dec->end = buf + storage;
   dec->bptr = buf;
-  dec->dif = ((od_ec_window)1 << (OD_EC_WINDOW_SIZE - 1)) - 1;
+  dec->dif = ((od_ec_dec_window)1 << (OD_EC_DEC_WINDOW_SIZE - 1)) - 1;
   dec->rng = 0x8000;
   dec->cnt = -15;
   dec->error = 0;
@@ -144,8 +166,8 @@ void od_ec_dec_init(od_ec_dec *dec, const unsigned char *buf,
   f: The probability that the bit is one, scaled by 32768.
   Return: The value decoded (0 or 1).*/
 int od_ec_decode_bool_q15(od_ec_dec *dec, unsigned f) {
-  od_ec_window dif;
-  od_ec_window vw;
+  od_ec_dec_window dif;
+  od_ec_dec_window vw;
   unsigned r;
   unsigned r_new;
   unsigned v;
@@ -154,11 +176,11 @@ int od_ec_decode_bool_q15(od_ec_dec *dec, unsigned f) {
   OD_ASSERT(f < 32768U);
   dif = dec->dif;
   r = dec->rng;
-  OD_ASSERT(dif >> (OD_EC_WINDOW_SIZE - 16) < r);
+  OD_ASSERT(dif >> (OD_EC_DEC_WINDOW_SIZE - 16) < r);
   OD_ASSERT(32768U <= r);
   v = ((r >> 8) * (uint32_t)(f >> EC_PROB_SHIFT) >> (7 - EC_PROB_SHIFT));
   v += EC_MIN_PROB;
-  vw = (od_ec_window)v << (OD_EC_WINDOW_SIZE - 16);
+  vw = (od_ec_dec_window)v << (OD_EC_DEC_WINDOW_SIZE - 16);
   ret = 1;
   r_new = v;
   if (dif >= vw) {
@@ -179,36 +201,56 @@ int od_ec_decode_bool_q15(od_ec_dec *dec, unsigned f) {
          This should be at most 16.
   Return: The decoded symbol s.*/
 int od_ec_decode_cdf_q15(od_ec_dec *dec, const uint16_t *icdf, int nsyms) {
-  od_ec_window dif;
+  od_ec_dec_window dif;
   unsigned r;
   unsigned c;
   unsigned u;
   unsigned v;
   int ret;
-  (void)nsyms;
   dif = dec->dif;
   r = dec->rng;
   const int N = nsyms - 1;
 
-  OD_ASSERT(dif >> (OD_EC_WINDOW_SIZE - 16) < r);
+  OD_ASSERT(dif >> (OD_EC_DEC_WINDOW_SIZE - 16) < r);
   OD_ASSERT(icdf[nsyms - 1] == OD_ICDF(32768U));
   OD_ASSERT(32768U <= r);
-  c = (unsigned)(dif >> (OD_EC_WINDOW_SIZE - 16));
-  v = r;
-  ret = -1;
-  do {
-    u = v;
-    v = ((r >> 8) * (uint32_t)(icdf[++ret] >> EC_PROB_SHIFT) >>
-         (7 - EC_PROB_SHIFT));
-    v += EC_MIN_PROB * (N - ret);
-  } while (c < v);
+  c = (unsigned)(dif >> (OD_EC_DEC_WINDOW_SIZE - 16));
+  if (nsyms >= OD_EC_CDF_SEARCH_MIN_SYMS) {
+    ret = od_ec_cdf_search(c, r, icdf, nsyms);
+    u = ret > 0 ? od_ec_cdf_scale(r, icdf[ret - 1], N - ret + 1) : r;
+    v = od_ec_cdf_scale(r, icdf[ret], N - ret);
+  } else {
+    v = r;
+    ret = -1;
+    do {
+      u = v;
+      ++ret;
+      v = od_ec_cdf_scale(r, icdf[ret], N - ret);
+    } while (c < v);
+  }
   OD_ASSERT(v < u);
   OD_ASSERT(u <= r);
   r = u - v;
-  dif -= (od_ec_window)v << (OD_EC_WINDOW_SIZE - 16);
+  dif -= (od_ec_dec_window)v << (OD_EC_DEC_WINDOW_SIZE - 16);
   return od_ec_dec_normalize(dec, dif, r, ret);
 }
 
+/*Finds the symbol whose range holds c, the top 16 bits of the window, in a
+   range of r: the first s for which c is not below the scaled icdf[s].
+  The scaled values decrease with s, so this is also the number of symbols
+   whose scaled values are above c, which the SIMD versions count in parallel.
+  nsyms: The number of symbols in the alphabet, from
+          OD_EC_CDF_SEARCH_MIN_SYMS to 16.
+  Return: The decoded symbol s.*/
+int od_ec_cdf_search_c(unsigned c, unsigned r, const uint16_t *icdf,
+                       int nsyms) {
+  const int N = nsyms - 1;
+  int ret;
+  ret = 0;
+  while (c < od_ec_cdf_scale(r, icdf[ret], N - ret)) ret++;
+  return ret;
+}
+
 /*Returns the number of bits "used" by the decoded symbols so far.
   This same number can be computed in either the encoder or the decoder, and is
    suitable for making coding decisions.
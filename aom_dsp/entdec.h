@@ -20,6 +20,20 @@ extern "C" {
 
 typedef struct od_ec_dec od_ec_dec;
 
+/*The decoder window is as wide as a machine word, so that each refill reads
+   as many bytes of the stream as it can at once.*/
+#if UINTPTR_MAX > 0xFFFFFFFFU
+typedef uint64_t od_ec_dec_window;
+#define OD_EC_DEC_WINDOW_SIZE (64)
+#else
+typedef uint32_t od_ec_dec_window;
+#define OD_EC_DEC_WINDOW_SIZE (32)
+#endif
+
+/*The smallest alphabet whose symbols od_ec_cdf_search() finds, rather than a
+   linear scan inlined in od_ec_decode_cdf_q15().*/
+#define OD_EC_CDF_SEARCH_MIN_SYMS (8)
+
 #if defined(OD_ACCOUNTING) && OD_ACCOUNTING
 #define OD_ACC_STR , char *acc_str
 #define od_ec_dec_bits(dec, ftb, str) od_ec_dec_bits_(dec, ftb, str)
@@ -49,12 +63,12 @@ struct od_ec_dec {
   const unsigned char *bptr;
   /*The difference between the high end of the current range, (low + rng), and
      the coded value, minus 1.
-    This stores up to OD_EC_WINDOW_SIZE bits of that difference, but the
+    This stores up to OD_EC_DEC_WINDOW_SIZE bits of that difference, but the
      decoder only uses the top 16 bits of the window to decode the next symbol.
     As we shift up during renormalization, if we don't have enough bits left in
      the window to fill the top 16, we'll read in more bits of the coded
      value.*/
-  od_ec_window dif;
+  od_ec_dec_window dif;
   /*The number of values in the current range.*/
   uint16_t rng;
   /*The number of bits of data in the current value.*/
@@ -74,6 +88,14 @@ OD_WARN_UNUSED_RESULT int od_ec_decode_cdf_q15(od_ec_dec *dec,
                                                const uint16_t *cdf, int nsyms)
     OD_ARG_NONNULL(1) OD_ARG_NONNULL(2);
 
+/*Scales the iCDF value of a symbol to the current range r, n symbols from the
+   end of the alphabet: the bottom of the range of the symbol, relative to the
+   top of the window.*/
+static INLINE unsigned od_ec_cdf_scale(unsigned r, unsigned icdf, int n) {
+  return ((r >> 8) * (uint32_t)(icdf >> EC_PROB_SHIFT) >> (7 - EC_PROB_SHIFT)) +
+         EC_MIN_PROB * n;
+}
+
 OD_WARN_UNUSED_RESULT uint32_t od_ec_dec_bits_(od_ec_dec *dec, unsigned ftb)
     OD_ARG_NONNULL(1);
 
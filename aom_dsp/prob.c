@@ -13,6 +13,7 @@
 
 #include <string.h>
 
+#include "./aom_dsp_rtcd.h"
 #include "aom_dsp/prob.h"
 
 static unsigned int tree_merge_probs_impl(unsigned int i,
@@ -215,3 +216,11 @@ void av1_indices_from_tree(int *ind, int *inv, const aom_tree_index *tree) {
   int stack_index = 0;
   tree_to_index(&stack_index, ind, inv, tree, 0, 0);
 }
+
+void aom_update_cdf_c(uint16_t *cdf, int val, int nsymbs) {
+  update_cdf_scalar(cdf, val, nsymbs);
+}
+
+void aom_update_wide_cdf(aom_cdf_prob *cdf, int val, int nsymbs) {
+  aom_update_cdf(cdf, val, nsymbs);
+}
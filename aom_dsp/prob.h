@@ -207,7 +207,15 @@ static INLINE void av1_tree_to_cdf(const aom_tree_index *tree,
 
 void av1_indices_from_tree(int *ind, int *inv, const aom_tree_index *tree);
 
-static INLINE void update_cdf(aom_cdf_prob *cdf, int val, int nsymbs) {
+// The smallest alphabet whose adaptation goes through aom_update_cdf(), which
+// updates 8 or 16 entries at a time.
+#define AOM_UPDATE_CDF_MIN_SYMS (8)
+
+// Adapts the CDF of an alphabet of any size through the RTCD kernels. This is
+// out of line since prob.h cannot include aom_dsp_rtcd.h, which includes it.
+void aom_update_wide_cdf(aom_cdf_prob *cdf, int val, int nsymbs);
+
+static INLINE void update_cdf_scalar(aom_cdf_prob *cdf, int val, int nsymbs) {
   int rate = 4 + (cdf[nsymbs] > 31) + get_msb(nsymbs);
 #if CONFIG_LV_MAP
   if (nsymbs == 2)
@@ -265,6 +273,16 @@ static INLINE void update_cdf(aom_cdf_prob *cdf, int val, int nsymbs) {
   cdf[nsymbs] += (cdf[nsymbs] < 32);
 }
 
+static INLINE void update_cdf(aom_cdf_prob *cdf, int val, int nsymbs) {
+#if !CONFIG_LV_MAP_MULTI
+  if (nsymbs >= AOM_UPDATE_CDF_MIN_SYMS) {
+    aom_update_wide_cdf(cdf, val, nsymbs);
+    return;
+  }
+#endif
+  update_cdf_scalar(cdf, val, nsymbs);
+}
+
 #if CONFIG_LV_MAP
 static INLINE void update_bin(aom_cdf_prob *cdf, int val, int nsymbs) {
   update_cdf(cdf, val, nsymbs);
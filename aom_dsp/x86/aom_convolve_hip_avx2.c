@@ -0,0 +1,211 @@
+/*
+ * Copyright (c) 2017, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <immintrin.h>
+#include <assert.h>
+
+#include "./aom_dsp_rtcd.h"
+#include "aom_dsp/aom_convolve.h"
+#include "aom_dsp/aom_dsp_common.h"
+#include "aom_dsp/aom_filter.h"
+
+// Load the 16 bytes at p into the low lane and the 16 bytes at p + 8 into the
+// high lane, so that each lane holds the 8 + 7 source pixels needed for 8
+// outputs. Two 128-bit loads are used so that we read no further than the
+// SSE2 version does.
+static INLINE __m256i load_src_x2(const uint8_t *p) {
+  return _mm256_inserti128_si256(
+      _mm256_castsi128_si256(_mm_loadu_si128((const __m128i *)p)),
+      _mm_loadu_si128((const __m128i *)(p + 8)), 1);
+}
+
+void aom_convolve8_add_src_hip_avx2(const uint8_t *src, ptrdiff_t src_stride,
+                                    uint8_t *dst, ptrdiff_t dst_stride,
+                                    const int16_t *filter_x, int x_step_q4,
+                                    const int16_t *filter_y, int y_step_q4,
+                                    int w, int h) {
+  // The kernel below produces 16 pixels per iteration.
+  if (w & 15) {
+    aom_convolve8_add_src_hip_sse2(src, src_stride, dst, dst_stride, filter_x,
+                                   x_step_q4, filter_y, y_step_q4, w, h);
+    return;
+  }
+
+  const int bd = 8;
+  assert(x_step_q4 == 16 && y_step_q4 == 16);
+  (void)x_step_q4;
+  (void)y_step_q4;
+
+  DECLARE_ALIGNED(32, uint16_t,
+                  temp[(MAX_SB_SIZE + SUBPEL_TAPS - 1) * MAX_SB_SIZE]);
+  const int intermediate_height = h + SUBPEL_TAPS - 1;
+  int i, j;
+  const int center_tap = ((SUBPEL_TAPS - 1) / 2);
+  const uint8_t *const src_ptr = src - center_tap * src_stride - center_tap;
+
+  const __m128i zero_128 = _mm_setzero_si128();
+  const __m256i zero = _mm256_setzero_si256();
+  // Add an offset to account for the "add_src" part of the convolve function.
+  const __m128i offset = _mm_insert_epi16(zero_128, 1 << FILTER_BITS, 3);
+
+  /* Horizontal filter */
+  {
+    const __m256i coeffs_x = _mm256_broadcastsi128_si256(
+        _mm_add_epi16(_mm_loadu_si128((__m128i *)filter_x), offset));
+
+    // coeffs 0 1 0 1 2 3 2 3
+    const __m256i tmp_0 = _mm256_unpacklo_epi32(coeffs_x, coeffs_x);
+    // coeffs 4 5 4 5 6 7 6 7
+    const __m256i tmp_1 = _mm256_unpackhi_epi32(coeffs_x, coeffs_x);
+
+    // coeffs 0 1 0 1 0 1 0 1
+    const __m256i coeff_01 = _mm256_unpacklo_epi64(tmp_0, tmp_0);
+    // coeffs 2 3 2 3 2 3 2 3
+    const __m256i coeff_23 = _mm256_unpackhi_epi64(tmp_0, tmp_0);
+    // coeffs 4 5 4 5 4 5 4 5
+    const __m256i coeff_45 = _mm256_unpacklo_epi64(tmp_1, tmp_1);
+    // coeffs 6 7 6 7 6 7 6 7
+    const __m256i coeff_67 = _mm256_unpackhi_epi64(tmp_1, tmp_1);
+
+    const __m256i round_const =
+        _mm256_set1_epi32((1 << (FILTER_BITS - EXTRAPREC_BITS - 1)) +
+                          (1 << (bd + FILTER_BITS - 1)));
+    const __m256i maxval = _mm256_set1_epi16(EXTRAPREC_CLAMP_LIMIT(bd) - 1);
+
+    for (i = 0; i < intermediate_height; ++i) {
+      for (j = 0; j < w; j += 16) {
+        const __m256i data = load_src_x2(&src_ptr[i * src_stride + j]);
+
+        // Filter even-index pixels
+        const __m256i src_0 = _mm256_unpacklo_epi8(data, zero);
+        const __m256i res_0 = _mm256_madd_epi16(src_0, coeff_01);
+        const __m256i src_2 =
+            _mm256_unpacklo_epi8(_mm256_srli_si256(data, 2), zero);
+        const __m256i res_2 = _mm256_madd_epi16(src_2, coeff_23);
+        const __m256i src_4 =
+            _mm256_unpacklo_epi8(_mm256_srli_si256(data, 4), zero);
+        const __m256i res_4 = _mm256_madd_epi16(src_4, coeff_45);
+        const __m256i src_6 =
+            _mm256_unpacklo_epi8(_mm256_srli_si256(data, 6), zero);
+        const __m256i res_6 = _mm256_madd_epi16(src_6, coeff_67);
+
+        __m256i res_even = _mm256_add_epi32(_mm256_add_epi32(res_0, res_4),
+                                            _mm256_add_epi32(res_2, res_6));
+        res_even = _mm256_srai_epi32(_mm256_add_epi32(res_even, round_const),
+                                     FILTER_BITS - EXTRAPREC_BITS);
+
+        // Filter odd-index pixels
+        const __m256i src_1 =
+            _mm256_unpacklo_epi8(_mm256_srli_si256(data, 1), zero);
+        const __m256i res_1 = _mm256_madd_epi16(src_1, coeff_01);
+        const __m256i src_3 =
+            _mm256_unpacklo_epi8(_mm256_srli_si256(data, 3), zero);
+        const __m256i res_3 = _mm256_madd_epi16(src_3, coeff_23);
+        const __m256i src_5 =
+            _mm256_unpacklo_epi8(_mm256_srli_si256(data, 5), zero);
+        const __m256i res_5 = _mm256_madd_epi16(src_5, coeff_45);
+        const __m256i src_7 =
+            _mm256_unpacklo_epi8(_mm256_srli_si256(data, 7), zero);
+        const __m256i res_7 = _mm256_madd_epi16(src_7, coeff_67);
+
+        __m256i res_odd = _mm256_add_epi32(_mm256_add_epi32(res_1, res_5),
+                                           _mm256_add_epi32(res_3, res_7));
+        res_odd = _mm256_srai_epi32(_mm256_add_epi32(res_odd, round_const),
+                                    FILTER_BITS - EXTRAPREC_BITS);
+
+        // Pack each lane in the column order 0, 2, 4, 6, 1, 3, 5, 7
+        __m256i res = _mm256_packs_epi32(res_even, res_odd);
+        res = _mm256_min_epi16(_mm256_max_epi16(res, zero), maxval);
+        _mm256_store_si256((__m256i *)&temp[i * MAX_SB_SIZE + j], res);
+      }
+    }
+  }
+
+  /* Vertical filter */
+  {
+    const __m256i coeffs_y = _mm256_broadcastsi128_si256(
+        _mm_add_epi16(_mm_loadu_si128((__m128i *)filter_y), offset));
+
+    // coeffs 0 1 0 1 2 3 2 3
+    const __m256i tmp_0 = _mm256_unpacklo_epi32(coeffs_y, coeffs_y);
+    // coeffs 4 5 4 5 6 7 6 7
+    const __m256i tmp_1 = _mm256_unpackhi_epi32(coeffs_y, coeffs_y);
+
+    // coeffs 0 1 0 1 0 1 0 1
+    const __m256i coeff_01 = _mm256_unpacklo_epi64(tmp_0, tmp_0);
+    // coeffs 2 3 2 3 2 3 2 3
+    const __m256i coeff_23 = _mm256_unpackhi_epi64(tmp_0, tmp_0);
+    // coeffs 4 5 4 5 4 5 4 5
+    const __m256i coeff_45 = _mm256_unpacklo_epi64(tmp_1, tmp_1);
+    // coeffs 6 7 6 7 6 7 6 7
+    const __m256i coeff_67 = _mm256_unpackhi_epi64(tmp_1, tmp_1);
+
+    const __m256i round_const =
+        _mm256_set1_epi32((1 << (FILTER_BITS + EXTRAPREC_BITS - 1)) -
+                          (1 << (bd + FILTER_BITS + EXTRAPREC_BITS - 1)));
+
+    for (i = 0; i < h; ++i) {
+      for (j = 0; j < w; j += 16) {
+        const uint16_t *data = &temp[i * MAX_SB_SIZE + j];
+        __m256i s[8];
+        for (int k = 0; k < 8; ++k)
+          s[k] = _mm256_load_si256((__m256i *)(data + k * MAX_SB_SIZE));
+
+        // Filter even-index pixels
+        const __m256i res_0 =
+            _mm256_madd_epi16(_mm256_unpacklo_epi16(s[0], s[1]), coeff_01);
+        const __m256i res_2 =
+            _mm256_madd_epi16(_mm256_unpacklo_epi16(s[2], s[3]), coeff_23);
+        const __m256i res_4 =
+            _mm256_madd_epi16(_mm256_unpacklo_epi16(s[4], s[5]), coeff_45);
+        const __m256i res_6 =
+            _mm256_madd_epi16(_mm256_unpacklo_epi16(s[6], s[7]), coeff_67);
+
+        const __m256i res_even = _mm256_add_epi32(
+            _mm256_add_epi32(res_0, res_2), _mm256_add_epi32(res_4, res_6));
+
+        // Filter odd-index pixels
+        const __m256i res_1 =
+            _mm256_madd_epi16(_mm256_unpackhi_epi16(s[0], s[1]), coeff_01);
+        const __m256i res_3 =
+            _mm256_madd_epi16(_mm256_unpackhi_epi16(s[2], s[3]), coeff_23);
+        const __m256i res_5 =
+            _mm256_madd_epi16(_mm256_unpackhi_epi16(s[4], s[5]), coeff_45);
+        const __m256i res_7 =
+            _mm256_madd_epi16(_mm256_unpackhi_epi16(s[6], s[7]), coeff_67);
+
+        const __m256i res_odd = _mm256_add_epi32(
+            _mm256_add_epi32(res_1, res_3), _mm256_add_epi32(res_5, res_7));
+
+        // Rearrange pixels back into the order 0 ... 7 within each lane
+        const __m256i res_lo = _mm256_unpacklo_epi32(res_even, res_odd);
+        const __m256i res_hi = _mm256_unpackhi_epi32(res_even, res_odd);
+
+        const __m256i res_lo_round =
+            _mm256_srai_epi32(_mm256_add_epi32(res_lo, round_const),
+                              FILTER_BITS + EXTRAPREC_BITS);
+        const __m256i res_hi_round =
+            _mm256_srai_epi32(_mm256_add_epi32(res_hi, round_const),
+                              FILTER_BITS + EXTRAPREC_BITS);
+
+        // Each lane now holds 8 output pixels; pack them to bytes and bring
+        // the two halves together in the low 128 bits.
+        const __m256i res_16bit =
+            _mm256_packs_epi32(res_lo_round, res_hi_round);
+        const __m256i res_8bit = _mm256_permute4x64_epi64(
+            _mm256_packus_epi16(res_16bit, res_16bit), _MM_SHUFFLE(0, 0, 2, 0));
+
+        _mm_storeu_si128((__m128i *)&dst[i * dst_stride + j],
+                         _mm256_castsi256_si128(res_8bit));
+      }
+    }
+  }
+}
@@ -0,0 +1,202 @@
+/*
+ * Copyright (c) 2017, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <immintrin.h>
+#include <assert.h>
+
+#include "./aom_dsp_rtcd.h"
+#include "aom_dsp/aom_convolve.h"
+#include "aom_dsp/aom_dsp_common.h"
+#include "aom_dsp/aom_filter.h"
+
+#if EXTRAPREC_BITS > 2
+#error "Highbd high-prec convolve filter only supports EXTRAPREC_BITS <= 2"
+#error "(need to use 32-bit intermediates for EXTRAPREC_BITS > 2)"
+#endif
+
+void aom_highbd_convolve8_add_src_hip_avx2(
+    const uint8_t *src8, ptrdiff_t src_stride, uint8_t *dst8,
+    ptrdiff_t dst_stride, const int16_t *filter_x, int x_step_q4,
+    const int16_t *filter_y, int y_step_q4, int w, int h, int bd) {
+  // The kernel below produces 16 pixels per iteration.
+  if (w & 15) {
+    aom_highbd_convolve8_add_src_hip_ssse3(src8, src_stride, dst8, dst_stride,
+                                           filter_x, x_step_q4, filter_y,
+                                           y_step_q4, w, h, bd);
+    return;
+  }
+
+  assert(x_step_q4 == 16 && y_step_q4 == 16);
+  (void)x_step_q4;
+  (void)y_step_q4;
+
+  const uint16_t *const src = CONVERT_TO_SHORTPTR(src8);
+  uint16_t *const dst = CONVERT_TO_SHORTPTR(dst8);
+
+  DECLARE_ALIGNED(32, uint16_t,
+                  temp[(MAX_SB_SIZE + SUBPEL_TAPS - 1) * MAX_SB_SIZE]);
+  const int intermediate_height = h + SUBPEL_TAPS - 1;
+  int i, j;
+  const int center_tap = ((SUBPEL_TAPS - 1) / 2);
+  const uint16_t *const src_ptr = src - center_tap * src_stride - center_tap;
+
+  const __m256i zero = _mm256_setzero_si256();
+  // Add an offset to account for the "add_src" part of the convolve function.
+  const __m128i offset =
+      _mm_insert_epi16(_mm_setzero_si128(), 1 << FILTER_BITS, 3);
+
+  /* Horizontal filter */
+  {
+    const __m256i coeffs_x = _mm256_broadcastsi128_si256(
+        _mm_add_epi16(_mm_loadu_si128((__m128i *)filter_x), offset));
+
+    // coeffs 0 1 0 1 2 3 2 3
+    const __m256i tmp_0 = _mm256_unpacklo_epi32(coeffs_x, coeffs_x);
+    // coeffs 4 5 4 5 6 7 6 7
+    const __m256i tmp_1 = _mm256_unpackhi_epi32(coeffs_x, coeffs_x);
+
+    // coeffs 0 1 0 1 0 1 0 1
+    const __m256i coeff_01 = _mm256_unpacklo_epi64(tmp_0, tmp_0);
+    // coeffs 2 3 2 3 2 3 2 3
+    const __m256i coeff_23 = _mm256_unpackhi_epi64(tmp_0, tmp_0);
+    // coeffs 4 5 4 5 4 5 4 5
+    const __m256i coeff_45 = _mm256_unpacklo_epi64(tmp_1, tmp_1);
+    // coeffs 6 7 6 7 6 7 6 7
+    const __m256i coeff_67 = _mm256_unpackhi_epi64(tmp_1, tmp_1);
+
+    const __m256i round_const =
+        _mm256_set1_epi32((1 << (FILTER_BITS - EXTRAPREC_BITS - 1)) +
+                          (1 << (bd + FILTER_BITS - 1)));
+    const __m256i maxval = _mm256_set1_epi16(EXTRAPREC_CLAMP_LIMIT(bd) - 1);
+
+    for (i = 0; i < intermediate_height; ++i) {
+      for (j = 0; j < w; j += 16) {
+        // data holds pixels j .. j + 15 and data2 holds pixels j + 8 .. j + 23,
+        // so that within each lane alignr() sees the 8 + 7 pixels it needs.
+        const uint16_t *const p = &src_ptr[i * src_stride + j];
+        const __m256i data = _mm256_loadu_si256((__m256i *)p);
+        const __m256i data2 = _mm256_loadu_si256((__m256i *)(p + 8));
+        const __m256i a = _mm256_permute2x128_si256(data, data2, 0x20);
+        const __m256i b = _mm256_permute2x128_si256(data, data2, 0x31);
+
+        // Filter even-index pixels
+        const __m256i res_0 = _mm256_madd_epi16(a, coeff_01);
+        const __m256i res_2 =
+            _mm256_madd_epi16(_mm256_alignr_epi8(b, a, 4), coeff_23);
+        const __m256i res_4 =
+            _mm256_madd_epi16(_mm256_alignr_epi8(b, a, 8), coeff_45);
+        const __m256i res_6 =
+            _mm256_madd_epi16(_mm256_alignr_epi8(b, a, 12), coeff_67);
+
+        __m256i res_even = _mm256_add_epi32(_mm256_add_epi32(res_0, res_4),
+                                            _mm256_add_epi32(res_2, res_6));
+        res_even = _mm256_srai_epi32(_mm256_add_epi32(res_even, round_const),
+                                     FILTER_BITS - EXTRAPREC_BITS);
+
+        // Filter odd-index pixels
+        const __m256i res_1 =
+            _mm256_madd_epi16(_mm256_alignr_epi8(b, a, 2), coeff_01);
+        const __m256i res_3 =
+            _mm256_madd_epi16(_mm256_alignr_epi8(b, a, 6), coeff_23);
+        const __m256i res_5 =
+            _mm256_madd_epi16(_mm256_alignr_epi8(b, a, 10), coeff_45);
+        const __m256i res_7 =
+            _mm256_madd_epi16(_mm256_alignr_epi8(b, a, 14), coeff_67);
+
+        __m256i res_odd = _mm256_add_epi32(_mm256_add_epi32(res_1, res_5),
+                                           _mm256_add_epi32(res_3, res_7));
+        res_odd = _mm256_srai_epi32(_mm256_add_epi32(res_odd, round_const),
+                                    FILTER_BITS - EXTRAPREC_BITS);
+
+        // Pack each lane in the column order 0, 2, 4, 6, 1, 3, 5, 7
+        __m256i res = _mm256_packs_epi32(res_even, res_odd);
+        res = _mm256_min_epi16(_mm256_max_epi16(res, zero), maxval);
+        _mm256_store_si256((__m256i *)&temp[i * MAX_SB_SIZE + j], res);
+      }
+    }
+  }
+
+  /* Vertical filter */
+  {
+    const __m256i coeffs_y = _mm256_broadcastsi128_si256(
+        _mm_add_epi16(_mm_loadu_si128((__m128i *)filter_y), offset));
+
+    // coeffs 0 1 0 1 2 3 2 3
+    const __m256i tmp_0 = _mm256_unpacklo_epi32(coeffs_y, coeffs_y);
+    // coeffs 4 5 4 5 6 7 6 7
+    const __m256i tmp_1 = _mm256_unpackhi_epi32(coeffs_y, coeffs_y);
+
+    // coeffs 0 1 0 1 0 1 0 1
+    const __m256i coeff_01 = _mm256_unpacklo_epi64(tmp_0, tmp_0);
+    // coeffs 2 3 2 3 2 3 2 3
+    const __m256i coeff_23 = _mm256_unpackhi_epi64(tmp_0, tmp_0);
+    // coeffs 4 5 4 5 4 5 4 5
+    const __m256i coeff_45 = _mm256_unpacklo_epi64(tmp_1, tmp_1);
+    // coeffs 6 7 6 7 6 7 6 7
+    const __m256i coeff_67 = _mm256_unpackhi_epi64(tmp_1, tmp_1);
+
+    const __m256i round_const =
+        _mm256_set1_epi32((1 << (FILTER_BITS + EXTRAPREC_BITS - 1)) -
+                          (1 << (bd + FILTER_BITS + EXTRAPREC_BITS - 1)));
+    const __m256i maxval = _mm256_set1_epi16((1 << bd) - 1);
+
+    for (i = 0; i < h; ++i) {
+      for (j = 0; j < w; j += 16) {
+        const uint16_t *data = &temp[i * MAX_SB_SIZE + j];
+        __m256i s[8];
+        for (int k = 0; k < 8; ++k)
+          s[k] = _mm256_load_si256((__m256i *)(data + k * MAX_SB_SIZE));
+
+        // Filter even-index pixels
+        const __m256i res_0 =
+            _mm256_madd_epi16(_mm256_unpacklo_epi16(s[0], s[1]), coeff_01);
+        const __m256i res_2 =
+            _mm256_madd_epi16(_mm256_unpacklo_epi16(s[2], s[3]), coeff_23);
+        const __m256i res_4 =
+            _mm256_madd_epi16(_mm256_unpacklo_epi16(s[4], s[5]), coeff_45);
+        const __m256i res_6 =
+            _mm256_madd_epi16(_mm256_unpacklo_epi16(s[6], s[7]), coeff_67);
+
+        const __m256i res_even = _mm256_add_epi32(
+            _mm256_add_epi32(res_0, res_2), _mm256_add_epi32(res_4, res_6));
+
+        // Filter odd-index pixels
+        const __m256i res_1 =
+            _mm256_madd_epi16(_mm256_unpackhi_epi16(s[0], s[1]), coeff_01);
+        const __m256i res_3 =
+            _mm256_madd_epi16(_mm256_unpackhi_epi16(s[2], s[3]), coeff_23);
+        const __m256i res_5 =
+            _mm256_madd_epi16(_mm256_unpackhi_epi16(s[4], s[5]), coeff_45);
+        const __m256i res_7 =
+            _mm256_madd_epi16(_mm256_unpackhi_epi16(s[6], s[7]), coeff_67);
+
+        const __m256i res_odd = _mm256_add_epi32(
+            _mm256_add_epi32(res_1, res_3), _mm256_add_epi32(res_5, res_7));
+
+        // Rearrange pixels back into the order 0 ... 7 within each lane
+        const __m256i res_lo = _mm256_unpacklo_epi32(res_even, res_odd);
+        const __m256i res_hi = _mm256_unpackhi_epi32(res_even, res_odd);
+
+        const __m256i res_lo_round =
+            _mm256_srai_epi32(_mm256_add_epi32(res_lo, round_const),
+                              FILTER_BITS + EXTRAPREC_BITS);
+        const __m256i res_hi_round =
+            _mm256_srai_epi32(_mm256_add_epi32(res_hi, round_const),
+                              FILTER_BITS + EXTRAPREC_BITS);
+
+        __m256i res_16bit = _mm256_packs_epi32(res_lo_round, res_hi_round);
+        res_16bit = _mm256_min_epi16(_mm256_max_epi16(res_16bit, zero), maxval);
+
+        _mm256_storeu_si256((__m256i *)&dst[i * dst_stride + j], res_16bit);
+      }
+    }
+  }
+}
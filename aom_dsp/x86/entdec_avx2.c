@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) 2017, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <assert.h>
+#include <immintrin.h>
+
+#include "./aom_dsp_rtcd.h"
+#include "aom_dsp/entdec.h"
+
+// The same search as od_ec_cdf_search_sse2(), over all 16 symbols at once.
+// Smaller alphabets cannot load 16 icdf values, and use the SSE2 version.
+int od_ec_cdf_search_avx2(unsigned c, unsigned r, const uint16_t *icdf,
+                          int nsyms) {
+  const __m256i c_biased = _mm256_set1_epi16((int16_t)(c ^ 0x8000));
+  const __m256i r8 = _mm256_set1_epi16((int16_t)(r >> 8));
+  __m256i p, lo, hi, v;
+  unsigned mask;
+  assert(nsyms >= 8 && nsyms <= 16);
+  if (nsyms < 16) return od_ec_cdf_search_sse2(c, r, icdf, nsyms);
+
+  p = _mm256_srli_epi16(_mm256_loadu_si256((const __m256i *)icdf),
+                        EC_PROB_SHIFT);
+  lo = _mm256_mullo_epi16(r8, p);
+  hi = _mm256_mulhi_epu16(r8, p);
+  v = _mm256_or_si256(_mm256_srli_epi16(lo, 7 - EC_PROB_SHIFT),
+                      _mm256_slli_epi16(hi, 16 - (7 - EC_PROB_SHIFT)));
+#if EC_MIN_PROB
+  v = _mm256_add_epi16(
+      v, _mm256_setr_epi16(15 * EC_MIN_PROB, 14 * EC_MIN_PROB,
+                           13 * EC_MIN_PROB, 12 * EC_MIN_PROB,
+                           11 * EC_MIN_PROB, 10 * EC_MIN_PROB, 9 * EC_MIN_PROB,
+                           8 * EC_MIN_PROB, 7 * EC_MIN_PROB, 6 * EC_MIN_PROB,
+                           5 * EC_MIN_PROB, 4 * EC_MIN_PROB, 3 * EC_MIN_PROB,
+                           2 * EC_MIN_PROB, EC_MIN_PROB, 0));
+#endif
+  v = _mm256_xor_si256(v, _mm256_set1_epi16((int16_t)0x8000));
+  mask = (unsigned)_mm256_movemask_epi8(_mm256_cmpgt_epi16(v, c_biased));
+  // Symbol 15 is never above c, so the mask has at most 30 bits set.
+  return get_msb(mask + 1) >> 1;
+}
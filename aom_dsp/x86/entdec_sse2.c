@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2017, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <assert.h>
+#include <emmintrin.h>
+
+#include "./aom_dsp_rtcd.h"
+#include "aom_dsp/entdec.h"
+
+// Counts how many of the 8 symbols from |first| have scaled icdf values above
+// c. The values decrease with the symbol, so these symbols are a prefix of the
+// 8, and the compare mask is a run of ones from bit 0.
+static INLINE int count_above_8(__m128i c_biased, __m128i r8,
+                                const uint16_t *icdf, int n, int first) {
+  const __m128i p = _mm_srli_epi16(
+      _mm_loadu_si128((const __m128i *)(icdf + first)), EC_PROB_SHIFT);
+  // The product of r >> 8 and the icdf value takes up to 23 bits, but the
+  // scaled value fits in 16.
+  const __m128i lo = _mm_mullo_epi16(r8, p);
+  const __m128i hi = _mm_mulhi_epu16(r8, p);
+  __m128i v = _mm_or_si128(_mm_srli_epi16(lo, 7 - EC_PROB_SHIFT),
+                           _mm_slli_epi16(hi, 16 - (7 - EC_PROB_SHIFT)));
+  int mask;
+#if EC_MIN_PROB
+  v = _mm_add_epi16(
+      v, _mm_sub_epi16(_mm_set1_epi16(EC_MIN_PROB * (n - first)),
+                       _mm_setr_epi16(0, EC_MIN_PROB, 2 * EC_MIN_PROB,
+                                      3 * EC_MIN_PROB, 4 * EC_MIN_PROB,
+                                      5 * EC_MIN_PROB, 6 * EC_MIN_PROB,
+                                      7 * EC_MIN_PROB)));
+#else
+  (void)n;
+#endif
+  // Unsigned compare, by biasing both sides.
+  v = _mm_xor_si128(v, _mm_set1_epi16((int16_t)0x8000));
+  mask = _mm_movemask_epi8(_mm_cmpgt_epi16(v, c_biased));
+  return get_msb(mask + 1) >> 1;
+}
+
+int od_ec_cdf_search_sse2(unsigned c, unsigned r, const uint16_t *icdf,
+                          int nsyms) {
+  const int n = nsyms - 1;
+  const __m128i c_biased = _mm_set1_epi16((int16_t)(c ^ 0x8000));
+  const __m128i r8 = _mm_set1_epi16((int16_t)(r >> 8));
+  int ret;
+  assert(nsyms >= 8 && nsyms <= 16);
+
+  ret = count_above_8(c_biased, r8, icdf, n, 0);
+  if (ret < 8) return ret;
+  // The last 8 symbols, which overlap the first 8 unless nsyms is 16. The
+  // symbol n is never above c, so this always finds the end of the prefix.
+  return nsyms - 8 + count_above_8(c_biased, r8, icdf, n, nsyms - 8);
+}
@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) 2017, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <assert.h>
+#include <immintrin.h>
+
+#include "./aom_dsp_rtcd.h"
+#include "aom_dsp/prob.h"
+
+// The same update as aom_update_cdf_sse2(), over 16 entries at once. Smaller
+// alphabets do not have 16 entries to load, and use the SSE2 version.
+void aom_update_cdf_avx2(uint16_t *cdf, int val, int nsymbs) {
+  const int rate = 4 + (cdf[nsymbs] > 31) + get_msb(nsymbs);
+  const int diff = ((CDF_PROB_TOP - (nsymbs << 5)) >> rate) << rate;
+  const __m256i idx = _mm256_setr_epi16(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11,
+                                        12, 13, 14, 15);
+  __m256i c, target, delta;
+  assert(nsymbs >= AOM_UPDATE_CDF_MIN_SYMS && nsymbs <= 16);
+  if (nsymbs < 15) {
+    aom_update_cdf_sse2(cdf, val, nsymbs);
+    return;
+  }
+
+  c = _mm256_loadu_si256((const __m256i *)cdf);
+  target = _mm256_sub_epi16(_mm256_set1_epi16(AOM_ICDF(32)),
+                            _mm256_slli_epi16(idx, 5));
+  target = _mm256_sub_epi16(
+      target, _mm256_and_si256(
+                  _mm256_cmpgt_epi16(idx, _mm256_set1_epi16(val - 1)),
+                  _mm256_set1_epi16(diff)));
+  delta = _mm256_sra_epi16(_mm256_sub_epi16(target, c),
+                           _mm_cvtsi32_si128(rate));
+  delta = _mm256_and_si256(
+      delta, _mm256_cmpgt_epi16(_mm256_set1_epi16(nsymbs - 1), idx));
+  _mm256_storeu_si256((__m256i *)cdf, _mm256_add_epi16(c, delta));
+  cdf[nsymbs] += (cdf[nsymbs] < 32);
+}
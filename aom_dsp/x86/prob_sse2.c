@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2017, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <assert.h>
+#include <emmintrin.h>
+
+#include "./aom_dsp_rtcd.h"
+#include "aom_dsp/prob.h"
+
+// Moves 8 entries of the inverse CDF, those of the symbols in |idx|, towards
+// the distribution that codes |val|, as update_cdf_scalar() does. Lanes from
+// |n| on are left as they are.
+// The targets are at least 32 and at most 32736, and the entries at most
+// 32768, so the differences fit in 16 signed bits and the shift is exact.
+static INLINE __m128i update_8(__m128i cdf, __m128i idx, __m128i val_m1,
+                               __m128i diff, __m128i n, __m128i rate) {
+  __m128i target =
+      _mm_sub_epi16(_mm_set1_epi16(AOM_ICDF(32)), _mm_slli_epi16(idx, 5));
+  __m128i delta;
+  target = _mm_sub_epi16(target, _mm_and_si128(_mm_cmpgt_epi16(idx, val_m1),
+                                               diff));
+  delta = _mm_sra_epi16(_mm_sub_epi16(target, cdf), rate);
+  return _mm_add_epi16(cdf, _mm_and_si128(delta, _mm_cmplt_epi16(idx, n)));
+}
+
+void aom_update_cdf_sse2(uint16_t *cdf, int val, int nsymbs) {
+  const int rate = 4 + (cdf[nsymbs] > 31) + get_msb(nsymbs);
+  const int diff = ((CDF_PROB_TOP - (nsymbs << 5)) >> rate) << rate;
+  const __m128i rate_v = _mm_cvtsi32_si128(rate);
+  const __m128i val_m1 = _mm_set1_epi16(val - 1);
+  const __m128i diff_v = _mm_set1_epi16(diff);
+  const __m128i n = _mm_set1_epi16(nsymbs - 1);
+  const __m128i idx = _mm_setr_epi16(0, 1, 2, 3, 4, 5, 6, 7);
+  const __m128i lo = _mm_loadu_si128((const __m128i *)cdf);
+  assert(nsymbs >= AOM_UPDATE_CDF_MIN_SYMS && nsymbs <= 16);
+
+  // The entries past the first 8 are updated with the last 8, which overlap
+  // them. Both are loaded before either is stored.
+  if (nsymbs > 9) {
+    const int first = nsymbs - 9;
+    const __m128i hi = _mm_loadu_si128((const __m128i *)(cdf + first));
+    _mm_storeu_si128((__m128i *)(cdf + first),
+                     update_8(hi, _mm_add_epi16(idx, _mm_set1_epi16(first)),
+                              val_m1, diff_v, n, rate_v));
+  }
+  _mm_storeu_si128((__m128i *)cdf,
+                   update_8(lo, idx, val_m1, diff_v, n, rate_v));
+  cdf[nsymbs] += (cdf[nsymbs] < 32);
+}
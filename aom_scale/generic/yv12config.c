@@ -37,6 +37,7 @@ int aom_free_frame_buffer(YV12_BUFFER_CONFIG *ybf) {
 #if CONFIG_HIGHBITDEPTH
     if (ybf->y_buffer_8bit) aom_free(ybf->y_buffer_8bit);
 #endif
+    if (ybf->corners) aom_free(ybf->corners);
 
     /* buffer_alloc isn't accessed by most functions.  Rather y_buffer,
       u_buffer and v_buffer point to buffer_alloc and are used.  Clear out
@@ -176,6 +177,7 @@ int aom_realloc_frame_buffer(YV12_BUFFER_CONFIG *ybf, int width, int height,
       assert(!ybf->y_buffer_8bit);
     }
 #endif
+    ybf->corners_valid = 0;
 
     ybf->corrupted = 0; /* assume not corrupted by errors */
     return 0;
@@ -183,6 +185,36 @@ int aom_realloc_frame_buffer(YV12_BUFFER_CONFIG *ybf, int width, int height,
   return -2;
 }
 
+size_t aom_calc_ext_frame_buffer_size(int width, int height, int ss_x, int ss_y,
+#if CONFIG_HIGHBITDEPTH
+                                      int use_highbitdepth,
+#endif
+                                      int border, int byte_alignment) {
+  // The same layout as aom_realloc_frame_buffer().
+  const int aligned_width = (width + 7) & ~7;
+  const int aligned_height = (height + 7) & ~7;
+  const int y_stride = ((aligned_width + 2 * border) + 31) & ~31;
+  const uint64_t yplane_size =
+      (aligned_height + 2 * border) * (uint64_t)y_stride + byte_alignment;
+  const int uv_height = aligned_height >> ss_y;
+  const int uv_stride = y_stride >> ss_x;
+  const int uv_border_h = border >> ss_y;
+  const uint64_t uvplane_size =
+      (uv_height + 2 * uv_border_h) * (uint64_t)uv_stride + byte_alignment;
+  const int align_addr_extra_size = 31;
+#if CONFIG_HIGHBITDEPTH
+  const uint64_t external_frame_size =
+      (1 + use_highbitdepth) * (yplane_size + 2 * uvplane_size) +
+      align_addr_extra_size;
+#else
+  const uint64_t external_frame_size =
+      yplane_size + 2 * uvplane_size + align_addr_extra_size;
+#endif  // CONFIG_HIGHBITDEPTH
+
+  if (external_frame_size != (size_t)external_frame_size) return 0;
+  return (size_t)external_frame_size;
+}
+
 int aom_alloc_frame_buffer(YV12_BUFFER_CONFIG *ybf, int width, int height,
                            int ss_x, int ss_y,
 #if CONFIG_HIGHBITDEPTH
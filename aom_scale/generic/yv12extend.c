@@ -180,6 +180,46 @@ void aom_extend_frame_inner_borders_c(YV12_BUFFER_CONFIG *ybf) {
   extend_frame(ybf, inner_bw);
 }
 
+// Extends the left and right borders of the luma rows [row_start, row_end)
+// and the matching chroma rows, along with the top border if row_start is 0
+// and the bottom border if row_end reaches the bottom of the frame. Covering
+// the frame in row ranges gives the same result as aom_extend_frame_borders().
+void aom_extend_frame_borders_rows_c(YV12_BUFFER_CONFIG *ybf, int row_start,
+                                     int row_end) {
+  const int ss_x = ybf->uv_width < ybf->y_width;
+  const int ss_y = ybf->uv_height < ybf->y_height;
+  const int ext_size = ybf->border;
+
+  for (int plane = 0; plane < 3; ++plane) {
+    const int is_uv = plane > 0;
+    const int plane_ss_y = is_uv ? ss_y : 0;
+    const int crop_height = ybf->crop_heights[is_uv];
+    const int start = row_start >> plane_ss_y;
+    const int end = row_end >= ybf->y_crop_height ? crop_height
+                                                  : row_end >> plane_ss_y;
+    const int top = start == 0 ? ext_size >> plane_ss_y : 0;
+    const int left = ext_size >> (is_uv ? ss_x : 0);
+    const int bottom =
+        end == crop_height
+            ? (ext_size >> plane_ss_y) + ybf->heights[is_uv] - crop_height
+            : 0;
+    const int right = left + ybf->widths[is_uv] - ybf->crop_widths[is_uv];
+    uint8_t *const src =
+        ybf->buffers[plane] + (ptrdiff_t)start * ybf->strides[is_uv];
+
+    if (end <= start) continue;
+#if CONFIG_HIGHBITDEPTH
+    if (ybf->flags & YV12_FLAG_HIGHBITDEPTH) {
+      extend_plane_high(src, ybf->strides[is_uv], ybf->crop_widths[is_uv],
+                        end - start, top, left, bottom, right);
+      continue;
+    }
+#endif
+    extend_plane(src, ybf->strides[is_uv], ybf->crop_widths[is_uv],
+                 end - start, top, left, bottom, right);
+  }
+}
+
 void aom_extend_frame_borders_y_c(YV12_BUFFER_CONFIG *ybf) {
   int ext_size = ybf->border;
   assert(ybf->y_height - ybf->y_crop_height < 16);
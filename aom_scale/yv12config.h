@@ -93,6 +93,13 @@ typedef struct yv12_buffer_config {
   int buf_8bit_valid;
 #endif
 
+  // The FAST corners of the luma plane, as x, y pairs, for use in global
+  // motion detection. They are allocated and detected on demand, and kept
+  // until the frame is written again.
+  int *corners;
+  int num_corners;
+  int corners_valid;
+
   uint8_t *buffer_alloc;
   size_t buffer_alloc_sz;
   int border;
@@ -135,6 +142,15 @@ int aom_realloc_frame_buffer(YV12_BUFFER_CONFIG *ybf, int width, int height,
                              int border, int byte_alignment,
                              aom_codec_frame_buffer_t *fb,
                              aom_get_frame_buffer_cb_fn_t cb, void *cb_priv);
+
+// Returns the minimum size in bytes aom_realloc_frame_buffer() requests from
+// the frame buffer callback for a frame of the given format, or 0 if it does
+// not fit in a size_t.
+size_t aom_calc_ext_frame_buffer_size(int width, int height, int ss_x, int ss_y,
+#if CONFIG_HIGHBITDEPTH
+                                      int use_highbitdepth,
+#endif
+                                      int border, int byte_alignment);
 int aom_free_frame_buffer(YV12_BUFFER_CONFIG *ybf);
 
 #ifdef __cplusplus
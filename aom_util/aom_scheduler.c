@@ -0,0 +1,506 @@
+/*
+ * Copyright (c) 2017, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <assert.h>
+#include <string.h>
+
+#include "./aom_config.h"
+#include "aom_mem/aom_mem.h"
+#include "aom_util/aom_scheduler.h"
+#if CONFIG_MULTITHREAD
+#include "aom_ports/aom_once.h"
+#endif
+
+#if CONFIG_MULTITHREAD
+#define scheduler_lock(mutex) pthread_mutex_lock(mutex)
+#define scheduler_unlock(mutex) pthread_mutex_unlock(mutex)
+#else
+#define scheduler_lock(mutex) (void)0
+#define scheduler_unlock(mutex) (void)0
+#endif  // CONFIG_MULTITHREAD
+
+#define INITIAL_DEQUE_SIZE 16
+
+typedef struct {
+  AVxWorkerHook hook;
+  void *data1;
+  void *data2;
+  AVxTaskGroup *group;
+} AVxTask;
+
+// A ring buffer of tasks. The owning thread pushes and pops tasks at the
+// bottom, the other threads steal them from the top.
+typedef struct {
+#if CONFIG_MULTITHREAD
+  pthread_mutex_t mutex_;
+#endif
+  AVxTask *tasks;
+  int size;  // A power of 2.
+  int top;
+  int bottom;
+} TaskDeque;
+
+typedef struct {
+  AVxScheduler *scheduler;
+  int index;
+  int sleeping;
+#if CONFIG_MULTITHREAD
+  pthread_cond_t cond_;
+#endif
+  AVxWorker worker;
+} SchedulerThread;
+
+struct AVxScheduler {
+  // Thread i owns deque i. Deque 0 is used for every task of a scheduler
+  // without threads.
+  TaskDeque deques[MAX_SCHEDULER_THREADS];
+  SchedulerThread threads[MAX_SCHEDULER_THREADS];
+#if CONFIG_MULTITHREAD
+  // Guards the fields below, and the sleeping flags of the threads.
+  pthread_mutex_t mutex_;
+#endif
+  int num_threads;
+  int next_deque;  // The deque the next task is submitted to.
+  int queued;      // The number of tasks in the deques.
+  int shutdown;
+  int ref_count;
+  // Set if the tasks run on an application thread pool. Such a scheduler has
+  // no threads and queues its tasks on deque 0.
+  int external;
+  aom_thread_pool_t pool;
+};
+
+//------------------------------------------------------------------------------
+// Task groups
+
+void aom_task_group_init(AVxTaskGroup *group) {
+  memset(group, 0, sizeof(*group));
+#if CONFIG_MULTITHREAD
+  pthread_mutex_init(&group->mutex_, NULL);
+  pthread_cond_init(&group->cond_, NULL);
+#endif
+}
+
+void aom_task_group_destroy(AVxTaskGroup *group) {
+  assert(group->pending == 0);
+#if CONFIG_MULTITHREAD
+  pthread_mutex_destroy(&group->mutex_);
+  pthread_cond_destroy(&group->cond_);
+#else
+  (void)group;
+#endif
+}
+
+int aom_task_group_next_job(AVxTaskGroup *group) {
+  int job;
+  scheduler_lock(&group->mutex_);
+  job = group->next_job++;
+  scheduler_unlock(&group->mutex_);
+  return job;
+}
+
+static void run_task(const AVxTask *task) {
+  AVxTaskGroup *const group = task->group;
+  const int ok = task->hook(task->data1, task->data2);
+
+  scheduler_lock(&group->mutex_);
+  group->had_error |= !ok;
+  if (--group->pending == 0) {
+#if CONFIG_MULTITHREAD
+    // Only the thread in aom_scheduler_wait() waits on the group.
+    pthread_cond_signal(&group->cond_);
+#endif
+  }
+  scheduler_unlock(&group->mutex_);
+}
+
+//------------------------------------------------------------------------------
+// Task deques. The deque mutex must be held.
+
+static int deque_push_bottom(TaskDeque *d, const AVxTask *task) {
+  if (d->bottom - d->top == d->size) {
+    const int size = d->size ? 2 * d->size : INITIAL_DEQUE_SIZE;
+    AVxTask *const tasks = (AVxTask *)aom_malloc(size * sizeof(*tasks));
+    int i;
+    if (tasks == NULL) return 0;
+    for (i = 0; i < d->size; ++i)
+      tasks[i] = d->tasks[(d->top + i) & (d->size - 1)];
+    aom_free(d->tasks);
+    d->tasks = tasks;
+    d->bottom = d->size;
+    d->top = 0;
+    d->size = size;
+  }
+  d->tasks[d->bottom++ & (d->size - 1)] = *task;
+  return 1;
+}
+
+static int deque_pop_bottom(TaskDeque *d, AVxTask *task) {
+  if (d->bottom == d->top) return 0;
+  *task = d->tasks[--d->bottom & (d->size - 1)];
+  if (d->bottom == d->top) d->bottom = d->top = 0;
+  return 1;
+}
+
+static int deque_steal_top(TaskDeque *d, AVxTask *task) {
+  if (d->bottom == d->top) return 0;
+  *task = d->tasks[d->top++ & (d->size - 1)];
+  if (d->bottom == d->top) d->bottom = d->top = 0;
+  return 1;
+}
+
+// Removes the oldest task of group from the deque.
+static int deque_take_group(TaskDeque *d, const AVxTaskGroup *group,
+                            AVxTask *task) {
+  const int mask = d->size - 1;
+  int i, j;
+
+  for (i = d->top; i < d->bottom; ++i) {
+    if (d->tasks[i & mask].group == group) {
+      *task = d->tasks[i & mask];
+      for (j = i; j > d->top; --j)
+        d->tasks[j & mask] = d->tasks[(j - 1) & mask];
+      if (++d->top == d->bottom) d->bottom = d->top = 0;
+      return 1;
+    }
+  }
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+
+static int get_num_deques(AVxScheduler *s) {
+  int num_deques;
+  scheduler_lock(&s->mutex_);
+  num_deques = s->num_threads > 0 ? s->num_threads : 1;
+  scheduler_unlock(&s->mutex_);
+  return num_deques;
+}
+
+static void task_dequeued(AVxScheduler *s) {
+  scheduler_lock(&s->mutex_);
+  --s->queued;
+  scheduler_unlock(&s->mutex_);
+}
+
+#if CONFIG_MULTITHREAD
+// Takes the newest task of the thread's own deque, or else steals the oldest
+// task of the next thread with any.
+static int get_task(SchedulerThread *thread, AVxTask *task) {
+  AVxScheduler *const s = thread->scheduler;
+  const int num_deques = get_num_deques(s);
+  int found = 0;
+  int i;
+
+  for (i = 0; i < num_deques && !found; ++i) {
+    TaskDeque *const d = &s->deques[(thread->index + i) % num_deques];
+    pthread_mutex_lock(&d->mutex_);
+    found = i == 0 ? deque_pop_bottom(d, task) : deque_steal_top(d, task);
+    pthread_mutex_unlock(&d->mutex_);
+  }
+  if (found) task_dequeued(s);
+  return found;
+}
+
+static int thread_loop(SchedulerThread *thread, void *unused) {
+  AVxScheduler *const s = thread->scheduler;
+  int done = 0;
+  (void)unused;
+
+  while (!done) {
+    AVxTask task;
+    if (get_task(thread, &task)) {
+      run_task(&task);
+      continue;
+    }
+
+    pthread_mutex_lock(&s->mutex_);
+    while (!s->queued && !s->shutdown) {
+      thread->sleeping = 1;
+      pthread_cond_wait(&thread->cond_, &s->mutex_);
+    }
+    thread->sleeping = 0;
+    done = s->shutdown;
+    pthread_mutex_unlock(&s->mutex_);
+  }
+  return 1;
+}
+
+// Starts threads until the scheduler has num_threads of them.
+static void add_threads(AVxScheduler *s, int num_threads) {
+  const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+  int i;
+
+  if (num_threads > MAX_SCHEDULER_THREADS) num_threads = MAX_SCHEDULER_THREADS;
+  for (i = s->num_threads; i < num_threads; ++i) {
+    SchedulerThread *const thread = &s->threads[i];
+
+    thread->scheduler = s;
+    thread->index = i;
+    thread->sleeping = 0;
+    if (pthread_cond_init(&thread->cond_, NULL)) break;
+    winterface->init(&thread->worker);
+    thread->worker.hook = (AVxWorkerHook)thread_loop;
+    thread->worker.data1 = thread;
+    thread->worker.data2 = NULL;
+    if (!winterface->reset(&thread->worker)) {
+      pthread_cond_destroy(&thread->cond_);
+      break;
+    }
+    // The thread may take tasks of its deque from now on.
+    pthread_mutex_lock(&s->mutex_);
+    ++s->num_threads;
+    pthread_mutex_unlock(&s->mutex_);
+    winterface->launch(&thread->worker);
+  }
+}
+#endif  // CONFIG_MULTITHREAD
+
+AVxScheduler *aom_scheduler_create(int num_threads) {
+  AVxScheduler *const s = (AVxScheduler *)aom_calloc(1, sizeof(*s));
+  if (s == NULL) return NULL;
+
+#if CONFIG_MULTITHREAD
+  {
+    int i;
+    pthread_mutex_init(&s->mutex_, NULL);
+    for (i = 0; i < MAX_SCHEDULER_THREADS; ++i)
+      pthread_mutex_init(&s->deques[i].mutex_, NULL);
+  }
+  add_threads(s, num_threads);
+#else
+  (void)num_threads;
+#endif  // CONFIG_MULTITHREAD
+  return s;
+}
+
+void aom_scheduler_destroy(AVxScheduler *s) {
+  int i;
+
+  if (s == NULL) return;
+  assert(s->queued == 0);
+
+#if CONFIG_MULTITHREAD
+  pthread_mutex_lock(&s->mutex_);
+  s->shutdown = 1;
+  for (i = 0; i < s->num_threads; ++i)
+    pthread_cond_signal(&s->threads[i].cond_);
+  pthread_mutex_unlock(&s->mutex_);
+
+  for (i = 0; i < s->num_threads; ++i) {
+    aom_get_worker_interface()->end(&s->threads[i].worker);
+    pthread_cond_destroy(&s->threads[i].cond_);
+  }
+  pthread_mutex_destroy(&s->mutex_);
+#endif  // CONFIG_MULTITHREAD
+
+  for (i = 0; i < MAX_SCHEDULER_THREADS; ++i) {
+#if CONFIG_MULTITHREAD
+    pthread_mutex_destroy(&s->deques[i].mutex_);
+#endif
+    aom_free(s->deques[i].tasks);
+  }
+  aom_free(s);
+}
+
+//------------------------------------------------------------------------------
+// Application thread pools
+
+#if CONFIG_MULTITHREAD
+// Each task queued on an external scheduler submits one of these to the
+// application thread pool. It runs the oldest task of the scheduler, unless
+// aom_scheduler_wait() has run them all already.
+static void run_external_task(void *arg) {
+  AVxScheduler *const s = (AVxScheduler *)arg;
+  TaskDeque *const d = &s->deques[0];
+  AVxTask task;
+  int found;
+
+  pthread_mutex_lock(&d->mutex_);
+  found = deque_steal_top(d, &task);
+  pthread_mutex_unlock(&d->mutex_);
+  if (found) {
+    task_dequeued(s);
+    run_task(&task);
+  }
+}
+
+static AVxScheduler *create_external(const aom_thread_pool_t *pool) {
+  AVxScheduler *const s = aom_scheduler_create(0);
+  if (s == NULL) return NULL;
+  s->external = 1;
+  s->pool = *pool;
+  return s;
+}
+#endif  // CONFIG_MULTITHREAD
+
+//------------------------------------------------------------------------------
+// The shared scheduler
+
+static AVxScheduler *g_shared_scheduler = NULL;
+
+#if CONFIG_MULTITHREAD
+static pthread_mutex_t g_shared_mutex;
+
+static void init_shared_mutex(void) {
+  pthread_mutex_init(&g_shared_mutex, NULL);
+}
+#endif  // CONFIG_MULTITHREAD
+
+AVxScheduler *aom_scheduler_acquire(const aom_thread_pool_t *pool,
+                                    int num_threads) {
+  AVxScheduler *s;
+
+#if CONFIG_MULTITHREAD
+  if (pool != NULL && pool->submit != NULL) return create_external(pool);
+  once(init_shared_mutex);
+#else
+  (void)pool;
+#endif
+  scheduler_lock(&g_shared_mutex);
+  if (g_shared_scheduler == NULL) {
+    g_shared_scheduler = aom_scheduler_create(num_threads);
+  } else {
+#if CONFIG_MULTITHREAD
+    add_threads(g_shared_scheduler, num_threads);
+#endif
+  }
+  s = g_shared_scheduler;
+  if (s != NULL) ++s->ref_count;
+  scheduler_unlock(&g_shared_mutex);
+  return s;
+}
+
+void aom_scheduler_release(AVxScheduler *s) {
+  if (s == NULL) return;
+  if (s->external) {
+    aom_scheduler_destroy(s);
+    return;
+  }
+  scheduler_lock(&g_shared_mutex);
+  assert(s == g_shared_scheduler && s->ref_count > 0);
+  if (--s->ref_count == 0) {
+    aom_scheduler_destroy(s);
+    g_shared_scheduler = NULL;
+  }
+  scheduler_unlock(&g_shared_mutex);
+}
+
+int aom_scheduler_num_threads(AVxScheduler *s) {
+  int num_threads;
+  if (s->external) return s->pool.num_threads;
+  scheduler_lock(&s->mutex_);
+  num_threads = s->num_threads;
+  scheduler_unlock(&s->mutex_);
+  return num_threads;
+}
+
+//------------------------------------------------------------------------------
+
+int aom_scheduler_submit(AVxScheduler *s, AVxTaskGroup *group,
+                         AVxWorkerHook hook, void *data1, void *data2) {
+  TaskDeque *d;
+  AVxTask task;
+  int ok;
+
+  task.hook = hook;
+  task.data1 = data1;
+  task.data2 = data2;
+  task.group = group;
+
+  scheduler_lock(&group->mutex_);
+  ++group->pending;
+  scheduler_unlock(&group->mutex_);
+
+  // Spread the tasks over the deques, so that the threads start on them
+  // without having to steal.
+  scheduler_lock(&s->mutex_);
+  d = &s->deques[s->next_deque];
+  if (++s->next_deque >= s->num_threads) s->next_deque = 0;
+  scheduler_unlock(&s->mutex_);
+
+  scheduler_lock(&d->mutex_);
+  ok = deque_push_bottom(d, &task);
+  scheduler_unlock(&d->mutex_);
+  if (!ok) {
+    scheduler_lock(&group->mutex_);
+    --group->pending;
+    scheduler_unlock(&group->mutex_);
+    return 0;
+  }
+
+  scheduler_lock(&s->mutex_);
+  ++s->queued;
+#if CONFIG_MULTITHREAD
+  if (s->external) {
+    scheduler_unlock(&s->mutex_);
+    // If the pool does not take the task, aom_scheduler_wait() runs it.
+    s->pool.submit(s->pool.priv, run_external_task, s);
+    return 1;
+  }
+  {
+    // Wake up the owner of the deque, or else any sleeping thread.
+    const int first = (int)(d - s->deques);
+    int i;
+    for (i = 0; i < s->num_threads; ++i) {
+      SchedulerThread *const thread =
+          &s->threads[(first + i) % s->num_threads];
+      if (thread->sleeping) {
+        thread->sleeping = 0;
+        pthread_cond_signal(&thread->cond_);
+        break;
+      }
+    }
+  }
+#endif  // CONFIG_MULTITHREAD
+  scheduler_unlock(&s->mutex_);
+  return 1;
+}
+
+int aom_scheduler_wait(AVxScheduler *s, AVxTaskGroup *group) {
+  const int num_deques = get_num_deques(s);
+  int ok;
+  int i;
+
+  // Run the tasks of the group which no thread has taken yet, oldest first.
+  for (i = 0; i < num_deques; ++i) {
+    TaskDeque *const d = &s->deques[i];
+    AVxTask task;
+    int found;
+
+    do {
+      scheduler_lock(&d->mutex_);
+      found = deque_take_group(d, group, &task);
+      scheduler_unlock(&d->mutex_);
+      if (found) {
+        task_dequeued(s);
+        run_task(&task);
+      }
+    } while (found);
+  }
+
+  scheduler_lock(&group->mutex_);
+#if CONFIG_MULTITHREAD
+  while (group->pending > 0) pthread_cond_wait(&group->cond_, &group->mutex_);
+#endif
+  assert(group->pending == 0);
+  ok = !group->had_error;
+  group->had_error = 0;
+  group->next_job = 0;
+  scheduler_unlock(&group->mutex_);
+
+#if CONFIG_MULTITHREAD
+  // The tasks submitted to the application thread pool refer to the
+  // scheduler, which may be destroyed once this returns.
+  if (s->external) s->pool.wait(s->pool.priv);
+#endif
+  return ok;
+}
@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2017, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+//
+// Work-stealing task scheduler
+//
+// A scheduler owns a pool of threads, each with its own deque of tasks. A
+// thread runs the tasks of its own deque newest first and, once that is
+// empty, steals the oldest task of another thread. Tasks are submitted as
+// part of a task group, which is waited on as a whole. The thread waiting on
+// a group runs the group's tasks that have not been started yet itself, so a
+// group of tasks always completes, even on a scheduler without threads.
+//
+// A scheduler can also run its tasks on a thread pool of the application,
+// given as an aom_thread_pool_t, instead of threads of its own.
+
+#ifndef AOM_SCHEDULER_H_
+#define AOM_SCHEDULER_H_
+
+#include "./aom_config.h"
+#include "aom/aom.h"
+#include "aom_util/aom_thread.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// The maximum number of threads of a scheduler.
+#define MAX_SCHEDULER_THREADS 64
+
+typedef struct AVxScheduler AVxScheduler;
+
+// A set of tasks which is waited on together. The group also hands out job
+// indices, so that the tasks of a group can share out a list of jobs as they
+// get to run: jobs are claimed in order, and a job which only waits on
+// earlier jobs cannot deadlock however few of the tasks run at a time.
+typedef struct AVxTaskGroup {
+#if CONFIG_MULTITHREAD
+  pthread_mutex_t mutex_;
+  pthread_cond_t cond_;
+#endif
+  int pending;    // tasks submitted and not finished yet
+  int next_job;   // next job index returned by aom_task_group_next_job()
+  int had_error;  // set if the hook of a task returned false
+} AVxTaskGroup;
+
+void aom_task_group_init(AVxTaskGroup *group);
+void aom_task_group_destroy(AVxTaskGroup *group);
+
+// Returns the next job index of the group, starting from 0. Thread-safe.
+int aom_task_group_next_job(AVxTaskGroup *group);
+
+// Creates a scheduler with num_threads threads, which may be 0. Without
+// CONFIG_MULTITHREAD no threads are created. Returns NULL on failure.
+AVxScheduler *aom_scheduler_create(int num_threads);
+
+// Stops the threads and frees the scheduler. No tasks may be pending.
+void aom_scheduler_destroy(AVxScheduler *scheduler);
+
+// Returns a scheduler which runs its tasks on the application thread pool
+// if pool is not NULL and has a submit function. Otherwise returns the
+// process-wide scheduler, grown to at least num_threads threads, and takes a
+// reference to it. Without CONFIG_MULTITHREAD the pool is ignored. Returns
+// NULL on failure. Thread-safe.
+AVxScheduler *aom_scheduler_acquire(const aom_thread_pool_t *pool,
+                                    int num_threads);
+
+// Releases a scheduler returned by aom_scheduler_acquire(). The process-wide
+// scheduler is destroyed with its last reference. Thread-safe.
+void aom_scheduler_release(AVxScheduler *scheduler);
+
+// Returns the number of threads of the scheduler, or of its application
+// thread pool.
+int aom_scheduler_num_threads(AVxScheduler *scheduler);
+
+// Queues a call of hook(data1, data2) as part of group. Returns false if the
+// task cannot be queued, in which case it is not run at all: the tasks
+// submitted before it may wait on work of the caller, so it is never run on
+// the calling thread. The caller must still wait on the group. Thread-safe.
+int aom_scheduler_submit(AVxScheduler *scheduler, AVxTaskGroup *group,
+                         AVxWorkerHook hook, void *data1, void *data2);
+
+// Waits for all the tasks of group to finish, running those not started yet
+// on the calling thread. Returns false if the hook of any task returned
+// false. The group can then be used for another set of tasks, with its job
+// indices starting from 0 again.
+int aom_scheduler_wait(AVxScheduler *scheduler, AVxTaskGroup *group);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // AOM_SCHEDULER_H_
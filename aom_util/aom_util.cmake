@@ -12,6 +12,8 @@ if (NOT AOM_AOM_UTIL_AOM_UTIL_CMAKE_)
 set(AOM_AOM_UTIL_AOM_UTIL_CMAKE_ 1)
 
 set(AOM_UTIL_SOURCES
+    "${AOM_ROOT}/aom_util/aom_scheduler.c"
+    "${AOM_ROOT}/aom_util/aom_scheduler.h"
     "${AOM_ROOT}/aom_util/aom_thread.c"
     "${AOM_ROOT}/aom_util/aom_thread.h"
     "${AOM_ROOT}/aom_util/endian_inl.h"
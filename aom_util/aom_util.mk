@@ -11,6 +11,8 @@
 
 
 UTIL_SRCS-yes += aom_util.mk
+UTIL_SRCS-yes += aom_scheduler.c
+UTIL_SRCS-yes += aom_scheduler.h
 UTIL_SRCS-yes += aom_thread.c
 UTIL_SRCS-yes += aom_thread.h
 UTIL_SRCS-yes += debug_util.c
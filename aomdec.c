@@ -31,7 +31,10 @@
 #endif
 
 #include "./args.h"
+#include "./image_queue.h"
 #include "./ivfdec.h"
+#include "./mapped_file.h"
+#include "./rawdec.h"
 
 #include "aom/aom_decoder.h"
 #include "aom_ports/mem_ops.h"
@@ -59,6 +62,7 @@ static const char *exec_name;
 struct AvxDecInputContext {
   struct AvxInputContext *aom_input_ctx;
   struct WebmInputContext *webm_ctx;
+  AvxMappedFile *mapped;  // Read instead of aom_input_ctx->file if mapped.
 };
 
 static const arg_def_t help =
@@ -92,6 +96,9 @@ static const arg_def_t threadsarg =
     ARG_DEF("t", "threads", 1, "Max threads to use");
 static const arg_def_t frameparallelarg =
     ARG_DEF(NULL, "frame-parallel", 0, "Frame parallel decode");
+static const arg_def_t rowmtarg =
+    ARG_DEF(NULL, "row-mt", 1,
+            "Enable row-based multi-threading within a tile (default: 1)");
 static const arg_def_t verbosearg =
     ARG_DEF("v", "verbose", 0, "Show version string");
 static const arg_def_t scalearg =
@@ -104,6 +111,9 @@ static const arg_def_t md5arg =
     ARG_DEF(NULL, "md5", 0, "Compute the MD5 sum of the decoded frame");
 static const arg_def_t framestatsarg =
     ARG_DEF(NULL, "framestats", 1, "Output per-frame stats (.csv format)");
+static const arg_def_t writebehindarg =
+    ARG_DEF(NULL, "write-behind", 1,
+            "Number of frames to queue for writing on a thread (default: 4)");
 #if CONFIG_HIGHBITDEPTH
 static const arg_def_t outbitdeptharg =
     ARG_DEF(NULL, "output-bit-depth", 1, "Output bit-depth for decoded frames");
@@ -132,11 +142,13 @@ static const arg_def_t *all_args[] = { &help,
                                        &outputfile,
                                        &threadsarg,
                                        &frameparallelarg,
+                                       &rowmtarg,
                                        &verbosearg,
                                        &scalearg,
                                        &fb_arg,
                                        &md5arg,
                                        &framestatsarg,
+                                       &writebehindarg,
                                        &continuearg,
 #if CONFIG_HIGHBITDEPTH
                                        &outbitdeptharg,
@@ -213,71 +225,52 @@ void usage_exit(void) {
   exit(EXIT_FAILURE);
 }
 
-static int raw_read_frame(FILE *infile, uint8_t **buffer, size_t *bytes_read,
-                          size_t *buffer_size) {
-  char raw_hdr[RAW_FRAME_HDR_SZ];
-  size_t frame_size = 0;
-
-  if (fread(raw_hdr, RAW_FRAME_HDR_SZ, 1, infile) != 1) {
-    if (!feof(infile)) warn("Failed to read RAW frame size\n");
-  } else {
-    const size_t kCorruptFrameThreshold = 256 * 1024 * 1024;
-    const size_t kFrameTooSmallThreshold = 256 * 1024;
-    frame_size = mem_get_le32(raw_hdr);
-
-    if (frame_size > kCorruptFrameThreshold) {
-      warn("Read invalid frame size (%u)\n", (unsigned int)frame_size);
-      frame_size = 0;
-    }
-
-    if (frame_size < kFrameTooSmallThreshold) {
-      warn("Warning: Read invalid frame size (%u) - not a raw file?\n",
-           (unsigned int)frame_size);
-    }
-
-    if (frame_size > *buffer_size) {
-      uint8_t *new_buf = realloc(*buffer, 2 * frame_size);
-      if (new_buf) {
-        *buffer = new_buf;
-        *buffer_size = 2 * frame_size;
-      } else {
-        warn("Failed to allocate compressed data buffer\n");
-        frame_size = 0;
-      }
-    }
-  }
-
-  if (!feof(infile)) {
-    if (fread(*buffer, 1, frame_size, infile) != frame_size) {
-      warn("Failed to read full frame\n");
-      return 1;
+// Sets *frame to the next frame of the input. This points into the mapped
+// file if the input could be mapped, and to *buf otherwise.
+static int read_frame(struct AvxDecInputContext *input, uint8_t **buf,
+                      size_t *bytes_in_buffer, size_t *buffer_size,
+                      const uint8_t **frame) {
+  int ret;
+
+  if (input->mapped->data) {
+    switch (input->aom_input_ctx->file_type) {
+      case FILE_TYPE_RAW:
+        return raw_read_frame_mapped(input->mapped, frame, bytes_in_buffer);
+      case FILE_TYPE_IVF:
+        return ivf_read_frame_mapped(input->mapped, frame, bytes_in_buffer);
+#if CONFIG_OBU_NO_IVF
+      case FILE_TYPE_OBU:
+        return obu_read_temporal_unit_mapped(input->mapped, frame,
+                                             bytes_in_buffer);
+#endif
+      default: return 1;
     }
-    *bytes_read = frame_size;
   }
 
-  return 0;
-}
-
-static int read_frame(struct AvxDecInputContext *input, uint8_t **buf,
-                      size_t *bytes_in_buffer, size_t *buffer_size) {
   switch (input->aom_input_ctx->file_type) {
 #if CONFIG_WEBM_IO
     case FILE_TYPE_WEBM:
-      return webm_read_frame(input->webm_ctx, buf, bytes_in_buffer);
+      ret = webm_read_frame(input->webm_ctx, buf, bytes_in_buffer);
+      break;
 #endif
     case FILE_TYPE_RAW:
-      return raw_read_frame(input->aom_input_ctx->file, buf, bytes_in_buffer,
-                            buffer_size);
+      ret = raw_read_frame(input->aom_input_ctx->file, buf, bytes_in_buffer,
+                           buffer_size);
+      break;
     case FILE_TYPE_IVF:
-      return ivf_read_frame(input->aom_input_ctx->file, buf, bytes_in_buffer,
-                            buffer_size);
+      ret = ivf_read_frame(input->aom_input_ctx->file, buf, bytes_in_buffer,
+                           buffer_size);
+      break;
 #if CONFIG_OBU_NO_IVF
     case FILE_TYPE_OBU:
-      return obu_read_temporal_unit(input->aom_input_ctx->file, buf,
-                                    bytes_in_buffer, buffer_size);
+      ret = obu_read_temporal_unit(input->aom_input_ctx->file, buf,
+                                   bytes_in_buffer, buffer_size);
+      break;
 #endif
     default: return 1;
   }
+  *frame = *buf;
+  return ret;
 }
 
 static void update_image_md5(const aom_image_t *img, const int planes[3],
@@ -322,6 +315,76 @@ static void write_image_file(const aom_image_t *img, const int *planes,
   }
 }
 
+// The output of a single file, written either inline or on the write-behind
+// thread.
+struct OutputContext {
+  FILE *outfile;
+  MD5Context *md5_ctx;
+  int do_md5;
+  int use_y4m;
+  int flipuv;
+  // The Y4M file header, written with the first frame.
+  int y4m_width;
+  int y4m_height;
+  struct AvxRational y4m_framerate;
+  int frames;
+};
+
+static void write_output_frame(struct OutputContext *output,
+                               const aom_image_t *img) {
+  const int PLANES_YUV[] = { AOM_PLANE_Y, AOM_PLANE_U, AOM_PLANE_V };
+  const int PLANES_YVU[] = { AOM_PLANE_Y, AOM_PLANE_V, AOM_PLANE_U };
+  const int *planes = output->flipuv ? PLANES_YVU : PLANES_YUV;
+#if CONFIG_MONO_VIDEO
+  const int num_planes =
+      (!output->use_y4m && img->cs == AOM_CS_MONOCHROME) ? 1 : 3;
+#else
+  const int num_planes = 3;
+#endif
+
+  if (output->use_y4m) {
+    char y4m_buf[Y4M_BUFFER_SIZE] = { 0 };
+    size_t len = 0;
+    if (output->frames == 0) {
+      // Y4M file header
+      len = y4m_write_file_header(y4m_buf, sizeof(y4m_buf), output->y4m_width,
+                                  output->y4m_height, &output->y4m_framerate,
+                                  img->fmt, img->bit_depth);
+      if (output->do_md5) {
+        MD5Update(output->md5_ctx, (md5byte *)y4m_buf, (unsigned int)len);
+      } else {
+        fputs(y4m_buf, output->outfile);
+      }
+    }
+
+    // Y4M frame header
+    len = y4m_write_frame_header(y4m_buf, sizeof(y4m_buf));
+    if (output->do_md5) {
+      MD5Update(output->md5_ctx, (md5byte *)y4m_buf, (unsigned int)len);
+    } else {
+      fputs(y4m_buf, output->outfile);
+    }
+  }
+
+  if (output->do_md5) {
+    update_image_md5(img, planes, output->md5_ctx);
+  } else {
+    write_image_file(img, planes, num_planes, output->outfile);
+  }
+  ++output->frames;
+}
+
+// Writes the queued frames until the decoder has finished.
+static void write_behind_thread(AvxImageQueue *queue, void *arg) {
+  struct OutputContext *const output = (struct OutputContext *)arg;
+  aom_image_t *img;
+
+  while ((img = image_queue_front(queue)) != NULL) {
+    write_output_frame(output, img);
+    image_queue_pop(queue);
+  }
+}
+
 static int file_is_raw(struct AvxInputContext *input) {
   uint8_t buf[32];
   int is_raw = 0;
@@ -376,16 +439,27 @@ struct ExternalFrameBufferList {
 static int get_av1_frame_buffer(void *cb_priv, size_t min_size,
                                 aom_codec_frame_buffer_t *fb) {
   int i;
+  int fit = -1;
+  int spare = -1;
   struct ExternalFrameBufferList *const ext_fb_list =
       (struct ExternalFrameBufferList *)cb_priv;
   if (ext_fb_list == NULL) return -1;
 
-  // Find a free frame buffer.
+  // Find the smallest free frame buffer large enough for the frame, so that
+  // larger ones are kept for when the frame size grows, and failing that the
+  // smallest free one to reallocate.
   for (i = 0; i < ext_fb_list->num_external_frame_buffers; ++i) {
-    if (!ext_fb_list->ext_fb[i].in_use) break;
+    const struct ExternalFrameBuffer *const ext_fb = &ext_fb_list->ext_fb[i];
+    if (ext_fb->in_use) continue;
+    if (ext_fb->size >= min_size) {
+      if (fit < 0 || ext_fb->size < ext_fb_list->ext_fb[fit].size) fit = i;
+    } else if (spare < 0 || ext_fb->size < ext_fb_list->ext_fb[spare].size) {
+      spare = i;
+    }
   }
 
-  if (i == ext_fb_list->num_external_frame_buffers) return -1;
+  if (fit < 0 && spare < 0) return -1;
+  i = fit >= 0 ? fit : spare;
 
   if (ext_fb_list->ext_fb[i].size < min_size) {
     free(ext_fb_list->ext_fb[i].data);
@@ -516,8 +590,10 @@ static int main_loop(int argc, const char **argv_) {
   int i;
   int ret = EXIT_FAILURE;
   uint8_t *buf = NULL;
+  const uint8_t *frame = NULL;
   size_t bytes_in_buffer = 0, buffer_size = 0;
   FILE *infile;
+  AvxMappedFile mapped;
   int frame_in = 0, frame_out = 0, flipuv = 0, noblit = 0;
   int do_md5 = 0, progress = 0, frame_parallel = 0;
   int stop_after = 0, postproc = 0, summary = 0, quiet = 1;
@@ -541,6 +617,7 @@ static int main_loop(int argc, const char **argv_) {
   int tile_row = -1;
   int tile_col = -1;
 #endif  // CONFIG_EXT_TILE
+  unsigned int row_mt = 1;
   int frames_corrupted = 0;
   int dec_flags = 0;
   int do_scale = 0;
@@ -555,13 +632,16 @@ static int main_loop(int argc, const char **argv_) {
   const char *outfile_pattern = NULL;
   char outfile_name[PATH_MAX] = { 0 };
   FILE *outfile = NULL;
+  struct OutputContext output;
+  int write_behind = 4;
+  AvxImageQueue *write_behind_queue = NULL;
 
   FILE *framestats_file = NULL;
 
   MD5Context md5_ctx;
   unsigned char md5_digest[16];
 
-  struct AvxDecInputContext input = { NULL, NULL };
+  struct AvxDecInputContext input = { NULL, NULL, NULL };
   struct AvxInputContext aom_input_ctx;
 #if CONFIG_WEBM_IO
   struct WebmInputContext webm_ctx;
@@ -569,6 +649,8 @@ static int main_loop(int argc, const char **argv_) {
   input.webm_ctx = &webm_ctx;
 #endif
   input.aom_input_ctx = &aom_input_ctx;
+  input.mapped = &mapped;
+  memset(&mapped, 0, sizeof(mapped));
 
   /* Parse command line */
   exec_name = argv_[0];
@@ -619,6 +701,8 @@ static int main_loop(int argc, const char **argv_) {
         die("Error: Could not open --framestats file (%s) for writing.\n",
             arg.val);
       }
+    } else if (arg_match(&arg, &writebehindarg, argi)) {
+      write_behind = arg_parse_uint(&arg);
     } else if (arg_match(&arg, &summaryarg, argi)) {
       summary = 1;
     } else if (arg_match(&arg, &threadsarg, argi)) {
@@ -627,6 +711,8 @@ static int main_loop(int argc, const char **argv_) {
 #if CONFIG_AV1_DECODER
     else if (arg_match(&arg, &frameparallelarg, argi))
       frame_parallel = 1;
+    else if (arg_match(&arg, &rowmtarg, argi))
+      row_mt = arg_parse_uint(&arg);
 #endif
     else if (arg_match(&arg, &verbosearg, argi))
       quiet = 0;
@@ -700,6 +786,11 @@ static int main_loop(int argc, const char **argv_) {
     return EXIT_FAILURE;
   }
 
+  // Frames are read in place from the file if it can be mapped. Files which
+  // cannot, e.g. pipes, are read with fread().
+  if (input.aom_input_ctx->file_type != FILE_TYPE_WEBM)
+    mapped_file_open(input.mapped, infile);
+
   outfile_pattern = outfile_pattern ? outfile_pattern : "-";
   single_file = is_single_file(outfile_pattern);
 
@@ -710,6 +801,25 @@ static int main_loop(int argc, const char **argv_) {
       MD5Init(&md5_ctx);
     else
       outfile = open_outfile(outfile_name);
+
+    memset(&output, 0, sizeof(output));
+    output.outfile = outfile;
+    output.md5_ctx = &md5_ctx;
+    output.do_md5 = do_md5;
+    output.use_y4m = use_y4m;
+    output.flipuv = flipuv;
+
+    // Frames are copied into the queue and written on a thread while the next
+    // ones decode. Without threads they are written inline.
+    if (write_behind > 0) {
+      write_behind_queue = image_queue_create(write_behind);
+      if (write_behind_queue &&
+          !image_queue_start_thread(write_behind_queue, write_behind_thread,
+                                    &output)) {
+        image_queue_destroy(write_behind_queue);
+        write_behind_queue = NULL;
+      }
+    }
   }
 
   if (use_y4m && !noblit) {
@@ -765,9 +875,17 @@ static int main_loop(int argc, const char **argv_) {
   }
 #endif
 
+#if CONFIG_AV1_DECODER
+  if (aom_codec_control(&decoder, AV1D_SET_ROW_MT, row_mt)) {
+    fprintf(stderr, "Failed to set row_mt: %s\n", aom_codec_error(&decoder));
+    goto fail;
+  }
+#endif
+
   if (arg_skip) fprintf(stderr, "Skipping first %d frames.\n", arg_skip);
   while (arg_skip) {
-    if (read_frame(&input, &buf, &bytes_in_buffer, &buffer_size)) break;
+    if (read_frame(&input, &buf, &bytes_in_buffer, &buffer_size, &frame))
+      break;
     arg_skip--;
   }
 
@@ -798,14 +916,14 @@ static int main_loop(int argc, const char **argv_) {
 
     frame_avail = 0;
     if (!stop_after || frame_in < stop_after) {
-      if (!read_frame(&input, &buf, &bytes_in_buffer, &buffer_size)) {
+      if (!read_frame(&input, &buf, &bytes_in_buffer, &buffer_size, &frame)) {
         frame_avail = 1;
         frame_in++;
 
         aom_usec_timer_start(&timer);
 
-        if (aom_codec_decode(&decoder, buf, (unsigned int)bytes_in_buffer, NULL,
-                             0)) {
+        if (aom_codec_decode(&decoder, frame, (unsigned int)bytes_in_buffer,
+                             NULL, 0)) {
           const char *detail = aom_codec_error_detail(&decoder);
           warn("Failed to decode frame %d: %s", frame_in,
                aom_codec_error(&decoder));
@@ -953,31 +1071,14 @@ static int main_loop(int argc, const char **argv_) {
 
       if (single_file) {
         if (use_y4m) {
-          char y4m_buf[Y4M_BUFFER_SIZE] = { 0 };
-          size_t len = 0;
           if (img->fmt == AOM_IMG_FMT_I440 || img->fmt == AOM_IMG_FMT_I44016) {
             fprintf(stderr, "Cannot produce y4m output for 440 sampling.\n");
             goto fail;
           }
           if (frame_out == 1) {
-            // Y4M file header
-            len = y4m_write_file_header(
-                y4m_buf, sizeof(y4m_buf), aom_input_ctx.width,
-                aom_input_ctx.height, &aom_input_ctx.framerate, img->fmt,
-                img->bit_depth);
-            if (do_md5) {
-              MD5Update(&md5_ctx, (md5byte *)y4m_buf, (unsigned int)len);
-            } else {
-              fputs(y4m_buf, outfile);
-            }
-          }
-
-          // Y4M frame header
-          len = y4m_write_frame_header(y4m_buf, sizeof(y4m_buf));
-          if (do_md5) {
-            MD5Update(&md5_ctx, (md5byte *)y4m_buf, (unsigned int)len);
-          } else {
-            fputs(y4m_buf, outfile);
+            output.y4m_width = aom_input_ctx.width;
+            output.y4m_height = aom_input_ctx.height;
+            output.y4m_framerate = aom_input_ctx.framerate;
           }
         } else {
           if (frame_out == 1) {
@@ -1001,10 +1102,15 @@ static int main_loop(int argc, const char **argv_) {
           }
         }
 
-        if (do_md5) {
-          update_image_md5(img, planes, &md5_ctx);
+        if (write_behind_queue) {
+          aom_image_t *const queued = image_queue_get_free(write_behind_queue);
+          if (!queued || !image_queue_copy_image(queued, img)) {
+            fprintf(stderr, "Failed to queue output frame.\n");
+            goto fail;
+          }
+          image_queue_push(write_behind_queue);
         } else {
-          write_image_file(img, planes, num_planes, outfile);
+          write_output_frame(&output, img);
         }
       } else {
         generate_filename(outfile_pattern, outfile_name, PATH_MAX, img->d_w,
@@ -1028,6 +1134,15 @@ static int main_loop(int argc, const char **argv_) {
     fprintf(stderr, "\n");
   }
 
+  if (!quiet && !num_external_frame_buffers) {
+    unsigned int pool_stats[2];
+    if (!aom_codec_control(&decoder, AV1D_GET_FRAME_BUFFER_POOL_STATS,
+                           pool_stats)) {
+      fprintf(stderr, "Frame buffers: %u reused, %u allocated\n",
+              pool_stats[0], pool_stats[1]);
+    }
+  }
+
   if (frames_corrupted) {
     fprintf(stderr, "WARNING: %d frames corrupted.\n", frames_corrupted);
   } else {
@@ -1043,6 +1158,13 @@ fail:
 
 fail2:
 
+  if (write_behind_queue) {
+    image_queue_finish(write_behind_queue);
+    if (!quiet)
+      image_queue_print_stats(write_behind_queue, "Write-behind", stderr);
+    image_queue_destroy(write_behind_queue);
+  }
+
   if (!noblit && single_file) {
     if (do_md5) {
       MD5Final(md5_digest, &md5_ctx);
@@ -1069,6 +1191,7 @@ fail2:
   }
   free(ext_fb_list.ext_fb);
 
+  mapped_file_close(&mapped);
   fclose(infile);
   if (framestats_file) fclose(framestats_file);
 
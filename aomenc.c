@@ -30,6 +30,7 @@
 #endif
 
 #include "./args.h"
+#include "./image_queue.h"
 #include "./ivfenc.h"
 #include "./tools_common.h"
 #include "examples/encoder_util.h"
@@ -112,6 +113,37 @@ static int read_frame(struct AvxInputContext *input_ctx, aom_image_t *img) {
   return !shortread;
 }
 
+struct ReadAheadContext {
+  struct AvxInputContext *input;
+  int limit;
+};
+
+// Reads the input frames into the read-ahead queue, which holds copies of the
+// frames returned by the Y4M reader as it reuses its buffer.
+static void read_ahead_thread(AvxImageQueue *queue, void *arg) {
+  const struct ReadAheadContext *const ctx = (struct ReadAheadContext *)arg;
+  struct AvxInputContext *const input = ctx->input;
+  aom_image_t *img;
+  int frames = 0;
+
+  while ((!ctx->limit || frames < ctx->limit) &&
+         (img = image_queue_get_free(queue)) != NULL) {
+    if (input->file_type == FILE_TYPE_Y4M) {
+      aom_image_t frame;
+      if (!read_frame(input, &frame) || !image_queue_copy_image(img, &frame))
+        break;
+    } else {
+      if (!img->img_data &&
+          !aom_img_alloc(img, input->fmt, input->width, input->height, 32))
+        break;
+      if (!read_frame(input, img)) break;
+    }
+    image_queue_push(queue);
+    ++frames;
+  }
+  image_queue_finish(queue);
+}
+
 static int file_is_y4m(const char detect[4]) {
   if (memcmp(detect, "YUV4", 4) == 0) {
     return 1;
@@ -157,6 +189,10 @@ static const arg_def_t limit =
     ARG_DEF(NULL, "limit", 1, "Stop encoding after n input frames");
 static const arg_def_t skip =
     ARG_DEF(NULL, "skip", 1, "Skip the first n input frames");
+static const arg_def_t read_ahead =
+    ARG_DEF(NULL, "read-ahead", 1,
+            "Number of input frames to read ahead on a separate thread "
+            "(0 to read them inline, default: 4)");
 static const arg_def_t deadline =
     ARG_DEF("d", "deadline", 1, "Deadline per frame (usec)");
 static const arg_def_t good_dl =
@@ -220,6 +256,7 @@ static const arg_def_t *main_args[] = { &help,
                                         &fpf_name,
                                         &limit,
                                         &skip,
+                                        &read_ahead,
                                         &deadline,
                                         &good_dl,
                                         &quietarg,
@@ -423,6 +460,9 @@ static const arg_def_t tile_cols =
 static const arg_def_t tile_rows =
     ARG_DEF(NULL, "tile-rows", 1,
             "Number of tile rows to use, log2 (set to 0 while threads > 1)");
+static const arg_def_t row_mt =
+    ARG_DEF(NULL, "row-mt", 1,
+            "Enable row based multi-threading (0: off (default), 1: on)");
 #if CONFIG_MAX_TILE
 static const arg_def_t tile_width =
     ARG_DEF(NULL, "tile-width", 1, "Tile widths (comma separated)");
@@ -575,6 +615,7 @@ static const arg_def_t *av1_args[] = { &cpu_used_av1,
 #endif  // CONFIG_EXT_TILE
                                        &tile_cols,
                                        &tile_rows,
+                                       &row_mt,
 #if CONFIG_DEPENDENT_HORZTILES
                                        &tile_dependent_rows,
 #endif
@@ -634,6 +675,7 @@ static const int av1_arg_ctrl_map[] = { AOME_SET_CPUUSED,
 #endif  // CONFIG_EXT_TILE
                                         AV1E_SET_TILE_COLUMNS,
                                         AV1E_SET_TILE_ROWS,
+                                        AV1E_SET_ROW_MT,
 #if CONFIG_DEPENDENT_HORZTILES
                                         AV1E_SET_TILE_DEPENDENT_ROWS,
 #endif
@@ -806,6 +848,7 @@ static void parse_global_config(struct AvxEncoderConfig *global, char **argv) {
   memset(global, 0, sizeof(*global));
   global->codec = get_aom_encoder_by_index(num_encoder - 1);
   global->passes = 0;
+  global->read_ahead = 4;
   global->color_type = I420;
   /* Assign default deadline to good quality */
   global->deadline = AOM_DL_GOOD_QUALITY;
@@ -854,6 +897,8 @@ static void parse_global_config(struct AvxEncoderConfig *global, char **argv) {
       global->limit = arg_parse_uint(&arg);
     else if (arg_match(&arg, &skip, argi))
       global->skip_frames = arg_parse_uint(&arg);
+    else if (arg_match(&arg, &read_ahead, argi))
+      global->read_ahead = arg_parse_uint(&arg);
     else if (arg_match(&arg, &psnrarg, argi))
       global->show_psnr = 1;
     else if (arg_match(&arg, &recontest, argi))
@@ -1826,6 +1871,10 @@ int main(int argc, const char **argv_) {
   int input_shift = 0;
 #endif
   int frame_avail, got_data;
+  aom_image_t *in_frame = &raw;
+  AvxImageQueue *read_ahead_queue = NULL;
+  aom_image_t *queued_frame = NULL;
+  struct ReadAheadContext read_ahead_ctx;
 
   struct AvxInputContext input;
   struct AvxEncoderConfig global;
@@ -2086,6 +2135,20 @@ int main(int argc, const char **argv_) {
     }
 #endif
 
+    // Read the input on a separate thread, so that the encoder does not wait
+    // for the disk or the Y4M chroma conversion.
+    if (global.read_ahead > 0) {
+      read_ahead_ctx.input = &input;
+      read_ahead_ctx.limit = global.limit;
+      read_ahead_queue = image_queue_create(global.read_ahead);
+      if (read_ahead_queue &&
+          !image_queue_start_thread(read_ahead_queue, read_ahead_thread,
+                                    &read_ahead_ctx)) {
+        image_queue_destroy(read_ahead_queue);
+        read_ahead_queue = NULL;
+      }
+    }
+
     frame_avail = 1;
     got_data = 0;
 
@@ -2093,7 +2156,16 @@ int main(int argc, const char **argv_) {
       struct aom_usec_timer timer;
 
       if (!global.limit || frames_in < global.limit) {
-        frame_avail = read_frame(&input, &raw);
+        if (read_ahead_queue) {
+          // The previous frame has been passed to the encoder, which copies
+          // it, so its place in the queue can be reused.
+          if (queued_frame) image_queue_pop(read_ahead_queue);
+          queued_frame = image_queue_front(read_ahead_queue);
+          frame_avail = queued_frame != NULL;
+          if (frame_avail) in_frame = queued_frame;
+        } else {
+          frame_avail = read_frame(&input, &raw);
+        }
 
         if (frame_avail) frames_in++;
         seen_frames =
@@ -2128,14 +2200,14 @@ int main(int argc, const char **argv_) {
           // Input bit depth and stream bit depth do not match, so up
           // shift frame to stream bit depth
           if (!allocated_raw_shift) {
-            aom_img_alloc(&raw_shift, raw.fmt | AOM_IMG_FMT_HIGHBITDEPTH,
+            aom_img_alloc(&raw_shift, in_frame->fmt | AOM_IMG_FMT_HIGHBITDEPTH,
                           input.width, input.height, 32);
             allocated_raw_shift = 1;
           }
-          aom_img_upshift(&raw_shift, &raw, input_shift);
+          aom_img_upshift(&raw_shift, in_frame, input_shift);
           frame_to_encode = &raw_shift;
         } else {
-          frame_to_encode = &raw;
+          frame_to_encode = in_frame;
         }
         aom_usec_timer_start(&timer);
         if (use_16bit_internal) {
@@ -2157,7 +2229,8 @@ int main(int argc, const char **argv_) {
 #else
         aom_usec_timer_start(&timer);
         FOREACH_STREAM(stream, streams) {
-          encode_frame(stream, &global, frame_avail ? &raw : NULL, frames_in);
+          encode_frame(stream, &global, frame_avail ? in_frame : NULL,
+                       frames_in);
         }
 #endif
         aom_usec_timer_mark(&timer);
@@ -2208,6 +2281,16 @@ int main(int argc, const char **argv_) {
       if (!global.quiet) fprintf(stderr, "\033[K");
     }
 
+    if (read_ahead_queue) {
+      image_queue_stop(read_ahead_queue);
+      if (global.verbose)
+        image_queue_print_stats(read_ahead_queue, "Read-ahead", stderr);
+      image_queue_destroy(read_ahead_queue);
+      read_ahead_queue = NULL;
+      queued_frame = NULL;
+      in_frame = &raw;
+    }
+
     if (stream_cnt > 1) fprintf(stderr, "\n");
 
     if (!global.quiet) {
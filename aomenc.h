@@ -45,6 +45,7 @@ struct AvxEncoderConfig {
   int verbose;
   int limit;
   int skip_frames;
+  int read_ahead;
   int show_psnr;
   enum TestDecodeFatality test_decode;
   int have_framerate;
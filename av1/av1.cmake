@@ -379,6 +379,10 @@ set(AOM_AV1_ENCODER_INTRIN_SSE4_1
     ${AOM_AV1_ENCODER_INTRIN_SSE4_1}
     "${AOM_ROOT}/av1/encoder/x86/corner_match_sse4.c")
 
+set(AOM_AV1_ENCODER_INTRIN_AVX2
+    ${AOM_AV1_ENCODER_INTRIN_AVX2}
+    "${AOM_ROOT}/av1/encoder/x86/corner_match_avx2.c")
+
 if (CONFIG_INSPECTION)
   set(AOM_AV1_DECODER_SOURCES
       ${AOM_AV1_DECODER_SOURCES}
@@ -418,6 +422,18 @@ if (CONFIG_CFL)
       ${AOM_AV1_COMMON_SOURCES}
     "${AOM_ROOT}/av1/common/cfl.c"
     "${AOM_ROOT}/av1/common/cfl.h")
+
+  set(AOM_AV1_COMMON_INTRIN_SSE2
+      ${AOM_AV1_COMMON_INTRIN_SSE2}
+      "${AOM_ROOT}/av1/common/x86/cfl_sse2.c")
+
+  set(AOM_AV1_COMMON_INTRIN_SSSE3
+      ${AOM_AV1_COMMON_INTRIN_SSSE3}
+      "${AOM_ROOT}/av1/common/x86/cfl_ssse3.c")
+
+  set(AOM_AV1_COMMON_INTRIN_AVX2
+      ${AOM_AV1_COMMON_INTRIN_AVX2}
+      "${AOM_ROOT}/av1/common/x86/cfl_avx2.c")
 endif ()
 
 if (CONFIG_LOOP_RESTORATION)
@@ -430,6 +446,10 @@ if (CONFIG_LOOP_RESTORATION)
       ${AOM_AV1_COMMON_INTRIN_SSE4_1}
       "${AOM_ROOT}/av1/common/x86/selfguided_sse4.c")
 
+  set(AOM_AV1_COMMON_INTRIN_AVX2
+      ${AOM_AV1_COMMON_INTRIN_AVX2}
+      "${AOM_ROOT}/av1/common/x86/selfguided_avx2.c")
+
   set(AOM_AV1_ENCODER_SOURCES
       ${AOM_AV1_ENCODER_SOURCES}
       "${AOM_ROOT}/av1/encoder/pickrst.c"
@@ -461,6 +481,10 @@ if (CONFIG_JNT_COMP)
       "${AOM_ROOT}/av1/common/x86/warp_plane_sse4.c")
 endif ()
 
+set(AOM_AV1_COMMON_INTRIN_AVX2
+    ${AOM_AV1_COMMON_INTRIN_AVX2}
+    "${AOM_ROOT}/av1/common/x86/warp_error_avx2.c")
+
 if (CONFIG_HIGHBITDEPTH)
   set(AOM_AV1_COMMON_INTRIN_SSSE3
       ${AOM_AV1_COMMON_INTRIN_SSSE3}
@@ -477,9 +501,7 @@ if (CONFIG_HASH_ME)
   set(AOM_AV1_ENCODER_SOURCES
       ${AOM_AV1_ENCODER_SOURCES}
       "${AOM_ROOT}/av1/encoder/hash_motion.h"
-      "${AOM_ROOT}/av1/encoder/hash_motion.c"
-      "${AOM_ROOT}/third_party/vector/vector.h"
-      "${AOM_ROOT}/third_party/vector/vector.c")
+      "${AOM_ROOT}/av1/encoder/hash_motion.c")
 endif ()
 
 if (CONFIG_Q_ADAPT_PROBS)
@@ -87,6 +87,7 @@ ifeq ($(CONFIG_LOOP_RESTORATION),yes)
 AV1_COMMON_SRCS-yes += common/restoration.h
 AV1_COMMON_SRCS-yes += common/restoration.c
 AV1_COMMON_SRCS-$(HAVE_SSE4_1) += common/x86/selfguided_sse4.c
+AV1_COMMON_SRCS-$(HAVE_AVX2) += common/x86/selfguided_avx2.c
 endif
 ifeq ($(CONFIG_INTRA_EDGE),yes)
 AV1_COMMON_SRCS-$(HAVE_SSE4_1) += common/x86/intra_edge_sse4.c
@@ -118,6 +119,9 @@ AV1_COMMON_SRCS-yes += common/odintrin.h
 ifeq ($(CONFIG_CFL),yes)
 AV1_COMMON_SRCS-yes += common/cfl.h
 AV1_COMMON_SRCS-yes += common/cfl.c
+AV1_COMMON_SRCS-$(HAVE_SSE2) += common/x86/cfl_sse2.c
+AV1_COMMON_SRCS-$(HAVE_SSSE3) += common/x86/cfl_ssse3.c
+AV1_COMMON_SRCS-$(HAVE_AVX2) += common/x86/cfl_avx2.c
 endif
 
 AV1_COMMON_SRCS-yes += common/obmc.h
@@ -144,6 +148,7 @@ AV1_COMMON_SRCS-$(HAVE_SSSE3) += common/x86/warp_plane_ssse3.c
 ifeq ($(CONFIG_JNT_COMP), yes)
 AV1_COMMON_SRCS-$(HAVE_SSE4_1) += common/x86/warp_plane_sse4.c
 endif
+AV1_COMMON_SRCS-$(HAVE_AVX2) += common/x86/warp_error_avx2.c
 ifeq ($(CONFIG_HIGHBITDEPTH),yes)
 AV1_COMMON_SRCS-$(HAVE_SSSE3) += common/x86/highbd_warp_plane_ssse3.c
 ifeq ($(CONFIG_JNT_COMP), yes)
@@ -116,8 +116,6 @@ AV1_CX_SRCS-yes += encoder/mbgraph.h
 AV1_CX_SRCS-yes += encoder/hash.c
 AV1_CX_SRCS-yes += encoder/hash.h
 ifeq ($(CONFIG_HASH_ME),yes)
-AV1_CX_SRCS-yes += ../third_party/vector/vector.h
-AV1_CX_SRCS-yes += ../third_party/vector/vector.c
 AV1_CX_SRCS-yes += encoder/hash_motion.c
 AV1_CX_SRCS-yes += encoder/hash_motion.h
 endif
@@ -165,6 +163,7 @@ AV1_CX_SRCS-$(HAVE_MSA) += encoder/mips/msa/fdct_msa.h
 AV1_CX_SRCS-$(HAVE_MSA) += encoder/mips/msa/temporal_filter_msa.c
 
 AV1_CX_SRCS-$(HAVE_SSE4_1) += encoder/x86/corner_match_sse4.c
+AV1_CX_SRCS-$(HAVE_AVX2) += encoder/x86/corner_match_avx2.c
 
 AV1_CX_SRCS-yes += encoder/tx_prune_model_weights.h
 
@@ -39,6 +39,7 @@ struct av1_extracfg {
   unsigned int static_thresh;
   unsigned int tile_columns;  // log2 number of tile columns
   unsigned int tile_rows;     // log2 number of tile rows
+  unsigned int row_mt;
 #if CONFIG_DEPENDENT_HORZTILES
   unsigned int dependent_horz_tiles;
 #endif
@@ -101,6 +102,7 @@ static struct av1_extracfg default_extra_cfg = {
   0,  // static_thresh
   0,  // tile_columns
   0,  // tile_rows
+  0,  // row_mt
 #if CONFIG_DEPENDENT_HORZTILES
   0,  // Dependent Horizontal tiles
 #endif
@@ -277,6 +279,7 @@ static aom_codec_err_t validate_config(aom_codec_alg_priv_t *ctx,
   RANGE_CHECK(extra_cfg, cpu_used, 0, 8);
   RANGE_CHECK(extra_cfg, dev_sf, 0, UINT8_MAX);
   RANGE_CHECK_HI(extra_cfg, noise_sensitivity, 6);
+  RANGE_CHECK_HI(extra_cfg, row_mt, 1);
   RANGE_CHECK(extra_cfg, superblock_size, AOM_SUPERBLOCK_SIZE_64X64,
               AOM_SUPERBLOCK_SIZE_DYNAMIC);
 #if CONFIG_EXT_TILE
@@ -468,6 +471,7 @@ static aom_codec_err_t set_encoder_config(
   const int is_vbr = cfg->rc_end_usage == AOM_VBR;
   oxcf->profile = cfg->g_profile;
   oxcf->max_threads = (int)cfg->g_threads;
+  oxcf->row_mt = extra_cfg->row_mt;
   oxcf->width = cfg->g_w;
   oxcf->height = cfg->g_h;
   oxcf->bit_depth = cfg->g_bit_depth;
@@ -799,6 +803,13 @@ static aom_codec_err_t ctrl_set_tile_rows(aom_codec_alg_priv_t *ctx,
   return update_extra_cfg(ctx, &extra_cfg);
 }
 
+static aom_codec_err_t ctrl_set_row_mt(aom_codec_alg_priv_t *ctx,
+                                       va_list args) {
+  struct av1_extracfg extra_cfg = ctx->extra_cfg;
+  extra_cfg.row_mt = CAST(AV1E_SET_ROW_MT, args);
+  return update_extra_cfg(ctx, &extra_cfg);
+}
+
 #if CONFIG_DEPENDENT_HORZTILES
 static aom_codec_err_t ctrl_set_tile_dependent_rows(aom_codec_alg_priv_t *ctx,
                                                     va_list args) {
@@ -1463,6 +1474,23 @@ static aom_codec_err_t ctrl_set_roi_map(aom_codec_alg_priv_t *ctx,
   return AOM_CODEC_INVALID_PARAM;
 }
 
+static aom_codec_err_t ctrl_set_thread_pool(aom_codec_alg_priv_t *ctx,
+                                            va_list args) {
+  const aom_thread_pool_t *const pool = va_arg(args, aom_thread_pool_t *);
+
+  // The workers are started with the first frame.
+  if (ctx->cpi->scheduler != NULL) return AOM_CODEC_ERROR;
+  if (pool == NULL) {
+    av1_zero(ctx->cpi->thread_pool);
+  } else if (pool->submit != NULL && pool->wait != NULL &&
+             pool->num_threads > 0) {
+    ctx->cpi->thread_pool = *pool;
+  } else {
+    return AOM_CODEC_INVALID_PARAM;
+  }
+  return AOM_CODEC_OK;
+}
+
 static aom_codec_err_t ctrl_set_active_map(aom_codec_alg_priv_t *ctx,
                                            va_list args) {
   aom_active_map_t *const map = va_arg(args, aom_active_map_t *);
@@ -1579,6 +1607,7 @@ static aom_codec_ctrl_fn_map_t encoder_ctrl_maps[] = {
   { AV1_SET_REFERENCE, ctrl_set_reference },
   { AOM_SET_POSTPROC, ctrl_set_previewpp },
   { AOME_SET_ROI_MAP, ctrl_set_roi_map },
+  { AOM_SET_THREAD_POOL, ctrl_set_thread_pool },
   { AOME_SET_ACTIVEMAP, ctrl_set_active_map },
   { AOME_SET_SCALEMODE, ctrl_set_scale_mode },
   { AOME_SET_CPUUSED, ctrl_set_cpuused },
@@ -1589,6 +1618,7 @@ static aom_codec_ctrl_fn_map_t encoder_ctrl_maps[] = {
   { AOME_SET_STATIC_THRESHOLD, ctrl_set_static_thresh },
   { AV1E_SET_TILE_COLUMNS, ctrl_set_tile_columns },
   { AV1E_SET_TILE_ROWS, ctrl_set_tile_rows },
+  { AV1E_SET_ROW_MT, ctrl_set_row_mt },
 #if CONFIG_DEPENDENT_HORZTILES
   { AV1E_SET_TILE_DEPENDENT_ROWS, ctrl_set_tile_dependent_rows },
 #endif
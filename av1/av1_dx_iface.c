@@ -9,6 +9,7 @@
  * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
  */
 
+#include <limits.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -57,15 +58,18 @@ struct aom_codec_alg_priv {
   int skip_loop_filter;
   int decode_tile_row;
   int decode_tile_col;
-
-  // Frame parallel related.
+  int row_mt;
+  aom_thread_pool_t thread_pool;
+  // The frame size the internal frame buffers are allocated for up front.
+  int max_fb_width;
+  int max_fb_height;
+
+  // Frame parallel related. The in-loop filters of each frame run while the
+  // next frame is decoded, so the decoded frames are output one call late
+  // from frame_cache.
   int frame_parallel_decode;  // frame-based threading.
   AVxWorker *frame_workers;
   int num_frame_workers;
-  int next_submit_worker_id;
-  int last_submit_worker_id;
-  int next_output_worker_id;
-  int available_threads;
   cache_frame frame_cache[FRAME_CACHE_SIZE];
   int frame_cache_write;
   int frame_cache_read;
@@ -100,6 +104,7 @@ static aom_codec_err_t decoder_init(aom_codec_ctx_t *ctx,
     ctx->priv = (aom_codec_priv_t *)priv;
     ctx->priv->init_flags = ctx->init_flags;
     priv->flushed = 0;
+    priv->row_mt = 1;
     // Only do frame parallel decode when threads > 1.
     priv->frame_parallel_decode =
         (ctx->config.dec && (ctx->config.dec->threads > 1) &&
@@ -125,6 +130,7 @@ static aom_codec_err_t decoder_destroy(aom_codec_alg_priv_t *ctx) {
       FrameWorkerData *const frame_worker_data =
           (FrameWorkerData *)worker->data1;
       aom_get_worker_interface()->end(worker);
+      av1_dec_sync_frame_filter(frame_worker_data->pbi);
 #if CONFIG_MFMV
       aom_free(frame_worker_data->pbi->common.tpl_mvs);
       frame_worker_data->pbi->common.tpl_mvs = NULL;
@@ -134,11 +140,6 @@ static aom_codec_err_t decoder_destroy(aom_codec_alg_priv_t *ctx) {
       av1_free_restoration_buffers(&frame_worker_data->pbi->common);
 #endif  // CONFIG_LOOP_RESTORATION
       av1_decoder_remove(frame_worker_data->pbi);
-      aom_free(frame_worker_data->scratch_buffer);
-#if CONFIG_MULTITHREAD
-      pthread_mutex_destroy(&frame_worker_data->stats_mutex);
-      pthread_cond_destroy(&frame_worker_data->stats_cond);
-#endif
       aom_free(frame_worker_data);
     }
 #if CONFIG_MULTITHREAD
@@ -409,6 +410,31 @@ static void init_buffer_callbacks(aom_codec_alg_priv_t *ctx) {
   }
 }
 
+static aom_codec_err_t prealloc_frame_buffers(aom_codec_alg_priv_t *ctx) {
+  BufferPool *const pool = ctx->buffer_pool;
+  size_t size;
+  int ret;
+
+  // Only the internal frame buffers are pooled.
+  if (ctx->max_fb_width == 0 ||
+      (ctx->get_ext_fb_cb != NULL && ctx->release_ext_fb_cb != NULL))
+    return AOM_CODEC_OK;
+
+  size = aom_calc_ext_frame_buffer_size(ctx->max_fb_width, ctx->max_fb_height,
+                                        1, 1,
+#if CONFIG_HIGHBITDEPTH
+                                        !ctx->cfg.allow_lowbitdepth,
+#endif
+                                        AOM_BORDER_IN_PIXELS,
+                                        ctx->byte_alignment);
+  if (size == 0) return AOM_CODEC_MEM_ERROR;
+
+  lock_buffer_pool(pool);
+  ret = av1_prealloc_internal_frame_buffers(&pool->int_frame_buffers, size);
+  unlock_buffer_pool(pool);
+  return ret ? AOM_CODEC_MEM_ERROR : AOM_CODEC_OK;
+}
+
 static void set_default_ppflags(aom_postproc_cfg_t *cfg) {
   cfg->post_proc_flag = AOM_DEBLOCK | AOM_DEMACROBLOCK;
   cfg->deblocking_level = 4;
@@ -424,26 +450,8 @@ static int frame_worker_hook(void *arg1, void *arg2) {
       frame_worker_data->pbi, frame_worker_data->data_size, &data);
   frame_worker_data->data_end = data;
 
-  if (frame_worker_data->pbi->common.frame_parallel_decode) {
-    // In frame parallel decoding, a worker thread must successfully decode all
-    // the compressed data.
-    if (frame_worker_data->result != 0 ||
-        frame_worker_data->data + frame_worker_data->data_size - 1 > data) {
-      AVxWorker *const worker = frame_worker_data->pbi->frame_worker_owner;
-      BufferPool *const pool = frame_worker_data->pbi->common.buffer_pool;
-      // Signal all the other threads that are waiting for this frame.
-      av1_frameworker_lock_stats(worker);
-      frame_worker_data->frame_context_ready = 1;
-      lock_buffer_pool(pool);
-      frame_worker_data->pbi->cur_buf->buf.corrupted = 1;
-      unlock_buffer_pool(pool);
-      frame_worker_data->pbi->need_resync = 1;
-      av1_frameworker_signal_stats(worker);
-      av1_frameworker_unlock_stats(worker);
-      return 0;
-    }
-  } else if (frame_worker_data->result != 0) {
-    // Check decode result in serial decode.
+  if (frame_worker_data->result != 0) {
+    // Check decode result.
     frame_worker_data->pbi->cur_buf->buf.corrupted = 1;
     frame_worker_data->pbi->need_resync = 1;
   }
@@ -455,18 +463,11 @@ static aom_codec_err_t init_decoder(aom_codec_alg_priv_t *ctx) {
   const AVxWorkerInterface *const winterface = aom_get_worker_interface();
 
   ctx->last_show_frame = -1;
-  ctx->next_submit_worker_id = 0;
-  ctx->last_submit_worker_id = 0;
-  ctx->next_output_worker_id = 0;
   ctx->frame_cache_read = 0;
   ctx->frame_cache_write = 0;
   ctx->num_cache_frames = 0;
   ctx->need_resync = 1;
-  ctx->num_frame_workers =
-      (ctx->frame_parallel_decode == 1) ? ctx->cfg.threads : 1;
-  if (ctx->num_frame_workers > MAX_DECODE_THREADS)
-    ctx->num_frame_workers = MAX_DECODE_THREADS;
-  ctx->available_threads = ctx->num_frame_workers;
+  ctx->num_frame_workers = 1;
   ctx->flushed = 0;
 
   ctx->buffer_pool = (BufferPool *)aom_calloc(1, sizeof(BufferPool));
@@ -501,33 +502,14 @@ static aom_codec_err_t init_decoder(aom_codec_alg_priv_t *ctx) {
       set_error_detail(ctx, "Failed to allocate frame_worker_data");
       return AOM_CODEC_MEM_ERROR;
     }
-    frame_worker_data->pbi->frame_worker_owner = worker;
-    frame_worker_data->worker_id = i;
-    frame_worker_data->scratch_buffer = NULL;
-    frame_worker_data->scratch_buffer_size = 0;
-    frame_worker_data->frame_context_ready = 0;
     frame_worker_data->received_frame = 0;
-#if CONFIG_MULTITHREAD
-    if (pthread_mutex_init(&frame_worker_data->stats_mutex, NULL)) {
-      set_error_detail(ctx, "Failed to allocate frame_worker_data mutex");
-      return AOM_CODEC_MEM_ERROR;
-    }
-
-    if (pthread_cond_init(&frame_worker_data->stats_cond, NULL)) {
-      set_error_detail(ctx, "Failed to allocate frame_worker_data cond");
-      return AOM_CODEC_MEM_ERROR;
-    }
-#endif
     frame_worker_data->pbi->allow_lowbitdepth = ctx->cfg.allow_lowbitdepth;
 
-    // If decoding in serial mode, FrameWorker thread could create tile worker
-    // thread or loopfilter thread.
-    frame_worker_data->pbi->max_threads =
-        (ctx->frame_parallel_decode == 0) ? ctx->cfg.threads : 0;
+    // FrameWorker thread could create tile worker thread or loopfilter thread.
+    frame_worker_data->pbi->max_threads = ctx->cfg.threads;
 
     frame_worker_data->pbi->inv_tile_order = ctx->invert_tile_order;
-    frame_worker_data->pbi->common.frame_parallel_decode =
-        ctx->frame_parallel_decode;
+    frame_worker_data->pbi->frame_parallel_decode = ctx->frame_parallel_decode;
     worker->hook = (AVxWorkerHook)frame_worker_hook;
     if (!winterface->reset(worker)) {
       set_error_detail(ctx, "Frame Worker thread creation failed");
@@ -542,6 +524,11 @@ static aom_codec_err_t init_decoder(aom_codec_alg_priv_t *ctx) {
 
   init_buffer_callbacks(ctx);
 
+  if (prealloc_frame_buffers(ctx) != AOM_CODEC_OK) {
+    set_error_detail(ctx, "Failed to allocate frame buffers");
+    return AOM_CODEC_MEM_ERROR;
+  }
+
   return AOM_CODEC_OK;
 }
 
@@ -572,111 +559,66 @@ static aom_codec_err_t decode_one(aom_codec_alg_priv_t *ctx,
     if (!ctx->si.is_kf && !is_intra_only) return AOM_CODEC_ERROR;
   }
 
-  if (!ctx->frame_parallel_decode) {
-    AVxWorker *const worker = ctx->frame_workers;
-    FrameWorkerData *const frame_worker_data = (FrameWorkerData *)worker->data1;
-    frame_worker_data->data = *data;
-    frame_worker_data->data_size = data_sz;
-    frame_worker_data->user_priv = user_priv;
-    frame_worker_data->received_frame = 1;
-
-    // Set these even if already initialized.  The caller may have changed the
-    // decrypt config between frames.
-    frame_worker_data->pbi->decrypt_cb = ctx->decrypt_cb;
-    frame_worker_data->pbi->decrypt_state = ctx->decrypt_state;
+  AVxWorker *const worker = ctx->frame_workers;
+  FrameWorkerData *const frame_worker_data = (FrameWorkerData *)worker->data1;
+  AV1Decoder *const pbi = frame_worker_data->pbi;
+
+  // A shown frame held in the cache keeps its frame buffer.
+  if (ctx->frame_parallel_decode && ctx->num_cache_frames == FRAME_CACHE_SIZE) {
+    set_error_detail(ctx, "Frame output cache is full.");
+    return AOM_CODEC_ERROR;
+  }
+
+  frame_worker_data->data = *data;
+  frame_worker_data->data_size = data_sz;
+  frame_worker_data->user_priv = user_priv;
+  frame_worker_data->received_frame = 1;
+
+  // Set these even if already initialized.  The caller may have changed the
+  // decrypt config between frames.
+  pbi->decrypt_cb = ctx->decrypt_cb;
+  pbi->decrypt_state = ctx->decrypt_state;
+  pbi->row_mt = ctx->row_mt;
+  pbi->thread_pool = ctx->thread_pool;
 #if CONFIG_INSPECTION
-    frame_worker_data->pbi->inspect_cb = ctx->inspect_cb;
-    frame_worker_data->pbi->inspect_ctx = ctx->inspect_ctx;
+  pbi->inspect_cb = ctx->inspect_cb;
+  pbi->inspect_ctx = ctx->inspect_ctx;
 #endif
 
 #if CONFIG_EXT_TILE
-    frame_worker_data->pbi->dec_tile_row = ctx->decode_tile_row;
-    frame_worker_data->pbi->dec_tile_col = ctx->decode_tile_col;
+  pbi->dec_tile_row = ctx->decode_tile_row;
+  pbi->dec_tile_col = ctx->decode_tile_col;
 #endif  // CONFIG_EXT_TILE
 
-    worker->had_error = 0;
-    winterface->execute(worker);
+  worker->had_error = 0;
+  winterface->execute(worker);
 
-    // Update data pointer after decode.
-    *data = frame_worker_data->data_end;
+  // Update data pointer after decode.
+  *data = frame_worker_data->data_end;
 
-    if (worker->had_error)
-      return update_error_state(ctx, &frame_worker_data->pbi->common.error);
+  if (worker->had_error) return update_error_state(ctx, &pbi->common.error);
 
-    check_resync(ctx, frame_worker_data->pbi);
-  } else {
-    AVxWorker *const worker = &ctx->frame_workers[ctx->next_submit_worker_id];
-    FrameWorkerData *const frame_worker_data = (FrameWorkerData *)worker->data1;
-    // Copy context from last worker thread to next worker thread.
-    if (ctx->next_submit_worker_id != ctx->last_submit_worker_id)
-      av1_frameworker_copy_context(
-          &ctx->frame_workers[ctx->next_submit_worker_id],
-          &ctx->frame_workers[ctx->last_submit_worker_id]);
-
-    frame_worker_data->pbi->ready_for_new_data = 0;
-    // Copy the compressed data into worker's internal buffer.
-    // TODO(hkuang): Will all the workers allocate the same size
-    // as the size of the first intra frame be better? This will
-    // avoid too many deallocate and allocate.
-    if (frame_worker_data->scratch_buffer_size < data_sz) {
-      aom_free(frame_worker_data->scratch_buffer);
-      frame_worker_data->scratch_buffer = (uint8_t *)aom_malloc(data_sz);
-      if (frame_worker_data->scratch_buffer == NULL) {
-        set_error_detail(ctx, "Failed to reallocate scratch buffer");
-        return AOM_CODEC_MEM_ERROR;
-      }
-      frame_worker_data->scratch_buffer_size = data_sz;
+  check_resync(ctx, pbi);
+
+  if (ctx->frame_parallel_decode) {
+    YV12_BUFFER_CONFIG sd;
+
+    // The frame may still be filtered; decoder_get_frame() waits for it.
+    if (av1_get_raw_frame(pbi, &sd) == 0) {
+      AV1_COMMON *const cm = &pbi->common;
+      RefCntBuffer *const frame_bufs = cm->buffer_pool->frame_bufs;
+      cache_frame *const cache = &ctx->frame_cache[ctx->frame_cache_write];
+      cache->fb_idx = cm->new_fb_idx;
+      yuvconfig2image(&cache->img, &sd, user_priv);
+      cache->img.fb_priv = frame_bufs[cm->new_fb_idx].raw_frame_buffer.priv;
+      ctx->frame_cache_write = (ctx->frame_cache_write + 1) % FRAME_CACHE_SIZE;
+      ++ctx->num_cache_frames;
     }
-    frame_worker_data->data_size = data_sz;
-    memcpy(frame_worker_data->scratch_buffer, *data, data_sz);
-
-    frame_worker_data->frame_decoded = 0;
-    frame_worker_data->frame_context_ready = 0;
-    frame_worker_data->received_frame = 1;
-    frame_worker_data->data = frame_worker_data->scratch_buffer;
-    frame_worker_data->user_priv = user_priv;
-
-    if (ctx->next_submit_worker_id != ctx->last_submit_worker_id)
-      ctx->last_submit_worker_id =
-          (ctx->last_submit_worker_id + 1) % ctx->num_frame_workers;
-
-    ctx->next_submit_worker_id =
-        (ctx->next_submit_worker_id + 1) % ctx->num_frame_workers;
-    --ctx->available_threads;
-    worker->had_error = 0;
-    winterface->launch(worker);
   }
 
   return AOM_CODEC_OK;
 }
 
-static void wait_worker_and_cache_frame(aom_codec_alg_priv_t *ctx) {
-  YV12_BUFFER_CONFIG sd;
-  const AVxWorkerInterface *const winterface = aom_get_worker_interface();
-  AVxWorker *const worker = &ctx->frame_workers[ctx->next_output_worker_id];
-  FrameWorkerData *const frame_worker_data = (FrameWorkerData *)worker->data1;
-  ctx->next_output_worker_id =
-      (ctx->next_output_worker_id + 1) % ctx->num_frame_workers;
-  // TODO(hkuang): Add worker error handling here.
-  winterface->sync(worker);
-  frame_worker_data->received_frame = 0;
-  ++ctx->available_threads;
-
-  check_resync(ctx, frame_worker_data->pbi);
-
-  if (av1_get_raw_frame(frame_worker_data->pbi, &sd) == 0) {
-    AV1_COMMON *const cm = &frame_worker_data->pbi->common;
-    RefCntBuffer *const frame_bufs = cm->buffer_pool->frame_bufs;
-    ctx->frame_cache[ctx->frame_cache_write].fb_idx = cm->new_fb_idx;
-    yuvconfig2image(&ctx->frame_cache[ctx->frame_cache_write].img, &sd,
-                    frame_worker_data->user_priv);
-    ctx->frame_cache[ctx->frame_cache_write].img.fb_priv =
-        frame_bufs[cm->new_fb_idx].raw_frame_buffer.priv;
-    ctx->frame_cache_write = (ctx->frame_cache_write + 1) % FRAME_CACHE_SIZE;
-    ++ctx->num_cache_frames;
-  }
-}
-
 static aom_codec_err_t decoder_decode(aom_codec_alg_priv_t *ctx,
                                       const uint8_t *data, unsigned int data_sz,
                                       void *user_priv, long deadline) {
@@ -708,89 +650,36 @@ static aom_codec_err_t decoder_decode(aom_codec_alg_priv_t *ctx,
 
   data_start += index_size;
 #endif
-  if (ctx->frame_parallel_decode) {
-    // Decode in frame parallel mode. When decoding in this mode, the frame
-    // passed to the decoder must be either a normal frame or a superframe with
-    // superframe index so the decoder could get each frame's start position
-    // in the superframe.
-    if (frame_count > 0) {
-      int i;
-
-      for (i = 0; i < frame_count; ++i) {
-        const uint8_t *data_start_copy = data_start;
-        const uint32_t frame_size = frame_sizes[i];
-        if (data_start < data ||
-            frame_size > (uint32_t)(data_end - data_start)) {
-          set_error_detail(ctx, "Invalid frame size in index");
-          return AOM_CODEC_CORRUPT_FRAME;
-        }
-
-        if (ctx->available_threads == 0) {
-          // No more threads for decoding. Wait until the next output worker
-          // finishes decoding. Then copy the decoded frame into cache.
-          if (ctx->num_cache_frames < FRAME_CACHE_SIZE) {
-            wait_worker_and_cache_frame(ctx);
-          } else {
-            // TODO(hkuang): Add unit test to test this path.
-            set_error_detail(ctx, "Frame output cache is full.");
-            return AOM_CODEC_ERROR;
-          }
-        }
+  if (frame_count > 0) {
+    int i;
 
-        res =
-            decode_one(ctx, &data_start_copy, frame_size, user_priv, deadline);
-        if (res != AOM_CODEC_OK) return res;
-        data_start += frame_size;
-      }
-    } else {
-      if (ctx->available_threads == 0) {
-        // No more threads for decoding. Wait until the next output worker
-        // finishes decoding. Then copy the decoded frame into cache.
-        if (ctx->num_cache_frames < FRAME_CACHE_SIZE) {
-          wait_worker_and_cache_frame(ctx);
-        } else {
-          // TODO(hkuang): Add unit test to test this path.
-          set_error_detail(ctx, "Frame output cache is full.");
-          return AOM_CODEC_ERROR;
-        }
+    for (i = 0; i < frame_count; ++i) {
+      const uint8_t *data_start_copy = data_start;
+      const uint32_t frame_size = frame_sizes[i];
+      if (data_start < data ||
+          frame_size > (uint32_t)(data_end - data_start)) {
+        set_error_detail(ctx, "Invalid frame size in index");
+        return AOM_CODEC_CORRUPT_FRAME;
       }
 
-      res = decode_one(ctx, &data, data_sz, user_priv, deadline);
+      res =
+          decode_one(ctx, &data_start_copy, frame_size, user_priv, deadline);
       if (res != AOM_CODEC_OK) return res;
+
+      data_start += frame_size;
     }
   } else {
-    // Decode in serial mode.
-    if (frame_count > 0) {
-      int i;
-
-      for (i = 0; i < frame_count; ++i) {
-        const uint8_t *data_start_copy = data_start;
-        const uint32_t frame_size = frame_sizes[i];
-        if (data_start < data ||
-            frame_size > (uint32_t)(data_end - data_start)) {
-          set_error_detail(ctx, "Invalid frame size in index");
-          return AOM_CODEC_CORRUPT_FRAME;
-        }
-
-        res =
-            decode_one(ctx, &data_start_copy, frame_size, user_priv, deadline);
-        if (res != AOM_CODEC_OK) return res;
+    while (data_start < data_end) {
+      const uint32_t frame_size = (uint32_t)(data_end - data_start);
+      res = decode_one(ctx, &data_start, frame_size, user_priv, deadline);
+      if (res != AOM_CODEC_OK) return res;
 
-        data_start += frame_size;
-      }
-    } else {
+      // Account for suboptimal termination by the encoder.
       while (data_start < data_end) {
-        const uint32_t frame_size = (uint32_t)(data_end - data_start);
-        res = decode_one(ctx, &data_start, frame_size, user_priv, deadline);
-        if (res != AOM_CODEC_OK) return res;
-
-        // Account for suboptimal termination by the encoder.
-        while (data_start < data_end) {
-          const uint8_t marker =
-              read_marker(ctx->decrypt_cb, ctx->decrypt_state, data_start);
-          if (marker) break;
-          ++data_start;
-        }
+        const uint8_t marker =
+            read_marker(ctx->decrypt_cb, ctx->decrypt_state, data_start);
+        if (marker) break;
+        ++data_start;
       }
     }
   }
@@ -813,96 +702,88 @@ static aom_image_t *decoder_get_frame(aom_codec_alg_priv_t *ctx,
                                       aom_codec_iter_t *iter) {
   aom_image_t *img = NULL;
 
-  // Only return frame when all the cpu are busy or
-  // application fluhsed the decoder in frame parallel decode.
-  if (ctx->frame_parallel_decode && ctx->available_threads > 0 &&
-      !ctx->flushed) {
-    return NULL;
-  }
-
-  // Output the frames in the cache first.
-  if (ctx->num_cache_frames > 0) {
+  // Output the frames in the cache first. In frame parallel decode the last
+  // frame is held back until the next one is decoded or the application
+  // flushes the decoder, so that it is filtered meanwhile.
+  if (ctx->num_cache_frames > (ctx->flushed ? 0 : ctx->frame_parallel_decode)) {
+    cache_frame *const cache = &ctx->frame_cache[ctx->frame_cache_read];
+    FrameWorkerData *const frame_worker_data =
+        (FrameWorkerData *)ctx->frame_workers[0].data1;
+    av1_frame_progress_wait(frame_worker_data->pbi,
+                            &ctx->buffer_pool->frame_bufs[cache->fb_idx],
+                            INT_MAX);
     release_last_output_frame(ctx);
-    ctx->last_show_frame = ctx->frame_cache[ctx->frame_cache_read].fb_idx;
-    if (ctx->need_resync) return NULL;
-    img = &ctx->frame_cache[ctx->frame_cache_read].img;
+    ctx->last_show_frame = cache->fb_idx;
     ctx->frame_cache_read = (ctx->frame_cache_read + 1) % FRAME_CACHE_SIZE;
     --ctx->num_cache_frames;
-    return img;
+    if (ctx->need_resync) return NULL;
+    return &cache->img;
   }
 
   // iter acts as a flip flop, so an image is only returned on the first
   // call to get_frame.
-  if (*iter == NULL && ctx->frame_workers != NULL) {
-    do {
-      YV12_BUFFER_CONFIG sd;
-      const AVxWorkerInterface *const winterface = aom_get_worker_interface();
-      AVxWorker *const worker = &ctx->frame_workers[ctx->next_output_worker_id];
-      FrameWorkerData *const frame_worker_data =
-          (FrameWorkerData *)worker->data1;
-      ctx->next_output_worker_id =
-          (ctx->next_output_worker_id + 1) % ctx->num_frame_workers;
-      // Wait for the frame from worker thread.
-      if (winterface->sync(worker)) {
-        // Check if worker has received any frames.
-        if (frame_worker_data->received_frame == 1) {
-          ++ctx->available_threads;
-          frame_worker_data->received_frame = 0;
-          check_resync(ctx, frame_worker_data->pbi);
-        }
-        if (av1_get_raw_frame(frame_worker_data->pbi, &sd) == 0) {
-          AV1_COMMON *const cm = &frame_worker_data->pbi->common;
-          RefCntBuffer *const frame_bufs = cm->buffer_pool->frame_bufs;
-          release_last_output_frame(ctx);
-          ctx->last_show_frame = frame_worker_data->pbi->common.new_fb_idx;
-          if (ctx->need_resync) return NULL;
-          yuvconfig2image(&ctx->img, &sd, frame_worker_data->user_priv);
+  if (*iter == NULL && ctx->frame_workers != NULL &&
+      !ctx->frame_parallel_decode) {
+    YV12_BUFFER_CONFIG sd;
+    const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+    AVxWorker *const worker = ctx->frame_workers;
+    FrameWorkerData *const frame_worker_data = (FrameWorkerData *)worker->data1;
+    // Wait for the frame from worker thread.
+    if (winterface->sync(worker)) {
+      // Check if worker has received any frames.
+      if (frame_worker_data->received_frame == 1) {
+        frame_worker_data->received_frame = 0;
+        check_resync(ctx, frame_worker_data->pbi);
+      }
+      if (av1_get_raw_frame(frame_worker_data->pbi, &sd) == 0) {
+        AV1_COMMON *const cm = &frame_worker_data->pbi->common;
+        RefCntBuffer *const frame_bufs = cm->buffer_pool->frame_bufs;
+        ctx->last_show_frame = frame_worker_data->pbi->common.new_fb_idx;
+        if (ctx->need_resync) return NULL;
+        yuvconfig2image(&ctx->img, &sd, frame_worker_data->user_priv);
 
 #if CONFIG_EXT_TILE
-          if (cm->single_tile_decoding &&
-              frame_worker_data->pbi->dec_tile_row >= 0) {
-            const int tile_row =
-                AOMMIN(frame_worker_data->pbi->dec_tile_row, cm->tile_rows - 1);
-            const int mi_row = tile_row * cm->tile_height;
-            const int ssy = ctx->img.y_chroma_shift;
-            int plane;
-            ctx->img.planes[0] += mi_row * MI_SIZE * ctx->img.stride[0];
-            for (plane = 1; plane < MAX_MB_PLANE; ++plane) {
-              ctx->img.planes[plane] +=
-                  mi_row * (MI_SIZE >> ssy) * ctx->img.stride[plane];
-            }
-            ctx->img.d_h =
-                AOMMIN(cm->tile_height, cm->mi_rows - mi_row) * MI_SIZE;
+        if (cm->single_tile_decoding &&
+            frame_worker_data->pbi->dec_tile_row >= 0) {
+          const int tile_row =
+              AOMMIN(frame_worker_data->pbi->dec_tile_row, cm->tile_rows - 1);
+          const int mi_row = tile_row * cm->tile_height;
+          const int ssy = ctx->img.y_chroma_shift;
+          int plane;
+          ctx->img.planes[0] += mi_row * MI_SIZE * ctx->img.stride[0];
+          for (plane = 1; plane < MAX_MB_PLANE; ++plane) {
+            ctx->img.planes[plane] +=
+                mi_row * (MI_SIZE >> ssy) * ctx->img.stride[plane];
           }
+          ctx->img.d_h =
+              AOMMIN(cm->tile_height, cm->mi_rows - mi_row) * MI_SIZE;
+        }
 
-          if (cm->single_tile_decoding &&
-              frame_worker_data->pbi->dec_tile_col >= 0) {
-            const int tile_col =
-                AOMMIN(frame_worker_data->pbi->dec_tile_col, cm->tile_cols - 1);
-            const int mi_col = tile_col * cm->tile_width;
-            const int ssx = ctx->img.x_chroma_shift;
-            int plane;
-            ctx->img.planes[0] += mi_col * MI_SIZE;
-            for (plane = 1; plane < MAX_MB_PLANE; ++plane) {
-              ctx->img.planes[plane] += mi_col * (MI_SIZE >> ssx);
-            }
-            ctx->img.d_w =
-                AOMMIN(cm->tile_width, cm->mi_cols - mi_col) * MI_SIZE;
+        if (cm->single_tile_decoding &&
+            frame_worker_data->pbi->dec_tile_col >= 0) {
+          const int tile_col =
+              AOMMIN(frame_worker_data->pbi->dec_tile_col, cm->tile_cols - 1);
+          const int mi_col = tile_col * cm->tile_width;
+          const int ssx = ctx->img.x_chroma_shift;
+          int plane;
+          ctx->img.planes[0] += mi_col * MI_SIZE;
+          for (plane = 1; plane < MAX_MB_PLANE; ++plane) {
+            ctx->img.planes[plane] += mi_col * (MI_SIZE >> ssx);
           }
+          ctx->img.d_w =
+              AOMMIN(cm->tile_width, cm->mi_cols - mi_col) * MI_SIZE;
+        }
 #endif  // CONFIG_EXT_TILE
 
-          ctx->img.fb_priv = frame_bufs[cm->new_fb_idx].raw_frame_buffer.priv;
-          img = &ctx->img;
-          return img;
-        }
-      } else {
-        // Decoding failed. Release the worker thread.
-        frame_worker_data->received_frame = 0;
-        ++ctx->available_threads;
-        ctx->need_resync = 1;
-        if (ctx->flushed != 1) return NULL;
+        ctx->img.fb_priv = frame_bufs[cm->new_fb_idx].raw_frame_buffer.priv;
+        img = &ctx->img;
+        return img;
       }
-    } while (ctx->next_output_worker_id != ctx->next_submit_worker_id);
+    } else {
+      // Decoding failed. Release the worker thread.
+      frame_worker_data->received_frame = 0;
+      ctx->need_resync = 1;
+    }
   }
   return NULL;
 }
@@ -1146,7 +1027,7 @@ static aom_codec_err_t ctrl_get_render_size(aom_codec_alg_priv_t *ctx,
 static aom_codec_err_t ctrl_get_bit_depth(aom_codec_alg_priv_t *ctx,
                                           va_list args) {
   unsigned int *const bit_depth = va_arg(args, unsigned int *);
-  AVxWorker *const worker = &ctx->frame_workers[ctx->next_output_worker_id];
+  AVxWorker *const worker = ctx->frame_workers;
 
   if (bit_depth) {
     if (worker) {
@@ -1242,6 +1123,64 @@ static aom_codec_err_t ctrl_set_decode_tile_col(aom_codec_alg_priv_t *ctx,
   return AOM_CODEC_OK;
 }
 
+static aom_codec_err_t ctrl_set_row_mt(aom_codec_alg_priv_t *ctx,
+                                       va_list args) {
+  ctx->row_mt = va_arg(args, unsigned int) != 0;
+  return AOM_CODEC_OK;
+}
+
+static aom_codec_err_t ctrl_set_thread_pool(aom_codec_alg_priv_t *ctx,
+                                            va_list args) {
+  const aom_thread_pool_t *const pool = va_arg(args, aom_thread_pool_t *);
+
+  // The decoder is initialized with the first frame.
+  if (ctx->frame_workers != NULL) return AOM_CODEC_ERROR;
+  // The filter stage of frame parallel decoding runs on a thread of the
+  // decoder's own, and waits for the frame's filter tasks while the next
+  // frame's tile tasks, which wait for it, are pending on the same pool.
+  if (pool != NULL && ctx->frame_parallel_decode) return AOM_CODEC_INCAPABLE;
+  if (pool == NULL) {
+    memset(&ctx->thread_pool, 0, sizeof(ctx->thread_pool));
+  } else if (pool->submit != NULL && pool->wait != NULL &&
+             pool->num_threads > 0) {
+    ctx->thread_pool = *pool;
+  } else {
+    return AOM_CODEC_INVALID_PARAM;
+  }
+  return AOM_CODEC_OK;
+}
+
+static aom_codec_err_t ctrl_set_max_frame_buffer_size(
+    aom_codec_alg_priv_t *ctx, va_list args) {
+  const int *const size = va_arg(args, int *);
+
+  if (size == NULL || size[0] <= 0 || size[1] <= 0)
+    return AOM_CODEC_INVALID_PARAM;
+  ctx->max_fb_width = size[0];
+  ctx->max_fb_height = size[1];
+  // The decoder is initialized with the first frame, which allocates the
+  // buffers from then on.
+  if (ctx->frame_workers == NULL) return AOM_CODEC_OK;
+  return prealloc_frame_buffers(ctx);
+}
+
+static aom_codec_err_t ctrl_get_frame_buffer_pool_stats(
+    aom_codec_alg_priv_t *ctx, va_list args) {
+  unsigned int *const stats = va_arg(args, unsigned int *);
+
+  if (stats == NULL) return AOM_CODEC_INVALID_PARAM;
+  stats[0] = 0;
+  stats[1] = 0;
+  if (ctx->buffer_pool != NULL) {
+    BufferPool *const pool = ctx->buffer_pool;
+    lock_buffer_pool(pool);
+    stats[0] = pool->int_frame_buffers.pool_hits;
+    stats[1] = pool->int_frame_buffers.pool_misses;
+    unlock_buffer_pool(pool);
+  }
+  return AOM_CODEC_OK;
+}
+
 static aom_codec_err_t ctrl_set_inspection_callback(aom_codec_alg_priv_t *ctx,
                                                     va_list args) {
 #if !CONFIG_INSPECTION
@@ -1273,6 +1212,9 @@ static aom_codec_ctrl_fn_map_t decoder_ctrl_maps[] = {
   { AV1_SET_DECODE_TILE_ROW, ctrl_set_decode_tile_row },
   { AV1_SET_DECODE_TILE_COL, ctrl_set_decode_tile_col },
   { AV1_SET_INSPECTION_CALLBACK, ctrl_set_inspection_callback },
+  { AV1D_SET_ROW_MT, ctrl_set_row_mt },
+  { AOM_SET_THREAD_POOL, ctrl_set_thread_pool },
+  { AV1D_SET_MAX_FRAME_BUFFER_SIZE, ctrl_set_max_frame_buffer_size },
 
   // Getters
   { AOMD_GET_FRAME_CORRUPTED, ctrl_get_frame_corrupted },
@@ -1281,6 +1223,7 @@ static aom_codec_ctrl_fn_map_t decoder_ctrl_maps[] = {
   { AV1D_GET_BIT_DEPTH, ctrl_get_bit_depth },
   { AV1D_GET_DISPLAY_SIZE, ctrl_get_render_size },
   { AV1D_GET_FRAME_SIZE, ctrl_get_frame_size },
+  { AV1D_GET_FRAME_BUFFER_POOL_STATS, ctrl_get_frame_buffer_pool_stats },
   { AV1_GET_ACCOUNTING, ctrl_get_accounting },
   { AV1_GET_NEW_FRAME_IMAGE, ctrl_get_new_frame_image },
   { AV1_GET_REFERENCE, ctrl_get_reference },
@@ -1294,8 +1237,8 @@ static aom_codec_ctrl_fn_map_t decoder_ctrl_maps[] = {
 CODEC_INTERFACE(aom_codec_av1_dx) = {
   "AOMedia Project AV1 Decoder" VERSION_STRING,
   AOM_CODEC_INTERNAL_ABI_VERSION,
-  AOM_CODEC_CAP_DECODER |
-      AOM_CODEC_CAP_EXTERNAL_FRAME_BUFFER,  // aom_codec_caps_t
+  AOM_CODEC_CAP_DECODER | AOM_CODEC_CAP_EXTERNAL_FRAME_BUFFER |
+      AOM_CODEC_CAP_FRAME_THREADING,  // aom_codec_caps_t
   decoder_init,                             // aom_codec_init_fn_t
   decoder_destroy,                          // aom_codec_destroy_fn_t
   decoder_ctrl_maps,                        // aom_codec_ctrl_fn_map_t
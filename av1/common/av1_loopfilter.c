@@ -2720,6 +2720,40 @@ void av1_loop_filter_frame(YV12_BUFFER_CONFIG *frame, AV1_COMMON *cm,
 #endif
 }
 
+#if !CONFIG_LPF_SB
+void av1_loop_filter_frame_rows(YV12_BUFFER_CONFIG *frame, AV1_COMMON *cm,
+                                struct macroblockd_plane *planes, int start,
+                                int stop) {
+#if CONFIG_LOOPFILTER_LEVEL
+  const int filter_level[MAX_MB_PLANE][2] = {
+    { cm->lf.filter_level[0], cm->lf.filter_level[1] },
+    { cm->lf.filter_level_u, cm->lf.filter_level_u },
+    { cm->lf.filter_level_v, cm->lf.filter_level_v },
+  };
+
+  if (!filter_level[0][0] && !filter_level[0][1]) return;
+  for (int plane = 0; plane < MAX_MB_PLANE; ++plane) {
+    if (!filter_level[plane][0] && !filter_level[plane][1]) continue;
+    av1_loop_filter_frame_init(cm, filter_level[plane][0],
+                               filter_level[plane][1], plane);
+#if CONFIG_EXT_DELTA_Q
+    cm->lf.filter_level[0] = filter_level[plane][0];
+    cm->lf.filter_level[1] = filter_level[plane][1];
+#endif
+    av1_loop_filter_rows(frame, cm, planes, start, stop, plane);
+  }
+#if CONFIG_EXT_DELTA_Q
+  cm->lf.filter_level[0] = filter_level[0][0];
+  cm->lf.filter_level[1] = filter_level[0][1];
+#endif
+#else
+  if (!cm->lf.filter_level) return;
+  av1_loop_filter_frame_init(cm, cm->lf.filter_level, cm->lf.filter_level);
+  av1_loop_filter_rows(frame, cm, planes, start, stop, 0);
+#endif  // CONFIG_LOOPFILTER_LEVEL
+}
+#endif  // !CONFIG_LPF_SB
+
 void av1_loop_filter_data_reset(LFWorkerData *lf_data,
                                 YV12_BUFFER_CONFIG *frame_buffer,
                                 struct AV1Common *cm,
@@ -178,6 +178,13 @@ void av1_loop_filter_rows(YV12_BUFFER_CONFIG *frame_buffer,
                           struct AV1Common *cm,
                           struct macroblockd_plane *planes, int start, int stop,
                           int y_only);
+
+// Apply the loop filter to every plane of [start, stop) macro block rows at
+// the frame's filter levels. The level tables are set up on each call, so
+// the frame may be filtered a superblock row at a time.
+void av1_loop_filter_frame_rows(YV12_BUFFER_CONFIG *frame, struct AV1Common *cm,
+                                struct macroblockd_plane *planes, int start,
+                                int stop);
 #endif  // CONFIG_LPF_SB
 
 typedef struct LoopFilterWorkerData {
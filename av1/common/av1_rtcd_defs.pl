@@ -569,19 +569,54 @@ if (aom_config("CONFIG_JNT_COMP") eq "yes") {
 }
 }
 
+add_proto qw/int64_t av1_calc_frame_error/, "const uint8_t *const ref, int stride, const uint8_t *const dst, int p_width, int p_height, int p_stride";
+specialize qw/av1_calc_frame_error avx2/;
+
 if (aom_config("CONFIG_AV1_ENCODER") eq "yes") {
   add_proto qw/double compute_cross_correlation/, "unsigned char *im1, int stride1, int x1, int y1, unsigned char *im2, int stride2, int x2, int y2";
-  specialize qw/compute_cross_correlation sse4_1/;
+  specialize qw/compute_cross_correlation sse4_1 avx2/;
+}
+
+# CFL functions
+if (aom_config("CONFIG_CFL") eq "yes") {
+  add_proto qw/void cfl_subtract_average/, "int16_t *pred_buf_q3, int width, int height, int num_pel_log2";
+  specialize qw/cfl_subtract_average sse2 avx2/;
+
+  add_proto qw/void cfl_luma_subsampling_420_lbd/, "const uint8_t *input, int input_stride, int16_t *output_q3, int width, int height";
+  specialize qw/cfl_luma_subsampling_420_lbd sse2 ssse3 avx2/;
+  add_proto qw/void cfl_luma_subsampling_422_lbd/, "const uint8_t *input, int input_stride, int16_t *output_q3, int width, int height";
+  specialize qw/cfl_luma_subsampling_422_lbd sse2 ssse3 avx2/;
+  add_proto qw/void cfl_luma_subsampling_440_lbd/, "const uint8_t *input, int input_stride, int16_t *output_q3, int width, int height";
+  specialize qw/cfl_luma_subsampling_440_lbd sse2 avx2/;
+  add_proto qw/void cfl_luma_subsampling_444_lbd/, "const uint8_t *input, int input_stride, int16_t *output_q3, int width, int height";
+  specialize qw/cfl_luma_subsampling_444_lbd sse2 avx2/;
+
+  add_proto qw/void cfl_build_prediction_lbd/, "const int16_t *pred_buf_q3, uint8_t *dst, int dst_stride, int width, int height, int alpha_q3";
+  specialize qw/cfl_build_prediction_lbd sse2 ssse3 avx2/;
+
+  if (aom_config("CONFIG_HIGHBITDEPTH") eq "yes") {
+    add_proto qw/void cfl_luma_subsampling_420_hbd/, "const uint16_t *input, int input_stride, int16_t *output_q3, int width, int height";
+    specialize qw/cfl_luma_subsampling_420_hbd sse2 ssse3 avx2/;
+    add_proto qw/void cfl_luma_subsampling_422_hbd/, "const uint16_t *input, int input_stride, int16_t *output_q3, int width, int height";
+    specialize qw/cfl_luma_subsampling_422_hbd sse2 ssse3 avx2/;
+    add_proto qw/void cfl_luma_subsampling_440_hbd/, "const uint16_t *input, int input_stride, int16_t *output_q3, int width, int height";
+    specialize qw/cfl_luma_subsampling_440_hbd sse2 avx2/;
+    add_proto qw/void cfl_luma_subsampling_444_hbd/, "const uint16_t *input, int input_stride, int16_t *output_q3, int width, int height";
+    specialize qw/cfl_luma_subsampling_444_hbd sse2 avx2/;
+
+    add_proto qw/void cfl_build_prediction_hbd/, "const int16_t *pred_buf_q3, uint16_t *dst, int dst_stride, int width, int height, int alpha_q3, int bit_depth";
+    specialize qw/cfl_build_prediction_hbd sse2 ssse3 avx2/;
+  }
 }
 
 # LOOP_RESTORATION functions
 
 if (aom_config("CONFIG_LOOP_RESTORATION") eq "yes") {
   add_proto qw/void apply_selfguided_restoration/, "const uint8_t *dat, int width, int height, int stride, int eps, const int *xqd, uint8_t *dst, int dst_stride, int32_t *tmpbuf, int bit_depth, int highbd";
-  specialize qw/apply_selfguided_restoration sse4_1/;
+  specialize qw/apply_selfguided_restoration sse4_1 avx2/;
 
   add_proto qw/void av1_selfguided_restoration/, "const uint8_t *dgd, int width, int height, int stride, int32_t *flt1, int32_t *flt2, int flt_stride, const sgr_params_type *params, int bit_depth, int highbd";
-  specialize qw/av1_selfguided_restoration sse4_1/;
+  specialize qw/av1_selfguided_restoration sse4_1 avx2/;
 }
 
 # CONVOLVE_ROUND/COMPOUND_ROUND functions
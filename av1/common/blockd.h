@@ -661,6 +661,13 @@ typedef struct macroblockd {
   int prev_qindex;
   int delta_qindex;
   int current_qindex;
+  // CDEF strength already signalled for each 64x64 unit of the current
+  // superblock, or -1. Kept per tile so that tiles can be coded in parallel.
+#if CONFIG_EXT_PARTITION
+  int cdef_preset[4];
+#else
+  int cdef_preset;
+#endif
 #if CONFIG_EXT_DELTA_Q
   // Since actual frame level loop filtering level value is not available
   // at the beginning of the tile (only available during actual filtering)
@@ -152,13 +152,62 @@ static INLINE void copy_rect(uint16_t *dst, int dstride, const uint16_t *src,
   }
 }
 
-void av1_cdef_frame(YV12_BUFFER_CONFIG *frame, AV1_COMMON *cm,
-                    MACROBLOCKD *xd) {
+// Returns the 2 * CDEF_VBORDER pre-filter lines saved around the top edge of
+// filter block row fbr (fbr > 0).
+static INLINE uint16_t *boundary_lines(const AV1CdefLineBufs *lines, int pli,
+                                       int fbr) {
+  return lines->linebuf[pli] + (fbr - 1) * 2 * CDEF_VBORDER * lines->stride;
+}
+
+void av1_cdef_init_frame(AV1CdefLineBufs *lines, YV12_BUFFER_CONFIG *frame,
+                         AV1_COMMON *cm, MACROBLOCKD *xd) {
+  av1_zero(*lines);
+  lines->nvfb = (cm->mi_rows + MI_SIZE_64X64 - 1) / MI_SIZE_64X64;
+  lines->nhfb = (cm->mi_cols + MI_SIZE_64X64 - 1) / MI_SIZE_64X64;
+  lines->stride = cm->mi_cols << MI_SIZE_LOG2;
+  lines->nplanes = MAX_MB_PLANE;
+  av1_setup_dst_planes(xd->plane, cm->sb_size, frame, 0, 0);
+  for (int pli = 0; pli < MAX_MB_PLANE; pli++) {
+    if (xd->plane[pli].subsampling_x != xd->plane[pli].subsampling_y)
+      lines->nplanes = 1;
+  }
+  if (lines->nvfb < 2) return;
+  for (int pli = 0; pli < lines->nplanes; pli++) {
+    CHECK_MEM_ERROR(cm, lines->linebuf[pli],
+                    aom_malloc(sizeof(*lines->linebuf[pli]) *
+                               (lines->nvfb - 1) * 2 * CDEF_VBORDER *
+                               lines->stride));
+  }
+}
+
+void av1_cdef_free_frame(AV1CdefLineBufs *lines) {
+  for (int pli = 0; pli < MAX_MB_PLANE; pli++) {
+    aom_free(lines->linebuf[pli]);
+    lines->linebuf[pli] = NULL;
+  }
+}
+
+void av1_cdef_save_boundary_lines(AV1CdefLineBufs *lines, AV1_COMMON *cm,
+                                  const MACROBLOCKD *xd, int fbr) {
+  assert(fbr > 0 && fbr < lines->nvfb);
+  for (int pli = 0; pli < lines->nplanes; pli++) {
+    const int mi_wide_l2 = MI_SIZE_LOG2 - xd->plane[pli].subsampling_x;
+    const int mi_high_l2 = MI_SIZE_LOG2 - xd->plane[pli].subsampling_y;
+    copy_sb8_16(cm, boundary_lines(lines, pli, fbr), lines->stride,
+                xd->plane[pli].dst.buf,
+                (MI_SIZE_64X64 << mi_high_l2) * fbr - CDEF_VBORDER, 0,
+                xd->plane[pli].dst.stride, 2 * CDEF_VBORDER,
+                cm->mi_cols << mi_wide_l2);
+  }
+}
+
+void av1_cdef_fb_row(const AV1CdefLineBufs *lines, AV1_COMMON *cm,
+                     const MACROBLOCKD *xd, int fbr) {
   DECLARE_ALIGNED(16, uint16_t, src[CDEF_INBUF_SIZE]);
-  uint16_t *linebuf[3];
-  uint16_t *colbuf[3];
+  uint16_t colbuf[MAX_MB_PLANE][((MI_SIZE_64X64 << MI_SIZE_LOG2) +
+                                 2 * CDEF_VBORDER) *
+                                CDEF_HBORDER];
   cdef_list dlist[MI_SIZE_64X64 * MI_SIZE_64X64];
-  unsigned char *row_cdef, *prev_row_cdef, *curr_row_cdef;
   int cdef_count;
   int dir[CDEF_NBLOCKS][CDEF_NBLOCKS] = { { 0 } };
   int var[CDEF_NBLOCKS][CDEF_NBLOCKS] = { { 0 } };
@@ -167,283 +216,257 @@ void av1_cdef_frame(YV12_BUFFER_CONFIG *frame, AV1_COMMON *cm,
   int xdec[3];
   int ydec[3];
   int coeff_shift = AOMMAX(cm->bit_depth - 8, 0);
-  int nplanes = MAX_MB_PLANE;
+  const int nplanes = lines->nplanes;
   int chroma_cdef = xd->plane[1].subsampling_x == xd->plane[1].subsampling_y &&
                     xd->plane[2].subsampling_x == xd->plane[2].subsampling_y;
-  const int nvfb = (cm->mi_rows + MI_SIZE_64X64 - 1) / MI_SIZE_64X64;
-  const int nhfb = (cm->mi_cols + MI_SIZE_64X64 - 1) / MI_SIZE_64X64;
-  av1_setup_dst_planes(xd->plane, cm->sb_size, frame, 0, 0);
-  row_cdef = aom_malloc(sizeof(*row_cdef) * (nhfb + 2) * 2);
-  memset(row_cdef, 1, sizeof(*row_cdef) * (nhfb + 2) * 2);
-  prev_row_cdef = row_cdef + 1;
-  curr_row_cdef = prev_row_cdef + nhfb + 2;
+  const int nvfb = lines->nvfb;
+  const int nhfb = lines->nhfb;
+  const int stride = lines->stride;
   for (int pli = 0; pli < nplanes; pli++) {
     xdec[pli] = xd->plane[pli].subsampling_x;
     ydec[pli] = xd->plane[pli].subsampling_y;
     mi_wide_l2[pli] = MI_SIZE_LOG2 - xd->plane[pli].subsampling_x;
     mi_high_l2[pli] = MI_SIZE_LOG2 - xd->plane[pli].subsampling_y;
-    if (xdec[pli] != ydec[pli]) nplanes = 1;
   }
-  const int stride = (cm->mi_cols << MI_SIZE_LOG2) + 2 * CDEF_HBORDER;
   for (int pli = 0; pli < nplanes; pli++) {
-    linebuf[pli] = aom_malloc(sizeof(*linebuf) * CDEF_VBORDER * stride);
-    colbuf[pli] =
-        aom_malloc(sizeof(*colbuf) *
-                   ((CDEF_BLOCKSIZE << mi_high_l2[pli]) + 2 * CDEF_VBORDER) *
-                   CDEF_HBORDER);
+    const int block_height =
+        (MI_SIZE_64X64 << mi_high_l2[pli]) + 2 * CDEF_VBORDER;
+    fill_rect(colbuf[pli], CDEF_HBORDER, block_height, CDEF_HBORDER,
+              CDEF_VERY_LARGE);
   }
-  for (int fbr = 0; fbr < nvfb; fbr++) {
-    for (int pli = 0; pli < nplanes; pli++) {
-      const int block_height =
-          (MI_SIZE_64X64 << mi_high_l2[pli]) + 2 * CDEF_VBORDER;
-      fill_rect(colbuf[pli], CDEF_HBORDER, block_height, CDEF_HBORDER,
-                CDEF_VERY_LARGE);
+  int cdef_left = 1;
+  for (int fbc = 0; fbc < nhfb; fbc++) {
+    int level, sec_strength;
+    int uv_level, uv_sec_strength;
+    int nhb, nvb;
+    int cstart = 0;
+    if (cm->mi_grid_visible[MI_SIZE_64X64 * fbr * cm->mi_stride +
+                            MI_SIZE_64X64 * fbc] == NULL ||
+        cm->mi_grid_visible[MI_SIZE_64X64 * fbr * cm->mi_stride +
+                            MI_SIZE_64X64 * fbc]
+                ->mbmi.cdef_strength == -1) {
+      cdef_left = 0;
+      continue;
     }
-    int cdef_left = 1;
-    for (int fbc = 0; fbc < nhfb; fbc++) {
-      int level, sec_strength;
-      int uv_level, uv_sec_strength;
-      int nhb, nvb;
-      int cstart = 0;
-      curr_row_cdef[fbc] = 0;
-      if (cm->mi_grid_visible[MI_SIZE_64X64 * fbr * cm->mi_stride +
-                              MI_SIZE_64X64 * fbc] == NULL ||
-          cm->mi_grid_visible[MI_SIZE_64X64 * fbr * cm->mi_stride +
-                              MI_SIZE_64X64 * fbc]
-                  ->mbmi.cdef_strength == -1) {
-        cdef_left = 0;
-        continue;
-      }
-      if (!cdef_left) cstart = -CDEF_HBORDER;
-      nhb = AOMMIN(MI_SIZE_64X64, cm->mi_cols - MI_SIZE_64X64 * fbc);
-      nvb = AOMMIN(MI_SIZE_64X64, cm->mi_rows - MI_SIZE_64X64 * fbr);
-      int tile_top, tile_left, tile_bottom, tile_right;
-      int mi_idx = MI_SIZE_64X64 * fbr * cm->mi_stride + MI_SIZE_64X64 * fbc;
-      MODE_INFO *const mi_tl = cm->mi + mi_idx;
-      BOUNDARY_TYPE boundary_tl = mi_tl->mbmi.boundary_info;
-      tile_top = boundary_tl & TILE_ABOVE_BOUNDARY;
-      tile_left = boundary_tl & TILE_LEFT_BOUNDARY;
-
-      if (fbr != nvfb - 1 &&
-          (&cm->mi[mi_idx + (MI_SIZE_64X64 - 1) * cm->mi_stride]))
-        tile_bottom = cm->mi[mi_idx + (MI_SIZE_64X64 - 1) * cm->mi_stride]
-                          .mbmi.boundary_info &
-                      TILE_BOTTOM_BOUNDARY;
-      else
-        tile_bottom = 1;
+    if (!cdef_left) cstart = -CDEF_HBORDER;
+    nhb = AOMMIN(MI_SIZE_64X64, cm->mi_cols - MI_SIZE_64X64 * fbc);
+    nvb = AOMMIN(MI_SIZE_64X64, cm->mi_rows - MI_SIZE_64X64 * fbr);
+    int tile_top, tile_left, tile_bottom, tile_right;
+    int mi_idx = MI_SIZE_64X64 * fbr * cm->mi_stride + MI_SIZE_64X64 * fbc;
+    MODE_INFO *const mi_tl = cm->mi + mi_idx;
+    BOUNDARY_TYPE boundary_tl = mi_tl->mbmi.boundary_info;
+    tile_top = boundary_tl & TILE_ABOVE_BOUNDARY;
+    tile_left = boundary_tl & TILE_LEFT_BOUNDARY;
 
-      if (fbc != nhfb - 1 && (&cm->mi[mi_idx + MI_SIZE_64X64 - 1]))
-        tile_right = cm->mi[mi_idx + MI_SIZE_64X64 - 1].mbmi.boundary_info &
-                     TILE_RIGHT_BOUNDARY;
-      else
-        tile_right = 1;
-
-      const int mbmi_cdef_strength =
-          cm->mi_grid_visible[MI_SIZE_64X64 * fbr * cm->mi_stride +
-                              MI_SIZE_64X64 * fbc]
-              ->mbmi.cdef_strength;
-      level = cm->cdef_strengths[mbmi_cdef_strength] / CDEF_SEC_STRENGTHS;
-      sec_strength =
-          cm->cdef_strengths[mbmi_cdef_strength] % CDEF_SEC_STRENGTHS;
-      sec_strength += sec_strength == 3;
-      uv_level = cm->cdef_uv_strengths[mbmi_cdef_strength] / CDEF_SEC_STRENGTHS;
-      uv_sec_strength =
-          cm->cdef_uv_strengths[mbmi_cdef_strength] % CDEF_SEC_STRENGTHS;
-      uv_sec_strength += uv_sec_strength == 3;
-      if ((level == 0 && sec_strength == 0 && uv_level == 0 &&
-           uv_sec_strength == 0) ||
+    if (fbr != nvfb - 1 &&
+        (&cm->mi[mi_idx + (MI_SIZE_64X64 - 1) * cm->mi_stride]))
+      tile_bottom = cm->mi[mi_idx + (MI_SIZE_64X64 - 1) * cm->mi_stride]
+                        .mbmi.boundary_info &
+                    TILE_BOTTOM_BOUNDARY;
+    else
+      tile_bottom = 1;
+
+    if (fbc != nhfb - 1 && (&cm->mi[mi_idx + MI_SIZE_64X64 - 1]))
+      tile_right = cm->mi[mi_idx + MI_SIZE_64X64 - 1].mbmi.boundary_info &
+                   TILE_RIGHT_BOUNDARY;
+    else
+      tile_right = 1;
+
+    const int mbmi_cdef_strength =
+        cm->mi_grid_visible[MI_SIZE_64X64 * fbr * cm->mi_stride +
+                            MI_SIZE_64X64 * fbc]
+            ->mbmi.cdef_strength;
+    level = cm->cdef_strengths[mbmi_cdef_strength] / CDEF_SEC_STRENGTHS;
+    sec_strength = cm->cdef_strengths[mbmi_cdef_strength] % CDEF_SEC_STRENGTHS;
+    sec_strength += sec_strength == 3;
+    uv_level = cm->cdef_uv_strengths[mbmi_cdef_strength] / CDEF_SEC_STRENGTHS;
+    uv_sec_strength =
+        cm->cdef_uv_strengths[mbmi_cdef_strength] % CDEF_SEC_STRENGTHS;
+    uv_sec_strength += uv_sec_strength == 3;
+    if ((level == 0 && sec_strength == 0 && uv_level == 0 &&
+         uv_sec_strength == 0) ||
 #if CONFIG_EXT_PARTITION
-          (cdef_count = sb_compute_cdef_list(cm, fbr * MI_SIZE_64X64,
-                                             fbc * MI_SIZE_64X64, dlist,
-                                             BLOCK_64X64)) == 0)
+        (cdef_count = sb_compute_cdef_list(cm, fbr * MI_SIZE_64X64,
+                                           fbc * MI_SIZE_64X64, dlist,
+                                           BLOCK_64X64)) == 0)
 #else
-          (cdef_count = sb_compute_cdef_list(cm, fbr * MI_SIZE_64X64,
-                                             fbc * MI_SIZE_64X64, dlist)) == 0)
+        (cdef_count = sb_compute_cdef_list(cm, fbr * MI_SIZE_64X64,
+                                           fbc * MI_SIZE_64X64, dlist)) == 0)
 #endif
-      {
-        cdef_left = 0;
-        continue;
-      }
+    {
+      cdef_left = 0;
+      continue;
+    }
 
-      curr_row_cdef[fbc] = 1;
-      for (int pli = 0; pli < nplanes; pli++) {
+    for (int pli = 0; pli < nplanes; pli++) {
 #if !CONFIG_CDEF_SINGLEPASS
-        DECLARE_ALIGNED(16, uint16_t, dst[CDEF_BLOCKSIZE * CDEF_BLOCKSIZE]);
+      DECLARE_ALIGNED(16, uint16_t, dst[CDEF_BLOCKSIZE * CDEF_BLOCKSIZE]);
 #endif
-        int coffset;
-        int rend, cend;
-        int pri_damping = cm->cdef_pri_damping;
-        int sec_damping = cm->cdef_sec_damping;
-        int hsize = nhb << mi_wide_l2[pli];
-        int vsize = nvb << mi_high_l2[pli];
-
-        if (pli) {
-          if (chroma_cdef)
-            level = uv_level;
-          else
-            level = 0;
-          sec_strength = uv_sec_strength;
-        }
+      int coffset;
+      int rend, cend;
+      int pri_damping = cm->cdef_pri_damping;
+      int sec_damping = cm->cdef_sec_damping;
+      int hsize = nhb << mi_wide_l2[pli];
+      int vsize = nvb << mi_high_l2[pli];
 
-        if (fbc == nhfb - 1)
-          cend = hsize;
+      if (pli) {
+        if (chroma_cdef)
+          level = uv_level;
         else
-          cend = hsize + CDEF_HBORDER;
+          level = 0;
+        sec_strength = uv_sec_strength;
+      }
 
-        if (fbr == nvfb - 1)
-          rend = vsize;
-        else
-          rend = vsize + CDEF_VBORDER;
-
-        coffset = fbc * MI_SIZE_64X64 << mi_wide_l2[pli];
-        if (fbc == nhfb - 1) {
-          /* On the last superblock column, fill in the right border with
-             CDEF_VERY_LARGE to avoid filtering with the outside. */
-          fill_rect(&src[cend + CDEF_HBORDER], CDEF_BSTRIDE,
-                    rend + CDEF_VBORDER, hsize + CDEF_HBORDER - cend,
-                    CDEF_VERY_LARGE);
-        }
-        if (fbr == nvfb - 1) {
-          /* On the last superblock row, fill in the bottom border with
-             CDEF_VERY_LARGE to avoid filtering with the outside. */
-          fill_rect(&src[(rend + CDEF_VBORDER) * CDEF_BSTRIDE], CDEF_BSTRIDE,
-                    CDEF_VBORDER, hsize + 2 * CDEF_HBORDER, CDEF_VERY_LARGE);
-        }
-        /* Copy in the pixels we need from the current superblock for
-           deringing.*/
-        copy_sb8_16(cm,
-                    &src[CDEF_VBORDER * CDEF_BSTRIDE + CDEF_HBORDER + cstart],
-                    CDEF_BSTRIDE, xd->plane[pli].dst.buf,
-                    (MI_SIZE_64X64 << mi_high_l2[pli]) * fbr, coffset + cstart,
-                    xd->plane[pli].dst.stride, rend, cend - cstart);
-        if (!prev_row_cdef[fbc]) {
-          copy_sb8_16(cm, &src[CDEF_HBORDER], CDEF_BSTRIDE,
-                      xd->plane[pli].dst.buf,
-                      (MI_SIZE_64X64 << mi_high_l2[pli]) * fbr - CDEF_VBORDER,
-                      coffset, xd->plane[pli].dst.stride, CDEF_VBORDER, hsize);
-        } else if (fbr > 0) {
-          copy_rect(&src[CDEF_HBORDER], CDEF_BSTRIDE, &linebuf[pli][coffset],
-                    stride, CDEF_VBORDER, hsize);
-        } else {
-          fill_rect(&src[CDEF_HBORDER], CDEF_BSTRIDE, CDEF_VBORDER, hsize,
-                    CDEF_VERY_LARGE);
-        }
-        if (!prev_row_cdef[fbc - 1]) {
-          copy_sb8_16(cm, src, CDEF_BSTRIDE, xd->plane[pli].dst.buf,
-                      (MI_SIZE_64X64 << mi_high_l2[pli]) * fbr - CDEF_VBORDER,
-                      coffset - CDEF_HBORDER, xd->plane[pli].dst.stride,
-                      CDEF_VBORDER, CDEF_HBORDER);
-        } else if (fbr > 0 && fbc > 0) {
-          copy_rect(src, CDEF_BSTRIDE, &linebuf[pli][coffset - CDEF_HBORDER],
-                    stride, CDEF_VBORDER, CDEF_HBORDER);
+      if (fbc == nhfb - 1)
+        cend = hsize;
+      else
+        cend = hsize + CDEF_HBORDER;
+
+      if (fbr == nvfb - 1)
+        rend = vsize;
+      else
+        rend = vsize + CDEF_VBORDER;
+
+      coffset = fbc * MI_SIZE_64X64 << mi_wide_l2[pli];
+      if (fbc == nhfb - 1) {
+        /* On the last superblock column, fill in the right border with
+           CDEF_VERY_LARGE to avoid filtering with the outside. */
+        fill_rect(&src[cend + CDEF_HBORDER], CDEF_BSTRIDE,
+                  rend + CDEF_VBORDER, hsize + CDEF_HBORDER - cend,
+                  CDEF_VERY_LARGE);
+      }
+      if (fbr == nvfb - 1) {
+        /* On the last superblock row, fill in the bottom border with
+           CDEF_VERY_LARGE to avoid filtering with the outside. */
+        fill_rect(&src[(rend + CDEF_VBORDER) * CDEF_BSTRIDE], CDEF_BSTRIDE,
+                  CDEF_VBORDER, hsize + 2 * CDEF_HBORDER, CDEF_VERY_LARGE);
+      }
+      /* Copy in the pixels we need from the current superblock for
+         deringing.*/
+      copy_sb8_16(cm,
+                  &src[CDEF_VBORDER * CDEF_BSTRIDE + CDEF_HBORDER + cstart],
+                  CDEF_BSTRIDE, xd->plane[pli].dst.buf,
+                  (MI_SIZE_64X64 << mi_high_l2[pli]) * fbr, coffset + cstart,
+                  xd->plane[pli].dst.stride, vsize, cend - cstart);
+      /* The rows above and below the superblock may belong to filter block
+         rows that have already been filtered, so they always come from the
+         pre-filter copies. */
+      if (fbr < nvfb - 1) {
+        copy_rect(&src[(vsize + CDEF_VBORDER) * CDEF_BSTRIDE + CDEF_HBORDER +
+                       cstart],
+                  CDEF_BSTRIDE,
+                  boundary_lines(lines, pli, fbr + 1) +
+                      CDEF_VBORDER * stride + coffset + cstart,
+                  stride, CDEF_VBORDER, cend - cstart);
+      }
+      if (fbr > 0) {
+        const uint16_t *const top = boundary_lines(lines, pli, fbr);
+        copy_rect(&src[CDEF_HBORDER], CDEF_BSTRIDE, &top[coffset], stride,
+                  CDEF_VBORDER, hsize);
+        if (fbc > 0) {
+          copy_rect(src, CDEF_BSTRIDE, &top[coffset - CDEF_HBORDER], stride,
+                    CDEF_VBORDER, CDEF_HBORDER);
         } else {
           fill_rect(src, CDEF_BSTRIDE, CDEF_VBORDER, CDEF_HBORDER,
                     CDEF_VERY_LARGE);
         }
-        if (!prev_row_cdef[fbc + 1]) {
-          copy_sb8_16(cm, &src[CDEF_HBORDER + (nhb << mi_wide_l2[pli])],
-                      CDEF_BSTRIDE, xd->plane[pli].dst.buf,
-                      (MI_SIZE_64X64 << mi_high_l2[pli]) * fbr - CDEF_VBORDER,
-                      coffset + hsize, xd->plane[pli].dst.stride, CDEF_VBORDER,
-                      CDEF_HBORDER);
-        } else if (fbr > 0 && fbc < nhfb - 1) {
+        if (fbc < nhfb - 1) {
           copy_rect(&src[hsize + CDEF_HBORDER], CDEF_BSTRIDE,
-                    &linebuf[pli][coffset + hsize], stride, CDEF_VBORDER,
-                    CDEF_HBORDER);
+                    &top[coffset + hsize], stride, CDEF_VBORDER, CDEF_HBORDER);
         } else {
           fill_rect(&src[hsize + CDEF_HBORDER], CDEF_BSTRIDE, CDEF_VBORDER,
                     CDEF_HBORDER, CDEF_VERY_LARGE);
         }
-        if (cdef_left) {
-          /* If we deringed the superblock on the left then we need to copy in
-             saved pixels. */
-          copy_rect(src, CDEF_BSTRIDE, colbuf[pli], CDEF_HBORDER,
-                    rend + CDEF_VBORDER, CDEF_HBORDER);
-        }
-        /* Saving pixels in case we need to dering the superblock on the
-            right. */
-        copy_rect(colbuf[pli], CDEF_HBORDER, src + hsize, CDEF_BSTRIDE,
+      } else {
+        fill_rect(src, CDEF_BSTRIDE, CDEF_VBORDER, hsize + 2 * CDEF_HBORDER,
+                  CDEF_VERY_LARGE);
+      }
+      if (cdef_left) {
+        /* If we deringed the superblock on the left then we need to copy in
+           saved pixels. */
+        copy_rect(src, CDEF_BSTRIDE, colbuf[pli], CDEF_HBORDER,
                   rend + CDEF_VBORDER, CDEF_HBORDER);
-        copy_sb8_16(
-            cm, &linebuf[pli][coffset], stride, xd->plane[pli].dst.buf,
-            (MI_SIZE_64X64 << mi_high_l2[pli]) * (fbr + 1) - CDEF_VBORDER,
-            coffset, xd->plane[pli].dst.stride, CDEF_VBORDER, hsize);
+      }
+      /* Saving pixels in case we need to dering the superblock on the
+          right. */
+      copy_rect(colbuf[pli], CDEF_HBORDER, src + hsize, CDEF_BSTRIDE,
+                rend + CDEF_VBORDER, CDEF_HBORDER);
 
-        if (tile_top) {
-          fill_rect(src, CDEF_BSTRIDE, CDEF_VBORDER, hsize + 2 * CDEF_HBORDER,
-                    CDEF_VERY_LARGE);
-        }
-        if (tile_left) {
-          fill_rect(src, CDEF_BSTRIDE, vsize + 2 * CDEF_VBORDER, CDEF_HBORDER,
-                    CDEF_VERY_LARGE);
-        }
-        if (tile_bottom) {
-          fill_rect(&src[(vsize + CDEF_VBORDER) * CDEF_BSTRIDE], CDEF_BSTRIDE,
-                    CDEF_VBORDER, hsize + 2 * CDEF_HBORDER, CDEF_VERY_LARGE);
-        }
-        if (tile_right) {
-          fill_rect(&src[hsize + CDEF_HBORDER], CDEF_BSTRIDE,
-                    vsize + 2 * CDEF_VBORDER, CDEF_HBORDER, CDEF_VERY_LARGE);
-        }
+      if (tile_top) {
+        fill_rect(src, CDEF_BSTRIDE, CDEF_VBORDER, hsize + 2 * CDEF_HBORDER,
+                  CDEF_VERY_LARGE);
+      }
+      if (tile_left) {
+        fill_rect(src, CDEF_BSTRIDE, vsize + 2 * CDEF_VBORDER, CDEF_HBORDER,
+                  CDEF_VERY_LARGE);
+      }
+      if (tile_bottom) {
+        fill_rect(&src[(vsize + CDEF_VBORDER) * CDEF_BSTRIDE], CDEF_BSTRIDE,
+                  CDEF_VBORDER, hsize + 2 * CDEF_HBORDER, CDEF_VERY_LARGE);
+      }
+      if (tile_right) {
+        fill_rect(&src[hsize + CDEF_HBORDER], CDEF_BSTRIDE,
+                  vsize + 2 * CDEF_VBORDER, CDEF_HBORDER, CDEF_VERY_LARGE);
+      }
 #if CONFIG_HIGHBITDEPTH
-        if (cm->use_highbitdepth) {
-          cdef_filter_fb(
+      if (cm->use_highbitdepth) {
+        cdef_filter_fb(
 #if CONFIG_CDEF_SINGLEPASS
-              NULL,
-              &CONVERT_TO_SHORTPTR(xd->plane[pli].dst.buf)
+            NULL,
+            &CONVERT_TO_SHORTPTR(xd->plane[pli].dst.buf)
 #else
-              (uint8_t *)&CONVERT_TO_SHORTPTR(xd->plane[pli].dst.buf)
+            (uint8_t *)&CONVERT_TO_SHORTPTR(xd->plane[pli].dst.buf)
 #endif
-                  [xd->plane[pli].dst.stride *
-                       (MI_SIZE_64X64 * fbr << mi_high_l2[pli]) +
-                   (fbc * MI_SIZE_64X64 << mi_wide_l2[pli])],
+                [xd->plane[pli].dst.stride *
+                     (MI_SIZE_64X64 * fbr << mi_high_l2[pli]) +
+                 (fbc * MI_SIZE_64X64 << mi_wide_l2[pli])],
 #if CONFIG_CDEF_SINGLEPASS
-              xd->plane[pli].dst.stride,
+            xd->plane[pli].dst.stride,
 #else
-              xd->plane[pli].dst.stride, dst,
+            xd->plane[pli].dst.stride, dst,
 #endif
-              &src[CDEF_VBORDER * CDEF_BSTRIDE + CDEF_HBORDER], xdec[pli],
-              ydec[pli], dir, NULL, var, pli, dlist, cdef_count, level,
+            &src[CDEF_VBORDER * CDEF_BSTRIDE + CDEF_HBORDER], xdec[pli],
+            ydec[pli], dir, NULL, var, pli, dlist, cdef_count, level,
 #if CONFIG_CDEF_SINGLEPASS
-              sec_strength, pri_damping, sec_damping, coeff_shift);
+            sec_strength, pri_damping, sec_damping, coeff_shift);
 #else
-              sec_strength, sec_damping, pri_damping, coeff_shift, 0, 1);
+            sec_strength, sec_damping, pri_damping, coeff_shift, 0, 1);
 #endif
-        } else {
+      } else {
 #endif
-          cdef_filter_fb(
-              &xd->plane[pli]
-                   .dst.buf[xd->plane[pli].dst.stride *
-                                (MI_SIZE_64X64 * fbr << mi_high_l2[pli]) +
-                            (fbc * MI_SIZE_64X64 << mi_wide_l2[pli])],
+        cdef_filter_fb(
+            &xd->plane[pli]
+                 .dst.buf[xd->plane[pli].dst.stride *
+                              (MI_SIZE_64X64 * fbr << mi_high_l2[pli]) +
+                          (fbc * MI_SIZE_64X64 << mi_wide_l2[pli])],
 #if CONFIG_CDEF_SINGLEPASS
-              NULL, xd->plane[pli].dst.stride,
+            NULL, xd->plane[pli].dst.stride,
 #else
-            xd->plane[pli].dst.stride, dst,
+          xd->plane[pli].dst.stride, dst,
 #endif
-              &src[CDEF_VBORDER * CDEF_BSTRIDE + CDEF_HBORDER], xdec[pli],
-              ydec[pli], dir, NULL, var, pli, dlist, cdef_count, level,
+            &src[CDEF_VBORDER * CDEF_BSTRIDE + CDEF_HBORDER], xdec[pli],
+            ydec[pli], dir, NULL, var, pli, dlist, cdef_count, level,
 #if CONFIG_CDEF_SINGLEPASS
-              sec_strength, pri_damping, sec_damping, coeff_shift);
+            sec_strength, pri_damping, sec_damping, coeff_shift);
 #else
-            sec_strength, sec_damping, pri_damping, coeff_shift, 0, 0);
+          sec_strength, sec_damping, pri_damping, coeff_shift, 0, 0);
 #endif
 
 #if CONFIG_HIGHBITDEPTH
-        }
-#endif
       }
-      cdef_left = 1;
-    }
-    {
-      unsigned char *tmp = prev_row_cdef;
-      prev_row_cdef = curr_row_cdef;
-      curr_row_cdef = tmp;
+#endif
     }
+    cdef_left = 1;
   }
-  aom_free(row_cdef);
-  for (int pli = 0; pli < nplanes; pli++) {
-    aom_free(linebuf[pli]);
-    aom_free(colbuf[pli]);
-  }
+}
+
+void av1_cdef_frame(YV12_BUFFER_CONFIG *frame, AV1_COMMON *cm,
+                    MACROBLOCKD *xd) {
+  AV1CdefLineBufs lines;
+  av1_cdef_init_frame(&lines, frame, cm, xd);
+  for (int fbr = 1; fbr < lines.nvfb; fbr++)
+    av1_cdef_save_boundary_lines(&lines, cm, xd, fbr);
+  for (int fbr = 0; fbr < lines.nvfb; fbr++)
+    av1_cdef_fb_row(&lines, cm, xd, fbr);
+  av1_cdef_free_frame(&lines);
 }
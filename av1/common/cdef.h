@@ -36,6 +36,19 @@ static INLINE int constrain(int diff, int threshold, int damping) {
 extern "C" {
 #endif
 
+// Pre-filter copies of the 2 * CDEF_VBORDER pixel rows that straddle each
+// boundary between 64x64 filter block rows. Filtering a block row only reads
+// these copies across its top and bottom edges, so the block rows can be
+// filtered in any order once the boundaries they touch have been saved.
+typedef struct AV1CdefLineBufs {
+  uint16_t *linebuf[MAX_MB_PLANE];
+  int stride;
+  int nplanes;
+  int nvfb;
+  int nhfb;
+} AV1CdefLineBufs;
+
+
 int sb_all_skip(const AV1_COMMON *const cm, int mi_row, int mi_col);
 #if CONFIG_EXT_PARTITION
 int sb_compute_cdef_list(const AV1_COMMON *const cm, int mi_row, int mi_col,
@@ -46,6 +59,18 @@ int sb_compute_cdef_list(const AV1_COMMON *const cm, int mi_row, int mi_col,
 #endif
 void av1_cdef_frame(YV12_BUFFER_CONFIG *frame, AV1_COMMON *cm, MACROBLOCKD *xd);
 
+// Sets up xd's destination planes for frame and allocates lines.
+void av1_cdef_init_frame(AV1CdefLineBufs *lines, YV12_BUFFER_CONFIG *frame,
+                         AV1_COMMON *cm, MACROBLOCKD *xd);
+void av1_cdef_free_frame(AV1CdefLineBufs *lines);
+// Saves the rows around the top edge of filter block row fbr. Must be called
+// before either of the filter block rows fbr - 1 and fbr is filtered.
+void av1_cdef_save_boundary_lines(AV1CdefLineBufs *lines, AV1_COMMON *cm,
+                                  const MACROBLOCKD *xd, int fbr);
+// Filters one row of 64x64 filter blocks. Only writes pixels inside that row.
+void av1_cdef_fb_row(const AV1CdefLineBufs *lines, AV1_COMMON *cm,
+                     const MACROBLOCKD *xd, int fbr);
+
 void av1_cdef_search(YV12_BUFFER_CONFIG *frame, const YV12_BUFFER_CONFIG *ref,
                      AV1_COMMON *cm, MACROBLOCKD *xd, int fast);
 
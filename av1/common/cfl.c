@@ -13,6 +13,8 @@
 #include "av1/common/common_data.h"
 #include "av1/common/onyxc_int.h"
 
+#include "./av1_rtcd.h"
+
 void cfl_init(CFL_CTX *cfl, AV1_COMMON *cm) {
   assert(block_size_wide[CFL_MAX_BLOCK_SIZE] == CFL_PRED_BUF_LINE);
   assert(block_size_high[CFL_MAX_BLOCK_SIZE] == CFL_PRED_BUF_LINE);
@@ -72,20 +74,14 @@ static INLINE void cfl_pad(CFL_CTX *cfl, int width, int height) {
   }
 }
 
-static void cfl_subtract_average(CFL_CTX *cfl, TX_SIZE tx_size) {
-  const int tx_height = tx_size_high[tx_size];
-  const int tx_width = tx_size_wide[tx_size];
-  const int num_pel_log2 =
-      tx_size_high_log2[tx_size] + tx_size_wide_log2[tx_size];
-
-  int16_t *pred_buf_q3 = cfl->pred_buf_q3;
+void cfl_subtract_average_c(int16_t *pred_buf_q3, int width, int height,
+                            int num_pel_log2) {
+  int16_t *const pred_buf_start = pred_buf_q3;
   int sum_q3 = 0;
 
-  cfl_pad(cfl, tx_width, tx_height);
-
-  for (int j = 0; j < tx_height; j++) {
-    assert(pred_buf_q3 + tx_width <= cfl->pred_buf_q3 + CFL_PRED_BUF_SQUARE);
-    for (int i = 0; i < tx_width; i++) {
+  assert((height - 1) * CFL_PRED_BUF_LINE + width <= CFL_PRED_BUF_SQUARE);
+  for (int j = 0; j < height; j++) {
+    for (int i = 0; i < width; i++) {
       sum_q3 += pred_buf_q3[i];
     }
     pred_buf_q3 += CFL_PRED_BUF_LINE;
@@ -94,10 +90,9 @@ static void cfl_subtract_average(CFL_CTX *cfl, TX_SIZE tx_size) {
   // Loss is never more than 1/2 (in Q3)
   assert(abs((avg_q3 * (1 << num_pel_log2)) - sum_q3) <= 1 << num_pel_log2 >>
          1);
-  pred_buf_q3 = cfl->pred_buf_q3;
-  for (int j = 0; j < tx_height; j++) {
-    assert(pred_buf_q3 + tx_width <= cfl->pred_buf_q3 + CFL_PRED_BUF_SQUARE);
-    for (int i = 0; i < tx_width; i++) {
+  pred_buf_q3 = pred_buf_start;
+  for (int j = 0; j < height; j++) {
+    for (int i = 0; i < width; i++) {
       pred_buf_q3[i] -= avg_q3;
     }
     pred_buf_q3 += CFL_PRED_BUF_LINE;
@@ -114,9 +109,9 @@ static INLINE int cfl_idx_to_alpha(int alpha_idx, int joint_sign,
   return (alpha_sign == CFL_SIGN_POS) ? abs_alpha_q3 + 1 : -abs_alpha_q3 - 1;
 }
 
-static void cfl_build_prediction_lbd(const int16_t *pred_buf_q3, uint8_t *dst,
-                                     int dst_stride, int width, int height,
-                                     int alpha_q3) {
+void cfl_build_prediction_lbd_c(const int16_t *pred_buf_q3, uint8_t *dst,
+                                int dst_stride, int width, int height,
+                                int alpha_q3) {
   assert((height - 1) * CFL_PRED_BUF_LINE + width <= CFL_PRED_BUF_SQUARE);
   for (int j = 0; j < height; j++) {
     for (int i = 0; i < width; i++) {
@@ -129,9 +124,9 @@ static void cfl_build_prediction_lbd(const int16_t *pred_buf_q3, uint8_t *dst,
 }
 
 #if CONFIG_HIGHBITDEPTH
-static void cfl_build_prediction_hbd(const int16_t *pred_buf_q3, uint16_t *dst,
-                                     int dst_stride, int width, int height,
-                                     int alpha_q3, int bit_depth) {
+void cfl_build_prediction_hbd_c(const int16_t *pred_buf_q3, uint16_t *dst,
+                                int dst_stride, int width, int height,
+                                int alpha_q3, int bit_depth) {
   assert((height - 1) * CFL_PRED_BUF_LINE + width <= CFL_PRED_BUF_SQUARE);
   for (int j = 0; j < height; j++) {
     for (int i = 0; i < width; i++) {
@@ -171,7 +166,12 @@ static void cfl_compute_parameters(MACROBLOCKD *const xd, TX_SIZE tx_size) {
   }
 #endif  // CONFIG_DEBUG
 
-  cfl_subtract_average(cfl, tx_size);
+  const int tx_width = tx_size_wide[tx_size];
+  const int tx_height = tx_size_high[tx_size];
+  cfl_pad(cfl, tx_width, tx_height);
+  cfl_subtract_average(cfl->pred_buf_q3, tx_width, tx_height,
+                       tx_size_wide_log2[tx_size] +
+                           tx_size_high_log2[tx_size]);
   cfl->are_parameters_computed = 1;
 }
 
@@ -199,9 +199,9 @@ void cfl_predict_block(MACROBLOCKD *const xd, uint8_t *dst, int dst_stride,
                            alpha_q3);
 }
 
-static void cfl_luma_subsampling_420_lbd(const uint8_t *input, int input_stride,
-                                         int16_t *output_q3, int width,
-                                         int height) {
+void cfl_luma_subsampling_420_lbd_c(const uint8_t *input, int input_stride,
+                                    int16_t *output_q3, int width,
+                                    int height) {
   assert((height - 1) * CFL_PRED_BUF_LINE + width <= CFL_PRED_BUF_SQUARE);
   for (int j = 0; j < height; j++) {
     for (int i = 0; i < width; i++) {
@@ -215,9 +215,9 @@ static void cfl_luma_subsampling_420_lbd(const uint8_t *input, int input_stride,
   }
 }
 
-static void cfl_luma_subsampling_422_lbd(const uint8_t *input, int input_stride,
-                                         int16_t *output_q3, int width,
-                                         int height) {
+void cfl_luma_subsampling_422_lbd_c(const uint8_t *input, int input_stride,
+                                    int16_t *output_q3, int width,
+                                    int height) {
   assert((height - 1) * CFL_PRED_BUF_LINE + width <= CFL_PRED_BUF_SQUARE);
   for (int j = 0; j < height; j++) {
     for (int i = 0; i < width; i++) {
@@ -229,9 +229,9 @@ static void cfl_luma_subsampling_422_lbd(const uint8_t *input, int input_stride,
   }
 }
 
-static void cfl_luma_subsampling_440_lbd(const uint8_t *input, int input_stride,
-                                         int16_t *output_q3, int width,
-                                         int height) {
+void cfl_luma_subsampling_440_lbd_c(const uint8_t *input, int input_stride,
+                                    int16_t *output_q3, int width,
+                                    int height) {
   assert((height - 1) * CFL_PRED_BUF_LINE + width <= CFL_PRED_BUF_SQUARE);
   for (int j = 0; j < height; j++) {
     for (int i = 0; i < width; i++) {
@@ -242,9 +242,9 @@ static void cfl_luma_subsampling_440_lbd(const uint8_t *input, int input_stride,
   }
 }
 
-static void cfl_luma_subsampling_444_lbd(const uint8_t *input, int input_stride,
-                                         int16_t *output_q3, int width,
-                                         int height) {
+void cfl_luma_subsampling_444_lbd_c(const uint8_t *input, int input_stride,
+                                    int16_t *output_q3, int width,
+                                    int height) {
   assert((height - 1) * CFL_PRED_BUF_LINE + width <= CFL_PRED_BUF_SQUARE);
   for (int j = 0; j < height; j++) {
     for (int i = 0; i < width; i++) {
@@ -258,17 +258,10 @@ static void cfl_luma_subsampling_444_lbd(const uint8_t *input, int input_stride,
 typedef void (*cfl_subsample_lbd_fn)(const uint8_t *input, int input_stride,
                                      int16_t *output_q3, int width, int height);
 
-static const cfl_subsample_lbd_fn subsample_lbd[2][2] = {
-  //  (sub_y == 0, sub_x == 0)       (sub_y == 0, sub_x == 1)
-  //  (sub_y == 1, sub_x == 0)       (sub_y == 1, sub_x == 1)
-  { cfl_luma_subsampling_444_lbd, cfl_luma_subsampling_422_lbd },
-  { cfl_luma_subsampling_440_lbd, cfl_luma_subsampling_420_lbd },
-};
-
 #if CONFIG_HIGHBITDEPTH
-static void cfl_luma_subsampling_420_hbd(const uint16_t *input,
-                                         int input_stride, int16_t *output_q3,
-                                         int width, int height) {
+void cfl_luma_subsampling_420_hbd_c(const uint16_t *input, int input_stride,
+                                    int16_t *output_q3, int width,
+                                    int height) {
   assert((height - 1) * CFL_PRED_BUF_LINE + width <= CFL_PRED_BUF_SQUARE);
   for (int j = 0; j < height; j++) {
     for (int i = 0; i < width; i++) {
@@ -282,9 +275,9 @@ static void cfl_luma_subsampling_420_hbd(const uint16_t *input,
   }
 }
 
-static void cfl_luma_subsampling_422_hbd(const uint16_t *input,
-                                         int input_stride, int16_t *output_q3,
-                                         int width, int height) {
+void cfl_luma_subsampling_422_hbd_c(const uint16_t *input, int input_stride,
+                                    int16_t *output_q3, int width,
+                                    int height) {
   assert((height - 1) * CFL_PRED_BUF_LINE + width <= CFL_PRED_BUF_SQUARE);
   for (int j = 0; j < height; j++) {
     for (int i = 0; i < width; i++) {
@@ -296,9 +289,9 @@ static void cfl_luma_subsampling_422_hbd(const uint16_t *input,
   }
 }
 
-static void cfl_luma_subsampling_440_hbd(const uint16_t *input,
-                                         int input_stride, int16_t *output_q3,
-                                         int width, int height) {
+void cfl_luma_subsampling_440_hbd_c(const uint16_t *input, int input_stride,
+                                    int16_t *output_q3, int width,
+                                    int height) {
   assert((height - 1) * CFL_PRED_BUF_LINE + width <= CFL_PRED_BUF_SQUARE);
   for (int j = 0; j < height; j++) {
     for (int i = 0; i < width; i++) {
@@ -309,9 +302,9 @@ static void cfl_luma_subsampling_440_hbd(const uint16_t *input,
   }
 }
 
-static void cfl_luma_subsampling_444_hbd(const uint16_t *input,
-                                         int input_stride, int16_t *output_q3,
-                                         int width, int height) {
+void cfl_luma_subsampling_444_hbd_c(const uint16_t *input, int input_stride,
+                                    int16_t *output_q3, int width,
+                                    int height) {
   assert((height - 1) * CFL_PRED_BUF_LINE + width <= CFL_PRED_BUF_SQUARE);
   for (int j = 0; j < height; j++) {
     for (int i = 0; i < width; i++) {
@@ -324,13 +317,6 @@ static void cfl_luma_subsampling_444_hbd(const uint16_t *input,
 
 typedef void (*cfl_subsample_hbd_fn)(const uint16_t *input, int input_stride,
                                      int16_t *output_q3, int width, int height);
-
-static const cfl_subsample_hbd_fn subsample_hbd[2][2] = {
-  //  (sub_y == 0, sub_x == 0)       (sub_y == 0, sub_x == 1)
-  //  (sub_y == 1, sub_x == 0)       (sub_y == 1, sub_x == 1)
-  { cfl_luma_subsampling_444_hbd, cfl_luma_subsampling_422_hbd },
-  { cfl_luma_subsampling_440_hbd, cfl_luma_subsampling_420_hbd },
-};
 #endif  // CONFIG_HIGHBITDEPTH
 
 static void cfl_store(CFL_CTX *cfl, const uint8_t *input, int input_stride,
@@ -365,8 +351,16 @@ static void cfl_store(CFL_CTX *cfl, const uint8_t *input, int input_stride,
   int16_t *pred_buf_q3 =
       cfl->pred_buf_q3 + (store_row * CFL_PRED_BUF_LINE + store_col);
 
+  // The subsampling functions are dispatched through av1_rtcd, so the tables
+  // cannot be static initializers.
 #if CONFIG_HIGHBITDEPTH
   if (use_hbd) {
+    const cfl_subsample_hbd_fn subsample_hbd[2][2] = {
+      //  (sub_y == 0, sub_x == 0)       (sub_y == 0, sub_x == 1)
+      //  (sub_y == 1, sub_x == 0)       (sub_y == 1, sub_x == 1)
+      { cfl_luma_subsampling_444_hbd, cfl_luma_subsampling_422_hbd },
+      { cfl_luma_subsampling_440_hbd, cfl_luma_subsampling_420_hbd },
+    };
     const uint16_t *input_16 = CONVERT_TO_SHORTPTR(input);
     // AND sub_x and sub_y with 1 to ensures that an attacker won't be able to
     // index the function pointer array out of bounds.
@@ -376,6 +370,12 @@ static void cfl_store(CFL_CTX *cfl, const uint8_t *input, int input_stride,
   }
 #endif  // CONFIG_HIGHBITDEPTH
   (void)use_hbd;
+  const cfl_subsample_lbd_fn subsample_lbd[2][2] = {
+    //  (sub_y == 0, sub_x == 0)       (sub_y == 0, sub_x == 1)
+    //  (sub_y == 1, sub_x == 0)       (sub_y == 1, sub_x == 1)
+    { cfl_luma_subsampling_444_lbd, cfl_luma_subsampling_422_lbd },
+    { cfl_luma_subsampling_440_lbd, cfl_luma_subsampling_420_lbd },
+  };
   // AND sub_x and sub_y with 1 to ensures that an attacker won't be able to
   // index the function pointer array out of bounds.
   subsample_lbd[sub_y & 1][sub_x & 1](input, input_stride, pred_buf_q3,
@@ -22,6 +22,8 @@ int av1_alloc_internal_frame_buffers(InternalFrameBufferList *list) {
       AOM_MAXIMUM_REF_BUFFERS + AOM_MAXIMUM_WORK_BUFFERS;
   list->int_fb = (InternalFrameBuffer *)aom_calloc(
       list->num_internal_frame_buffers, sizeof(*list->int_fb));
+  list->pool_hits = 0;
+  list->pool_misses = 0;
   return (list->int_fb == NULL);
 }
 
@@ -38,28 +40,75 @@ void av1_free_internal_frame_buffers(InternalFrameBufferList *list) {
   list->int_fb = NULL;
 }
 
+// Rounds |size| up to a multiple of an eighth of its highest power of two, so
+// that frame sizes which differ only slightly share buffers.
+static size_t size_class(size_t size) {
+  size_t step = 1;
+  size_t rounded;
+  while (step <= size >> 4) step <<= 1;
+  rounded = (size + step - 1) & ~(step - 1);
+  return rounded < size ? size : rounded;
+}
+
+static int realloc_frame_buffer(InternalFrameBuffer *int_fb, size_t size) {
+  aom_free(int_fb->data);
+  int_fb->size = 0;
+  // The data must be zeroed to fix a valgrind error from the C loop filter
+  // due to access uninitialized memory in frame border. It could be
+  // skipped if border were totally removed. As the buffers are reused, this
+  // only happens when the pool grows.
+  int_fb->data = (uint8_t *)aom_calloc(1, size);
+  if (!int_fb->data) return -1;
+  int_fb->size = size;
+  return 0;
+}
+
+int av1_prealloc_internal_frame_buffers(InternalFrameBufferList *list,
+                                        size_t size) {
+  int i;
+
+  assert(list != NULL);
+
+  size = size_class(size);
+  for (i = 0; i < list->num_internal_frame_buffers; ++i) {
+    InternalFrameBuffer *const int_fb = &list->int_fb[i];
+    if (!int_fb->in_use && int_fb->size < size &&
+        realloc_frame_buffer(int_fb, size))
+      return -1;
+  }
+  return 0;
+}
+
 int av1_get_frame_buffer(void *cb_priv, size_t min_size,
                          aom_codec_frame_buffer_t *fb) {
   int i;
+  int fit = -1;
+  int spare = -1;
   InternalFrameBufferList *const int_fb_list =
       (InternalFrameBufferList *)cb_priv;
   if (int_fb_list == NULL) return -1;
 
-  // Find a free frame buffer.
+  // Find the smallest free frame buffer large enough for the frame and,
+  // failing that, the smallest free one to grow.
   for (i = 0; i < int_fb_list->num_internal_frame_buffers; ++i) {
-    if (!int_fb_list->int_fb[i].in_use) break;
+    const InternalFrameBuffer *const int_fb = &int_fb_list->int_fb[i];
+    if (int_fb->in_use) continue;
+    if (int_fb->size >= min_size) {
+      if (fit < 0 || int_fb->size < int_fb_list->int_fb[fit].size) fit = i;
+    } else if (spare < 0 || int_fb->size < int_fb_list->int_fb[spare].size) {
+      spare = i;
+    }
   }
 
-  if (i == int_fb_list->num_internal_frame_buffers) return -1;
-
-  if (int_fb_list->int_fb[i].size < min_size) {
-    aom_free(int_fb_list->int_fb[i].data);
-    // The data must be zeroed to fix a valgrind error from the C loop filter
-    // due to access uninitialized memory in frame border. It could be
-    // skipped if border were totally removed.
-    int_fb_list->int_fb[i].data = (uint8_t *)aom_calloc(1, min_size);
-    if (!int_fb_list->int_fb[i].data) return -1;
-    int_fb_list->int_fb[i].size = min_size;
+  if (fit >= 0) {
+    i = fit;
+    ++int_fb_list->pool_hits;
+  } else {
+    if (spare < 0) return -1;
+    i = spare;
+    ++int_fb_list->pool_misses;
+    if (realloc_frame_buffer(&int_fb_list->int_fb[i], size_class(min_size)))
+      return -1;
   }
 
   fb->data = int_fb_list->int_fb[i].data;
@@ -25,9 +25,17 @@ typedef struct InternalFrameBuffer {
   int in_use;
 } InternalFrameBuffer;
 
+// The frame buffers keep their allocations while not in use, so they act as
+// a pool: a request is served by the smallest free buffer large enough for
+// it, and only allocates (rounded up to a size class) when there is none.
+// Buffers of a previous frame size are thus kept for when the stream switches
+// back to it.
 typedef struct InternalFrameBufferList {
   int num_internal_frame_buffers;
   InternalFrameBuffer *int_fb;
+  // The number of requests served without and with an allocation.
+  unsigned int pool_hits;
+  unsigned int pool_misses;
 } InternalFrameBufferList;
 
 // Initializes |list|. Returns 0 on success.
@@ -36,6 +44,11 @@ int av1_alloc_internal_frame_buffers(InternalFrameBufferList *list);
 // Free any data allocated to the frame buffers.
 void av1_free_internal_frame_buffers(InternalFrameBufferList *list);
 
+// Allocates at least |size| bytes to each of the free frame buffers, so that
+// requests up to |size| do not allocate. Returns 0 on success.
+int av1_prealloc_internal_frame_buffers(InternalFrameBufferList *list,
+                                        size_t size);
+
 // Callback used by libaom to request an external frame buffer. |cb_priv|
 // Callback private data, which points to an InternalFrameBufferList.
 // |min_size| is the minimum size in bytes needed to decode the next frame.
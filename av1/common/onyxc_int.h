@@ -164,17 +164,10 @@ typedef struct {
 #if CONFIG_TEMPMV_SIGNALING
   uint8_t intra_only;
 #endif
-  // The Following variables will only be used in frame parallel decode.
-
-  // frame_worker_owner indicates which FrameWorker owns this buffer. NULL means
-  // that no FrameWorker owns, or is decoding, this buffer.
-  AVxWorker *frame_worker_owner;
-
-  // row and col indicate which position frame has been decoded to in real
-  // pixel unit. They are reset to -1 when decoding begins and set to INT_MAX
-  // when the frame is fully decoded.
+  // Only used in frame parallel decode: the number of luma rows of the frame
+  // which are final, borders included. It is reset to -1 when decoding begins
+  // and set to INT_MAX once the whole frame is final.
   int row;
-  int col;
 } RefCntBuffer;
 
 typedef struct BufferPool {
@@ -427,7 +420,6 @@ typedef struct AV1Common {
   struct loopfilter lf;
   struct segmentation seg;
   int all_lossless;
-  int frame_parallel_decode;  // frame-based threading.
 
   int reduced_tx_set_used;
 
@@ -534,11 +526,6 @@ typedef struct AV1Common {
   int cdef_strengths[CDEF_MAX_STRENGTHS];
   int cdef_uv_strengths[CDEF_MAX_STRENGTHS];
   int cdef_bits;
-#if CONFIG_EXT_PARTITION
-  int cdef_preset[4];
-#else
-  int cdef_preset;
-#endif
 
   int delta_q_present_flag;
   // Resolution of delta quant
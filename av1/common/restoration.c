@@ -10,6 +10,7 @@
  *
  */
 
+#include <limits.h>
 #include <math.h>
 
 #include "./aom_config.h"
@@ -203,6 +204,53 @@ void extend_frame(uint8_t *data, int width, int height, int stride,
   extend_frame_lowbd(data, width, height, stride, border_horz, border_vert);
 }
 
+// Extend rows [y0, y1) of a plane which is height rows high by border pixels
+// to the left and right, and also above or below the plane if the rows
+// include its first or last row.
+static void extend_plane_rows(uint8_t *data, int width, int height, int stride,
+                              int y0, int y1, int border, int highbd) {
+  extend_frame(data + y0 * stride, width, y1 - y0, stride, border, 0, highbd);
+#if CONFIG_HIGHBITDEPTH
+  if (highbd) data = (uint8_t *)CONVERT_TO_SHORTPTR(data);
+#endif
+  const int line_bytes = (width + 2 * border) << highbd;
+  const int stride_bytes = stride << highbd;
+  uint8_t *const first = data - (border << highbd);
+  uint8_t *const last = first + (height - 1) * stride_bytes;
+  for (int i = 1; i <= border; ++i) {
+    if (y0 == 0) memcpy(first - i * stride_bytes, first, line_bytes);
+    if (y1 == height) memcpy(last + i * stride_bytes, last, line_bytes);
+  }
+}
+
+void av1_loop_restoration_extend_rows(YV12_BUFFER_CONFIG *frame,
+                                      const AV1_COMMON *cm, int mi_row_start,
+                                      int mi_row_end) {
+#if CONFIG_HIGHBITDEPTH
+  const int highbd = cm->use_highbitdepth;
+#else
+  const int highbd = 0;
+#endif
+
+  for (int plane = 0; plane < 3; ++plane) {
+    if (cm->rst_info[plane].frame_restoration_type == RESTORE_NONE) continue;
+
+    const int is_uv = plane > 0;
+    const int ss_y = is_uv && cm->subsampling_y;
+    const int plane_width = frame->crop_widths[is_uv];
+    const int plane_height =
+        ALIGN_POWER_OF_TWO(frame->crop_heights[is_uv], 3 - ss_y);
+    const int y0 =
+        AOMMIN(mi_row_start << (MI_SIZE_LOG2 - ss_y), plane_height);
+    const int y1 = AOMMIN(mi_row_end << (MI_SIZE_LOG2 - ss_y), plane_height);
+    if (y0 >= y1) continue;
+
+    extend_plane_rows(frame->buffers[plane], plane_width, plane_height,
+                      frame->strides[is_uv], y0, y1, RESTORATION_BORDER,
+                      highbd);
+  }
+}
+
 static void copy_tile_lowbd(int width, int height, const uint8_t *src,
                             int src_stride, uint8_t *dst, int dst_stride) {
   for (int i = 0; i < height; ++i)
@@ -1306,20 +1354,6 @@ void av1_loop_restoration_filter_unit(
 #endif  // CONFIG_STRIPED_LOOP_RESTORATION
 }
 
-typedef struct {
-  const RestorationInfo *rsi;
-#if CONFIG_STRIPED_LOOP_RESTORATION
-  RestorationLineBuffers *rlbs;
-  const AV1_COMMON *cm;
-  int tile_stripe0;
-#endif  // CONFIG_STRIPED_LOOP_RESTORATION
-  int ss_x, ss_y;
-  int highbd, bit_depth;
-  uint8_t *data8, *dst8;
-  int data_stride, dst_stride;
-  int32_t *tmpbuf;
-} FilterFrameCtxt;
-
 static void filter_frame_on_tile(int tile_row, int tile_col, void *priv) {
   (void)tile_col;
 #if CONFIG_STRIPED_LOOP_RESTORATION
@@ -1354,19 +1388,15 @@ static void filter_frame_on_unit(const RestorationTileLimits *limits,
       ctxt->data_stride, ctxt->dst8, ctxt->dst_stride, ctxt->tmpbuf);
 }
 
-void av1_loop_restoration_filter_frame(YV12_BUFFER_CONFIG *frame,
-                                       AV1_COMMON *cm) {
-  typedef void (*copy_fun)(const YV12_BUFFER_CONFIG *src,
-                           YV12_BUFFER_CONFIG *dst);
-  static const copy_fun copy_funs[3] = { aom_yv12_copy_y, aom_yv12_copy_u,
-                                         aom_yv12_copy_v };
-
-  YV12_BUFFER_CONFIG dst;
-  memset(&dst, 0, sizeof(dst));
+void av1_loop_restoration_filter_init(AV1LrStruct *lr_ctxt,
+                                      YV12_BUFFER_CONFIG *frame,
+                                      AV1_COMMON *cm) {
+  YV12_BUFFER_CONFIG *dst = &lr_ctxt->dst;
+  memset(dst, 0, sizeof(*dst));
   const int frame_width = frame->crop_widths[0];
   const int frame_height = ALIGN_POWER_OF_TWO(frame->crop_heights[0], 3);
   if (aom_realloc_frame_buffer(
-          &dst, frame_width, frame_height, cm->subsampling_x, cm->subsampling_y,
+          dst, frame_width, frame_height, cm->subsampling_x, cm->subsampling_y,
 #if CONFIG_HIGHBITDEPTH
           cm->use_highbitdepth,
 #endif
@@ -1374,9 +1404,7 @@ void av1_loop_restoration_filter_frame(YV12_BUFFER_CONFIG *frame,
     aom_internal_error(&cm->error, AOM_CODEC_MEM_ERROR,
                        "Failed to allocate restoration dst buffer");
 
-#if CONFIG_STRIPED_LOOP_RESTORATION
-  RestorationLineBuffers rlbs;
-#endif  // CONFIG_STRIPED_LOOP_RESTORATION
+  lr_ctxt->frame = frame;
 #if CONFIG_HIGHBITDEPTH
   const int bit_depth = cm->bit_depth;
   const int highbd = cm->use_highbitdepth;
@@ -1387,46 +1415,90 @@ void av1_loop_restoration_filter_frame(YV12_BUFFER_CONFIG *frame,
 
   for (int plane = 0; plane < 3; ++plane) {
     const RestorationInfo *rsi = &cm->rst_info[plane];
-    RestorationType rtype = rsi->frame_restoration_type;
-    if (rtype == RESTORE_NONE) {
-      copy_funs[plane](frame, &dst);
-      continue;
-    }
+    FilterFrameCtxt *ctxt = &lr_ctxt->ctxt[plane];
+    ctxt->rsi = rsi;
+    if (rsi->frame_restoration_type == RESTORE_NONE) continue;
 
     const int is_uv = plane > 0;
-    const int ss_y = is_uv && cm->subsampling_y;
-    const int plane_width = frame->crop_widths[is_uv];
-    const int plane_height =
-        ALIGN_POWER_OF_TWO(frame->crop_heights[is_uv], 3 - ss_y);
-
-    extend_frame(frame->buffers[plane], plane_width, plane_height,
-                 frame->strides[is_uv], RESTORATION_BORDER, RESTORATION_BORDER,
-                 highbd);
 
-    FilterFrameCtxt ctxt;
-    ctxt.rsi = rsi;
 #if CONFIG_STRIPED_LOOP_RESTORATION
-    ctxt.rlbs = &rlbs;
-    ctxt.cm = cm;
+    ctxt->rlbs = NULL;
+    ctxt->cm = cm;
+    ctxt->tile_stripe0 = 0;
 #endif  // CONFIG_STRIPED_LOOP_RESTORATION
-    ctxt.ss_x = is_uv && cm->subsampling_x;
-    ctxt.ss_y = is_uv && cm->subsampling_y;
-    ctxt.highbd = highbd;
-    ctxt.bit_depth = bit_depth;
-    ctxt.data8 = frame->buffers[plane];
-    ctxt.dst8 = dst.buffers[plane];
-    ctxt.data_stride = frame->strides[is_uv];
-    ctxt.dst_stride = dst.strides[is_uv];
-    ctxt.tmpbuf = cm->rst_tmpbuf;
+    ctxt->ss_x = is_uv && cm->subsampling_x;
+    ctxt->ss_y = is_uv && cm->subsampling_y;
+    ctxt->highbd = highbd;
+    ctxt->bit_depth = bit_depth;
+    ctxt->data8 = frame->buffers[plane];
+    ctxt->dst8 = dst->buffers[plane];
+    ctxt->data_stride = frame->strides[is_uv];
+    ctxt->dst_stride = dst->strides[is_uv];
+    ctxt->tmpbuf = cm->rst_tmpbuf;
+  }
+}
 
-    av1_foreach_rest_unit_in_frame(cm, plane, filter_frame_on_tile,
-                                   filter_frame_on_unit, &ctxt);
+void av1_loop_restoration_copy_planes(AV1LrStruct *lr_ctxt) {
+  typedef void (*copy_fun)(const YV12_BUFFER_CONFIG *src,
+                           YV12_BUFFER_CONFIG *dst);
+  static const copy_fun copy_funs[3] = { aom_yv12_copy_y, aom_yv12_copy_u,
+                                         aom_yv12_copy_v };
+
+  for (int plane = 0; plane < 3; ++plane) {
+    if (lr_ctxt->ctxt[plane].rsi->frame_restoration_type == RESTORE_NONE)
+      continue;
+    copy_funs[plane](&lr_ctxt->dst, lr_ctxt->frame);
   }
+  aom_free_frame_buffer(&lr_ctxt->dst);
+}
+
+void av1_loop_restoration_filter_frame(YV12_BUFFER_CONFIG *frame,
+                                       AV1_COMMON *cm) {
+  AV1LrStruct lr_ctxt;
+#if CONFIG_STRIPED_LOOP_RESTORATION
+  RestorationLineBuffers rlbs;
+#endif  // CONFIG_STRIPED_LOOP_RESTORATION
+
+  av1_loop_restoration_extend_rows(frame, cm, 0, cm->mi_rows);
+  av1_loop_restoration_filter_init(&lr_ctxt, frame, cm);
 
   for (int plane = 0; plane < 3; ++plane) {
-    copy_funs[plane](&dst, frame);
+    FilterFrameCtxt *ctxt = &lr_ctxt.ctxt[plane];
+    if (cm->rst_info[plane].frame_restoration_type == RESTORE_NONE) continue;
+#if CONFIG_STRIPED_LOOP_RESTORATION
+    ctxt->rlbs = &rlbs;
+#endif  // CONFIG_STRIPED_LOOP_RESTORATION
+    av1_foreach_rest_unit_in_frame(cm, plane, filter_frame_on_tile,
+                                   filter_frame_on_unit, ctxt);
   }
-  aom_free_frame_buffer(&dst);
+
+  av1_loop_restoration_copy_planes(&lr_ctxt);
+}
+
+// Get the limits of unit (i, j) in a tile which has nvunits rows and nhunits
+// columns of restoration units. The bottom and right units absorb whatever is
+// left over, so can be up to 150% of the nominal unit size.
+static void get_rest_unit_limits(const AV1PixelRect *tile_rect, int unit_size,
+                                 int ss_y, int i, int nvunits, int j,
+                                 int nhunits, RestorationTileLimits *limits) {
+  const int y0 = i * unit_size;
+  const int x0 = j * unit_size;
+  limits->v_start = tile_rect->top + y0;
+  limits->v_end =
+      (i == nvunits - 1) ? tile_rect->bottom : limits->v_start + unit_size;
+  limits->h_start = tile_rect->left + x0;
+  limits->h_end =
+      (j == nhunits - 1) ? tile_rect->right : limits->h_start + unit_size;
+  assert(limits->v_end <= tile_rect->bottom);
+  assert(limits->h_end <= tile_rect->right);
+#if CONFIG_STRIPED_LOOP_RESTORATION
+  // Offset the tile upwards to align with the restoration processing stripe
+  const int voffset = RESTORATION_TILE_OFFSET >> ss_y;
+  limits->v_start = AOMMAX(tile_rect->top, limits->v_start - voffset);
+  if (limits->v_end < tile_rect->bottom) limits->v_end -= voffset;
+#else
+  (void)ss_y;
+#endif  // CONFIG_STRIPED_LOOP_RESTORATION
 }
 
 static void foreach_rest_unit_in_tile(const AV1PixelRect *tile_rect,
@@ -1437,47 +1509,20 @@ static void foreach_rest_unit_in_tile(const AV1PixelRect *tile_rect,
                                       void *priv) {
   const int tile_w = tile_rect->right - tile_rect->left;
   const int tile_h = tile_rect->bottom - tile_rect->top;
-  const int ext_size = unit_size * 3 / 2;
+  const int nvunits = count_units_in_tile(unit_size, tile_h);
+  const int nhunits = count_units_in_tile(unit_size, tile_w);
 
   const int tile_idx = tile_col + tile_row * tile_cols;
   const int unit_idx0 = tile_idx * units_per_tile;
 
-  int y0 = 0, i = 0;
-  while (y0 < tile_h) {
-    int remaining_h = tile_h - y0;
-    int h = (remaining_h < ext_size) ? remaining_h : unit_size;
-
-    RestorationTileLimits limits;
-    limits.v_start = tile_rect->top + y0;
-    limits.v_end = tile_rect->top + y0 + h;
-    assert(limits.v_end <= tile_rect->bottom);
-#if CONFIG_STRIPED_LOOP_RESTORATION
-    // Offset the tile upwards to align with the restoration processing stripe
-    const int voffset = RESTORATION_TILE_OFFSET >> ss_y;
-    limits.v_start = AOMMAX(tile_rect->top, limits.v_start - voffset);
-    if (limits.v_end < tile_rect->bottom) limits.v_end -= voffset;
-#else
-    (void)ss_y;
-#endif  // CONFIG_STRIPED_LOOP_RESTORATION
-
-    int x0 = 0, j = 0;
-    while (x0 < tile_w) {
-      int remaining_w = tile_w - x0;
-      int w = (remaining_w < ext_size) ? remaining_w : unit_size;
-
-      limits.h_start = tile_rect->left + x0;
-      limits.h_end = tile_rect->left + x0 + w;
-      assert(limits.h_end <= tile_rect->right);
-
+  for (int i = 0; i < nvunits; ++i) {
+    for (int j = 0; j < nhunits; ++j) {
+      RestorationTileLimits limits;
+      get_rest_unit_limits(tile_rect, unit_size, ss_y, i, nvunits, j, nhunits,
+                           &limits);
       const int unit_idx = unit_idx0 + i * hunits_per_tile + j;
       on_rest_unit(&limits, tile_rect, unit_idx, priv);
-
-      x0 += w;
-      ++j;
     }
-
-    y0 += h;
-    ++i;
   }
 }
 
@@ -1508,6 +1553,94 @@ void av1_foreach_rest_unit_in_frame(const struct AV1Common *cm, int plane,
   }
 }
 
+void av1_get_rest_unit_grid(const struct AV1Common *cm, int plane, int *rows,
+                            int *cols) {
+  const int is_uv = plane > 0;
+  const int unit_size = cm->rst_info[plane].restoration_unit_size;
+
+  TileInfo tile_info;
+  av1_tile_set_col(&tile_info, cm, 0);
+  *rows = 0;
+  for (int tile_row = 0; tile_row < cm->tile_rows; ++tile_row) {
+    av1_tile_set_row(&tile_info, cm, tile_row);
+    const AV1PixelRect tile_rect = get_ext_tile_rect(&tile_info, cm, is_uv);
+    *rows += count_units_in_tile(unit_size, tile_rect.bottom - tile_rect.top);
+  }
+  av1_tile_set_row(&tile_info, cm, 0);
+  *cols = 0;
+  for (int tile_col = 0; tile_col < cm->tile_cols; ++tile_col) {
+    av1_tile_set_col(&tile_info, cm, tile_col);
+    const AV1PixelRect tile_rect = get_ext_tile_rect(&tile_info, cm, is_uv);
+    *cols += count_units_in_tile(unit_size, tile_rect.right - tile_rect.left);
+  }
+}
+
+void av1_get_rest_unit_row_bounds(const struct AV1Common *cm, int plane,
+                                  int row, int *v_start, int *v_end) {
+  const int is_uv = plane > 0;
+  const int ss_y = is_uv && cm->subsampling_y;
+  const int unit_size = cm->rst_info[plane].restoration_unit_size;
+
+  TileInfo tile_info;
+  AV1PixelRect tile_rect;
+  int nvunits;
+  av1_tile_set_col(&tile_info, cm, 0);
+  for (int tile_row = 0;; ++tile_row) {
+    assert(tile_row < cm->tile_rows);
+    av1_tile_set_row(&tile_info, cm, tile_row);
+    tile_rect = get_ext_tile_rect(&tile_info, cm, is_uv);
+    nvunits = count_units_in_tile(unit_size, tile_rect.bottom - tile_rect.top);
+    if (row < nvunits) break;
+    row -= nvunits;
+  }
+
+  RestorationTileLimits limits;
+  get_rest_unit_limits(&tile_rect, unit_size, ss_y, row, nvunits, 0, 1,
+                       &limits);
+  *v_start = limits.v_start;
+  *v_end = limits.v_end;
+}
+
+void av1_loop_restoration_filter_grid_unit(const struct AV1Common *cm,
+                                           int plane, int row, int col,
+                                           FilterFrameCtxt *ctxt) {
+  const int is_uv = plane > 0;
+  const int ss_y = is_uv && cm->subsampling_y;
+  const RestorationInfo *rsi = &cm->rst_info[plane];
+  const int unit_size = rsi->restoration_unit_size;
+
+  // Find the tile containing the unit, and the unit's position in that tile.
+  TileInfo tile_info;
+  AV1PixelRect tile_rect;
+  int tile_row, tile_col, nvunits, nhunits;
+  av1_tile_set_col(&tile_info, cm, 0);
+  for (tile_row = 0;; ++tile_row) {
+    assert(tile_row < cm->tile_rows);
+    av1_tile_set_row(&tile_info, cm, tile_row);
+    tile_rect = get_ext_tile_rect(&tile_info, cm, is_uv);
+    nvunits = count_units_in_tile(unit_size, tile_rect.bottom - tile_rect.top);
+    if (row < nvunits) break;
+    row -= nvunits;
+  }
+  for (tile_col = 0;; ++tile_col) {
+    assert(tile_col < cm->tile_cols);
+    av1_tile_set_col(&tile_info, cm, tile_col);
+    tile_rect = get_ext_tile_rect(&tile_info, cm, is_uv);
+    nhunits = count_units_in_tile(unit_size, tile_rect.right - tile_rect.left);
+    if (col < nhunits) break;
+    col -= nhunits;
+  }
+
+  RestorationTileLimits limits;
+  get_rest_unit_limits(&tile_rect, unit_size, ss_y, row, nvunits, col, nhunits,
+                       &limits);
+  const int tile_idx = tile_col + tile_row * cm->tile_cols;
+  const int unit_idx = tile_idx * rsi->units_per_tile +
+                       row * rsi->horz_units_per_tile + col;
+  filter_frame_on_tile(tile_row, tile_col, ctxt);
+  filter_frame_on_unit(&limits, &tile_rect, unit_idx, ctxt);
+}
+
 #if CONFIG_MAX_TILE
 // Get the horizontal or vertical index of the tile containing mi_x. For a
 // horizontal index, mi_x should be the left-most column for some block in mi
@@ -1744,7 +1877,8 @@ static void save_tile_row_boundary_lines(const YV12_BUFFER_CONFIG *frame,
                                          int tile_row,
                                          const TileInfo *tile_info,
                                          int use_highbd, int plane,
-                                         AV1_COMMON *cm, int after_cdef) {
+                                         AV1_COMMON *cm, int after_cdef,
+                                         int row_start, int row_end) {
   const int is_uv = plane > 0;
   const int ss_y = is_uv && cm->subsampling_y;
   const int stripe_height = RESTORATION_PROC_UNIT_SIZE >> ss_y;
@@ -1801,14 +1935,20 @@ static void save_tile_row_boundary_lines(const YV12_BUFFER_CONFIG *frame,
     }
 #endif  // CONFIG_LOOPFILTERING_ACROSS_TILES
 
+    // Only save the lines whose first row is in [row_start, row_end).
+    const int above_row = after_cdef ? y0 : y0 - RESTORATION_CTX_VERT;
+    const int below_row = after_cdef ? y1 - 1 : y1;
+    const int save_above = above_row >= row_start && above_row < row_end;
+    const int save_below = below_row >= row_start && below_row < row_end;
+
     if (!after_cdef) {
       // Save deblocked context where needed.
-      if (use_deblock_above) {
-        save_deblock_boundary_lines(frame, cm, plane, y0 - RESTORATION_CTX_VERT,
-                                    frame_stripe, use_highbd, 1, boundaries);
+      if (use_deblock_above && save_above) {
+        save_deblock_boundary_lines(frame, cm, plane, above_row, frame_stripe,
+                                    use_highbd, 1, boundaries);
       }
-      if (use_deblock_below) {
-        save_deblock_boundary_lines(frame, cm, plane, y1, frame_stripe,
+      if (use_deblock_below && save_below) {
+        save_deblock_boundary_lines(frame, cm, plane, below_row, frame_stripe,
                                     use_highbd, 0, boundaries);
       }
     } else {
@@ -1818,12 +1958,12 @@ static void save_tile_row_boundary_lines(const YV12_BUFFER_CONFIG *frame,
       //
       // In addition, we need to save copies of the outermost line within
       // the tile, rather than using data from outside the tile.
-      if (!use_deblock_above) {
-        save_cdef_boundary_lines(frame, cm, plane, y0, frame_stripe, use_highbd,
-                                 1, boundaries);
+      if (!use_deblock_above && save_above) {
+        save_cdef_boundary_lines(frame, cm, plane, above_row, frame_stripe,
+                                 use_highbd, 1, boundaries);
       }
-      if (!use_deblock_below) {
-        save_cdef_boundary_lines(frame, cm, plane, y1 - 1, frame_stripe,
+      if (!use_deblock_below && save_below) {
+        save_cdef_boundary_lines(frame, cm, plane, below_row, frame_stripe,
                                  use_highbd, 0, boundaries);
       }
     }
@@ -1835,6 +1975,13 @@ static void save_tile_row_boundary_lines(const YV12_BUFFER_CONFIG *frame,
 // lines are saved in rst_internal.stripe_boundary_lines
 void av1_loop_restoration_save_boundary_lines(const YV12_BUFFER_CONFIG *frame,
                                               AV1_COMMON *cm, int after_cdef) {
+  av1_loop_restoration_save_boundary_rows(frame, cm, after_cdef, 0,
+                                          cm->mi_rows);
+}
+
+void av1_loop_restoration_save_boundary_rows(const YV12_BUFFER_CONFIG *frame,
+                                             AV1_COMMON *cm, int after_cdef,
+                                             int mi_row_start, int mi_row_end) {
 #if CONFIG_HIGHBITDEPTH
   const int use_highbd = cm->use_highbitdepth;
 #else
@@ -1842,11 +1989,17 @@ void av1_loop_restoration_save_boundary_lines(const YV12_BUFFER_CONFIG *frame,
 #endif
 
   for (int p = 0; p < MAX_MB_PLANE; ++p) {
+    const int ss_y = p > 0 && cm->subsampling_y;
+    const int row_start = mi_row_start << (MI_SIZE_LOG2 - ss_y);
+    // The bottom tile may be rounded up past the last mi row.
+    const int row_end = mi_row_end >= cm->mi_rows
+                            ? INT_MAX
+                            : mi_row_end << (MI_SIZE_LOG2 - ss_y);
     TileInfo tile_info;
     for (int tile_row = 0; tile_row < cm->tile_rows; ++tile_row) {
       av1_tile_init(&tile_info, cm, tile_row, 0);
       save_tile_row_boundary_lines(frame, tile_row, &tile_info, use_highbd, p,
-                                   cm, after_cdef);
+                                   cm, after_cdef, row_start, row_end);
     }
   }
 }
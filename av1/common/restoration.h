@@ -320,8 +320,66 @@ void av1_loop_restoration_filter_unit(
     int ss_x, int ss_y, int highbd, int bit_depth, uint8_t *data8, int stride,
     uint8_t *dst8, int dst_stride, int32_t *tmpbuf);
 
+typedef struct {
+  const RestorationInfo *rsi;
+#if CONFIG_STRIPED_LOOP_RESTORATION
+  RestorationLineBuffers *rlbs;
+  const struct AV1Common *cm;
+  int tile_stripe0;
+#endif  // CONFIG_STRIPED_LOOP_RESTORATION
+  int ss_x, ss_y;
+  int highbd, bit_depth;
+  uint8_t *data8, *dst8;
+  int data_stride, dst_stride;
+  int32_t *tmpbuf;
+} FilterFrameCtxt;
+
+typedef struct {
+  FilterFrameCtxt ctxt[MAX_MB_PLANE];
+  YV12_BUFFER_CONFIG *frame;
+  YV12_BUFFER_CONFIG dst;
+} AV1LrStruct;
+
 void av1_loop_restoration_filter_frame(YV12_BUFFER_CONFIG *frame,
                                        struct AV1Common *cm);
+
+// Extend the rows of frame in [mi_row_start, mi_row_end) of each restored
+// plane by RESTORATION_BORDER pixels to the left and right, and above or below
+// the plane too at its top and bottom edges. Every row must be extended before
+// any restoration unit which reads it is filtered.
+void av1_loop_restoration_extend_rows(YV12_BUFFER_CONFIG *frame,
+                                      const struct AV1Common *cm,
+                                      int mi_row_start, int mi_row_end);
+
+// The two halves of av1_loop_restoration_filter_frame(), for callers which
+// filter the restoration units themselves. av1_loop_restoration_filter_init()
+// allocates the output buffer and sets up one FilterFrameCtxt per plane, with
+// the cm->rst_tmpbuf scratch buffer. av1_loop_restoration_copy_planes() copies
+// the output back into the frame and frees the output buffer.
+void av1_loop_restoration_filter_init(AV1LrStruct *lr_ctxt,
+                                      YV12_BUFFER_CONFIG *frame,
+                                      struct AV1Common *cm);
+void av1_loop_restoration_copy_planes(AV1LrStruct *lr_ctxt);
+
+// Get the number of rows and columns of restoration units which cover the
+// given plane, counting across all tiles. Units in the same row of this grid
+// are at the same vertical position, and units in the same column are at the
+// same horizontal position.
+void av1_get_rest_unit_grid(const struct AV1Common *cm, int plane, int *rows,
+                            int *cols);
+
+// Get the first and one past the last pixel row processed by the units in row
+// `row` of the grid. Filtering them reads up to RESTORATION_BORDER rows more
+// on either side.
+void av1_get_rest_unit_row_bounds(const struct AV1Common *cm, int plane,
+                                  int row, int *v_start, int *v_end);
+
+// Filter the restoration unit at (row, col) in the grid described above.
+// ctxt must be set up as by av1_loop_restoration_filter_init(), but may have
+// its own rlbs and tmpbuf scratch buffers.
+void av1_loop_restoration_filter_grid_unit(const struct AV1Common *cm,
+                                           int plane, int row, int col,
+                                           FilterFrameCtxt *ctxt);
 void av1_loop_restoration_precal();
 
 typedef void (*rest_unit_visitor_t)(const RestorationTileLimits *limits,
@@ -355,6 +413,12 @@ int av1_loop_restoration_corners_in_sb(const struct AV1Common *cm, int plane,
 void av1_loop_restoration_save_boundary_lines(const YV12_BUFFER_CONFIG *frame,
                                               struct AV1Common *cm,
                                               int after_cdef);
+// As above, but only saves the lines which start in the mi rows
+// [mi_row_start, mi_row_end), so that the frame can be done in pieces.
+void av1_loop_restoration_save_boundary_rows(const YV12_BUFFER_CONFIG *frame,
+                                             struct AV1Common *cm,
+                                             int after_cdef, int mi_row_start,
+                                             int mi_row_end);
 #ifdef __cplusplus
 }  // extern "C"
 #endif
@@ -12,6 +12,7 @@
 #include "./aom_config.h"
 #include "aom_dsp/aom_dsp_common.h"
 #include "aom_mem/aom_mem.h"
+#include "av1/common/cdef.h"
 #include "av1/common/entropymode.h"
 #include "av1/common/thread_common.h"
 #include "av1/common/reconinter.h"
@@ -141,6 +142,13 @@ static INLINE void loop_filter_block_plane_hor(
   }
 }
 #endif
+// Takes the next superblock row to filter, and returns its first mi row.
+static INLINE int get_next_mi_row(AV1LfSync *const lf_sync,
+                                  const LFWorkerData *const lf_data) {
+  return lf_data->start +
+         aom_task_group_next_job(&lf_sync->tasks) * lf_data->cm->mib_size;
+}
+
 // Row-based multi-threaded loopfilter hook
 #if CONFIG_PARALLEL_DEBLOCKING
 static int loop_filter_ver_row_worker(AV1LfSync *const lf_sync,
@@ -150,8 +158,7 @@ static int loop_filter_ver_row_worker(AV1LfSync *const lf_sync,
 #if !CONFIG_EXT_PARTITION_TYPES
   enum lf_path path = get_loop_filter_path(lf_data->y_only, lf_data->planes);
 #endif
-  for (mi_row = lf_data->start; mi_row < lf_data->stop;
-       mi_row += lf_sync->num_workers * lf_data->cm->mib_size) {
+  while ((mi_row = get_next_mi_row(lf_sync, lf_data)) < lf_data->stop) {
     MODE_INFO **const mi =
         lf_data->cm->mi_grid_visible + mi_row * lf_data->cm->mi_stride;
 
@@ -190,8 +197,7 @@ static int loop_filter_hor_row_worker(AV1LfSync *const lf_sync,
   enum lf_path path = get_loop_filter_path(lf_data->y_only, lf_data->planes);
 #endif
 
-  for (mi_row = lf_data->start; mi_row < lf_data->stop;
-       mi_row += lf_sync->num_workers * lf_data->cm->mib_size) {
+  while ((mi_row = get_next_mi_row(lf_sync, lf_data)) < lf_data->stop) {
     MODE_INFO **const mi =
         lf_data->cm->mi_grid_visible + mi_row * lf_data->cm->mi_stride;
 
@@ -242,8 +248,7 @@ static int loop_filter_row_worker(AV1LfSync *const lf_sync,
   exit(EXIT_FAILURE);
 #endif  // CONFIG_EXT_PARTITION
 
-  for (mi_row = lf_data->start; mi_row < lf_data->stop;
-       mi_row += lf_sync->num_workers * lf_data->cm->mib_size) {
+  while ((mi_row = get_next_mi_row(lf_sync, lf_data)) < lf_data->stop) {
     MODE_INFO **const mi =
         lf_data->cm->mi_grid_visible + mi_row * lf_data->cm->mi_stride;
 
@@ -285,9 +290,38 @@ static int loop_filter_row_worker(AV1LfSync *const lf_sync,
 }
 #endif  //  CONFIG_PARALLEL_DEBLOCKING
 
+// Runs hook on num_workers workers, which take the rows in turn.
+static void run_lf_workers(YV12_BUFFER_CONFIG *frame, AV1_COMMON *cm,
+                           struct macroblockd_plane *planes, int start,
+                           int stop, int y_only, AVxWorkerHook hook,
+                           AVxScheduler *scheduler, int num_workers,
+                           AV1LfSync *lf_sync) {
+  int queued = 1;
+  int i;
+
+  for (i = 0; i < num_workers && queued; ++i) {
+    LFWorkerData *const lf_data = &lf_sync->lfdata[i];
+
+    // Loopfilter data
+    av1_loop_filter_data_reset(lf_data, frame, cm, planes);
+    lf_data->start = start;
+    lf_data->stop = stop;
+    lf_data->y_only = y_only;
+
+    queued = aom_scheduler_submit(scheduler, &lf_sync->tasks, hook, lf_sync,
+                                  lf_data);
+  }
+
+  // Wait till all rows are finished
+  aom_scheduler_wait(scheduler, &lf_sync->tasks);
+  if (!queued)
+    aom_internal_error(&cm->error, AOM_CODEC_MEM_ERROR,
+                       "Failed to queue loop filter tasks");
+}
+
 static void loop_filter_rows_mt(YV12_BUFFER_CONFIG *frame, AV1_COMMON *cm,
                                 struct macroblockd_plane *planes, int start,
-                                int stop, int y_only, AVxWorker *workers,
+                                int stop, int y_only, AVxScheduler *scheduler,
                                 int nworkers, AV1LfSync *lf_sync) {
 #if CONFIG_EXT_PARTITION
   printf(
@@ -296,14 +330,12 @@ static void loop_filter_rows_mt(YV12_BUFFER_CONFIG *frame, AV1_COMMON *cm,
   exit(EXIT_FAILURE);
 #endif  // CONFIG_EXT_PARTITION
 
-  const AVxWorkerInterface *const winterface = aom_get_worker_interface();
   // Number of superblock rows and cols
   const int sb_rows = mi_rows_aligned_to_sb(cm) >> cm->mib_size_log2;
   // Decoder may allocate more threads than number of tiles based on user's
   // input.
   const int tile_cols = cm->tile_cols;
   const int num_workers = AOMMIN(nworkers, tile_cols);
-  int i;
 
   if (!lf_sync->sync_range || sb_rows != lf_sync->rows ||
       num_workers > lf_sync->num_workers) {
@@ -325,91 +357,22 @@ static void loop_filter_rows_mt(YV12_BUFFER_CONFIG *frame, AV1_COMMON *cm,
   memset(lf_sync->cur_sb_col, -1, sizeof(*lf_sync->cur_sb_col) * sb_rows);
 
   // Filter all the vertical edges in the whole frame
-  for (i = 0; i < num_workers; ++i) {
-    AVxWorker *const worker = &workers[i];
-    LFWorkerData *const lf_data = &lf_sync->lfdata[i];
-
-    worker->hook = (AVxWorkerHook)loop_filter_ver_row_worker;
-    worker->data1 = lf_sync;
-    worker->data2 = lf_data;
-
-    // Loopfilter data
-    av1_loop_filter_data_reset(lf_data, frame, cm, planes);
-    lf_data->start = start + i * cm->mib_size;
-    lf_data->stop = stop;
-    lf_data->y_only = y_only;
-
-    // Start loopfiltering
-    if (i == num_workers - 1) {
-      winterface->execute(worker);
-    } else {
-      winterface->launch(worker);
-    }
-  }
-
-  // Wait till all rows are finished
-  for (i = 0; i < num_workers; ++i) {
-    winterface->sync(&workers[i]);
-  }
+  run_lf_workers(frame, cm, planes, start, stop, y_only,
+                 (AVxWorkerHook)loop_filter_ver_row_worker, scheduler,
+                 num_workers, lf_sync);
 
   memset(lf_sync->cur_sb_col, -1, sizeof(*lf_sync->cur_sb_col) * sb_rows);
   // Filter all the horizontal edges in the whole frame
-  for (i = 0; i < num_workers; ++i) {
-    AVxWorker *const worker = &workers[i];
-    LFWorkerData *const lf_data = &lf_sync->lfdata[i];
-
-    worker->hook = (AVxWorkerHook)loop_filter_hor_row_worker;
-    worker->data1 = lf_sync;
-    worker->data2 = lf_data;
-
-    // Loopfilter data
-    av1_loop_filter_data_reset(lf_data, frame, cm, planes);
-    lf_data->start = start + i * cm->mib_size;
-    lf_data->stop = stop;
-    lf_data->y_only = y_only;
-
-    // Start loopfiltering
-    if (i == num_workers - 1) {
-      winterface->execute(worker);
-    } else {
-      winterface->launch(worker);
-    }
-  }
-
-  // Wait till all rows are finished
-  for (i = 0; i < num_workers; ++i) {
-    winterface->sync(&workers[i]);
-  }
+  run_lf_workers(frame, cm, planes, start, stop, y_only,
+                 (AVxWorkerHook)loop_filter_hor_row_worker, scheduler,
+                 num_workers, lf_sync);
 #else   // CONFIG_PARALLEL_DEBLOCKING
   // Initialize cur_sb_col to -1 for all SB rows.
   memset(lf_sync->cur_sb_col, -1, sizeof(*lf_sync->cur_sb_col) * sb_rows);
 
-  for (i = 0; i < num_workers; ++i) {
-    AVxWorker *const worker = &workers[i];
-    LFWorkerData *const lf_data = &lf_sync->lfdata[i];
-
-    worker->hook = (AVxWorkerHook)loop_filter_row_worker;
-    worker->data1 = lf_sync;
-    worker->data2 = lf_data;
-
-    // Loopfilter data
-    av1_loop_filter_data_reset(lf_data, frame, cm, planes);
-    lf_data->start = start + i * cm->mib_size;
-    lf_data->stop = stop;
-    lf_data->y_only = y_only;
-
-    // Start loopfiltering
-    if (i == num_workers - 1) {
-      winterface->execute(worker);
-    } else {
-      winterface->launch(worker);
-    }
-  }
-
-  // Wait till all rows are finished
-  for (i = 0; i < num_workers; ++i) {
-    winterface->sync(&workers[i]);
-  }
+  run_lf_workers(frame, cm, planes, start, stop, y_only,
+                 (AVxWorkerHook)loop_filter_row_worker, scheduler, num_workers,
+                 lf_sync);
 #endif  // CONFIG_PARALLEL_DEBLOCKING
 }
 
@@ -419,8 +382,9 @@ void av1_loop_filter_frame_mt(YV12_BUFFER_CONFIG *frame, AV1_COMMON *cm,
 #if CONFIG_LOOPFILTER_LEVEL
                               int frame_filter_level_r,
 #endif
-                              int y_only, int partial_frame, AVxWorker *workers,
-                              int num_workers, AV1LfSync *lf_sync) {
+                              int y_only, int partial_frame,
+                              AVxScheduler *scheduler, int num_workers,
+                              AV1LfSync *lf_sync) {
   int start_mi_row, end_mi_row, mi_rows_to_filter;
 
   if (!frame_filter_level) return;
@@ -440,7 +404,7 @@ void av1_loop_filter_frame_mt(YV12_BUFFER_CONFIG *frame, AV1_COMMON *cm,
   av1_loop_filter_frame_init(cm, frame_filter_level, frame_filter_level);
 #endif  // CONFIG_LOOPFILTER_LEVEL
   loop_filter_rows_mt(frame, cm, planes, start_mi_row, end_mi_row, y_only,
-                      workers, num_workers, lf_sync);
+                      scheduler, num_workers, lf_sync);
 }
 
 // Set up nsync by width.
@@ -461,6 +425,7 @@ static INLINE int get_sync_range(int width) {
 void av1_loop_filter_alloc(AV1LfSync *lf_sync, AV1_COMMON *cm, int rows,
                            int width, int num_workers) {
   lf_sync->rows = rows;
+  aom_task_group_init(&lf_sync->tasks);
 #if CONFIG_MULTITHREAD
   {
     int i;
@@ -515,12 +480,500 @@ void av1_loop_filter_dealloc(AV1LfSync *lf_sync) {
 #endif  // CONFIG_MULTITHREAD
     aom_free(lf_sync->lfdata);
     aom_free(lf_sync->cur_sb_col);
+    if (lf_sync->rows > 0) aom_task_group_destroy(&lf_sync->tasks);
     // clear the structure as the source of this call may be a resize in which
     // case this call will be followed by an _alloc() which may fail.
     av1_zero(*lf_sync);
   }
 }
 
+enum {
+  // The row has been deblocked and the CDEF lines around it saved.
+  SB_ROW_DEBLOCKED = 1,
+  // The row, and every row above it, has been CDEF filtered and is ready to
+  // be restored.
+  SB_ROW_FILTERED = 2,
+};
+
+static INLINE void filter_sync_read(AV1FilterSync *const filter_sync, int r,
+                                    int stage) {
+#if CONFIG_MULTITHREAD
+  if (r >= 0) {
+    pthread_mutex_t *const mutex = &filter_sync->mutex_[r];
+    mutex_lock(mutex);
+
+    while (filter_sync->row_stage[r] < stage) {
+      pthread_cond_wait(&filter_sync->cond_[r], mutex);
+    }
+    pthread_mutex_unlock(mutex);
+  }
+#else
+  (void)filter_sync;
+  (void)r;
+  (void)stage;
+#endif  // CONFIG_MULTITHREAD
+}
+
+static INLINE void filter_sync_write(AV1FilterSync *const filter_sync, int r,
+                                     int stage) {
+#if CONFIG_MULTITHREAD
+  mutex_lock(&filter_sync->mutex_[r]);
+
+  filter_sync->row_stage[r] = stage;
+
+  pthread_cond_signal(&filter_sync->cond_[r]);
+  pthread_mutex_unlock(&filter_sync->mutex_[r]);
+#else
+  (void)filter_sync;
+  (void)r;
+  (void)stage;
+#endif  // CONFIG_MULTITHREAD
+}
+
+#if CONFIG_LOOP_RESTORATION
+// Setting up the processing stripe boundaries of a restoration unit
+// temporarily overwrites the 3 rows just outside the stripe, up to
+// RESTORATION_EXTRA_HORZ pixels either side of the unit, and the filters read
+// 3 pixels beyond the unit. So a unit in one row may only be filtered once the
+// units above it and above and to its right have been filtered and their
+// boundaries restored.
+static INLINE void lr_sync_read(AV1LrSync *const lr_sync, int r, int c) {
+#if CONFIG_MULTITHREAD
+  if (lr_sync->row_info[r].row) {
+    pthread_mutex_t *const mutex = &lr_sync->mutex_[r - 1];
+    mutex_lock(mutex);
+
+    while (c + 1 > lr_sync->cur_col[r - 1]) {
+      pthread_cond_wait(&lr_sync->cond_[r - 1], mutex);
+    }
+    pthread_mutex_unlock(mutex);
+  }
+#else
+  (void)lr_sync;
+  (void)r;
+  (void)c;
+#endif  // CONFIG_MULTITHREAD
+}
+
+static INLINE void lr_sync_write(AV1LrSync *const lr_sync, int r, int c,
+                                 const int cols) {
+#if CONFIG_MULTITHREAD
+  mutex_lock(&lr_sync->mutex_[r]);
+
+  // The last unit of a row satisfies every column of the next row.
+  lr_sync->cur_col[r] = (c < cols - 1) ? c : cols;
+
+  pthread_cond_signal(&lr_sync->cond_[r]);
+  pthread_mutex_unlock(&lr_sync->mutex_[r]);
+#else
+  (void)lr_sync;
+  (void)r;
+  (void)c;
+  (void)cols;
+#endif  // CONFIG_MULTITHREAD
+}
+
+// Each row of restoration units reads up to RESTORATION_BORDER rows below
+// the units, which at a tile boundary are in the next superblock row. Find the
+// superblock row which has to be filtered before the row of units can be.
+static int get_rest_unit_row_sb_row(const AV1_COMMON *cm, int plane, int row,
+                                    int sb_rows) {
+  const int ss_y = plane > 0 && cm->subsampling_y;
+  int v_start, v_end;
+  av1_get_rest_unit_row_bounds(cm, plane, row, &v_start, &v_end);
+  const int last_row = (v_end + RESTORATION_BORDER - 1) << ss_y;
+  return AOMMIN(last_row >> (MI_SIZE_LOG2 + MAX_MIB_SIZE_LOG2), sb_rows - 1);
+}
+
+// List the rows of restoration units of every restored plane, reallocating
+// lr_sync if there are more of them than before.
+static void lr_sync_setup_rows(AV1LrSync *const lr_sync, AV1_COMMON *cm,
+                               int sb_rows, int num_workers) {
+  int plane_rows[MAX_MB_PLANE] = { 0 };
+  int plane_cols[MAX_MB_PLANE] = { 0 };
+  int rows = 0;
+
+  for (int plane = 0; plane < MAX_MB_PLANE; ++plane) {
+    if (cm->rst_info[plane].frame_restoration_type == RESTORE_NONE) continue;
+    av1_get_rest_unit_grid(cm, plane, &plane_rows[plane], &plane_cols[plane]);
+    rows += plane_rows[plane];
+  }
+
+  if (rows > lr_sync->rows || num_workers > lr_sync->num_workers) {
+    av1_loop_restoration_dealloc(lr_sync);
+    av1_loop_restoration_alloc(lr_sync, cm, rows, num_workers);
+  }
+
+  rows = 0;
+  for (int plane = 0; plane < MAX_MB_PLANE; ++plane) {
+    for (int r = 0; r < plane_rows[plane]; ++r, ++rows) {
+      AV1LrRowInfo *const row_info = &lr_sync->row_info[rows];
+      row_info->plane = plane;
+      row_info->row = r;
+      row_info->cols = plane_cols[plane];
+      row_info->sb_row = get_rest_unit_row_sb_row(cm, plane, r, sb_rows);
+    }
+  }
+  lr_sync->num_rows = rows;
+  memset(lr_sync->cur_col, -1, sizeof(*lr_sync->cur_col) * rows);
+}
+
+static void restore_sb_row(AV1LrSync *const lr_sync,
+                           LRWorkerData *const lr_data, int sb_row) {
+  for (int r = 0; r < lr_sync->num_rows; ++r) {
+    const AV1LrRowInfo *const row_info = &lr_sync->row_info[r];
+    if (row_info->sb_row != sb_row) continue;
+
+    FilterFrameCtxt ctxt = lr_data->lr_ctxt->ctxt[row_info->plane];
+#if CONFIG_STRIPED_LOOP_RESTORATION
+    ctxt.rlbs = lr_data->rlbs;
+#endif  // CONFIG_STRIPED_LOOP_RESTORATION
+    ctxt.tmpbuf = lr_data->rst_tmpbuf;
+
+    for (int c = 0; c < row_info->cols; ++c) {
+      lr_sync_read(lr_sync, r, c);
+      av1_loop_restoration_filter_grid_unit(lr_data->cm, row_info->plane,
+                                            row_info->row, c, &ctxt);
+      lr_sync_write(lr_sync, r, c, row_info->cols);
+    }
+  }
+}
+#endif  // CONFIG_LOOP_RESTORATION
+
+static void get_sb_row_fb_rows(const AV1FilterSync *filter_sync, int sb_row,
+                               int *fbr_start, int *fbr_end) {
+  const int mi_row = sb_row << MAX_MIB_SIZE_LOG2;
+  *fbr_start = mi_row / MI_SIZE_64X64;
+  *fbr_end = AOMMIN((mi_row + MAX_MIB_SIZE) / MI_SIZE_64X64,
+                    filter_sync->cdef_lines->nvfb);
+}
+
+static void deblock_sb_row(AV1FilterSync *const filter_sync,
+                           FilterPipelineWorkerData *const data, int sb_row) {
+  AV1_COMMON *const cm = filter_sync->cm;
+  const int stages = filter_sync->stages;
+
+#if !CONFIG_LPF_SB
+  if (stages & FILTER_STAGE_DEBLOCK) {
+    const int mi_row = sb_row << MAX_MIB_SIZE_LOG2;
+    av1_loop_filter_frame_rows(filter_sync->frame, cm, data->planes, mi_row,
+                               AOMMIN(mi_row + MAX_MIB_SIZE, cm->mi_rows));
+  }
+#else
+  (void)data;
+#endif  // !CONFIG_LPF_SB
+
+  // The lines around the top of this row and between its filter block rows
+  // are final now, and must be saved before CDEF starts on either side.
+  if (stages & FILTER_STAGE_CDEF) {
+    int fbr_start, fbr_end;
+    get_sb_row_fb_rows(filter_sync, sb_row, &fbr_start, &fbr_end);
+    for (int fbr = AOMMAX(fbr_start, 1); fbr < fbr_end; ++fbr) {
+      av1_cdef_save_boundary_lines(filter_sync->cdef_lines, cm,
+                                   filter_sync->xd, fbr);
+    }
+  }
+}
+
+static void filter_sb_row(AV1FilterSync *const filter_sync,
+                          FilterPipelineWorkerData *const data, int sb_row) {
+  AV1_COMMON *const cm = filter_sync->cm;
+  const int stages = filter_sync->stages;
+  const int mi_row = sb_row << MAX_MIB_SIZE_LOG2;
+  const int mi_row_end = AOMMIN(mi_row + MAX_MIB_SIZE, cm->mi_rows);
+
+#if CONFIG_STRIPED_LOOP_RESTORATION
+  if (filter_sync->save_lr_lines) {
+    av1_loop_restoration_save_boundary_rows(filter_sync->frame, cm, 0, mi_row,
+                                            mi_row_end);
+  }
+#endif  // CONFIG_STRIPED_LOOP_RESTORATION
+
+  if (stages & FILTER_STAGE_CDEF) {
+    int fbr_start, fbr_end;
+    get_sb_row_fb_rows(filter_sync, sb_row, &fbr_start, &fbr_end);
+    for (int fbr = fbr_start; fbr < fbr_end; ++fbr) {
+      av1_cdef_fb_row(filter_sync->cdef_lines, cm, filter_sync->xd, fbr);
+    }
+  }
+
+#if CONFIG_LOOP_RESTORATION
+  if (stages & FILTER_STAGE_RESTORE) {
+    av1_loop_restoration_extend_rows(filter_sync->frame, cm, mi_row,
+                                     mi_row_end);
+#if CONFIG_STRIPED_LOOP_RESTORATION
+    if (filter_sync->save_lr_lines) {
+      av1_loop_restoration_save_boundary_rows(filter_sync->frame, cm, 1,
+                                              mi_row, mi_row_end);
+    }
+#endif  // CONFIG_STRIPED_LOOP_RESTORATION
+  }
+#endif  // CONFIG_LOOP_RESTORATION
+
+  // A row of restoration units may span several superblock rows, so rows are
+  // only marked as filtered in order. Without restoration the row is final
+  // now, and reported before the next row can be.
+  filter_sync_read(filter_sync, sb_row - 1, SB_ROW_FILTERED);
+  if (filter_sync->row_done && !(stages & FILTER_STAGE_RESTORE))
+    filter_sync->row_done(filter_sync->row_done_priv, sb_row);
+  filter_sync_write(filter_sync, sb_row, SB_ROW_FILTERED);
+
+#if CONFIG_LOOP_RESTORATION
+  if (stages & FILTER_STAGE_RESTORE)
+    restore_sb_row(&filter_sync->lr_sync, data->lr_data, sb_row);
+#else
+  (void)data;
+#endif  // CONFIG_LOOP_RESTORATION
+}
+
+// Job r deblocks superblock row r, then applies CDEF and loop restoration to
+// row r - 1, whose bottom lines are changed by deblocking row r. Jobs only
+// wait on earlier jobs, so they are handed out to the workers in turn.
+static int filter_pipeline_worker(AV1FilterSync *const filter_sync,
+                                  FilterPipelineWorkerData *const data) {
+  int r;
+  while ((r = aom_task_group_next_job(&filter_sync->tasks)) <=
+         filter_sync->sb_rows) {
+    filter_sync_read(filter_sync, r - 1, SB_ROW_DEBLOCKED);
+    if (r < filter_sync->sb_rows) {
+      deblock_sb_row(filter_sync, data, r);
+      filter_sync_write(filter_sync, r, SB_ROW_DEBLOCKED);
+    }
+    if (r > 0) filter_sb_row(filter_sync, data, r - 1);
+  }
+  return 1;
+}
+
+void av1_filter_frame_pipeline_mt(YV12_BUFFER_CONFIG *frame, AV1_COMMON *cm,
+                                  MACROBLOCKD *xd, int stages,
+                                  AVxScheduler *scheduler, int nworkers,
+                                  AV1FilterSync *filter_sync,
+                                  AV1FilterRowDoneCb row_done,
+                                  void *row_done_priv) {
+  const int sb_rows = (cm->mi_rows + MAX_MIB_SIZE - 1) >> MAX_MIB_SIZE_LOG2;
+  const int num_workers = AOMMAX(AOMMIN(nworkers, sb_rows + 1), 1);
+  AV1CdefLineBufs cdef_lines;
+  int queued = 1;
+  int i;
+
+  if (!stages) return;
+
+  if (sb_rows > filter_sync->rows || num_workers > filter_sync->num_workers) {
+    av1_filter_pipeline_dealloc(filter_sync);
+    av1_filter_pipeline_alloc(filter_sync, cm, sb_rows, num_workers);
+  }
+  memset(filter_sync->row_stage, 0, sizeof(*filter_sync->row_stage) * sb_rows);
+  filter_sync->frame = frame;
+  filter_sync->cm = cm;
+  filter_sync->xd = xd;
+  filter_sync->sb_rows = sb_rows;
+  filter_sync->cdef_lines = &cdef_lines;
+  filter_sync->row_done = row_done;
+  filter_sync->row_done_priv = row_done_priv;
+
+#if !CONFIG_PARALLEL_DEBLOCKING && !CONFIG_LPF_SB
+  // Without parallel deblocking, the edges are filtered using transform size
+  // context carried down the whole frame, so do all the rows up front.
+  if (stages & FILTER_STAGE_DEBLOCK) {
+    av1_loop_filter_frame_rows(frame, cm, xd->plane, 0, cm->mi_rows);
+    stages &= ~FILTER_STAGE_DEBLOCK;
+  }
+#endif  // !CONFIG_PARALLEL_DEBLOCKING && !CONFIG_LPF_SB
+  filter_sync->stages = stages;
+
+  if (stages & FILTER_STAGE_CDEF)
+    av1_cdef_init_frame(&cdef_lines, frame, cm, xd);
+
+#if CONFIG_LOOP_RESTORATION
+  if (stages & FILTER_STAGE_RESTORE) {
+    lr_sync_setup_rows(&filter_sync->lr_sync, cm, sb_rows, num_workers);
+    av1_loop_restoration_filter_init(&filter_sync->lr_ctxt, frame, cm);
+  }
+#if CONFIG_STRIPED_LOOP_RESTORATION
+  // The boundary lines are saved here only if the restoration input is made
+  // here too; otherwise the caller has saved them already.
+  filter_sync->save_lr_lines =
+      (stages & FILTER_STAGE_RESTORE) &&
+      (stages & (FILTER_STAGE_DEBLOCK | FILTER_STAGE_CDEF));
+#endif  // CONFIG_STRIPED_LOOP_RESTORATION
+#endif  // CONFIG_LOOP_RESTORATION
+
+  for (i = 0; i < num_workers && queued; ++i) {
+    FilterPipelineWorkerData *const data = &filter_sync->workerdata[i];
+
+    memcpy(data->planes, xd->plane, sizeof(data->planes));
+#if CONFIG_LOOP_RESTORATION
+    if (stages & FILTER_STAGE_RESTORE) {
+      data->lr_data = &filter_sync->lr_sync.lrworkerdata[i];
+      data->lr_data->lr_ctxt = &filter_sync->lr_ctxt;
+      data->lr_data->cm = cm;
+    }
+#endif  // CONFIG_LOOP_RESTORATION
+
+    queued = aom_scheduler_submit(scheduler, &filter_sync->tasks,
+                                  (AVxWorkerHook)filter_pipeline_worker,
+                                  filter_sync, data);
+  }
+
+  // Wait till all rows are finished. The jobs only wait on earlier ones, so
+  // the workers queued before a failure still filter every row.
+  aom_scheduler_wait(scheduler, &filter_sync->tasks);
+
+  if (stages & FILTER_STAGE_CDEF) av1_cdef_free_frame(&cdef_lines);
+  if (!queued)
+    aom_internal_error(&cm->error, AOM_CODEC_MEM_ERROR,
+                       "Failed to queue filter pipeline tasks");
+#if CONFIG_LOOP_RESTORATION
+  if (stages & FILTER_STAGE_RESTORE)
+    av1_loop_restoration_copy_planes(&filter_sync->lr_ctxt);
+#endif  // CONFIG_LOOP_RESTORATION
+}
+
+void av1_filter_pipeline_alloc(AV1FilterSync *filter_sync, AV1_COMMON *cm,
+                               int rows, int num_workers) {
+  filter_sync->rows = rows;
+  aom_task_group_init(&filter_sync->tasks);
+#if CONFIG_MULTITHREAD
+  {
+    int i;
+
+    CHECK_MEM_ERROR(cm, filter_sync->mutex_,
+                    aom_malloc(sizeof(*filter_sync->mutex_) * rows));
+    if (filter_sync->mutex_) {
+      for (i = 0; i < rows; ++i) {
+        pthread_mutex_init(&filter_sync->mutex_[i], NULL);
+      }
+    }
+
+    CHECK_MEM_ERROR(cm, filter_sync->cond_,
+                    aom_malloc(sizeof(*filter_sync->cond_) * rows));
+    if (filter_sync->cond_) {
+      for (i = 0; i < rows; ++i) {
+        pthread_cond_init(&filter_sync->cond_[i], NULL);
+      }
+    }
+  }
+#endif  // CONFIG_MULTITHREAD
+
+  CHECK_MEM_ERROR(cm, filter_sync->row_stage,
+                  aom_malloc(sizeof(*filter_sync->row_stage) * rows));
+
+  CHECK_MEM_ERROR(cm, filter_sync->workerdata,
+                  aom_calloc(num_workers, sizeof(*filter_sync->workerdata)));
+  filter_sync->num_workers = num_workers;
+}
+
+void av1_filter_pipeline_dealloc(AV1FilterSync *filter_sync) {
+  if (filter_sync != NULL) {
+#if CONFIG_MULTITHREAD
+    int i;
+
+    if (filter_sync->mutex_ != NULL) {
+      for (i = 0; i < filter_sync->rows; ++i) {
+        pthread_mutex_destroy(&filter_sync->mutex_[i]);
+      }
+      aom_free(filter_sync->mutex_);
+    }
+    if (filter_sync->cond_ != NULL) {
+      for (i = 0; i < filter_sync->rows; ++i) {
+        pthread_cond_destroy(&filter_sync->cond_[i]);
+      }
+      aom_free(filter_sync->cond_);
+    }
+#endif  // CONFIG_MULTITHREAD
+    aom_free(filter_sync->row_stage);
+    aom_free(filter_sync->workerdata);
+    if (filter_sync->rows > 0) aom_task_group_destroy(&filter_sync->tasks);
+#if CONFIG_LOOP_RESTORATION
+    av1_loop_restoration_dealloc(&filter_sync->lr_sync);
+#endif  // CONFIG_LOOP_RESTORATION
+    // clear the structure as the source of this call may be a resize in which
+    // case this call will be followed by an _alloc() which may fail.
+    av1_zero(*filter_sync);
+  }
+}
+
+#if CONFIG_LOOP_RESTORATION
+void av1_loop_restoration_alloc(AV1LrSync *lr_sync, AV1_COMMON *cm, int rows,
+                                int num_workers) {
+  lr_sync->rows = rows;
+#if CONFIG_MULTITHREAD
+  {
+    int i;
+
+    CHECK_MEM_ERROR(cm, lr_sync->mutex_,
+                    aom_malloc(sizeof(*lr_sync->mutex_) * rows));
+    if (lr_sync->mutex_) {
+      for (i = 0; i < rows; ++i) {
+        pthread_mutex_init(&lr_sync->mutex_[i], NULL);
+      }
+    }
+
+    CHECK_MEM_ERROR(cm, lr_sync->cond_,
+                    aom_malloc(sizeof(*lr_sync->cond_) * rows));
+    if (lr_sync->cond_) {
+      for (i = 0; i < rows; ++i) {
+        pthread_cond_init(&lr_sync->cond_[i], NULL);
+      }
+    }
+  }
+#endif  // CONFIG_MULTITHREAD
+
+  CHECK_MEM_ERROR(cm, lr_sync->cur_col,
+                  aom_malloc(sizeof(*lr_sync->cur_col) * rows));
+  CHECK_MEM_ERROR(cm, lr_sync->row_info,
+                  aom_malloc(sizeof(*lr_sync->row_info) * rows));
+
+  CHECK_MEM_ERROR(cm, lr_sync->lrworkerdata,
+                  aom_calloc(num_workers, sizeof(*lr_sync->lrworkerdata)));
+  lr_sync->num_workers = num_workers;
+
+  for (int i = 0; i < num_workers; ++i) {
+    LRWorkerData *const lr_data = &lr_sync->lrworkerdata[i];
+    CHECK_MEM_ERROR(cm, lr_data->rst_tmpbuf,
+                    (int32_t *)aom_memalign(16, RESTORATION_TMPBUF_SIZE));
+#if CONFIG_STRIPED_LOOP_RESTORATION
+    CHECK_MEM_ERROR(cm, lr_data->rlbs, aom_malloc(sizeof(*lr_data->rlbs)));
+#endif  // CONFIG_STRIPED_LOOP_RESTORATION
+  }
+}
+
+void av1_loop_restoration_dealloc(AV1LrSync *lr_sync) {
+  if (lr_sync != NULL) {
+#if CONFIG_MULTITHREAD
+    int i;
+
+    if (lr_sync->mutex_ != NULL) {
+      for (i = 0; i < lr_sync->rows; ++i) {
+        pthread_mutex_destroy(&lr_sync->mutex_[i]);
+      }
+      aom_free(lr_sync->mutex_);
+    }
+    if (lr_sync->cond_ != NULL) {
+      for (i = 0; i < lr_sync->rows; ++i) {
+        pthread_cond_destroy(&lr_sync->cond_[i]);
+      }
+      aom_free(lr_sync->cond_);
+    }
+#endif  // CONFIG_MULTITHREAD
+    aom_free(lr_sync->cur_col);
+    aom_free(lr_sync->row_info);
+    if (lr_sync->lrworkerdata != NULL) {
+      for (int j = 0; j < lr_sync->num_workers; ++j) {
+        aom_free(lr_sync->lrworkerdata[j].rst_tmpbuf);
+#if CONFIG_STRIPED_LOOP_RESTORATION
+        aom_free(lr_sync->lrworkerdata[j].rlbs);
+#endif  // CONFIG_STRIPED_LOOP_RESTORATION
+      }
+      aom_free(lr_sync->lrworkerdata);
+    }
+    // clear the structure as the source of this call may be a resize in which
+    // case this call will be followed by an _alloc() which may fail.
+    av1_zero(*lr_sync);
+  }
+}
+#endif  // CONFIG_LOOP_RESTORATION
+
 // Accumulate frame counts. FRAME_COUNTS consist solely of 'unsigned int'
 // members, so we treat it as an array, and sum over the whole length.
 void av1_accumulate_frame_counts(FRAME_COUNTS *acc_counts,
@@ -13,6 +13,10 @@
 #define AV1_COMMON_LOOPFILTER_THREAD_H_
 #include "./aom_config.h"
 #include "av1/common/av1_loopfilter.h"
+#if CONFIG_LOOP_RESTORATION
+#include "av1/common/restoration.h"
+#endif  // CONFIG_LOOP_RESTORATION
+#include "aom_util/aom_scheduler.h"
 #include "aom_util/aom_thread.h"
 
 #ifdef __cplusplus
@@ -20,6 +24,7 @@ extern "C" {
 #endif
 
 struct AV1Common;
+struct AV1CdefLineBufs;
 struct FRAME_COUNTS;
 
 // Loopfilter row synchronization
@@ -38,8 +43,99 @@ typedef struct AV1LfSyncData {
   // Row-based parallel loopfilter data
   LFWorkerData *lfdata;
   int num_workers;
+  // The workers, which take the superblock rows in turn.
+  AVxTaskGroup tasks;
 } AV1LfSync;
 
+#if CONFIG_LOOP_RESTORATION
+typedef struct LoopRestorationWorkerData {
+  int32_t *rst_tmpbuf;
+#if CONFIG_STRIPED_LOOP_RESTORATION
+  RestorationLineBuffers *rlbs;
+#endif  // CONFIG_STRIPED_LOOP_RESTORATION
+  AV1LrStruct *lr_ctxt;
+  const struct AV1Common *cm;
+  int start;
+  int step;
+} LRWorkerData;
+
+typedef struct {
+  int plane;
+  int row;
+  int cols;
+  // The superblock row which the filter pipeline has to finish first.
+  int sb_row;
+} AV1LrRowInfo;
+
+// Loop restoration row synchronization. The rows are the rows of restoration
+// units of each plane in turn.
+typedef struct AV1LrSyncData {
+#if CONFIG_MULTITHREAD
+  pthread_mutex_t *mutex_;
+  pthread_cond_t *cond_;
+#endif
+  // The index of the last filtered restoration unit in each row.
+  int *cur_col;
+  AV1LrRowInfo *row_info;
+  // The number of rows allocated, and the number used by the current frame.
+  int rows;
+  int num_rows;
+
+  LRWorkerData *lrworkerdata;
+  int num_workers;
+} AV1LrSync;
+#endif  // CONFIG_LOOP_RESTORATION
+
+// Called by the in-loop filter pipeline once superblock row sb_row is final.
+typedef void (*AV1FilterRowDoneCb)(void *priv, int sb_row);
+
+// The stages of the in-loop filter pipeline, in the order they are applied.
+#define FILTER_STAGE_DEBLOCK (1 << 0)
+#define FILTER_STAGE_CDEF (1 << 1)
+#define FILTER_STAGE_RESTORE (1 << 2)
+
+typedef struct FilterPipelineWorkerData {
+  struct macroblockd_plane planes[MAX_MB_PLANE];
+#if CONFIG_LOOP_RESTORATION
+  LRWorkerData *lr_data;
+#endif  // CONFIG_LOOP_RESTORATION
+} FilterPipelineWorkerData;
+
+// In-loop filter pipeline synchronization. Each superblock row is deblocked,
+// CDEF filtered and restored in turn, while the rows below it are working
+// through the earlier stages.
+typedef struct AV1FilterSyncData {
+#if CONFIG_MULTITHREAD
+  pthread_mutex_t *mutex_;
+  pthread_cond_t *cond_;
+#endif
+  // The last stage finished by each superblock row.
+  int *row_stage;
+  int rows;
+
+  FilterPipelineWorkerData *workerdata;
+  int num_workers;
+  // The workers, which take the jobs in turn.
+  AVxTaskGroup tasks;
+
+  // The frame being filtered.
+  YV12_BUFFER_CONFIG *frame;
+  struct AV1Common *cm;
+  struct macroblockd *xd;
+  int stages;
+  int sb_rows;
+  struct AV1CdefLineBufs *cdef_lines;
+  AV1FilterRowDoneCb row_done;
+  void *row_done_priv;
+#if CONFIG_LOOP_RESTORATION
+  AV1LrSync lr_sync;
+  AV1LrStruct lr_ctxt;
+#if CONFIG_STRIPED_LOOP_RESTORATION
+  int save_lr_lines;
+#endif  // CONFIG_STRIPED_LOOP_RESTORATION
+#endif  // CONFIG_LOOP_RESTORATION
+} AV1FilterSync;
+
 // Allocate memory for loopfilter row synchronization.
 void av1_loop_filter_alloc(AV1LfSync *lf_sync, struct AV1Common *cm, int rows,
                            int width, int num_workers);
@@ -47,15 +143,49 @@ void av1_loop_filter_alloc(AV1LfSync *lf_sync, struct AV1Common *cm, int rows,
 // Deallocate loopfilter synchronization related mutex and data.
 void av1_loop_filter_dealloc(AV1LfSync *lf_sync);
 
-// Multi-threaded loopfilter that uses the tile threads.
+// Multi-threaded loopfilter that runs num_workers workers on scheduler.
 void av1_loop_filter_frame_mt(YV12_BUFFER_CONFIG *frame, struct AV1Common *cm,
                               struct macroblockd_plane *planes,
                               int frame_filter_level,
 #if CONFIG_LOOPFILTER_LEVEL
                               int frame_filter_level_r,
 #endif
-                              int y_only, int partial_frame, AVxWorker *workers,
-                              int num_workers, AV1LfSync *lf_sync);
+                              int y_only, int partial_frame,
+                              AVxScheduler *scheduler, int num_workers,
+                              AV1LfSync *lf_sync);
+
+// Allocate memory for the filter pipeline synchronization.
+void av1_filter_pipeline_alloc(AV1FilterSync *filter_sync,
+                               struct AV1Common *cm, int rows,
+                               int num_workers);
+
+// Deallocate the filter pipeline synchronization related mutex and data.
+void av1_filter_pipeline_dealloc(AV1FilterSync *filter_sync);
+
+// Apply the given FILTER_STAGE_* in-loop filters to frame, pipelined by
+// superblock row: CDEF starts on a row once deblocking has finished the row
+// below it, and loop restoration follows behind CDEF. The striped restoration
+// boundary lines are saved along the way if the deblocking or CDEF stage is
+// run too; otherwise the caller must have saved them. The rows are shared out
+// between num_workers workers run on scheduler. If row_done is not NULL it is
+// called on each superblock row in turn as soon as the row is final, which
+// is only before the end when loop restoration is not applied.
+void av1_filter_frame_pipeline_mt(YV12_BUFFER_CONFIG *frame,
+                                  struct AV1Common *cm, struct macroblockd *xd,
+                                  int stages, AVxScheduler *scheduler,
+                                  int num_workers, AV1FilterSync *filter_sync,
+                                  AV1FilterRowDoneCb row_done,
+                                  void *row_done_priv);
+
+#if CONFIG_LOOP_RESTORATION
+// Allocate memory for loop restoration row synchronization and the per-worker
+// scratch buffers.
+void av1_loop_restoration_alloc(AV1LrSync *lr_sync, struct AV1Common *cm,
+                                int rows, int num_workers);
+
+// Deallocate loop restoration synchronization related mutex and data.
+void av1_loop_restoration_dealloc(AV1LrSync *lr_sync);
+#endif  // CONFIG_LOOP_RESTORATION
 
 void av1_accumulate_frame_counts(struct FRAME_COUNTS *acc_counts,
                                  struct FRAME_COUNTS *counts);
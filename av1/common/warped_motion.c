@@ -22,7 +22,7 @@
 #define WARP_ERROR_BLOCK 32
 
 /* clang-format off */
-static const int error_measure_lut[512] = {
+const int av1_error_measure_lut[512] = {
   // pow 0.7
   16384, 16339, 16294, 16249, 16204, 16158, 16113, 16068,
   16022, 15977, 15932, 15886, 15840, 15795, 15749, 15703,
@@ -411,8 +411,8 @@ static INLINE int highbd_error_measure(int err, int bd) {
   err = abs(err);
   e1 = err >> b;
   e2 = err & bmask;
-  return error_measure_lut[255 + e1] * (v - e2) +
-         error_measure_lut[256 + e1] * e2;
+  return av1_error_measure_lut[255 + e1] * (v - e2) +
+         av1_error_measure_lut[256 + e1] * e2;
 }
 
 /* Note: For an explanation of the warp algorithm, and some notes on bit widths
@@ -606,19 +606,20 @@ static int64_t highbd_warp_error(
     WarpedMotionParams *wm, const uint8_t *const ref8, int width, int height,
     int stride, const uint8_t *const dst8, int p_col, int p_row, int p_width,
     int p_height, int p_stride, int subsampling_x, int subsampling_y, int bd,
-    int64_t best_error) {
+    int sample_step, int64_t best_error) {
   int64_t gm_sumerr = 0;
   int warp_w, warp_h;
   int error_bsize_w = AOMMIN(p_width, WARP_ERROR_BLOCK);
   int error_bsize_h = AOMMIN(p_height, WARP_ERROR_BLOCK);
+  const int block_step = WARP_ERROR_BLOCK * sample_step;
   uint16_t tmp[WARP_ERROR_BLOCK * WARP_ERROR_BLOCK];
 
   ConvolveParams conv_params = get_conv_params(0, 0, 0);
 #if CONFIG_JNT_COMP
   conv_params.use_jnt_comp_avg = 0;
 #endif
-  for (int i = p_row; i < p_row + p_height; i += WARP_ERROR_BLOCK) {
-    for (int j = p_col; j < p_col + p_width; j += WARP_ERROR_BLOCK) {
+  for (int i = p_row; i < p_row + p_height; i += block_step) {
+    for (int j = p_col; j < p_col + p_width; j += block_step) {
       // avoid warping extra 8x8 blocks in the padded region of the frame
       // when p_width and p_height are not multiples of WARP_ERROR_BLOCK
       warp_w = AOMMIN(error_bsize_w, p_col + p_width - j);
@@ -639,7 +640,7 @@ static int64_t highbd_warp_error(
 #endif  // CONFIG_HIGHBITDEPTH
 
 static INLINE int error_measure(int err) {
-  return error_measure_lut[255 + err];
+  return av1_error_measure_lut[255 + err];
 }
 
 /* The warp filter for ROTZOOM and AFFINE models works as follows:
@@ -899,9 +900,9 @@ static void warp_plane(WarpedMotionParams *wm, const uint8_t *const ref,
                   alpha, beta, gamma, delta);
 }
 
-static int64_t frame_error(const uint8_t *const ref, int stride,
-                           const uint8_t *const dst, int p_width, int p_height,
-                           int p_stride) {
+int64_t av1_calc_frame_error_c(const uint8_t *const ref, int stride,
+                               const uint8_t *const dst, int p_width,
+                               int p_height, int p_stride) {
   int64_t sum_error = 0;
   for (int i = 0; i < p_height; ++i) {
     for (int j = 0; j < p_width; ++j) {
@@ -917,19 +918,20 @@ static int64_t warp_error(WarpedMotionParams *wm, const uint8_t *const ref,
                           const uint8_t *const dst, int p_col, int p_row,
                           int p_width, int p_height, int p_stride,
                           int subsampling_x, int subsampling_y,
-                          int64_t best_error) {
+                          int sample_step, int64_t best_error) {
   int64_t gm_sumerr = 0;
   int warp_w, warp_h;
   int error_bsize_w = AOMMIN(p_width, WARP_ERROR_BLOCK);
   int error_bsize_h = AOMMIN(p_height, WARP_ERROR_BLOCK);
+  const int block_step = WARP_ERROR_BLOCK * sample_step;
   uint8_t tmp[WARP_ERROR_BLOCK * WARP_ERROR_BLOCK];
   ConvolveParams conv_params = get_conv_params(0, 0, 0);
 #if CONFIG_JNT_COMP
   conv_params.use_jnt_comp_avg = 0;
 #endif
 
-  for (int i = p_row; i < p_row + p_height; i += WARP_ERROR_BLOCK) {
-    for (int j = p_col; j < p_col + p_width; j += WARP_ERROR_BLOCK) {
+  for (int i = p_row; i < p_row + p_height; i += block_step) {
+    for (int j = p_col; j < p_col + p_width; j += block_step) {
       // avoid warping extra 8x8 blocks in the padded region of the frame
       // when p_width and p_height are not multiples of WARP_ERROR_BLOCK
       warp_w = AOMMIN(error_bsize_w, p_col + p_width - j);
@@ -937,7 +939,8 @@ static int64_t warp_error(WarpedMotionParams *wm, const uint8_t *const ref,
       warp_plane(wm, ref, width, height, stride, tmp, j, i, warp_w, warp_h,
                  WARP_ERROR_BLOCK, subsampling_x, subsampling_y, &conv_params);
 
-      gm_sumerr += frame_error(tmp, WARP_ERROR_BLOCK, dst + j + i * p_stride,
+      gm_sumerr +=
+          av1_calc_frame_error(tmp, WARP_ERROR_BLOCK, dst + j + i * p_stride,
                                warp_w, warp_h, p_stride);
       if (gm_sumerr > best_error) return gm_sumerr;
     }
@@ -958,7 +961,7 @@ int64_t av1_frame_error(
                               p_stride, bd);
   }
 #endif  // CONFIG_HIGHBITDEPTH
-  return frame_error(ref, stride, dst, p_width, p_height, p_stride);
+  return av1_calc_frame_error(ref, stride, dst, p_width, p_height, p_stride);
 }
 
 int64_t av1_warp_error(WarpedMotionParams *wm,
@@ -968,18 +971,18 @@ int64_t av1_warp_error(WarpedMotionParams *wm,
                        const uint8_t *ref, int width, int height, int stride,
                        uint8_t *dst, int p_col, int p_row, int p_width,
                        int p_height, int p_stride, int subsampling_x,
-                       int subsampling_y, int64_t best_error) {
+                       int subsampling_y, int sample_step, int64_t best_error) {
   if (wm->wmtype <= AFFINE)
     if (!get_shear_params(wm)) return 1;
 #if CONFIG_HIGHBITDEPTH
   if (use_hbd)
     return highbd_warp_error(wm, ref, width, height, stride, dst, p_col, p_row,
                              p_width, p_height, p_stride, subsampling_x,
-                             subsampling_y, bd, best_error);
+                             subsampling_y, bd, sample_step, best_error);
 #endif  // CONFIG_HIGHBITDEPTH
   return warp_error(wm, ref, width, height, stride, dst, p_col, p_row, p_width,
                     p_height, p_stride, subsampling_x, subsampling_y,
-                    best_error);
+                    sample_step, best_error);
 }
 
 void av1_warp_plane(WarpedMotionParams *wm,
@@ -46,13 +46,18 @@
 
 extern const int16_t warped_filter[WARPEDPIXEL_PREC_SHIFTS * 3 + 1][8];
 
+// The error of each pixel difference, indexed by the difference plus 255.
+extern const int av1_error_measure_lut[512];
+
 void project_points_affine(const int32_t *mat, int *points, int *proj,
                            const int n, const int stride_points,
                            const int stride_proj, const int subsampling_x,
                            const int subsampling_y);
 
 // Returns the error between the result of applying motion 'wm' to the frame
-// described by 'ref' and the frame described by 'dst'.
+// described by 'ref' and the frame described by 'dst'. Only one in every
+// 'sample_step' error blocks is measured across and down the frame, so a step
+// of 1 measures all of it. Stops once the error exceeds 'best_error'.
 int64_t av1_warp_error(WarpedMotionParams *wm,
 #if CONFIG_HIGHBITDEPTH
                        int use_hbd, int bd,
@@ -60,7 +65,7 @@ int64_t av1_warp_error(WarpedMotionParams *wm,
                        const uint8_t *ref, int width, int height, int stride,
                        uint8_t *dst, int p_col, int p_row, int p_width,
                        int p_height, int p_stride, int subsampling_x,
-                       int subsampling_y, int64_t best_error);
+                       int subsampling_y, int sample_step, int64_t best_error);
 
 // Returns the error between the frame described by 'ref' and the frame
 // described by 'dst'.
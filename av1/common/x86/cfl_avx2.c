@@ -0,0 +1,296 @@
+/*
+ * Copyright (c) 2017, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <immintrin.h>
+
+#include "./av1_rtcd.h"
+#include "av1/common/cfl.h"
+
+// The kernels below process 16 outputs per iteration. Narrower blocks are
+// forwarded to the SSE2/SSSE3 versions.
+
+void cfl_subtract_average_avx2(int16_t *pred_buf_q3, int width, int height,
+                               int num_pel_log2) {
+  if (width < 16) {
+    cfl_subtract_average_sse2(pred_buf_q3, width, height, num_pel_log2);
+    return;
+  }
+  const __m256i ones = _mm256_set1_epi16(1);
+  __m256i sum = _mm256_setzero_si256();
+  int16_t *row = pred_buf_q3;
+
+  for (int j = 0; j < height; j++) {
+    for (int i = 0; i < width; i += 16) {
+      const __m256i v = _mm256_loadu_si256((const __m256i *)(row + i));
+      sum = _mm256_add_epi32(sum, _mm256_madd_epi16(v, ones));
+    }
+    row += CFL_PRED_BUF_LINE;
+  }
+  __m128i sum_128 = _mm_add_epi32(_mm256_castsi256_si128(sum),
+                                  _mm256_extracti128_si256(sum, 1));
+  sum_128 = _mm_add_epi32(sum_128, _mm_srli_si128(sum_128, 8));
+  sum_128 = _mm_add_epi32(sum_128, _mm_srli_si128(sum_128, 4));
+  const int sum_q3 = _mm_cvtsi128_si32(sum_128);
+  const int avg_q3 = (sum_q3 + (1 << (num_pel_log2 - 1))) >> num_pel_log2;
+
+  const __m256i avg = _mm256_set1_epi16(avg_q3);
+  row = pred_buf_q3;
+  for (int j = 0; j < height; j++) {
+    for (int i = 0; i < width; i += 16) {
+      __m256i *const p = (__m256i *)(row + i);
+      _mm256_storeu_si256(p, _mm256_sub_epi16(_mm256_loadu_si256(p), avg));
+    }
+    row += CFL_PRED_BUF_LINE;
+  }
+}
+
+void cfl_luma_subsampling_420_lbd_avx2(const uint8_t *input, int input_stride,
+                                       int16_t *output_q3, int width,
+                                       int height) {
+  if (width < 16) {
+    cfl_luma_subsampling_420_lbd_ssse3(input, input_stride, output_q3, width,
+                                       height);
+    return;
+  }
+  const __m256i ones = _mm256_set1_epi8(1);
+  for (int j = 0; j < height; j++) {
+    for (int i = 0; i < width; i += 16) {
+      const __m256i top =
+          _mm256_loadu_si256((const __m256i *)(input + 2 * i));
+      const __m256i bot =
+          _mm256_loadu_si256((const __m256i *)(input + 2 * i + input_stride));
+      const __m256i sum = _mm256_add_epi16(_mm256_maddubs_epi16(top, ones),
+                                           _mm256_maddubs_epi16(bot, ones));
+      _mm256_storeu_si256((__m256i *)(output_q3 + i),
+                          _mm256_slli_epi16(sum, 1));
+    }
+    input += input_stride << 1;
+    output_q3 += CFL_PRED_BUF_LINE;
+  }
+}
+
+void cfl_luma_subsampling_422_lbd_avx2(const uint8_t *input, int input_stride,
+                                       int16_t *output_q3, int width,
+                                       int height) {
+  if (width < 16) {
+    cfl_luma_subsampling_422_lbd_ssse3(input, input_stride, output_q3, width,
+                                       height);
+    return;
+  }
+  const __m256i ones = _mm256_set1_epi8(1);
+  for (int j = 0; j < height; j++) {
+    for (int i = 0; i < width; i += 16) {
+      const __m256i top =
+          _mm256_loadu_si256((const __m256i *)(input + 2 * i));
+      const __m256i sum = _mm256_maddubs_epi16(top, ones);
+      _mm256_storeu_si256((__m256i *)(output_q3 + i),
+                          _mm256_slli_epi16(sum, 2));
+    }
+    input += input_stride;
+    output_q3 += CFL_PRED_BUF_LINE;
+  }
+}
+
+void cfl_luma_subsampling_440_lbd_avx2(const uint8_t *input, int input_stride,
+                                       int16_t *output_q3, int width,
+                                       int height) {
+  if (width < 16) {
+    cfl_luma_subsampling_440_lbd_sse2(input, input_stride, output_q3, width,
+                                      height);
+    return;
+  }
+  for (int j = 0; j < height; j++) {
+    for (int i = 0; i < width; i += 16) {
+      const __m256i top = _mm256_cvtepu8_epi16(
+          _mm_loadu_si128((const __m128i *)(input + i)));
+      const __m256i bot = _mm256_cvtepu8_epi16(
+          _mm_loadu_si128((const __m128i *)(input + i + input_stride)));
+      _mm256_storeu_si256((__m256i *)(output_q3 + i),
+                          _mm256_slli_epi16(_mm256_add_epi16(top, bot), 2));
+    }
+    input += input_stride << 1;
+    output_q3 += CFL_PRED_BUF_LINE;
+  }
+}
+
+void cfl_luma_subsampling_444_lbd_avx2(const uint8_t *input, int input_stride,
+                                       int16_t *output_q3, int width,
+                                       int height) {
+  if (width < 16) {
+    cfl_luma_subsampling_444_lbd_sse2(input, input_stride, output_q3, width,
+                                      height);
+    return;
+  }
+  for (int j = 0; j < height; j++) {
+    for (int i = 0; i < width; i += 16) {
+      const __m256i luma = _mm256_cvtepu8_epi16(
+          _mm_loadu_si128((const __m128i *)(input + i)));
+      _mm256_storeu_si256((__m256i *)(output_q3 + i),
+                          _mm256_slli_epi16(luma, 3));
+    }
+    input += input_stride;
+    output_q3 += CFL_PRED_BUF_LINE;
+  }
+}
+
+// See scale_luma_ssse3() in cfl_ssse3.c.
+static INLINE __m256i scale_luma_avx2(__m256i ac_q3, __m256i alpha_q12,
+                                      __m256i alpha_sign) {
+  const __m256i abs_scaled =
+      _mm256_mulhrs_epi16(_mm256_abs_epi16(ac_q3), alpha_q12);
+  return _mm256_sign_epi16(_mm256_sign_epi16(abs_scaled, ac_q3), alpha_sign);
+}
+
+void cfl_build_prediction_lbd_avx2(const int16_t *pred_buf_q3, uint8_t *dst,
+                                   int dst_stride, int width, int height,
+                                   int alpha_q3) {
+  if (width < 16) {
+    cfl_build_prediction_lbd_ssse3(pred_buf_q3, dst, dst_stride, width, height,
+                                   alpha_q3);
+    return;
+  }
+  const __m256i alpha_q12 = _mm256_set1_epi16(abs(alpha_q3) << 9);
+  const __m256i alpha_sign = _mm256_set1_epi16(alpha_q3);
+
+  for (int j = 0; j < height; j++) {
+    for (int i = 0; i < width; i += 16) {
+      const __m256i ac =
+          _mm256_loadu_si256((const __m256i *)(pred_buf_q3 + i));
+      const __m256i scaled = scale_luma_avx2(ac, alpha_q12, alpha_sign);
+      const __m256i d =
+          _mm256_cvtepu8_epi16(_mm_loadu_si128((__m128i *)(dst + i)));
+      const __m256i sum = _mm256_add_epi16(d, scaled);
+      // Packing works within 128-bit lanes, gather the two low quadwords.
+      const __m256i res =
+          _mm256_permute4x64_epi64(_mm256_packus_epi16(sum, sum), 0x08);
+      _mm_storeu_si128((__m128i *)(dst + i), _mm256_castsi256_si128(res));
+    }
+    dst += dst_stride;
+    pred_buf_q3 += CFL_PRED_BUF_LINE;
+  }
+}
+
+#if CONFIG_HIGHBITDEPTH
+// Sums the adjacent pairs of 32 high bit depth luma samples.
+static INLINE __m256i sum_pairs_hbd_avx2(const uint16_t *p) {
+  const __m256i lo = _mm256_loadu_si256((const __m256i *)p);
+  const __m256i hi = _mm256_loadu_si256((const __m256i *)(p + 16));
+  // Horizontal adds work within 128-bit lanes, restore the sample order.
+  return _mm256_permute4x64_epi64(_mm256_hadd_epi16(lo, hi), 0xd8);
+}
+
+void cfl_luma_subsampling_420_hbd_avx2(const uint16_t *input, int input_stride,
+                                       int16_t *output_q3, int width,
+                                       int height) {
+  if (width < 16) {
+    cfl_luma_subsampling_420_hbd_ssse3(input, input_stride, output_q3, width,
+                                       height);
+    return;
+  }
+  for (int j = 0; j < height; j++) {
+    for (int i = 0; i < width; i += 16) {
+      const __m256i top = sum_pairs_hbd_avx2(input + 2 * i);
+      const __m256i bot = sum_pairs_hbd_avx2(input + 2 * i + input_stride);
+      _mm256_storeu_si256((__m256i *)(output_q3 + i),
+                          _mm256_slli_epi16(_mm256_add_epi16(top, bot), 1));
+    }
+    input += input_stride << 1;
+    output_q3 += CFL_PRED_BUF_LINE;
+  }
+}
+
+void cfl_luma_subsampling_422_hbd_avx2(const uint16_t *input, int input_stride,
+                                       int16_t *output_q3, int width,
+                                       int height) {
+  if (width < 16) {
+    cfl_luma_subsampling_422_hbd_ssse3(input, input_stride, output_q3, width,
+                                       height);
+    return;
+  }
+  for (int j = 0; j < height; j++) {
+    for (int i = 0; i < width; i += 16) {
+      const __m256i sum = sum_pairs_hbd_avx2(input + 2 * i);
+      _mm256_storeu_si256((__m256i *)(output_q3 + i),
+                          _mm256_slli_epi16(sum, 2));
+    }
+    input += input_stride;
+    output_q3 += CFL_PRED_BUF_LINE;
+  }
+}
+
+void cfl_luma_subsampling_440_hbd_avx2(const uint16_t *input, int input_stride,
+                                       int16_t *output_q3, int width,
+                                       int height) {
+  if (width < 16) {
+    cfl_luma_subsampling_440_hbd_sse2(input, input_stride, output_q3, width,
+                                      height);
+    return;
+  }
+  for (int j = 0; j < height; j++) {
+    for (int i = 0; i < width; i += 16) {
+      const __m256i top = _mm256_loadu_si256((const __m256i *)(input + i));
+      const __m256i bot =
+          _mm256_loadu_si256((const __m256i *)(input + i + input_stride));
+      _mm256_storeu_si256((__m256i *)(output_q3 + i),
+                          _mm256_slli_epi16(_mm256_add_epi16(top, bot), 2));
+    }
+    input += input_stride << 1;
+    output_q3 += CFL_PRED_BUF_LINE;
+  }
+}
+
+void cfl_luma_subsampling_444_hbd_avx2(const uint16_t *input, int input_stride,
+                                       int16_t *output_q3, int width,
+                                       int height) {
+  if (width < 16) {
+    cfl_luma_subsampling_444_hbd_sse2(input, input_stride, output_q3, width,
+                                      height);
+    return;
+  }
+  for (int j = 0; j < height; j++) {
+    for (int i = 0; i < width; i += 16) {
+      const __m256i luma = _mm256_loadu_si256((const __m256i *)(input + i));
+      _mm256_storeu_si256((__m256i *)(output_q3 + i),
+                          _mm256_slli_epi16(luma, 3));
+    }
+    input += input_stride;
+    output_q3 += CFL_PRED_BUF_LINE;
+  }
+}
+
+void cfl_build_prediction_hbd_avx2(const int16_t *pred_buf_q3, uint16_t *dst,
+                                   int dst_stride, int width, int height,
+                                   int alpha_q3, int bit_depth) {
+  if (width < 16) {
+    cfl_build_prediction_hbd_ssse3(pred_buf_q3, dst, dst_stride, width, height,
+                                   alpha_q3, bit_depth);
+    return;
+  }
+  const __m256i alpha_q12 = _mm256_set1_epi16(abs(alpha_q3) << 9);
+  const __m256i alpha_sign = _mm256_set1_epi16(alpha_q3);
+  const __m256i max = _mm256_set1_epi16((1 << bit_depth) - 1);
+  const __m256i zero = _mm256_setzero_si256();
+
+  for (int j = 0; j < height; j++) {
+    for (int i = 0; i < width; i += 16) {
+      const __m256i ac =
+          _mm256_loadu_si256((const __m256i *)(pred_buf_q3 + i));
+      const __m256i scaled = scale_luma_avx2(ac, alpha_q12, alpha_sign);
+      __m256i *const p = (__m256i *)(dst + i);
+      const __m256i sum = _mm256_add_epi16(_mm256_loadu_si256(p), scaled);
+      _mm256_storeu_si256(
+          p, _mm256_min_epi16(_mm256_max_epi16(sum, zero), max));
+    }
+    dst += dst_stride;
+    pred_buf_q3 += CFL_PRED_BUF_LINE;
+  }
+}
+#endif  // CONFIG_HIGHBITDEPTH
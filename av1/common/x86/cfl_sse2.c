@@ -0,0 +1,282 @@
+/*
+ * Copyright (c) 2017, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <emmintrin.h>
+
+#include "./av1_rtcd.h"
+#include "av1/common/cfl.h"
+
+// Loads 2, 4 or 8 int16_t elements depending on width.
+static INLINE __m128i load_q3_sse2(const int16_t *p, int width) {
+  if (width >= 8) return _mm_loadu_si128((const __m128i *)p);
+  if (width == 4) return _mm_loadl_epi64((const __m128i *)p);
+  return _mm_cvtsi32_si128(*(const int32_t *)p);
+}
+
+// Stores 2, 4 or 8 int16_t elements depending on width.
+static INLINE void store_q3_sse2(int16_t *p, __m128i v, int width) {
+  if (width >= 8)
+    _mm_storeu_si128((__m128i *)p, v);
+  else if (width == 4)
+    _mm_storel_epi64((__m128i *)p, v);
+  else
+    *(int32_t *)p = _mm_cvtsi128_si32(v);
+}
+
+// Loads 4, 8 or 16 bytes, the luma needed for width horizontally subsampled
+// outputs.
+static INLINE __m128i load_luma_x2_sse2(const uint8_t *p, int width) {
+  if (width >= 8) return _mm_loadu_si128((const __m128i *)p);
+  if (width == 4) return _mm_loadl_epi64((const __m128i *)p);
+  return _mm_cvtsi32_si128(*(const int32_t *)p);
+}
+
+// Loads up to 8 bytes and widens them to int16_t.
+static INLINE __m128i load_luma_sse2(const uint8_t *p, int width) {
+  const __m128i zero = _mm_setzero_si128();
+  if (width >= 8)
+    return _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)p), zero);
+  return _mm_unpacklo_epi8(_mm_cvtsi32_si128(*(const int32_t *)p), zero);
+}
+
+// Sums each pair of horizontally adjacent bytes into an int16_t.
+static INLINE __m128i sum_pairs_epu8(__m128i a) {
+  const __m128i mask = _mm_set1_epi16(0xff);
+  return _mm_add_epi16(_mm_and_si128(a, mask), _mm_srli_epi16(a, 8));
+}
+
+void cfl_subtract_average_sse2(int16_t *pred_buf_q3, int width, int height,
+                               int num_pel_log2) {
+  const __m128i ones = _mm_set1_epi16(1);
+  __m128i sum = _mm_setzero_si128();
+  int16_t *row = pred_buf_q3;
+
+  for (int j = 0; j < height; j++) {
+    for (int i = 0; i < width; i += 8) {
+      const __m128i v = load_q3_sse2(row + i, width);
+      sum = _mm_add_epi32(sum, _mm_madd_epi16(v, ones));
+    }
+    row += CFL_PRED_BUF_LINE;
+  }
+  sum = _mm_add_epi32(sum, _mm_srli_si128(sum, 8));
+  sum = _mm_add_epi32(sum, _mm_srli_si128(sum, 4));
+  const int sum_q3 = _mm_cvtsi128_si32(sum);
+  const int avg_q3 = (sum_q3 + (1 << (num_pel_log2 - 1))) >> num_pel_log2;
+
+  const __m128i avg = _mm_set1_epi16(avg_q3);
+  row = pred_buf_q3;
+  for (int j = 0; j < height; j++) {
+    for (int i = 0; i < width; i += 8) {
+      const __m128i v = load_q3_sse2(row + i, width);
+      store_q3_sse2(row + i, _mm_sub_epi16(v, avg), width);
+    }
+    row += CFL_PRED_BUF_LINE;
+  }
+}
+
+void cfl_luma_subsampling_420_lbd_sse2(const uint8_t *input, int input_stride,
+                                       int16_t *output_q3, int width,
+                                       int height) {
+  for (int j = 0; j < height; j++) {
+    for (int i = 0; i < width; i += 8) {
+      const __m128i top = load_luma_x2_sse2(input + 2 * i, width);
+      const __m128i bot =
+          load_luma_x2_sse2(input + 2 * i + input_stride, width);
+      const __m128i sum =
+          _mm_add_epi16(sum_pairs_epu8(top), sum_pairs_epu8(bot));
+      store_q3_sse2(output_q3 + i, _mm_slli_epi16(sum, 1), width);
+    }
+    input += input_stride << 1;
+    output_q3 += CFL_PRED_BUF_LINE;
+  }
+}
+
+void cfl_luma_subsampling_422_lbd_sse2(const uint8_t *input, int input_stride,
+                                       int16_t *output_q3, int width,
+                                       int height) {
+  for (int j = 0; j < height; j++) {
+    for (int i = 0; i < width; i += 8) {
+      const __m128i sum =
+          sum_pairs_epu8(load_luma_x2_sse2(input + 2 * i, width));
+      store_q3_sse2(output_q3 + i, _mm_slli_epi16(sum, 2), width);
+    }
+    input += input_stride;
+    output_q3 += CFL_PRED_BUF_LINE;
+  }
+}
+
+void cfl_luma_subsampling_440_lbd_sse2(const uint8_t *input, int input_stride,
+                                       int16_t *output_q3, int width,
+                                       int height) {
+  for (int j = 0; j < height; j++) {
+    for (int i = 0; i < width; i += 8) {
+      const __m128i top = load_luma_sse2(input + i, width);
+      const __m128i bot = load_luma_sse2(input + i + input_stride, width);
+      store_q3_sse2(output_q3 + i, _mm_slli_epi16(_mm_add_epi16(top, bot), 2),
+                    width);
+    }
+    input += input_stride << 1;
+    output_q3 += CFL_PRED_BUF_LINE;
+  }
+}
+
+void cfl_luma_subsampling_444_lbd_sse2(const uint8_t *input, int input_stride,
+                                       int16_t *output_q3, int width,
+                                       int height) {
+  for (int j = 0; j < height; j++) {
+    for (int i = 0; i < width; i += 8) {
+      const __m128i luma = load_luma_sse2(input + i, width);
+      store_q3_sse2(output_q3 + i, _mm_slli_epi16(luma, 3), width);
+    }
+    input += input_stride;
+    output_q3 += CFL_PRED_BUF_LINE;
+  }
+}
+
+// Computes ROUND_POWER_OF_TWO_SIGNED(alpha_q3 * ac_q3, 6) for 8 values.
+// alpha_q10 holds abs(alpha_q3) << 10, so the high half of the product is the
+// truncated result and bit 15 of the low half is the rounding bit.
+static INLINE __m128i scale_luma_sse2(__m128i ac_q3, __m128i alpha_q10,
+                                      __m128i alpha_sign) {
+  const __m128i abs_ac_q3 =
+      _mm_max_epi16(ac_q3, _mm_sub_epi16(_mm_setzero_si128(), ac_q3));
+  const __m128i hi = _mm_mulhi_epu16(abs_ac_q3, alpha_q10);
+  const __m128i round =
+      _mm_srli_epi16(_mm_mullo_epi16(abs_ac_q3, alpha_q10), 15);
+  const __m128i abs_scaled = _mm_add_epi16(hi, round);
+  const __m128i sign = _mm_srai_epi16(_mm_xor_si128(ac_q3, alpha_sign), 15);
+  return _mm_sub_epi16(_mm_xor_si128(abs_scaled, sign), sign);
+}
+
+void cfl_build_prediction_lbd_sse2(const int16_t *pred_buf_q3, uint8_t *dst,
+                                   int dst_stride, int width, int height,
+                                   int alpha_q3) {
+  const __m128i alpha_q10 = _mm_set1_epi16(abs(alpha_q3) << 10);
+  const __m128i alpha_sign = _mm_set1_epi16(alpha_q3);
+  const __m128i zero = _mm_setzero_si128();
+
+  for (int j = 0; j < height; j++) {
+    for (int i = 0; i < width; i += 8) {
+      const __m128i ac = load_q3_sse2(pred_buf_q3 + i, width);
+      const __m128i scaled = scale_luma_sse2(ac, alpha_q10, alpha_sign);
+      if (width >= 8) {
+        const __m128i d =
+            _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i *)(dst + i)), zero);
+        const __m128i res = _mm_packus_epi16(_mm_add_epi16(d, scaled), zero);
+        _mm_storel_epi64((__m128i *)(dst + i), res);
+      } else {
+        const __m128i d =
+            _mm_unpacklo_epi8(_mm_cvtsi32_si128(*(int32_t *)dst), zero);
+        const __m128i res = _mm_packus_epi16(_mm_add_epi16(d, scaled), zero);
+        *(int32_t *)dst = _mm_cvtsi128_si32(res);
+      }
+    }
+    dst += dst_stride;
+    pred_buf_q3 += CFL_PRED_BUF_LINE;
+  }
+}
+
+#if CONFIG_HIGHBITDEPTH
+// Loads the 2 * width luma samples needed for width horizontally subsampled
+// outputs and sums each adjacent pair. At most 8 outputs are produced.
+static INLINE __m128i sum_pairs_hbd_sse2(const uint16_t *p, int width) {
+  const __m128i ones = _mm_set1_epi16(1);
+  if (width >= 8) {
+    const __m128i lo = _mm_loadu_si128((const __m128i *)p);
+    const __m128i hi = _mm_loadu_si128((const __m128i *)(p + 8));
+    return _mm_packs_epi32(_mm_madd_epi16(lo, ones), _mm_madd_epi16(hi, ones));
+  }
+  const __m128i v = (width == 4) ? _mm_loadu_si128((const __m128i *)p)
+                                 : _mm_loadl_epi64((const __m128i *)p);
+  const __m128i sum = _mm_madd_epi16(v, ones);
+  return _mm_packs_epi32(sum, sum);
+}
+
+void cfl_luma_subsampling_420_hbd_sse2(const uint16_t *input, int input_stride,
+                                       int16_t *output_q3, int width,
+                                       int height) {
+  for (int j = 0; j < height; j++) {
+    for (int i = 0; i < width; i += 8) {
+      const __m128i top = sum_pairs_hbd_sse2(input + 2 * i, width);
+      const __m128i bot =
+          sum_pairs_hbd_sse2(input + 2 * i + input_stride, width);
+      store_q3_sse2(output_q3 + i, _mm_slli_epi16(_mm_add_epi16(top, bot), 1),
+                    width);
+    }
+    input += input_stride << 1;
+    output_q3 += CFL_PRED_BUF_LINE;
+  }
+}
+
+void cfl_luma_subsampling_422_hbd_sse2(const uint16_t *input, int input_stride,
+                                       int16_t *output_q3, int width,
+                                       int height) {
+  for (int j = 0; j < height; j++) {
+    for (int i = 0; i < width; i += 8) {
+      const __m128i sum = sum_pairs_hbd_sse2(input + 2 * i, width);
+      store_q3_sse2(output_q3 + i, _mm_slli_epi16(sum, 2), width);
+    }
+    input += input_stride;
+    output_q3 += CFL_PRED_BUF_LINE;
+  }
+}
+
+void cfl_luma_subsampling_440_hbd_sse2(const uint16_t *input, int input_stride,
+                                       int16_t *output_q3, int width,
+                                       int height) {
+  for (int j = 0; j < height; j++) {
+    for (int i = 0; i < width; i += 8) {
+      const __m128i top = load_q3_sse2((const int16_t *)(input + i), width);
+      const __m128i bot =
+          load_q3_sse2((const int16_t *)(input + i + input_stride), width);
+      store_q3_sse2(output_q3 + i, _mm_slli_epi16(_mm_add_epi16(top, bot), 2),
+                    width);
+    }
+    input += input_stride << 1;
+    output_q3 += CFL_PRED_BUF_LINE;
+  }
+}
+
+void cfl_luma_subsampling_444_hbd_sse2(const uint16_t *input, int input_stride,
+                                       int16_t *output_q3, int width,
+                                       int height) {
+  for (int j = 0; j < height; j++) {
+    for (int i = 0; i < width; i += 8) {
+      const __m128i luma = load_q3_sse2((const int16_t *)(input + i), width);
+      store_q3_sse2(output_q3 + i, _mm_slli_epi16(luma, 3), width);
+    }
+    input += input_stride;
+    output_q3 += CFL_PRED_BUF_LINE;
+  }
+}
+
+void cfl_build_prediction_hbd_sse2(const int16_t *pred_buf_q3, uint16_t *dst,
+                                   int dst_stride, int width, int height,
+                                   int alpha_q3, int bit_depth) {
+  const __m128i alpha_q10 = _mm_set1_epi16(abs(alpha_q3) << 10);
+  const __m128i alpha_sign = _mm_set1_epi16(alpha_q3);
+  const __m128i max = _mm_set1_epi16((1 << bit_depth) - 1);
+  const __m128i zero = _mm_setzero_si128();
+
+  for (int j = 0; j < height; j++) {
+    for (int i = 0; i < width; i += 8) {
+      const __m128i ac = load_q3_sse2(pred_buf_q3 + i, width);
+      const __m128i scaled = scale_luma_sse2(ac, alpha_q10, alpha_sign);
+      const __m128i d = load_q3_sse2((const int16_t *)(dst + i), width);
+      const __m128i res =
+          _mm_min_epi16(_mm_max_epi16(_mm_add_epi16(d, scaled), zero), max);
+      store_q3_sse2((int16_t *)(dst + i), res, width);
+    }
+    dst += dst_stride;
+    pred_buf_q3 += CFL_PRED_BUF_LINE;
+  }
+}
+#endif  // CONFIG_HIGHBITDEPTH
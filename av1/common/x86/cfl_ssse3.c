@@ -0,0 +1,190 @@
+/*
+ * Copyright (c) 2017, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <tmmintrin.h>
+
+#include "./av1_rtcd.h"
+#include "av1/common/cfl.h"
+
+// Stores 2, 4 or 8 int16_t elements depending on width.
+static INLINE void store_q3_ssse3(int16_t *p, __m128i v, int width) {
+  if (width >= 8)
+    _mm_storeu_si128((__m128i *)p, v);
+  else if (width == 4)
+    _mm_storel_epi64((__m128i *)p, v);
+  else
+    *(int32_t *)p = _mm_cvtsi128_si32(v);
+}
+
+// Loads the 2 * width luma samples needed for width horizontally subsampled
+// outputs and sums each adjacent pair. At most 8 outputs are produced.
+static INLINE __m128i sum_pairs_lbd_ssse3(const uint8_t *p, int width) {
+  const __m128i ones = _mm_set1_epi8(1);
+  __m128i v;
+  if (width >= 8)
+    v = _mm_loadu_si128((const __m128i *)p);
+  else if (width == 4)
+    v = _mm_loadl_epi64((const __m128i *)p);
+  else
+    v = _mm_cvtsi32_si128(*(const int32_t *)p);
+  return _mm_maddubs_epi16(v, ones);
+}
+
+void cfl_luma_subsampling_420_lbd_ssse3(const uint8_t *input, int input_stride,
+                                        int16_t *output_q3, int width,
+                                        int height) {
+  for (int j = 0; j < height; j++) {
+    for (int i = 0; i < width; i += 8) {
+      const __m128i top = sum_pairs_lbd_ssse3(input + 2 * i, width);
+      const __m128i bot =
+          sum_pairs_lbd_ssse3(input + 2 * i + input_stride, width);
+      store_q3_ssse3(output_q3 + i, _mm_slli_epi16(_mm_add_epi16(top, bot), 1),
+                     width);
+    }
+    input += input_stride << 1;
+    output_q3 += CFL_PRED_BUF_LINE;
+  }
+}
+
+void cfl_luma_subsampling_422_lbd_ssse3(const uint8_t *input, int input_stride,
+                                        int16_t *output_q3, int width,
+                                        int height) {
+  for (int j = 0; j < height; j++) {
+    for (int i = 0; i < width; i += 8) {
+      const __m128i sum = sum_pairs_lbd_ssse3(input + 2 * i, width);
+      store_q3_ssse3(output_q3 + i, _mm_slli_epi16(sum, 2), width);
+    }
+    input += input_stride;
+    output_q3 += CFL_PRED_BUF_LINE;
+  }
+}
+
+// Computes ROUND_POWER_OF_TWO_SIGNED(alpha_q3 * ac_q3, 6) for 8 values.
+// alpha_q12 holds abs(alpha_q3) << 9 so that _mm_mulhrs_epi16() performs the
+// rounding shift by 6 on the magnitude; the sign is restored afterwards.
+static INLINE __m128i scale_luma_ssse3(__m128i ac_q3, __m128i alpha_q12,
+                                       __m128i alpha_sign) {
+  const __m128i abs_scaled = _mm_mulhrs_epi16(_mm_abs_epi16(ac_q3), alpha_q12);
+  return _mm_sign_epi16(_mm_sign_epi16(abs_scaled, ac_q3), alpha_sign);
+}
+
+void cfl_build_prediction_lbd_ssse3(const int16_t *pred_buf_q3, uint8_t *dst,
+                                    int dst_stride, int width, int height,
+                                    int alpha_q3) {
+  const __m128i alpha_q12 = _mm_set1_epi16(abs(alpha_q3) << 9);
+  const __m128i alpha_sign = _mm_set1_epi16(alpha_q3);
+  const __m128i zero = _mm_setzero_si128();
+
+  if (width == 4) {
+    for (int j = 0; j < height; j++) {
+      const __m128i ac = _mm_loadl_epi64((const __m128i *)pred_buf_q3);
+      const __m128i scaled = scale_luma_ssse3(ac, alpha_q12, alpha_sign);
+      const __m128i d =
+          _mm_unpacklo_epi8(_mm_cvtsi32_si128(*(int32_t *)dst), zero);
+      const __m128i res = _mm_packus_epi16(_mm_add_epi16(d, scaled), zero);
+      *(int32_t *)dst = _mm_cvtsi128_si32(res);
+      dst += dst_stride;
+      pred_buf_q3 += CFL_PRED_BUF_LINE;
+    }
+    return;
+  }
+  for (int j = 0; j < height; j++) {
+    for (int i = 0; i < width; i += 8) {
+      const __m128i ac = _mm_loadu_si128((const __m128i *)(pred_buf_q3 + i));
+      const __m128i scaled = scale_luma_ssse3(ac, alpha_q12, alpha_sign);
+      const __m128i d =
+          _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i *)(dst + i)), zero);
+      const __m128i res = _mm_packus_epi16(_mm_add_epi16(d, scaled), zero);
+      _mm_storel_epi64((__m128i *)(dst + i), res);
+    }
+    dst += dst_stride;
+    pred_buf_q3 += CFL_PRED_BUF_LINE;
+  }
+}
+
+#if CONFIG_HIGHBITDEPTH
+// Loads the 2 * width luma samples needed for width horizontally subsampled
+// outputs and sums each adjacent pair. At most 8 outputs are produced.
+static INLINE __m128i sum_pairs_hbd_ssse3(const uint16_t *p, int width) {
+  if (width >= 8) {
+    const __m128i lo = _mm_loadu_si128((const __m128i *)p);
+    const __m128i hi = _mm_loadu_si128((const __m128i *)(p + 8));
+    return _mm_hadd_epi16(lo, hi);
+  }
+  const __m128i v = (width == 4) ? _mm_loadu_si128((const __m128i *)p)
+                                 : _mm_loadl_epi64((const __m128i *)p);
+  return _mm_hadd_epi16(v, v);
+}
+
+void cfl_luma_subsampling_420_hbd_ssse3(const uint16_t *input,
+                                        int input_stride, int16_t *output_q3,
+                                        int width, int height) {
+  for (int j = 0; j < height; j++) {
+    for (int i = 0; i < width; i += 8) {
+      const __m128i top = sum_pairs_hbd_ssse3(input + 2 * i, width);
+      const __m128i bot =
+          sum_pairs_hbd_ssse3(input + 2 * i + input_stride, width);
+      store_q3_ssse3(output_q3 + i, _mm_slli_epi16(_mm_add_epi16(top, bot), 1),
+                     width);
+    }
+    input += input_stride << 1;
+    output_q3 += CFL_PRED_BUF_LINE;
+  }
+}
+
+void cfl_luma_subsampling_422_hbd_ssse3(const uint16_t *input,
+                                        int input_stride, int16_t *output_q3,
+                                        int width, int height) {
+  for (int j = 0; j < height; j++) {
+    for (int i = 0; i < width; i += 8) {
+      const __m128i sum = sum_pairs_hbd_ssse3(input + 2 * i, width);
+      store_q3_ssse3(output_q3 + i, _mm_slli_epi16(sum, 2), width);
+    }
+    input += input_stride;
+    output_q3 += CFL_PRED_BUF_LINE;
+  }
+}
+
+void cfl_build_prediction_hbd_ssse3(const int16_t *pred_buf_q3, uint16_t *dst,
+                                    int dst_stride, int width, int height,
+                                    int alpha_q3, int bit_depth) {
+  const __m128i alpha_q12 = _mm_set1_epi16(abs(alpha_q3) << 9);
+  const __m128i alpha_sign = _mm_set1_epi16(alpha_q3);
+  const __m128i max = _mm_set1_epi16((1 << bit_depth) - 1);
+  const __m128i zero = _mm_setzero_si128();
+
+  if (width == 4) {
+    for (int j = 0; j < height; j++) {
+      const __m128i ac = _mm_loadl_epi64((const __m128i *)pred_buf_q3);
+      const __m128i scaled = scale_luma_ssse3(ac, alpha_q12, alpha_sign);
+      const __m128i d = _mm_loadl_epi64((const __m128i *)dst);
+      const __m128i res =
+          _mm_min_epi16(_mm_max_epi16(_mm_add_epi16(d, scaled), zero), max);
+      _mm_storel_epi64((__m128i *)dst, res);
+      dst += dst_stride;
+      pred_buf_q3 += CFL_PRED_BUF_LINE;
+    }
+    return;
+  }
+  for (int j = 0; j < height; j++) {
+    for (int i = 0; i < width; i += 8) {
+      const __m128i ac = _mm_loadu_si128((const __m128i *)(pred_buf_q3 + i));
+      const __m128i scaled = scale_luma_ssse3(ac, alpha_q12, alpha_sign);
+      const __m128i d = _mm_loadu_si128((const __m128i *)(dst + i));
+      const __m128i res =
+          _mm_min_epi16(_mm_max_epi16(_mm_add_epi16(d, scaled), zero), max);
+      _mm_storeu_si128((__m128i *)(dst + i), res);
+    }
+    dst += dst_stride;
+    pred_buf_q3 += CFL_PRED_BUF_LINE;
+  }
+}
+#endif  // CONFIG_HIGHBITDEPTH
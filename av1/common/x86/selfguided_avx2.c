@@ -0,0 +1,445 @@
+/*
+ * Copyright (c) 2017, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <immintrin.h>
+
+#include "./aom_config.h"
+#include "./av1_rtcd.h"
+#include "av1/common/restoration.h"
+
+// The AVX2 kernels follow the structure of selfguided_sse4.c, but work on 8
+// 32-bit values at a time. Rows of the A, B, C and D buffers are not 32-byte
+// aligned, so all accesses to them are unaligned.
+
+static INLINE __m256i yy_loadu_256(const void *p) {
+  return _mm256_loadu_si256((const __m256i *)p);
+}
+
+static INLINE void yy_storeu_256(void *p, __m256i v) {
+  _mm256_storeu_si256((__m256i *)p, v);
+}
+
+// Load 8 bytes from the possibly-misaligned pointer p, extend each byte to
+// 32-bit precision and return them in an AVX2 register.
+static __m256i yy_load_extend_8_32(const void *p) {
+  return _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)p));
+}
+
+#if CONFIG_HIGHBITDEPTH
+// Load 8 halfwords from the possibly-misaligned pointer p, extend each
+// halfword to 32-bit precision and return them in an AVX2 register.
+static __m256i yy_load_extend_16_32(const void *p) {
+  return _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)p));
+}
+#endif  // CONFIG_HIGHBITDEPTH
+
+// Compute the scan of an AVX2 register holding 8 32-bit integers. If the
+// register holds x0..x7 then the scan will hold x0, x0+x1, x0+x1+x2, ...,
+// x0+...+x7
+static __m256i scan_32(__m256i x) {
+  // Scan each 128-bit lane independently, then add the total of the low lane
+  // to every element of the high lane.
+  const __m256i x01 = _mm256_add_epi32(x, _mm256_slli_si256(x, 4));
+  const __m256i x0123 = _mm256_add_epi32(x01, _mm256_slli_si256(x01, 8));
+  const __m256i lo = _mm256_permute2x128_si256(x0123, x0123, 0x08);
+  return _mm256_add_epi32(x0123, _mm256_shuffle_epi32(lo, 0xff));
+}
+
+// Broadcast the last 32-bit element of x to all eight lanes.
+static __m256i broadcast_last_32(__m256i x) {
+  return _mm256_permutevar8x32_epi32(x, _mm256_set1_epi32(7));
+}
+
+// Compute two integral images from src. B sums elements; A sums their
+// squares. The images are offset by one pixel, so will have width and height
+// equal to width + 1, height + 1 and the first row and column will be zero.
+//
+// buf_stride should be a multiple of 8.
+static void integral_images(const uint8_t *src, int src_stride, int width,
+                            int height, int32_t *A, int32_t *B,
+                            int buf_stride) {
+  // Write out the zero top row
+  memset(A, 0, sizeof(*A) * (width + 1));
+  memset(B, 0, sizeof(*B) * (width + 1));
+
+  const __m256i zero = _mm256_setzero_si256();
+  for (int i = 0; i < height; ++i) {
+    // Zero the left column.
+    A[(i + 1) * buf_stride] = B[(i + 1) * buf_stride] = 0;
+
+    // ldiff is the difference H - D where H is the output sample immediately
+    // to the left and D is the output sample above it. These are scalars,
+    // replicated across the eight lanes.
+    __m256i ldiff1 = zero, ldiff2 = zero;
+    for (int j = 0; j < width; j += 8) {
+      const int ABj = 1 + j;
+
+      const __m256i above1 = yy_loadu_256(B + ABj + i * buf_stride);
+      const __m256i above2 = yy_loadu_256(A + ABj + i * buf_stride);
+
+      const __m256i x1 = yy_load_extend_8_32(src + j + i * src_stride);
+      const __m256i x2 = _mm256_madd_epi16(x1, x1);
+
+      const __m256i sc1 = scan_32(x1);
+      const __m256i sc2 = scan_32(x2);
+
+      const __m256i row1 =
+          _mm256_add_epi32(_mm256_add_epi32(sc1, above1), ldiff1);
+      const __m256i row2 =
+          _mm256_add_epi32(_mm256_add_epi32(sc2, above2), ldiff2);
+
+      yy_storeu_256(B + ABj + (i + 1) * buf_stride, row1);
+      yy_storeu_256(A + ABj + (i + 1) * buf_stride, row2);
+
+      // Calculate the new H - D.
+      ldiff1 = broadcast_last_32(_mm256_sub_epi32(row1, above1));
+      ldiff2 = broadcast_last_32(_mm256_sub_epi32(row2, above2));
+    }
+  }
+}
+
+#if CONFIG_HIGHBITDEPTH
+// Compute two integral images from src. B sums elements; A sums their squares
+//
+// buf_stride should be a multiple of 8.
+static void integral_images_highbd(const uint16_t *src, int src_stride,
+                                   int width, int height, int32_t *A,
+                                   int32_t *B, int buf_stride) {
+  // Write out the zero top row
+  memset(A, 0, sizeof(*A) * (width + 1));
+  memset(B, 0, sizeof(*B) * (width + 1));
+
+  const __m256i zero = _mm256_setzero_si256();
+  for (int i = 0; i < height; ++i) {
+    // Zero the left column.
+    A[(i + 1) * buf_stride] = B[(i + 1) * buf_stride] = 0;
+
+    // ldiff is the difference H - D where H is the output sample immediately
+    // to the left and D is the output sample above it. These are scalars,
+    // replicated across the eight lanes.
+    __m256i ldiff1 = zero, ldiff2 = zero;
+    for (int j = 0; j < width; j += 8) {
+      const int ABj = 1 + j;
+
+      const __m256i above1 = yy_loadu_256(B + ABj + i * buf_stride);
+      const __m256i above2 = yy_loadu_256(A + ABj + i * buf_stride);
+
+      const __m256i x1 = yy_load_extend_16_32(src + j + i * src_stride);
+      const __m256i x2 = _mm256_madd_epi16(x1, x1);
+
+      const __m256i sc1 = scan_32(x1);
+      const __m256i sc2 = scan_32(x2);
+
+      const __m256i row1 =
+          _mm256_add_epi32(_mm256_add_epi32(sc1, above1), ldiff1);
+      const __m256i row2 =
+          _mm256_add_epi32(_mm256_add_epi32(sc2, above2), ldiff2);
+
+      yy_storeu_256(B + ABj + (i + 1) * buf_stride, row1);
+      yy_storeu_256(A + ABj + (i + 1) * buf_stride, row2);
+
+      // Calculate the new H - D.
+      ldiff1 = broadcast_last_32(_mm256_sub_epi32(row1, above1));
+      ldiff2 = broadcast_last_32(_mm256_sub_epi32(row2, above2));
+    }
+  }
+}
+#endif  // CONFIG_HIGHBITDEPTH
+
+// Compute eight values of boxsum from the given integral image. ii should
+// point at the middle of the box (for the first value). r is the box radius
+static __m256i boxsum_from_ii(const int32_t *ii, int stride, int r) {
+  const __m256i tl = yy_loadu_256(ii - (r + 1) - (r + 1) * stride);
+  const __m256i tr = yy_loadu_256(ii + (r + 0) - (r + 1) * stride);
+  const __m256i bl = yy_loadu_256(ii - (r + 1) + r * stride);
+  const __m256i br = yy_loadu_256(ii + (r + 0) + r * stride);
+  const __m256i u = _mm256_sub_epi32(tr, tl);
+  const __m256i v = _mm256_sub_epi32(br, bl);
+  return _mm256_sub_epi32(v, u);
+}
+
+static __m256i round_for_shift(unsigned shift) {
+  return _mm256_set1_epi32((1 << shift) >> 1);
+}
+
+static __m256i compute_p(__m256i sum1, __m256i sum2, int bit_depth, int n) {
+  __m256i an, bb;
+  if (bit_depth > 8) {
+    const __m256i rounding_a = round_for_shift(2 * (bit_depth - 8));
+    const __m256i rounding_b = round_for_shift(bit_depth - 8);
+    const __m128i shift_a = _mm_cvtsi32_si128(2 * (bit_depth - 8));
+    const __m128i shift_b = _mm_cvtsi32_si128(bit_depth - 8);
+    const __m256i a =
+        _mm256_srl_epi32(_mm256_add_epi32(sum2, rounding_a), shift_a);
+    const __m256i b =
+        _mm256_srl_epi32(_mm256_add_epi32(sum1, rounding_b), shift_b);
+    // b < 2^14, so we can use a 16-bit madd rather than a 32-bit
+    // mullo to square it
+    bb = _mm256_madd_epi16(b, b);
+    an = _mm256_max_epi32(_mm256_mullo_epi32(a, _mm256_set1_epi32(n)), bb);
+  } else {
+    bb = _mm256_madd_epi16(sum1, sum1);
+    an = _mm256_mullo_epi32(sum2, _mm256_set1_epi32(n));
+  }
+  return _mm256_sub_epi32(an, bb);
+}
+
+// Assumes that C, D are integral images for the original buffer which has been
+// extended to have a padding of SGRPROJ_BORDER_VERT/SGRPROJ_BORDER_HORZ pixels
+// on the sides. A, B, C, D point at logical position (0, 0).
+static void calc_ab(int32_t *A, int32_t *B, const int32_t *C, const int32_t *D,
+                    int width, int height, int buf_stride, int eps,
+                    int bit_depth, int r) {
+  const int n = (2 * r + 1) * (2 * r + 1);
+  const __m256i s = _mm256_set1_epi32(sgrproj_mtable[eps - 1][n - 1]);
+  // one_over_n[n-1] is 2^12/n, so easily fits in an int16
+  const __m256i one_over_n = _mm256_set1_epi32(one_by_x[n - 1]);
+
+  const __m256i rnd_z = round_for_shift(SGRPROJ_MTABLE_BITS);
+  const __m256i rnd_res = round_for_shift(SGRPROJ_RECIP_BITS);
+
+  for (int i = -1; i < height + 1; ++i) {
+    for (int j0 = -1; j0 < width + 1; j0 += 8) {
+      const int32_t *Cij = C + i * buf_stride + j0;
+      const int32_t *Dij = D + i * buf_stride + j0;
+
+      const __m256i pre_sum1 = boxsum_from_ii(Dij, buf_stride, r);
+      const __m256i pre_sum2 = boxsum_from_ii(Cij, buf_stride, r);
+
+#if CONFIG_DEBUG
+      // When width + 2 isn't a multiple of eight, the upper lanes of z are
+      // computed from uninitialised data. This is harmless (the gather below
+      // only uses indices in [0, 255] and the results land in locations we
+      // don't read again), but mask it so that Valgrind doesn't complain
+      // about an uninitialised value being used as a load address.
+      const __m256i mask =
+          _mm256_cmpgt_epi32(_mm256_set1_epi32(width + 1 - j0),
+                             _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+      const __m256i sum1 = _mm256_and_si256(mask, pre_sum1);
+      const __m256i sum2 = _mm256_and_si256(mask, pre_sum2);
+#else
+      const __m256i sum1 = pre_sum1;
+      const __m256i sum2 = pre_sum2;
+#endif  // CONFIG_DEBUG
+
+      const __m256i p = compute_p(sum1, sum2, bit_depth, n);
+
+      const __m256i z = _mm256_min_epi32(
+          _mm256_srli_epi32(_mm256_add_epi32(_mm256_mullo_epi32(p, s), rnd_z),
+                            SGRPROJ_MTABLE_BITS),
+          _mm256_set1_epi32(255));
+
+      const __m256i a_res =
+          _mm256_i32gather_epi32((const int *)x_by_xplus1, z, 4);
+
+      yy_storeu_256(A + i * buf_stride + j0, a_res);
+
+      const __m256i a_complement =
+          _mm256_sub_epi32(_mm256_set1_epi32(SGRPROJ_SGR), a_res);
+
+      // sum1 might have lanes greater than 2^15, so we can't use madd to do
+      // multiplication involving sum1. However, a_complement and one_over_n
+      // are both less than 256, so we can multiply them first.
+      const __m256i a_comp_over_n = _mm256_madd_epi16(a_complement, one_over_n);
+      const __m256i b_int = _mm256_mullo_epi32(a_comp_over_n, sum1);
+      const __m256i b_res = _mm256_srli_epi32(
+          _mm256_add_epi32(b_int, rnd_res), SGRPROJ_RECIP_BITS);
+
+      yy_storeu_256(B + i * buf_stride + j0, b_res);
+    }
+  }
+}
+
+// Calculate 8 values of the "cross sum" starting at buf. This is a 3x3 filter
+// where the outer four corners have weight 3 and all other pixels have weight
+// 4.
+static __m256i cross_sum(const int32_t *buf, int stride) {
+  const __m256i a_l = yy_loadu_256(buf - 1 - stride);
+  const __m256i a_c = yy_loadu_256(buf - stride);
+  const __m256i a_r = yy_loadu_256(buf + 1 - stride);
+  const __m256i b_l = yy_loadu_256(buf - 1);
+  const __m256i b_c = yy_loadu_256(buf);
+  const __m256i b_r = yy_loadu_256(buf + 1);
+  const __m256i c_l = yy_loadu_256(buf - 1 + stride);
+  const __m256i c_c = yy_loadu_256(buf + stride);
+  const __m256i c_r = yy_loadu_256(buf + 1 + stride);
+
+  const __m256i fours = _mm256_add_epi32(
+      _mm256_add_epi32(_mm256_add_epi32(b_l, b_c), _mm256_add_epi32(b_r, a_c)),
+      c_c);
+  const __m256i threes = _mm256_add_epi32(_mm256_add_epi32(a_l, a_r),
+                                          _mm256_add_epi32(c_l, c_r));
+
+  return _mm256_sub_epi32(_mm256_slli_epi32(_mm256_add_epi32(fours, threes), 2),
+                          threes);
+}
+
+// The final filter for selfguided restoration. Computes a weighted average
+// across A, B with "cross sums" (see cross_sum implementation above)
+static void final_filter(int32_t *dst, int dst_stride, const int32_t *A,
+                         const int32_t *B, int buf_stride, const void *dgd8,
+                         int dgd_stride, int width, int height, int highbd) {
+  const int nb = 5;
+  const __m256i rounding =
+      round_for_shift(SGRPROJ_SGR_BITS + nb - SGRPROJ_RST_BITS);
+  const uint8_t *dgd_real =
+      highbd ? (const uint8_t *)CONVERT_TO_SHORTPTR(dgd8) : dgd8;
+
+  for (int i = 0; i < height; ++i) {
+    for (int j = 0; j < width; j += 8) {
+      const __m256i a = cross_sum(A + i * buf_stride + j, buf_stride);
+      const __m256i b = cross_sum(B + i * buf_stride + j, buf_stride);
+      const uint8_t *dgd_ij = dgd_real + ((i * dgd_stride + j) << highbd);
+      const __m256i src = highbd ? _mm256_cvtepu16_epi32(_mm_loadu_si128(
+                                       (const __m128i *)dgd_ij))
+                                 : yy_load_extend_8_32(dgd_ij);
+
+      const __m256i v = _mm256_add_epi32(_mm256_madd_epi16(a, src), b);
+      const __m256i w =
+          _mm256_srai_epi32(_mm256_add_epi32(v, rounding),
+                            SGRPROJ_SGR_BITS + nb - SGRPROJ_RST_BITS);
+
+      yy_storeu_256(dst + i * dst_stride + j, w);
+    }
+  }
+}
+
+void av1_selfguided_restoration_avx2(const uint8_t *dgd8, int width,
+                                     int height, int dgd_stride, int32_t *flt1,
+                                     int32_t *flt2, int flt_stride,
+                                     const sgr_params_type *params,
+                                     int bit_depth, int highbd) {
+  DECLARE_ALIGNED(32, int32_t, buf[4 * RESTORATION_PROC_UNIT_PELS]);
+  memset(buf, 0, sizeof(buf));
+
+  const int width_ext = width + 2 * SGRPROJ_BORDER_HORZ;
+  const int height_ext = height + 2 * SGRPROJ_BORDER_VERT;
+
+  // Adjusting the stride of A and B here appears to avoid bad cache effects,
+  // leading to a significant speed improvement.
+  // We also align the stride to a multiple of 32 bytes for efficiency.
+  int buf_stride = ((width_ext + 7) & ~7) + 16;
+
+  // The "tl" pointers point at the top-left of the initialised data for the
+  // array.
+  int32_t *Atl = buf + 0 * RESTORATION_PROC_UNIT_PELS + 3;
+  int32_t *Btl = buf + 1 * RESTORATION_PROC_UNIT_PELS + 3;
+  int32_t *Ctl = buf + 2 * RESTORATION_PROC_UNIT_PELS + 3;
+  int32_t *Dtl = buf + 3 * RESTORATION_PROC_UNIT_PELS + 3;
+
+  // The "0" pointers are (- SGRPROJ_BORDER_VERT, -SGRPROJ_BORDER_HORZ). Note
+  // there's a zero row and column in A, B (integral images), so we move down
+  // and right one for them.
+  const int buf_diag_border =
+      SGRPROJ_BORDER_HORZ + buf_stride * SGRPROJ_BORDER_VERT;
+
+  int32_t *A0 = Atl + 1 + buf_stride;
+  int32_t *B0 = Btl + 1 + buf_stride;
+  int32_t *C0 = Ctl + 1 + buf_stride;
+  int32_t *D0 = Dtl + 1 + buf_stride;
+
+  // Finally, A, B, C, D point at position (0, 0).
+  int32_t *A = A0 + buf_diag_border;
+  int32_t *B = B0 + buf_diag_border;
+  int32_t *C = C0 + buf_diag_border;
+  int32_t *D = D0 + buf_diag_border;
+
+  const int dgd_diag_border =
+      SGRPROJ_BORDER_HORZ + dgd_stride * SGRPROJ_BORDER_VERT;
+  const uint8_t *dgd0 = dgd8 - dgd_diag_border;
+
+// Generate integral images from the input. C will contain sums of squares; D
+// will contain just sums
+#if CONFIG_HIGHBITDEPTH
+  if (highbd)
+    integral_images_highbd(CONVERT_TO_SHORTPTR(dgd0), dgd_stride, width_ext,
+                           height_ext, Ctl, Dtl, buf_stride);
+  else
+#endif  // CONFIG_HIGHBITDEPTH
+    integral_images(dgd0, dgd_stride, width_ext, height_ext, Ctl, Dtl,
+                    buf_stride);
+
+  // Write to flt1 and flt2
+  for (int i = 0; i < 2; ++i) {
+    int r = i ? params->r2 : params->r1;
+    int e = i ? params->e2 : params->e1;
+    int32_t *flt = i ? flt2 : flt1;
+
+    assert(r + 1 <= AOMMIN(SGRPROJ_BORDER_VERT, SGRPROJ_BORDER_HORZ));
+    calc_ab(A, B, C, D, width, height, buf_stride, e, bit_depth, r);
+    final_filter(flt, flt_stride, A, B, buf_stride, dgd8, dgd_stride, width,
+                 height, highbd);
+  }
+}
+
+void apply_selfguided_restoration_avx2(const uint8_t *dat8, int width,
+                                       int height, int stride, int eps,
+                                       const int *xqd, uint8_t *dst8,
+                                       int dst_stride, int32_t *tmpbuf,
+                                       int bit_depth, int highbd) {
+  int32_t *flt1 = tmpbuf;
+  int32_t *flt2 = flt1 + RESTORATION_TILEPELS_MAX;
+  assert(width * height <= RESTORATION_TILEPELS_MAX);
+  av1_selfguided_restoration_avx2(dat8, width, height, stride, flt1, flt2,
+                                  width, &sgr_params[eps], bit_depth, highbd);
+
+  int xq[2];
+  decode_xq(xqd, xq);
+
+  const __m256i xq0 = _mm256_set1_epi32(xq[0]);
+  const __m256i xq1 = _mm256_set1_epi32(xq[1]);
+  const __m256i rounding = round_for_shift(SGRPROJ_PRJ_BITS + SGRPROJ_RST_BITS);
+
+  for (int i = 0; i < height; ++i) {
+    // Calculate output in batches of 8 pixels
+    for (int j = 0; j < width; j += 8) {
+      const int k = i * width + j;
+      const int m = i * dst_stride + j;
+
+      const uint8_t *dat8ij = dat8 + i * stride + j;
+      __m256i src;
+      if (highbd) {
+        src = _mm256_cvtepu16_epi32(
+            _mm_loadu_si128((const __m128i *)CONVERT_TO_SHORTPTR(dat8ij)));
+      } else {
+        src = yy_load_extend_8_32(dat8ij);
+      }
+
+      const __m256i u = _mm256_slli_epi32(src, SGRPROJ_RST_BITS);
+      const __m256i f1 = _mm256_sub_epi32(yy_loadu_256(&flt1[k]), u);
+      const __m256i f2 = _mm256_sub_epi32(yy_loadu_256(&flt2[k]), u);
+
+      const __m256i v =
+          _mm256_add_epi32(_mm256_add_epi32(_mm256_mullo_epi32(xq0, f1),
+                                            _mm256_mullo_epi32(xq1, f2)),
+                           _mm256_slli_epi32(u, SGRPROJ_PRJ_BITS));
+      const __m256i w = _mm256_srai_epi32(_mm256_add_epi32(v, rounding),
+                                          SGRPROJ_PRJ_BITS + SGRPROJ_RST_BITS);
+
+      if (highbd) {
+        // Pack into 16 bits and clamp to [0, 2^bit_depth). The pack works
+        // within each 128-bit lane, so gather the results into the low lane.
+        const __m256i tmp = _mm256_permute4x64_epi64(
+            _mm256_packus_epi32(w, w), _MM_SHUFFLE(0, 0, 2, 0));
+        const __m128i max = _mm_set1_epi16((1 << bit_depth) - 1);
+        const __m128i res = _mm_min_epi16(_mm256_castsi256_si128(tmp), max);
+        _mm_storeu_si128((__m128i *)CONVERT_TO_SHORTPTR(dst8 + m), res);
+      } else {
+        // Pack into 8 bits and clamp to [0, 256)
+        const __m256i tmp = _mm256_permute4x64_epi64(_mm256_packs_epi32(w, w),
+                                                     _MM_SHUFFLE(0, 0, 2, 0));
+        const __m128i tmp16 = _mm256_castsi256_si128(tmp);
+        const __m128i res = _mm_packus_epi16(tmp16, tmp16);
+        _mm_storel_epi64((__m128i *)(dst8 + m), res);
+      }
+    }
+  }
+}
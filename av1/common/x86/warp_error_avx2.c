@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2017, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <immintrin.h>
+
+#include "./av1_rtcd.h"
+#include "av1/common/warped_motion.h"
+
+// Looks up the error of 16 pixel differences at a time in
+// av1_error_measure_lut.
+// Each 32-bit lane adds up two errors of at most 16384 for every 16 pixels of
+// a row, so the sums are only widened to 64 bits at the end of each row.
+int64_t av1_calc_frame_error_avx2(const uint8_t *const ref, int stride,
+                                  const uint8_t *const dst, int p_width,
+                                  int p_height, int p_stride) {
+  const __m256i offset = _mm256_set1_epi16(255);
+  __m256i sum = _mm256_setzero_si256();
+  int64_t sum_error = 0;
+  int i, j;
+
+  for (i = 0; i < p_height; ++i) {
+    const uint8_t *const r = ref + i * stride;
+    const uint8_t *const d = dst + i * p_stride;
+    __m256i row_sum = _mm256_setzero_si256();
+    for (j = 0; j + 16 <= p_width; j += 16) {
+      const __m256i r16 =
+          _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(r + j)));
+      const __m256i d16 =
+          _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(d + j)));
+      const __m256i idx = _mm256_add_epi16(_mm256_sub_epi16(d16, r16), offset);
+      const __m256i idx_lo = _mm256_cvtepu16_epi32(_mm256_castsi256_si128(idx));
+      const __m256i idx_hi =
+          _mm256_cvtepu16_epi32(_mm256_extracti128_si256(idx, 1));
+      row_sum = _mm256_add_epi32(
+          row_sum, _mm256_i32gather_epi32(av1_error_measure_lut, idx_lo, 4));
+      row_sum = _mm256_add_epi32(
+          row_sum, _mm256_i32gather_epi32(av1_error_measure_lut, idx_hi, 4));
+    }
+    for (; j < p_width; ++j)
+      sum_error += av1_error_measure_lut[255 + d[j] - r[j]];
+    sum = _mm256_add_epi64(
+        sum, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(row_sum)));
+    sum = _mm256_add_epi64(
+        sum, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(row_sum, 1)));
+  }
+
+  {
+    int64_t sums[2];
+    _mm_storeu_si128((__m128i *)sums,
+                     _mm_add_epi64(_mm256_castsi256_si128(sum),
+                                   _mm256_extracti128_si256(sum, 1)));
+    return sum_error + sums[0] + sums[1];
+  }
+}
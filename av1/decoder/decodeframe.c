@@ -145,6 +145,58 @@ static REFERENCE_MODE read_frame_reference_mode(
   }
 }
 
+// Stages of decode_token_and_recon_block(). Serial decoding runs both at
+// once; row-based multi-threaded decoding parses a superblock into a
+// DecSbBuffer on one thread and reconstructs it later on another.
+#define DEC_PARSE 1
+#define DEC_RECON 2
+#define DEC_PARSE_AND_RECON (DEC_PARSE | DEC_RECON)
+
+// Moves the coefficients of a parsed transform block from the coefficient
+// buffer of |plane| to the buffered superblock, packed up to the last nonzero
+// one, and clears them for the next transform block.
+static void store_sb_tx_block(DecSbBuffer *const sb, MACROBLOCKD *const xd,
+                              int plane, int eob, int16_t max_scan_line) {
+  DecEobInfo *const eob_info = &sb->eob_info[plane][sb->eob_pos[plane]++];
+  eob_info->eob = eob;
+  eob_info->max_scan_line = max_scan_line;
+  if (eob) {
+    tran_low_t *const dqcoeff = xd->plane[plane].dqcoeff;
+    const int n = max_scan_line + 1;
+    memcpy(sb->dqcoeff[plane] + sb->dqcoeff_pos[plane], dqcoeff,
+           n * sizeof(*dqcoeff));
+    memset(dqcoeff, 0, n * sizeof(*dqcoeff));
+    sb->dqcoeff_pos[plane] += n;
+  }
+}
+
+// Unpacks the next transform block of the buffered superblock into the
+// coefficient buffer of |plane|, which inverse_transform_block() clears.
+static void load_sb_tx_block(DecSbBuffer *const sb, MACROBLOCKD *const xd,
+                             int plane, int *eob, int16_t *max_scan_line) {
+  const DecEobInfo *const eob_info =
+      &sb->eob_info[plane][sb->eob_pos[plane]++];
+  *eob = eob_info->eob;
+  *max_scan_line = eob_info->max_scan_line;
+  if (*eob) {
+    const int n = *max_scan_line + 1;
+    memcpy(xd->plane[plane].dqcoeff,
+           sb->dqcoeff[plane] + sb->dqcoeff_pos[plane],
+           n * sizeof(*sb->dqcoeff[plane]));
+    sb->dqcoeff_pos[plane] += n;
+  }
+}
+
+static void next_sb_color_index_map(DecSbBuffer *const sb,
+                                    MACROBLOCKD *const xd, int plane,
+                                    BLOCK_SIZE bsize) {
+  struct macroblockd_plane *const pd = &xd->plane[plane];
+  pd->color_index_map =
+      sb->color_index_map[plane] + sb->color_index_pos[plane];
+  sb->color_index_pos[plane] += (block_size_wide[bsize] >> pd->subsampling_x) *
+                                (block_size_high[bsize] >> pd->subsampling_y);
+}
+
 static void inverse_transform_block(MACROBLOCKD *xd, int plane,
                                     const TX_TYPE tx_type,
                                     const TX_SIZE tx_size, uint8_t *dst,
@@ -159,39 +211,47 @@ static void inverse_transform_block(MACROBLOCKD *xd, int plane,
 
 static void predict_and_reconstruct_intra_block(
     AV1_COMMON *cm, MACROBLOCKD *const xd, aom_reader *const r,
-    MB_MODE_INFO *const mbmi, int plane, int row, int col, TX_SIZE tx_size) {
+    MB_MODE_INFO *const mbmi, int plane, int row, int col, TX_SIZE tx_size,
+    DecSbBuffer *const sb, int stage) {
   PLANE_TYPE plane_type = get_plane_type(plane);
-  av1_predict_intra_block_facade(cm, xd, plane, col, row, tx_size);
+  if (stage & DEC_RECON)
+    av1_predict_intra_block_facade(cm, xd, plane, col, row, tx_size);
 
   if (!mbmi->skip) {
     struct macroblockd_plane *const pd = &xd->plane[plane];
+    int16_t max_scan_line = 0;
+    int eob;
+    if (stage & DEC_PARSE) {
 #if TXCOEFF_TIMER
-    struct aom_usec_timer timer;
-    aom_usec_timer_start(&timer);
+      struct aom_usec_timer timer;
+      aom_usec_timer_start(&timer);
 #endif
 #if CONFIG_LV_MAP
-    int16_t max_scan_line = 0;
-    int eob;
-    av1_read_coeffs_txb_facade(cm, xd, r, row, col, plane, tx_size,
-                               &max_scan_line, &eob);
-    // tx_type will be read out in av1_read_coeffs_txb_facade
-    const TX_TYPE tx_type = av1_get_tx_type(plane_type, xd, row, col, tx_size);
+      av1_read_coeffs_txb_facade(cm, xd, r, row, col, plane, tx_size,
+                                 &max_scan_line, &eob);
 #else   // CONFIG_LV_MAP
-    const TX_TYPE tx_type = av1_get_tx_type(plane_type, xd, row, col, tx_size);
-    const SCAN_ORDER *scan_order = get_scan(cm, tx_size, tx_type, mbmi);
-    int16_t max_scan_line = 0;
-    const int eob =
-        av1_decode_block_tokens(cm, xd, plane, scan_order, col, row, tx_size,
-                                tx_type, &max_scan_line, r, mbmi->segment_id);
+      const TX_TYPE tx_type =
+          av1_get_tx_type(plane_type, xd, row, col, tx_size);
+      const SCAN_ORDER *scan_order = get_scan(cm, tx_size, tx_type, mbmi);
+      eob = av1_decode_block_tokens(cm, xd, plane, scan_order, col, row,
+                                    tx_size, tx_type, &max_scan_line, r,
+                                    mbmi->segment_id);
 #endif  // CONFIG_LV_MAP
 
 #if TXCOEFF_TIMER
-    aom_usec_timer_mark(&timer);
-    const int64_t elapsed_time = aom_usec_timer_elapsed(&timer);
-    cm->txcoeff_timer += elapsed_time;
-    ++cm->txb_count;
+      aom_usec_timer_mark(&timer);
+      const int64_t elapsed_time = aom_usec_timer_elapsed(&timer);
+      cm->txcoeff_timer += elapsed_time;
+      ++cm->txb_count;
 #endif
-    if (eob) {
+      if (sb != NULL) store_sb_tx_block(sb, xd, plane, eob, max_scan_line);
+    } else {
+      load_sb_tx_block(sb, xd, plane, &eob, &max_scan_line);
+    }
+    if ((stage & DEC_RECON) && eob) {
+      // With CONFIG_LV_MAP, tx_type is read out in av1_read_coeffs_txb_facade
+      const TX_TYPE tx_type =
+          av1_get_tx_type(plane_type, xd, row, col, tx_size);
       uint8_t *dst =
           &pd->dst.buf[(row * pd->dst.stride + col) << tx_size_wide_log2[0]];
       inverse_transform_block(xd, plane, tx_type, tx_size, dst, pd->dst.stride,
@@ -199,7 +259,8 @@ static void predict_and_reconstruct_intra_block(
     }
   }
 #if CONFIG_CFL
-  if (plane == AOM_PLANE_Y && xd->cfl.store_y && is_cfl_allowed(mbmi)) {
+  if ((stage & DEC_RECON) && plane == AOM_PLANE_Y && xd->cfl.store_y &&
+      is_cfl_allowed(mbmi)) {
     cfl_store_tx(xd, row, col, tx_size, mbmi->sb_type);
   }
 #endif  // CONFIG_CFL
@@ -210,7 +271,8 @@ static void decode_reconstruct_tx(AV1_COMMON *cm, MACROBLOCKD *const xd,
                                   int plane, BLOCK_SIZE plane_bsize,
                                   int blk_row, int blk_col, int block,
                                   TX_SIZE tx_size, int *eob_total, int mi_row,
-                                  int mi_col) {
+                                  int mi_col, DecSbBuffer *const sb,
+                                  int stage) {
   (void)mi_row;
   (void)mi_col;
   const struct macroblockd_plane *const pd = &xd->plane[plane];
@@ -232,49 +294,54 @@ static void decode_reconstruct_tx(AV1_COMMON *cm, MACROBLOCKD *const xd,
 #endif  // DISABLE_VARTX_FOR_CHROMA
       ) {
     PLANE_TYPE plane_type = get_plane_type(plane);
+    int16_t max_scan_line = 0;
+    int eob;
+    if (stage & DEC_PARSE) {
 #if TXCOEFF_TIMER
-    struct aom_usec_timer timer;
-    aom_usec_timer_start(&timer);
+      struct aom_usec_timer timer;
+      aom_usec_timer_start(&timer);
 #endif
 #if CONFIG_LV_MAP
-    int16_t max_scan_line = 0;
-    int eob;
-    av1_read_coeffs_txb_facade(cm, xd, r, blk_row, blk_col, plane, tx_size,
-                               &max_scan_line, &eob);
-    // tx_type will be read out in av1_read_coeffs_txb_facade
-    const TX_TYPE tx_type =
-        av1_get_tx_type(plane_type, xd, blk_row, blk_col, tx_size);
+      av1_read_coeffs_txb_facade(cm, xd, r, blk_row, blk_col, plane, tx_size,
+                                 &max_scan_line, &eob);
 #else   // CONFIG_LV_MAP
-    const TX_TYPE tx_type =
-        av1_get_tx_type(plane_type, xd, blk_row, blk_col, tx_size);
-    const SCAN_ORDER *sc = get_scan(cm, tx_size, tx_type, mbmi);
-    int16_t max_scan_line = 0;
-    const int eob =
-        av1_decode_block_tokens(cm, xd, plane, sc, blk_col, blk_row, tx_size,
-                                tx_type, &max_scan_line, r, mbmi->segment_id);
+      const TX_TYPE tx_type =
+          av1_get_tx_type(plane_type, xd, blk_row, blk_col, tx_size);
+      const SCAN_ORDER *sc = get_scan(cm, tx_size, tx_type, mbmi);
+      eob = av1_decode_block_tokens(cm, xd, plane, sc, blk_col, blk_row,
+                                    tx_size, tx_type, &max_scan_line, r,
+                                    mbmi->segment_id);
 #endif  // CONFIG_LV_MAP
 
 #if TXCOEFF_TIMER
-    aom_usec_timer_mark(&timer);
-    const int64_t elapsed_time = aom_usec_timer_elapsed(&timer);
-    cm->txcoeff_timer += elapsed_time;
-    ++cm->txb_count;
+      aom_usec_timer_mark(&timer);
+      const int64_t elapsed_time = aom_usec_timer_elapsed(&timer);
+      cm->txcoeff_timer += elapsed_time;
+      ++cm->txb_count;
 #endif
+      if (sb != NULL) store_sb_tx_block(sb, xd, plane, eob, max_scan_line);
+    } else {
+      load_sb_tx_block(sb, xd, plane, &eob, &max_scan_line);
+    }
 
-    uint8_t *dst =
-        &pd->dst
-             .buf[(blk_row * pd->dst.stride + blk_col) << tx_size_wide_log2[0]];
-    inverse_transform_block(xd, plane, tx_type, tx_size, dst, pd->dst.stride,
-                            max_scan_line, eob, cm->reduced_tx_set_used);
+    if (stage & DEC_RECON) {
+      // With CONFIG_LV_MAP, tx_type is read out in av1_read_coeffs_txb_facade
+      const TX_TYPE tx_type =
+          av1_get_tx_type(plane_type, xd, blk_row, blk_col, tx_size);
+      uint8_t *dst = &pd->dst.buf[(blk_row * pd->dst.stride + blk_col)
+                                  << tx_size_wide_log2[0]];
+      inverse_transform_block(xd, plane, tx_type, tx_size, dst, pd->dst.stride,
+                              max_scan_line, eob, cm->reduced_tx_set_used);
 #if CONFIG_MISMATCH_DEBUG
-    int pixel_c, pixel_r;
-    int blk_w = block_size_wide[bsize];
-    int blk_h = block_size_high[bsize];
-    mi_to_pixel_loc(&pixel_c, &pixel_r, mi_col, mi_row, blk_col, blk_row,
-                    pd->subsampling_x, pd->subsampling_y);
-    mismatch_check_block_tx(dst, pd->dst.stride, plane, pixel_c, pixel_r, blk_w,
-                            blk_h);
+      int pixel_c, pixel_r;
+      int blk_w = block_size_wide[bsize];
+      int blk_h = block_size_high[bsize];
+      mi_to_pixel_loc(&pixel_c, &pixel_r, mi_col, mi_row, blk_col, blk_row,
+                      pd->subsampling_x, pd->subsampling_y);
+      mismatch_check_block_tx(dst, pd->dst.stride, plane, pixel_c, pixel_r,
+                              blk_w, blk_h);
 #endif
+    }
     *eob_total += eob;
   } else {
     const TX_SIZE sub_txs = sub_tx_size_map[1][tx_size];
@@ -295,41 +362,25 @@ static void decode_reconstruct_tx(AV1_COMMON *cm, MACROBLOCKD *const xd,
 
         decode_reconstruct_tx(cm, xd, r, mbmi, plane, plane_bsize, offsetr,
                               offsetc, block, sub_txs, eob_total, mi_row,
-                              mi_col);
+                              mi_col, sb, stage);
         block += sub_step;
       }
     }
   }
 }
 
-static void set_offsets(AV1_COMMON *const cm, MACROBLOCKD *const xd,
-                        BLOCK_SIZE bsize, int mi_row, int mi_col, int bw,
-                        int bh, int x_mis, int y_mis) {
-  const int offset = mi_row * cm->mi_stride + mi_col;
+// Sets up xd for a block whose mode info is already in the mode info grid.
+static void set_recon_offsets(AV1_COMMON *const cm, MACROBLOCKD *const xd,
+                              BLOCK_SIZE bsize, int mi_row, int mi_col, int bw,
+                              int bh) {
   const TileInfo *const tile = &xd->tile;
 
-  xd->mi = cm->mi_grid_visible + offset;
-  xd->mi[0] = &cm->mi[offset];
-  // TODO(slavarnway): Generate sb_type based on bwl and bhl, instead of
-  // passing bsize from decode_partition().
-  xd->mi[0]->mbmi.sb_type = bsize;
-#if CONFIG_RD_DEBUG
-  xd->mi[0]->mbmi.mi_row = mi_row;
-  xd->mi[0]->mbmi.mi_col = mi_col;
-#endif
+  xd->mi = cm->mi_grid_visible + mi_row * cm->mi_stride + mi_col;
 #if CONFIG_CFL
   xd->cfl.mi_row = mi_row;
   xd->cfl.mi_col = mi_col;
 #endif
 
-  assert(x_mis && y_mis);
-  for (int x = 1; x < x_mis; ++x) xd->mi[x] = xd->mi[0];
-  int idx = cm->mi_stride;
-  for (int y = 1; y < y_mis; ++y) {
-    memcpy(&xd->mi[idx], &xd->mi[0], x_mis * sizeof(xd->mi[0]));
-    idx += cm->mi_stride;
-  }
-
   set_plane_n4(xd, bw, bh);
   set_skip_context(xd, mi_row, mi_col);
 
@@ -345,6 +396,32 @@ static void set_offsets(AV1_COMMON *const cm, MACROBLOCKD *const xd,
                        mi_col);
 }
 
+static void set_offsets(AV1_COMMON *const cm, MACROBLOCKD *const xd,
+                        BLOCK_SIZE bsize, int mi_row, int mi_col, int bw,
+                        int bh, int x_mis, int y_mis) {
+  const int offset = mi_row * cm->mi_stride + mi_col;
+  MODE_INFO **const mi = cm->mi_grid_visible + offset;
+
+  mi[0] = &cm->mi[offset];
+  // TODO(slavarnway): Generate sb_type based on bwl and bhl, instead of
+  // passing bsize from decode_partition().
+  mi[0]->mbmi.sb_type = bsize;
+#if CONFIG_RD_DEBUG
+  mi[0]->mbmi.mi_row = mi_row;
+  mi[0]->mbmi.mi_col = mi_col;
+#endif
+
+  assert(x_mis && y_mis);
+  for (int x = 1; x < x_mis; ++x) mi[x] = mi[0];
+  int idx = cm->mi_stride;
+  for (int y = 1; y < y_mis; ++y) {
+    memcpy(&mi[idx], &mi[0], x_mis * sizeof(mi[0]));
+    idx += cm->mi_stride;
+  }
+
+  set_recon_offsets(cm, xd, bsize, mi_row, mi_col, bw, bh);
+}
+
 static void decode_mbmi_block(AV1Decoder *const pbi, MACROBLOCKD *const xd,
                               int mi_row, int mi_col, aom_reader *r,
 #if CONFIG_EXT_PARTITION_TYPES
@@ -377,25 +454,88 @@ static void decode_mbmi_block(AV1Decoder *const pbi, MACROBLOCKD *const xd,
   aom_merge_corrupted_flag(&xd->corrupted, reader_corrupted_flag);
 }
 
+// Frame parallel decoding: the last luma row of ref_frame the prediction of a
+// block with motion vector mv may read, or INT_MAX if the whole frame is
+// needed. Rows are counted from the top of the frame as the filter worker
+// publishes them, with the extent of the interpolation filters on top.
+static int get_ref_row_bound(const AV1_COMMON *cm, const MACROBLOCKD *xd,
+                             const MB_MODE_INFO *mbmi,
+                             MV_REFERENCE_FRAME ref_frame, MV mv, int mi_row,
+                             int bh) {
+  const RefBuffer *const ref_buf = &cm->frame_refs[ref_frame - LAST_FRAME];
+  const int row =
+      (mi_row + bh) * MI_SIZE + (AOMMAX(mv.row, 0) >> SUBPEL_BITS) + 1;
+
+  if (av1_is_scaled(&ref_buf->sf) || mbmi->motion_mode != SIMPLE_TRANSLATION ||
+      xd->global_motion[ref_frame].wmtype > TRANSLATION)
+    return INT_MAX;
+  return row + 2 * AOM_INTERP_EXTEND;
+}
+
+// Waits until the reference rows the inter prediction of the block reads are
+// final. Sub8x8 chroma is predicted with the motion vectors of the blocks
+// above and to the left too, as in build_inter_predictors(), when the block
+// carries the chroma of its 8x8.
+static void wait_for_ref_rows(AV1Decoder *const pbi, MACROBLOCKD *const xd,
+                              int mi_row, int mi_col, BLOCK_SIZE bsize) {
+  AV1_COMMON *const cm = &pbi->common;
+  RefCntBuffer *const frame_bufs = cm->buffer_pool->frame_bufs;
+  const int bh = mi_size_high[bsize];
+  const int chroma_ref = is_chroma_reference(mi_row, mi_col, bsize,
+                                             cm->subsampling_x,
+                                             cm->subsampling_y);
+  const int row_start =
+      chroma_ref && (block_size_high[bsize] == 4) && cm->subsampling_y ? -1
+                                                                        : 0;
+  const int col_start =
+      chroma_ref && (block_size_wide[bsize] == 4) && cm->subsampling_x ? -1
+                                                                        : 0;
+
+  for (int row = row_start; row <= 0; ++row) {
+    for (int col = col_start; col <= 0; ++col) {
+      const MB_MODE_INFO *const mbmi = &xd->mi[row * xd->mi_stride + col]->mbmi;
+      if (!is_inter_block(mbmi)) continue;
+      for (int ref = 0; ref < 1 + has_second_ref(mbmi); ++ref) {
+        const MV_REFERENCE_FRAME frame = mbmi->ref_frame[ref];
+        if (frame < LAST_FRAME) continue;
+        av1_frame_progress_wait(
+            pbi, &frame_bufs[cm->frame_refs[frame - LAST_FRAME].idx],
+            get_ref_row_bound(cm, xd, mbmi, frame, mbmi->mv[ref].as_mv, mi_row,
+                              bh));
+      }
+    }
+  }
+}
+
+// Parses the palette color indices and coefficients of a block (DEC_PARSE)
+// and/or predicts and reconstructs it (DEC_RECON). When sb is not NULL the
+// parsed data goes through the superblock buffer instead of xd.
 static void decode_token_and_recon_block(AV1Decoder *const pbi,
                                          MACROBLOCKD *const xd, int mi_row,
                                          int mi_col, aom_reader *r,
-                                         BLOCK_SIZE bsize) {
+                                         BLOCK_SIZE bsize,
+                                         DecSbBuffer *const sb, int stage) {
   AV1_COMMON *const cm = &pbi->common;
   const int bw = mi_size_wide[bsize];
   const int bh = mi_size_high[bsize];
   const int x_mis = AOMMIN(bw, cm->mi_cols - mi_col);
   const int y_mis = AOMMIN(bh, cm->mi_rows - mi_row);
 
-  set_offsets(cm, xd, bsize, mi_row, mi_col, bw, bh, x_mis, y_mis);
+  if (stage & DEC_PARSE)
+    set_offsets(cm, xd, bsize, mi_row, mi_col, bw, bh, x_mis, y_mis);
+  else
+    set_recon_offsets(cm, xd, bsize, mi_row, mi_col, bw, bh);
   MB_MODE_INFO *mbmi = &xd->mi[0]->mbmi;
 #if CONFIG_CFL
   CFL_CTX *const cfl = &xd->cfl;
   cfl->is_chroma_reference = is_chroma_reference(
       mi_row, mi_col, bsize, cfl->subsampling_x, cfl->subsampling_y);
+  // av1_read_mode_info() sets store_y on the parsing MACROBLOCKD.
+  if (!(stage & DEC_PARSE) && !is_inter_block(mbmi))
+    cfl->store_y = !cfl->is_chroma_reference || mbmi->uv_mode == UV_CFL_PRED;
 #endif  // CONFIG_CFL
 
-  if (cm->delta_q_present_flag) {
+  if ((stage & DEC_PARSE) && cm->delta_q_present_flag) {
     for (int i = 0; i < MAX_SEGMENTS; i++) {
 #if CONFIG_EXT_DELTA_Q
       const int current_qindex =
@@ -416,13 +556,16 @@ static void decode_token_and_recon_block(AV1Decoder *const pbi,
       }
     }
   }
-  if (mbmi->skip) av1_reset_skip_context(xd, mi_row, mi_col, bsize);
+  if ((stage & DEC_PARSE) && mbmi->skip)
+    av1_reset_skip_context(xd, mi_row, mi_col, bsize);
 
   if (!is_inter_block(mbmi)) {
     const int num_planes = av1_num_planes(cm);
     for (int plane = 0; plane < AOMMIN(2, num_planes); ++plane) {
-      if (mbmi->palette_mode_info.palette_size[plane])
-        av1_decode_palette_tokens(xd, plane, r);
+      if (mbmi->palette_mode_info.palette_size[plane]) {
+        if (sb != NULL) next_sb_color_index_map(sb, xd, plane, bsize);
+        if (stage & DEC_PARSE) av1_decode_palette_tokens(xd, plane, r);
+      }
     }
 
     for (int plane = 0; plane < num_planes; ++plane) {
@@ -454,52 +597,57 @@ static void decode_token_and_recon_block(AV1Decoder *const pbi,
           for (blk_row = row; blk_row < unit_height; blk_row += stepr)
             for (blk_col = col; blk_col < unit_width; blk_col += stepc)
               predict_and_reconstruct_intra_block(cm, xd, r, mbmi, plane,
-                                                  blk_row, blk_col, tx_size);
+                                                  blk_row, blk_col, tx_size,
+                                                  sb, stage);
         }
       }
     }
   } else {
-    for (int ref = 0; ref < 1 + has_second_ref(mbmi); ++ref) {
-      const MV_REFERENCE_FRAME frame = mbmi->ref_frame[ref];
-      if (frame < LAST_FRAME) {
+    if (stage & DEC_RECON) {
+      for (int ref = 0; ref < 1 + has_second_ref(mbmi); ++ref) {
+        const MV_REFERENCE_FRAME frame = mbmi->ref_frame[ref];
+        if (frame < LAST_FRAME) {
 #if CONFIG_INTRABC
-        assert(is_intrabc_block(mbmi));
-        assert(frame == INTRA_FRAME);
-        assert(ref == 0);
+          assert(is_intrabc_block(mbmi));
+          assert(frame == INTRA_FRAME);
+          assert(ref == 0);
 #else
-        assert(0);
+          assert(0);
 #endif  // CONFIG_INTRABC
-      } else {
-        RefBuffer *ref_buf = &cm->frame_refs[frame - LAST_FRAME];
-
-        xd->block_refs[ref] = ref_buf;
-        if ((!av1_is_valid_scale(&ref_buf->sf)))
-          aom_internal_error(xd->error_info, AOM_CODEC_UNSUP_BITSTREAM,
-                             "Reference frame has invalid dimensions");
-        av1_setup_pre_planes(xd, ref, ref_buf->buf, mi_row, mi_col,
-                             &ref_buf->sf);
+        } else {
+          RefBuffer *ref_buf = &cm->frame_refs[frame - LAST_FRAME];
+
+          xd->block_refs[ref] = ref_buf;
+          if ((!av1_is_valid_scale(&ref_buf->sf)))
+            aom_internal_error(xd->error_info, AOM_CODEC_UNSUP_BITSTREAM,
+                               "Reference frame has invalid dimensions");
+          av1_setup_pre_planes(xd, ref, ref_buf->buf, mi_row, mi_col,
+                               &ref_buf->sf);
+        }
       }
-    }
 
-    av1_build_inter_predictors_sb(cm, xd, mi_row, mi_col, NULL, bsize);
+      if (pbi->frame_parallel_decode)
+        wait_for_ref_rows(pbi, xd, mi_row, mi_col, bsize);
+      av1_build_inter_predictors_sb(cm, xd, mi_row, mi_col, NULL, bsize);
 
-    if (mbmi->motion_mode == OBMC_CAUSAL) {
-      av1_build_obmc_inter_predictors_sb(cm, xd, mi_row, mi_col);
-    }
+      if (mbmi->motion_mode == OBMC_CAUSAL) {
+        av1_build_obmc_inter_predictors_sb(cm, xd, mi_row, mi_col);
+      }
 
 #if CONFIG_MISMATCH_DEBUG
-    for (int plane = 0; plane < 3; ++plane) {
-      const struct macroblockd_plane *pd = &xd->plane[plane];
-      int pixel_c, pixel_r;
-      mi_to_pixel_loc(&pixel_c, &pixel_r, mi_col, mi_row, 0, 0,
-                      pd->subsampling_x, pd->subsampling_y);
-      if (!is_chroma_reference(mi_row, mi_col, bsize, pd->subsampling_x,
-                               pd->subsampling_y))
-        continue;
-      mismatch_check_block_pre(pd->dst.buf, pd->dst.stride, plane, pixel_c,
-                               pixel_r, pd->width, pd->height);
-    }
+      for (int plane = 0; plane < 3; ++plane) {
+        const struct macroblockd_plane *pd = &xd->plane[plane];
+        int pixel_c, pixel_r;
+        mi_to_pixel_loc(&pixel_c, &pixel_r, mi_col, mi_row, 0, 0,
+                        pd->subsampling_x, pd->subsampling_y);
+        if (!is_chroma_reference(mi_row, mi_col, bsize, pd->subsampling_x,
+                                 pd->subsampling_y))
+          continue;
+        mismatch_check_block_pre(pd->dst.buf, pd->dst.stride, plane, pixel_c,
+                                 pixel_r, pd->width, pd->height);
+      }
 #endif
+    }
 
     // Reconstruction
     if (!mbmi->skip) {
@@ -556,7 +704,7 @@ static void decode_token_and_recon_block(AV1Decoder *const pbi,
               for (blk_col = col; blk_col < unit_width; blk_col += bw_var_tx) {
                 decode_reconstruct_tx(cm, xd, r, mbmi, plane, plane_bsize,
                                       blk_row, blk_col, block, max_tx_size,
-                                      &eobtotal, mi_row, mi_col);
+                                      &eobtotal, mi_row, mi_col, sb, stage);
                 block += step;
               }
             }
@@ -566,7 +714,7 @@ static void decode_token_and_recon_block(AV1Decoder *const pbi,
     }
   }
 #if CONFIG_CFL
-  if (mbmi->uv_mode != UV_CFL_PRED) {
+  if ((stage & DEC_RECON) && mbmi->uv_mode != UV_CFL_PRED) {
     if (!cfl->is_chroma_reference && is_inter_block(mbmi) &&
         is_cfl_allowed(mbmi)) {
       cfl_store_block(xd, mbmi->sb_type, mbmi->tx_size);
@@ -574,8 +722,10 @@ static void decode_token_and_recon_block(AV1Decoder *const pbi,
   }
 #endif  // CONFIG_CFL
 
-  int reader_corrupted_flag = aom_reader_has_error(r);
-  aom_merge_corrupted_flag(&xd->corrupted, reader_corrupted_flag);
+  if (stage & DEC_PARSE) {
+    int reader_corrupted_flag = aom_reader_has_error(r);
+    aom_merge_corrupted_flag(&xd->corrupted, reader_corrupted_flag);
+  }
 }
 
 static void decode_block(AV1Decoder *const pbi, MACROBLOCKD *const xd,
@@ -583,14 +733,25 @@ static void decode_block(AV1Decoder *const pbi, MACROBLOCKD *const xd,
 #if CONFIG_EXT_PARTITION_TYPES
                          PARTITION_TYPE partition,
 #endif  // CONFIG_EXT_PARTITION_TYPES
-                         BLOCK_SIZE bsize) {
+                         BLOCK_SIZE bsize, DecSbBuffer *const sb) {
   decode_mbmi_block(pbi, xd, mi_row, mi_col, r,
 #if CONFIG_EXT_PARTITION_TYPES
                     partition,
 #endif
                     bsize);
 
-  decode_token_and_recon_block(pbi, xd, mi_row, mi_col, r, bsize);
+  if (sb != NULL) {
+    // Only parse; the block is reconstructed later from the buffer.
+    DecBlockInfo *const block = &sb->blocks[sb->num_blocks++];
+    block->mi_row = mi_row;
+    block->mi_col = mi_col;
+    block->bsize = bsize;
+    decode_token_and_recon_block(pbi, xd, mi_row, mi_col, r, bsize, sb,
+                                 DEC_PARSE);
+  } else {
+    decode_token_and_recon_block(pbi, xd, mi_row, mi_col, r, bsize, NULL,
+                                 DEC_PARSE_AND_RECON);
+  }
 }
 
 static PARTITION_TYPE read_partition(MACROBLOCKD *xd, int mi_row, int mi_col,
@@ -625,7 +786,7 @@ static PARTITION_TYPE read_partition(MACROBLOCKD *xd, int mi_row, int mi_col,
 // TODO(slavarnway): eliminate bsize and subsize in future commits
 static void decode_partition(AV1Decoder *const pbi, MACROBLOCKD *const xd,
                              int mi_row, int mi_col, aom_reader *r,
-                             BLOCK_SIZE bsize) {
+                             BLOCK_SIZE bsize, DecSbBuffer *const sb) {
   AV1_COMMON *const cm = &pbi->common;
   const int num_8x8_wh = mi_size_wide[bsize];
   const int hbs = num_8x8_wh >> 1;
@@ -667,9 +828,10 @@ static void decode_partition(AV1Decoder *const pbi, MACROBLOCKD *const xd,
 #endif
 #define DEC_BLOCK(db_r, db_c, db_subsize)                   \
   decode_block(pbi, xd, DEC_BLOCK_STX_ARG(db_r), (db_c), r, \
-               DEC_BLOCK_EPT_ARG(db_subsize))
-#define DEC_PARTITION(db_r, db_c, db_subsize) \
-  decode_partition(pbi, xd, DEC_BLOCK_STX_ARG(db_r), (db_c), r, (db_subsize))
+               DEC_BLOCK_EPT_ARG(db_subsize), sb)
+#define DEC_PARTITION(db_r, db_c, db_subsize)                   \
+  decode_partition(pbi, xd, DEC_BLOCK_STX_ARG(db_r), (db_c), r, \
+                   (db_subsize), sb)
 
   switch (partition) {
     case PARTITION_NONE: DEC_BLOCK(mi_row, mi_col, subsize); break;
@@ -2097,6 +2259,518 @@ static void dec_setup_across_tile_boundary_info(
 }
 #endif  // CONFIG_LOOPFILTERING_ACROSS_TILES
 
+// Resets the contexts at the start of a tile and returns its extent.
+static void init_tile_decode(AV1Decoder *pbi, TileData *const td,
+                             TileInfo *const tile_info, int tile_row,
+                             int tile_col) {
+  AV1_COMMON *const cm = &pbi->common;
+
+  av1_tile_set_row(tile_info, cm, tile_row);
+  av1_tile_set_col(tile_info, cm, tile_col);
+
+#if CONFIG_DEPENDENT_HORZTILES
+  av1_tile_set_tg_boundary(tile_info, cm, tile_row, tile_col);
+  if (!cm->dependent_horz_tiles || tile_row == 0 ||
+      tile_info->tg_horz_boundary) {
+    av1_zero_above_context(cm, tile_info->mi_col_start, tile_info->mi_col_end);
+  }
+#else
+  av1_zero_above_context(cm, tile_info->mi_col_start, tile_info->mi_col_end);
+#endif
+#if CONFIG_LOOP_RESTORATION
+  av1_reset_loop_restoration(&td->xd);
+#else
+  (void)td;
+#endif  // CONFIG_LOOP_RESTORATION
+
+#if CONFIG_LOOPFILTERING_ACROSS_TILES
+  dec_setup_across_tile_boundary_info(cm, tile_info);
+#endif  // CONFIG_LOOPFILTERING_ACROSS_TILES
+}
+
+// Decodes all the superblocks of one tile into td. Tiles in the same tile
+// column share the above context, so they must be decoded in order, but
+// distinct tile columns are independent and may run on separate threads.
+static void decode_tile(AV1Decoder *pbi, TileData *const td, int tile_row,
+                        int tile_col) {
+  AV1_COMMON *const cm = &pbi->common;
+  TileInfo tile_info;
+
+  init_tile_decode(pbi, td, &tile_info, tile_row, tile_col);
+
+  for (int mi_row = tile_info.mi_row_start; mi_row < tile_info.mi_row_end;
+       mi_row += cm->mib_size) {
+    av1_zero_left_context(&td->xd);
+
+    for (int mi_col = tile_info.mi_col_start; mi_col < tile_info.mi_col_end;
+         mi_col += cm->mib_size) {
+#if CONFIG_SYMBOLRATE
+      av1_record_superblock(td->xd.counts);
+#endif
+      decode_partition(pbi, &td->xd, mi_row, mi_col, &td->bit_reader,
+                       cm->sb_size, NULL);
+#if CONFIG_LPF_SB
+      if (USE_LOOP_FILTER_SUPERBLOCK) {
+#if CONFIG_LOOPFILTER_LEVEL
+        if (USE_GUESS_LEVEL) {
+          if (cm->lf.filter_level[0] || cm->lf.filter_level[1]) {
+            av1_loop_filter_frame(get_frame_new_buffer(cm), cm, &pbi->mb,
+                                  cm->lf.filter_level[0],
+                                  cm->lf.filter_level[1], 0, 1, mi_row, mi_col);
+            av1_loop_filter_frame(get_frame_new_buffer(cm), cm, &pbi->mb,
+                                  cm->lf.filter_level_u, cm->lf.filter_level_u,
+                                  1, 1, mi_row, mi_col);
+            av1_loop_filter_frame(get_frame_new_buffer(cm), cm, &pbi->mb,
+                                  cm->lf.filter_level_v, cm->lf.filter_level_v,
+                                  2, 1, mi_row, mi_col);
+          }
+        }
+#else
+        // apply deblocking filtering right after each superblock is decoded
+        const int filter_lvl =
+            cm->mi[mi_row * cm->mi_stride + mi_col].mbmi.filt_lvl;
+        av1_loop_filter_frame(get_frame_new_buffer(cm), cm, &pbi->mb,
+                              filter_lvl, 0, 1, mi_row, mi_col);
+#endif  // CONFIG_LOOPFILTER_LEVEL
+      }
+#endif  // CONFIG_LPF_SB
+    }
+    if (td->xd.corrupted)
+      aom_internal_error(td->xd.error_info, AOM_CODEC_CORRUPT_FRAME,
+                         "Failed to decode tile data");
+  }
+}
+
+static int tile_worker_hook(TileWorkerData *const tile_data, void *unused) {
+  AV1Decoder *const pbi = tile_data->pbi;
+  AV1_COMMON *const cm = &pbi->common;
+  const int tile_cols = cm->tile_cols;
+  const int tile_rows = cm->tile_rows;
+  int tile_col;
+  (void)unused;
+
+  tile_data->error_info.setjmp = 1;
+  if (setjmp(tile_data->error_info.jmp)) {
+    tile_data->error_info.setjmp = 0;
+    return 0;
+  }
+
+  while ((tile_col = aom_task_group_next_job(&pbi->tasks)) < tile_cols) {
+    for (int tile_row = 0; tile_row < tile_rows; ++tile_row) {
+      const int tile_idx = tile_row * tile_cols + tile_col;
+      TileData *const td = pbi->tile_data + tile_idx;
+
+      if (tile_idx < tile_data->start_tile || tile_idx > tile_data->end_tile)
+        continue;
+
+      td->xd.error_info = &tile_data->error_info;
+      if (td->xd.counts != NULL) td->xd.counts = &tile_data->counts;
+      decode_tile(pbi, td, tile_row, tile_col);
+    }
+  }
+
+  tile_data->error_info.setjmp = 0;
+  return 1;
+}
+
+static int can_decode_tiles_mt(const AV1Decoder *pbi, int startTile,
+                               int endTile) {
+  const AV1_COMMON *const cm = &pbi->common;
+#if CONFIG_LPF_SB
+  // The superblock loop filter runs in decode order on the shared pbi->mb.
+  (void)cm;
+  (void)startTile;
+  (void)endTile;
+  return 0;
+#else
+  if (pbi->max_threads <= 1 || cm->tile_cols <= 1) return 0;
+  if (endTile == startTile) return 0;
+#if CONFIG_EXT_TILE
+  if (cm->large_scale_tile) return 0;
+#endif  // CONFIG_EXT_TILE
+#if CONFIG_ACCOUNTING
+  if (pbi->acct_enabled) return 0;
+#endif
+  return 1;
+#endif  // CONFIG_LPF_SB
+}
+
+// The tile workers run as tasks on the application thread pool if one is set,
+// and otherwise on the shared scheduler, which is given a thread for each
+// worker but the one run by the main thread.
+static void create_tile_workers(AV1Decoder *pbi) {
+  AV1_COMMON *const cm = &pbi->common;
+
+  // Only run once to allocate thread data.
+  if (pbi->num_tile_workers == 0) {
+    const int num_threads = pbi->max_threads;
+    CHECK_MEM_ERROR(
+        cm, pbi->scheduler,
+        aom_scheduler_acquire(&pbi->thread_pool, num_threads - 1));
+    aom_task_group_init(&pbi->tasks);
+    CHECK_MEM_ERROR(cm, pbi->tile_worker_data,
+                    aom_memalign(32, num_threads *
+                                         sizeof(*pbi->tile_worker_data)));
+    pbi->num_tile_workers = num_threads;
+  }
+}
+
+// Whether the in-loop filters are applied to the frame together by
+// av1_filter_frame_pipeline_mt() once all its tiles are decoded. Frames which
+// are upscaled by superres between CDEF and loop restoration are not.
+static int use_filter_pipeline(const AV1Decoder *pbi) {
+  const AV1_COMMON *const cm = &pbi->common;
+#if CONFIG_HORZONLY_FRAME_SUPERRES
+  return pbi->max_threads > 1 && av1_superres_unscaled(cm);
+#else
+  (void)cm;
+  return pbi->max_threads > 1;
+#endif  // CONFIG_HORZONLY_FRAME_SUPERRES
+}
+
+static void filter_frame_pipeline(AV1Decoder *pbi) {
+  AV1_COMMON *const cm = &pbi->common;
+  int stages = 0;
+
+#if !CONFIG_LPF_SB
+#if CONFIG_INTRABC
+  if (!(cm->allow_intrabc && NO_FILTER_FOR_IBC))
+#endif  // CONFIG_INTRABC
+#if CONFIG_LOOPFILTER_LEVEL
+    if (cm->lf.filter_level[0] || cm->lf.filter_level[1])
+#else
+    if (cm->lf.filter_level)
+#endif  // CONFIG_LOOPFILTER_LEVEL
+      stages |= FILTER_STAGE_DEBLOCK;
+#endif  // !CONFIG_LPF_SB
+
+  if (!cm->skip_loop_filter &&
+#if CONFIG_INTRABC
+      !(cm->allow_intrabc && NO_FILTER_FOR_IBC) &&
+#endif  // CONFIG_INTRABC
+      !cm->all_lossless &&
+      (cm->cdef_bits || cm->cdef_strengths[0] || cm->cdef_uv_strengths[0]))
+    stages |= FILTER_STAGE_CDEF;
+
+#if CONFIG_LOOP_RESTORATION
+  if (cm->rst_info[0].frame_restoration_type != RESTORE_NONE ||
+      cm->rst_info[1].frame_restoration_type != RESTORE_NONE ||
+      cm->rst_info[2].frame_restoration_type != RESTORE_NONE)
+    stages |= FILTER_STAGE_RESTORE;
+#endif  // CONFIG_LOOP_RESTORATION
+
+  if (!stages) return;
+  create_tile_workers(pbi);
+  // In frame parallel mode the filter worker applies them while the next
+  // frame is decoded.
+  if (pbi->frame_parallel_decode) {
+    pbi->filter_stages = stages;
+    return;
+  }
+  av1_filter_frame_pipeline_mt(&pbi->cur_buf->buf, cm, &pbi->mb, stages,
+                               pbi->scheduler, pbi->num_tile_workers,
+                               &pbi->filter_sync, NULL, NULL);
+}
+
+// Decodes the tiles in [startTile, endTile] by sharing out the tile columns
+// between the tile workers.
+static void decode_tiles_mt(AV1Decoder *pbi, int startTile, int endTile) {
+  AV1_COMMON *const cm = &pbi->common;
+  int num_workers;
+  int corrupted = 0;
+  int queued = 1;
+  int i;
+
+  create_tile_workers(pbi);
+
+  num_workers = AOMMIN(pbi->num_tile_workers, cm->tile_cols);
+
+  for (i = 0; i < num_workers && queued; ++i) {
+    TileWorkerData *const tile_data = &pbi->tile_worker_data[i];
+
+    tile_data->pbi = pbi;
+    tile_data->start_tile = startTile;
+    tile_data->end_tile = endTile;
+    av1_zero(tile_data->error_info);
+    av1_zero(tile_data->counts);
+
+    queued = aom_scheduler_submit(pbi->scheduler, &pbi->tasks,
+                                  (AVxWorkerHook)tile_worker_hook, tile_data,
+                                  NULL);
+  }
+
+  corrupted |= !aom_scheduler_wait(pbi->scheduler, &pbi->tasks);
+  if (!queued)
+    aom_internal_error(&cm->error, AOM_CODEC_MEM_ERROR,
+                       "Failed to queue tile decoder tasks");
+  for (i = 0; i < num_workers; ++i) {
+    TileWorkerData *const tile_data = &pbi->tile_worker_data[i];
+
+    if (cm->refresh_frame_context == REFRESH_FRAME_CONTEXT_BACKWARD)
+      av1_accumulate_frame_counts(&cm->counts, &tile_data->counts);
+  }
+
+  for (i = startTile; i <= endTile; ++i)
+    corrupted |= pbi->tile_data[i].xd.corrupted;
+
+  aom_merge_corrupted_flag(&pbi->mb.corrupted, corrupted);
+  if (pbi->mb.corrupted)
+    aom_internal_error(&cm->error, AOM_CODEC_CORRUPT_FRAME,
+                       "Failed to decode tile data");
+}
+
+// Row-based multi-threading spreads the superblock rows of a tile over the
+// tile workers. It is used when there is a single tile column, so that
+// tile-based multi-threading has nothing to distribute.
+static int can_decode_rows_mt(const AV1Decoder *pbi) {
+#if CONFIG_MULTITHREAD && !CONFIG_LPF_SB
+  const AV1_COMMON *const cm = &pbi->common;
+  if (!pbi->row_mt || pbi->max_threads <= 1 || cm->tile_cols > 1) return 0;
+#if CONFIG_EXT_TILE
+  if (cm->large_scale_tile) return 0;
+#endif  // CONFIG_EXT_TILE
+#if CONFIG_ACCOUNTING
+  if (pbi->acct_enabled) return 0;
+#endif
+#if CONFIG_INTRABC
+  // Intra block copy predicts from anywhere in the frame decoded so far.
+  if (cm->allow_intrabc) return 0;
+#endif  // CONFIG_INTRABC
+  return 1;
+#else
+  (void)pbi;
+  return 0;
+#endif  // CONFIG_MULTITHREAD && !CONFIG_LPF_SB
+}
+
+static void alloc_sb_buffers(AV1Decoder *pbi, int rows, int cols) {
+  AV1_COMMON *const cm = &pbi->common;
+  const int luma = block_size_wide[cm->sb_size] * block_size_high[cm->sb_size];
+  const int chroma = luma >> (cm->subsampling_x + cm->subsampling_y);
+  const int coeffs = luma + 2 * chroma;
+  // Blocks and transform blocks are at least 4x4.
+  const int max_blocks = luma >> 4;
+  const int num_sbs = rows * cols;
+
+  if (pbi->sb_buffer_rows == rows && pbi->sb_buffer_cols == cols &&
+      pbi->sb_buffer_coeffs == coeffs)
+    return;
+
+  av1_dec_free_sb_buffers(pbi);
+  CHECK_MEM_ERROR(cm, pbi->sb_buffers,
+                  aom_calloc(num_sbs, sizeof(*pbi->sb_buffers)));
+  // Room for every coefficient of the superblock, although the transform
+  // blocks only take up to their last nonzero coefficient.
+  CHECK_MEM_ERROR(cm, pbi->sb_dqcoeff,
+                  aom_malloc(num_sbs * coeffs * sizeof(*pbi->sb_dqcoeff)));
+  CHECK_MEM_ERROR(cm, pbi->sb_eob_info,
+                  aom_malloc(num_sbs * (coeffs >> 4) *
+                             sizeof(*pbi->sb_eob_info)));
+  CHECK_MEM_ERROR(cm, pbi->sb_color_index_map,
+                  aom_malloc(num_sbs * (luma + chroma) *
+                             sizeof(*pbi->sb_color_index_map)));
+  CHECK_MEM_ERROR(cm, pbi->sb_blocks,
+                  aom_malloc(num_sbs * max_blocks * sizeof(*pbi->sb_blocks)));
+
+  for (int i = 0; i < num_sbs; ++i) {
+    DecSbBuffer *const sb = &pbi->sb_buffers[i];
+    sb->blocks = pbi->sb_blocks + i * max_blocks;
+    sb->dqcoeff[0] = pbi->sb_dqcoeff + i * coeffs;
+    sb->dqcoeff[1] = sb->dqcoeff[0] + luma;
+    sb->dqcoeff[2] = sb->dqcoeff[1] + chroma;
+    sb->eob_info[0] = pbi->sb_eob_info + i * (coeffs >> 4);
+    sb->eob_info[1] = sb->eob_info[0] + (luma >> 4);
+    sb->eob_info[2] = sb->eob_info[1] + (chroma >> 4);
+    sb->color_index_map[0] = pbi->sb_color_index_map + i * (luma + chroma);
+    sb->color_index_map[1] = sb->color_index_map[0] + luma;
+  }
+  pbi->sb_buffer_rows = rows;
+  pbi->sb_buffer_cols = cols;
+  pbi->sb_buffer_coeffs = coeffs;
+}
+
+static void reset_sb_buffer_pos(DecSbBuffer *const sb) {
+  av1_zero(sb->dqcoeff_pos);
+  av1_zero(sb->eob_pos);
+  av1_zero(sb->color_index_pos);
+}
+
+// Parses the tile superblock by superblock into the ring of superblock
+// buffers.
+static int row_mt_parse_hook(TileWorkerData *const tile_data, void *unused) {
+  AV1Decoder *const pbi = tile_data->pbi;
+  AV1_COMMON *const cm = &pbi->common;
+  TileData *const td = tile_data->td;
+  const TileInfo *const tile = &td->xd.tile;
+  AV1DecRowMTSync *const row_mt_sync = &pbi->row_mt_sync;
+  const int sb_cols = pbi->sb_buffer_cols;
+  (void)unused;
+
+  tile_data->error_info.setjmp = 1;
+  if (setjmp(tile_data->error_info.jmp)) {
+    tile_data->error_info.setjmp = 0;
+    av1_dec_row_mt_abort(row_mt_sync);
+    return 0;
+  }
+
+  td->xd.error_info = &tile_data->error_info;
+  for (int mi_row = tile->mi_row_start, r = 0; mi_row < tile->mi_row_end;
+       mi_row += cm->mib_size, ++r) {
+    DecSbBuffer *const sb_row =
+        pbi->sb_buffers + (r % pbi->sb_buffer_rows) * sb_cols;
+
+    // Wait for the previous user of the buffers to be reconstructed.
+    if (r >= pbi->sb_buffer_rows &&
+        !av1_dec_row_mt_wait_rows_done(row_mt_sync,
+                                       r - pbi->sb_buffer_rows + 1))
+      break;
+
+    av1_zero_left_context(&td->xd);
+
+    for (int mi_col = tile->mi_col_start, c = 0; mi_col < tile->mi_col_end;
+         mi_col += cm->mib_size, ++c) {
+      DecSbBuffer *const sb = sb_row + c;
+      sb->num_blocks = 0;
+      reset_sb_buffer_pos(sb);
+#if CONFIG_SYMBOLRATE
+      av1_record_superblock(td->xd.counts);
+#endif
+      decode_partition(pbi, &td->xd, mi_row, mi_col, &td->bit_reader,
+                       cm->sb_size, sb);
+      av1_dec_row_mt_set_parsed(row_mt_sync, r, c, sb_cols);
+    }
+    if (td->xd.corrupted)
+      aom_internal_error(td->xd.error_info, AOM_CODEC_CORRUPT_FRAME,
+                         "Failed to decode tile data");
+  }
+
+  tile_data->error_info.setjmp = 0;
+  return 1;
+}
+
+// Takes the superblock rows of the tile in turn, and reconstructs each as
+// soon as the parser and the row above are far enough ahead.
+static int row_mt_recon_hook(TileWorkerData *const tile_data, void *unused) {
+  AV1Decoder *const pbi = tile_data->pbi;
+  AV1_COMMON *const cm = &pbi->common;
+  MACROBLOCKD *const xd = &tile_data->xd;
+  const TileInfo *const tile = &xd->tile;
+  AV1DecRowMTSync *const row_mt_sync = &pbi->row_mt_sync;
+  const int sb_cols = pbi->sb_buffer_cols;
+  int r;
+  (void)unused;
+
+  tile_data->error_info.setjmp = 1;
+  if (setjmp(tile_data->error_info.jmp)) {
+    tile_data->error_info.setjmp = 0;
+    av1_dec_row_mt_abort(row_mt_sync);
+    return 0;
+  }
+
+  while (tile->mi_row_start +
+             ((r = aom_task_group_next_job(&pbi->tasks)) << cm->mib_size_log2) <
+         tile->mi_row_end) {
+    DecSbBuffer *const sb_row =
+        pbi->sb_buffers + (r % pbi->sb_buffer_rows) * sb_cols;
+
+    for (int c = 0; c < sb_cols; ++c) {
+      DecSbBuffer *const sb = sb_row + c;
+
+      if (!av1_dec_row_mt_wait_recon(row_mt_sync, r, c)) {
+        tile_data->error_info.setjmp = 0;
+        return 0;
+      }
+
+      reset_sb_buffer_pos(sb);
+      for (int i = 0; i < sb->num_blocks; ++i) {
+        const DecBlockInfo *const block = &sb->blocks[i];
+        decode_token_and_recon_block(pbi, xd, block->mi_row, block->mi_col,
+                                     NULL, block->bsize, sb, DEC_RECON);
+      }
+      av1_dec_row_mt_set_recon(row_mt_sync, r, c, sb_cols);
+    }
+  }
+
+  tile_data->error_info.setjmp = 0;
+  return 1;
+}
+
+// Decodes one tile with the main thread parsing and the other tile workers
+// reconstructing superblock rows in a wavefront.
+static void decode_tile_rows_mt(AV1Decoder *pbi, TileData *const td,
+                                int tile_row, int tile_col) {
+  AV1_COMMON *const cm = &pbi->common;
+  TileWorkerData *parser;
+  TileInfo tile_info;
+  int num_workers;
+  int sb_rows, sb_cols;
+  int corrupted = 0;
+  int queued = 1;
+  int i;
+
+  create_tile_workers(pbi);
+  num_workers = pbi->num_tile_workers;
+  // The parser waits for the reconstruction, so the reconstruction workers
+  // must not depend on this thread to run.
+  if (aom_scheduler_num_threads(pbi->scheduler) == 0)
+    aom_internal_error(&cm->error, AOM_CODEC_ERROR,
+                       "Tile decoder thread creation failed");
+
+  init_tile_decode(pbi, td, &tile_info, tile_row, tile_col);
+  sb_rows = ALIGN_POWER_OF_TWO(tile_info.mi_row_end - tile_info.mi_row_start,
+                               cm->mib_size_log2) >>
+            cm->mib_size_log2;
+  sb_cols = ALIGN_POWER_OF_TWO(tile_info.mi_col_end - tile_info.mi_col_start,
+                               cm->mib_size_log2) >>
+            cm->mib_size_log2;
+
+  // The parser may run ahead of the slowest reconstruction worker by one
+  // superblock row in addition to the rows being reconstructed.
+  alloc_sb_buffers(pbi, num_workers + 1, sb_cols);
+  if (pbi->row_mt_sync.rows < sb_rows) {
+    av1_dec_row_mt_dealloc(&pbi->row_mt_sync);
+    av1_dec_row_mt_alloc(&pbi->row_mt_sync, cm,
+                         (cm->mi_rows + cm->mib_size - 1) >> cm->mib_size_log2,
+                         cm->width);
+  }
+  av1_dec_row_mt_reset(&pbi->row_mt_sync);
+
+  for (i = 0; i < num_workers - 1 && queued; ++i) {
+    TileWorkerData *const tile_data = &pbi->tile_worker_data[i];
+
+    tile_data->pbi = pbi;
+    av1_zero(tile_data->error_info);
+    tile_data->xd = td->xd;
+    tile_data->xd.counts = NULL;
+    tile_data->xd.error_info = &tile_data->error_info;
+    av1_zero(tile_data->dqcoeff);
+    for (int plane = 0; plane < MAX_MB_PLANE; ++plane)
+      tile_data->xd.plane[plane].dqcoeff = tile_data->dqcoeff;
+    queued = aom_scheduler_submit(pbi->scheduler, &pbi->tasks,
+                                  (AVxWorkerHook)row_mt_recon_hook, tile_data,
+                                  NULL);
+  }
+  if (!queued) {
+    // The queued workers wait for rows of the parser, which is not started.
+    av1_dec_row_mt_abort(&pbi->row_mt_sync);
+    aom_scheduler_wait(pbi->scheduler, &pbi->tasks);
+    aom_internal_error(&cm->error, AOM_CODEC_MEM_ERROR,
+                       "Failed to queue tile decoder tasks");
+  }
+
+  parser = &pbi->tile_worker_data[num_workers - 1];
+  parser->pbi = pbi;
+  parser->td = td;
+  av1_zero(parser->error_info);
+  corrupted |= !row_mt_parse_hook(parser, NULL);
+  corrupted |= !aom_scheduler_wait(pbi->scheduler, &pbi->tasks);
+
+  aom_merge_corrupted_flag(&pbi->mb.corrupted, corrupted | td->xd.corrupted);
+  if (pbi->mb.corrupted)
+    aom_internal_error(&cm->error, AOM_CODEC_CORRUPT_FRAME,
+                       "Failed to decode tile data");
+}
+
 static const uint8_t *decode_tiles(AV1Decoder *pbi, const uint8_t *data,
                                    const uint8_t *data_end, int startTile,
                                    int endTile) {
@@ -2151,10 +2825,6 @@ static const uint8_t *decode_tiles(AV1Decoder *pbi, const uint8_t *data,
     CHECK_MEM_ERROR(cm, pbi->lf_worker.data1,
                     aom_memalign(32, sizeof(LFWorkerData)));
     pbi->lf_worker.hook = (AVxWorkerHook)av1_loop_filter_worker;
-    if (pbi->max_threads > 1 && !winterface->reset(&pbi->lf_worker)) {
-      aom_internal_error(&cm->error, AOM_CODEC_ERROR,
-                         "Loop filter thread creation failed");
-    }
   }
 
   if (cm->lf.filter_level && !cm->skip_loop_filter) {
@@ -2226,109 +2896,46 @@ static const uint8_t *decode_tiles(AV1Decoder *pbi, const uint8_t *data,
     }
   }
 
-  for (tile_row = tile_rows_start; tile_row < tile_rows_end; ++tile_row) {
-    const int row = inv_row_order ? tile_rows - 1 - tile_row : tile_row;
-    int mi_row = 0;
-    TileInfo tile_info;
-
-    av1_tile_set_row(&tile_info, cm, row);
+  if (can_decode_tiles_mt(pbi, startTile, endTile)) {
+    decode_tiles_mt(pbi, startTile, endTile);
+  } else {
+    for (tile_row = tile_rows_start; tile_row < tile_rows_end; ++tile_row) {
+      const int row = inv_row_order ? tile_rows - 1 - tile_row : tile_row;
 
-    for (tile_col = tile_cols_start; tile_col < tile_cols_end; ++tile_col) {
-      const int col = inv_col_order ? tile_cols - 1 - tile_col : tile_col;
-      TileData *const td = pbi->tile_data + tile_cols * row + col;
+      for (tile_col = tile_cols_start; tile_col < tile_cols_end; ++tile_col) {
+        const int col = inv_col_order ? tile_cols - 1 - tile_col : tile_col;
+        TileData *const td = pbi->tile_data + tile_cols * row + col;
 
-      if (tile_row * cm->tile_cols + tile_col < startTile ||
-          tile_row * cm->tile_cols + tile_col > endTile)
-        continue;
+        if (tile_row * cm->tile_cols + tile_col < startTile ||
+            tile_row * cm->tile_cols + tile_col > endTile)
+          continue;
 
 #if CONFIG_ACCOUNTING
-      if (pbi->acct_enabled) {
-        td->bit_reader.accounting->last_tell_frac =
-            aom_reader_tell_frac(&td->bit_reader);
-      }
-#endif
-
-      av1_tile_set_col(&tile_info, cm, col);
-
-#if CONFIG_DEPENDENT_HORZTILES
-      av1_tile_set_tg_boundary(&tile_info, cm, tile_row, tile_col);
-      if (!cm->dependent_horz_tiles || tile_row == 0 ||
-          tile_info.tg_horz_boundary) {
-        av1_zero_above_context(cm, tile_info.mi_col_start,
-                               tile_info.mi_col_end);
-      }
-#else
-      av1_zero_above_context(cm, tile_info.mi_col_start, tile_info.mi_col_end);
+        if (pbi->acct_enabled) {
+          td->bit_reader.accounting->last_tell_frac =
+              aom_reader_tell_frac(&td->bit_reader);
+        }
 #endif
-#if CONFIG_LOOP_RESTORATION
-      av1_reset_loop_restoration(&td->xd);
-#endif  // CONFIG_LOOP_RESTORATION
-
-#if CONFIG_LOOPFILTERING_ACROSS_TILES
-      dec_setup_across_tile_boundary_info(cm, &tile_info);
-#endif  // CONFIG_LOOPFILTERING_ACROSS_TILES
-
-      for (mi_row = tile_info.mi_row_start; mi_row < tile_info.mi_row_end;
-           mi_row += cm->mib_size) {
-        av1_zero_left_context(&td->xd);
 
-        for (int mi_col = tile_info.mi_col_start; mi_col < tile_info.mi_col_end;
-             mi_col += cm->mib_size) {
-#if CONFIG_SYMBOLRATE
-          av1_record_superblock(td->xd.counts);
-#endif
-          decode_partition(pbi, &td->xd, mi_row, mi_col, &td->bit_reader,
-                           cm->sb_size);
-#if CONFIG_LPF_SB
-          if (USE_LOOP_FILTER_SUPERBLOCK) {
-#if CONFIG_LOOPFILTER_LEVEL
-            if (USE_GUESS_LEVEL) {
-              if (cm->lf.filter_level[0] || cm->lf.filter_level[1]) {
-                av1_loop_filter_frame(get_frame_new_buffer(cm), cm, &pbi->mb,
-                                      cm->lf.filter_level[0],
-                                      cm->lf.filter_level[1], 0, 1, mi_row,
-                                      mi_col);
-                av1_loop_filter_frame(get_frame_new_buffer(cm), cm, &pbi->mb,
-                                      cm->lf.filter_level_u,
-                                      cm->lf.filter_level_u, 1, 1, mi_row,
-                                      mi_col);
-                av1_loop_filter_frame(get_frame_new_buffer(cm), cm, &pbi->mb,
-                                      cm->lf.filter_level_v,
-                                      cm->lf.filter_level_v, 2, 1, mi_row,
-                                      mi_col);
-              }
-            }
-#else
-            // apply deblocking filtering right after each superblock is decoded
-            const int filter_lvl =
-                cm->mi[mi_row * cm->mi_stride + mi_col].mbmi.filt_lvl;
-            av1_loop_filter_frame(get_frame_new_buffer(cm), cm, &pbi->mb,
-                                  filter_lvl, 0, 1, mi_row, mi_col);
-#endif  // CONFIG_LOOPFILTER_LEVEL
-          }
-#endif  // CONFIG_LPF_SB
-        }
+        if (can_decode_rows_mt(pbi))
+          decode_tile_rows_mt(pbi, td, row, col);
+        else
+          decode_tile(pbi, td, row, col);
         aom_merge_corrupted_flag(&pbi->mb.corrupted, td->xd.corrupted);
         if (pbi->mb.corrupted)
           aom_internal_error(&cm->error, AOM_CODEC_CORRUPT_FRAME,
                              "Failed to decode tile data");
       }
     }
-
-#if !CONFIG_OBU
-    assert(mi_row > 0);
-#endif
-
-    // After loopfiltering, the last 7 row pixels in each superblock row may
-    // still be changed by the longest loopfilter of the next superblock row.
-    if (cm->frame_parallel_decode)
-      av1_frameworker_broadcast(pbi->cur_buf, mi_row << cm->mib_size_log2);
   }
 
+  // With the filter pipeline, the frame is deblocked together with the other
+  // in-loop filters in av1_decode_tg_tiles_and_wrapup().
+  if (!use_filter_pipeline(pbi)
 #if CONFIG_INTRABC && !CONFIG_LPF_SB
-  if (!(cm->allow_intrabc && NO_FILTER_FOR_IBC))
+      && !(cm->allow_intrabc && NO_FILTER_FOR_IBC)
 #endif  // CONFIG_INTRABC && !CONFIG_LPF_SB
-  {
+          ) {
 // Loopfilter the whole frame.
 #if !CONFIG_LPF_SB
 #if CONFIG_OBU
@@ -2352,8 +2959,6 @@ static const uint8_t *decode_tiles(AV1Decoder *pbi, const uint8_t *data,
 #endif  // CONFIG_LOOPFILTER_LEVEL
 #endif  // CONFIG_LPF_SB
   }
-  if (cm->frame_parallel_decode)
-    av1_frameworker_broadcast(pbi->cur_buf, INT_MAX);
 
 #if CONFIG_EXT_TILE
   if (cm->large_scale_tile) {
@@ -2693,11 +3298,6 @@ static size_t read_uncompressed_header(AV1Decoder *pbi,
     cm->show_frame = 1;
     pbi->refresh_frame_flags = 0;
 
-    if (cm->frame_parallel_decode) {
-      for (int i = 0; i < REF_FRAMES; ++i)
-        cm->next_ref_frame_map[i] = cm->ref_frame_map[i];
-    }
-
     return 0;
   }
 
@@ -3578,28 +4178,6 @@ static void setup_frame_info(AV1Decoder *pbi) {
   }
 #endif
 
-  // If encoded in frame parallel mode, frame context is ready after decoding
-  // the frame header.
-  if (cm->frame_parallel_decode &&
-      cm->refresh_frame_context != REFRESH_FRAME_CONTEXT_BACKWARD) {
-    AVxWorker *const worker = pbi->frame_worker_owner;
-    FrameWorkerData *const frame_worker_data = worker->data1;
-    if (cm->refresh_frame_context == REFRESH_FRAME_CONTEXT_FORWARD) {
-#if CONFIG_NO_FRAME_CONTEXT_SIGNALING
-      cm->frame_contexts[cm->new_fb_idx] = *cm->fc;
-#else
-      cm->frame_contexts[cm->frame_context_idx] = *cm->fc;
-#endif  // CONFIG_NO_FRAME_CONTEXT_SIGNALING
-    }
-    av1_frameworker_lock_stats(worker);
-    pbi->cur_buf->row = -1;
-    pbi->cur_buf->col = -1;
-    frame_worker_data->frame_context_ready = 1;
-    // Signal the main thread that context is ready.
-    av1_frameworker_signal_stats(worker);
-    av1_frameworker_unlock_stats(worker);
-  }
-
   dec_setup_frame_boundary_info(cm);
 }
 
@@ -3644,40 +4222,45 @@ void av1_decode_tg_tiles_and_wrapup(AV1Decoder *pbi, const uint8_t *data,
     return;
   }
 
+  if (use_filter_pipeline(pbi)) {
+    filter_frame_pipeline(pbi);
+  } else {
 #if CONFIG_STRIPED_LOOP_RESTORATION
 #if CONFIG_HORZONLY_FRAME_SUPERRES
-  if (!av1_superres_unscaled(cm)) aom_extend_frame_borders(&pbi->cur_buf->buf);
+    if (!av1_superres_unscaled(cm))
+      aom_extend_frame_borders(&pbi->cur_buf->buf);
 #endif  // CONFIG_HORZONLY_FRAME_SUPERRES
-  if (cm->rst_info[0].frame_restoration_type != RESTORE_NONE ||
-      cm->rst_info[1].frame_restoration_type != RESTORE_NONE ||
-      cm->rst_info[2].frame_restoration_type != RESTORE_NONE) {
-    av1_loop_restoration_save_boundary_lines(&pbi->cur_buf->buf, cm, 0);
-  }
+    if (cm->rst_info[0].frame_restoration_type != RESTORE_NONE ||
+        cm->rst_info[1].frame_restoration_type != RESTORE_NONE ||
+        cm->rst_info[2].frame_restoration_type != RESTORE_NONE) {
+      av1_loop_restoration_save_boundary_lines(&pbi->cur_buf->buf, cm, 0);
+    }
 #endif  // CONFIG_STRIPED_LOOP_RESTORATION
 
-  if (!cm->skip_loop_filter &&
+    if (!cm->skip_loop_filter &&
 #if CONFIG_INTRABC
-      !(cm->allow_intrabc && NO_FILTER_FOR_IBC) &&
+        !(cm->allow_intrabc && NO_FILTER_FOR_IBC) &&
 #endif  // CONFIG_INTRABC
-      !cm->all_lossless &&
-      (cm->cdef_bits || cm->cdef_strengths[0] || cm->cdef_uv_strengths[0])) {
-    av1_cdef_frame(&pbi->cur_buf->buf, cm, &pbi->mb);
-  }
+        !cm->all_lossless &&
+        (cm->cdef_bits || cm->cdef_strengths[0] || cm->cdef_uv_strengths[0])) {
+      av1_cdef_frame(&pbi->cur_buf->buf, cm, &pbi->mb);
+    }
 
 #if CONFIG_HORZONLY_FRAME_SUPERRES
-  superres_post_decode(pbi);
+    superres_post_decode(pbi);
 #endif  // CONFIG_HORZONLY_FRAME_SUPERRES
 
 #if CONFIG_LOOP_RESTORATION
-  if (cm->rst_info[0].frame_restoration_type != RESTORE_NONE ||
-      cm->rst_info[1].frame_restoration_type != RESTORE_NONE ||
-      cm->rst_info[2].frame_restoration_type != RESTORE_NONE) {
+    if (cm->rst_info[0].frame_restoration_type != RESTORE_NONE ||
+        cm->rst_info[1].frame_restoration_type != RESTORE_NONE ||
+        cm->rst_info[2].frame_restoration_type != RESTORE_NONE) {
 #if CONFIG_STRIPED_LOOP_RESTORATION
-    av1_loop_restoration_save_boundary_lines(&pbi->cur_buf->buf, cm, 1);
+      av1_loop_restoration_save_boundary_lines(&pbi->cur_buf->buf, cm, 1);
 #endif
-    av1_loop_restoration_filter_frame((YV12_BUFFER_CONFIG *)xd->cur_buf, cm);
-  }
+      av1_loop_restoration_filter_frame((YV12_BUFFER_CONFIG *)xd->cur_buf, cm);
+    }
 #endif  // CONFIG_LOOP_RESTORATION
+  }
 
   if (!xd->corrupted) {
     if (cm->refresh_frame_context == REFRESH_FRAME_CONTEXT_BACKWARD) {
@@ -3733,21 +4316,16 @@ void av1_decode_tg_tiles_and_wrapup(AV1Decoder *pbi, const uint8_t *data,
   }
 #endif
 
-// Non frame parallel update frame context here.
+// Update frame context here.
 #if CONFIG_EXT_TILE
   if (!cm->large_scale_tile) {
 #endif  // CONFIG_EXT_TILE
-    // TODO(yunqingwang): If cm->frame_parallel_decode = 0, then the following
-    // update always happens. Seems it is done more than necessary.
-    if (!cm->frame_parallel_decode ||
-        cm->refresh_frame_context != REFRESH_FRAME_CONTEXT_FORWARD) {
 #if CONFIG_NO_FRAME_CONTEXT_SIGNALING
-      cm->frame_contexts[cm->new_fb_idx] = *cm->fc;
+    cm->frame_contexts[cm->new_fb_idx] = *cm->fc;
 #else
-    if (!cm->error_resilient_mode)
-      cm->frame_contexts[cm->frame_context_idx] = *cm->fc;
+  if (!cm->error_resilient_mode)
+    cm->frame_contexts[cm->frame_context_idx] = *cm->fc;
 #endif
-    }
 #if CONFIG_EXT_TILE
   }
 #endif  // CONFIG_EXT_TILE
@@ -129,28 +129,45 @@ AV1Decoder *av1_decoder_create(BufferPool *const pool) {
   cm->error.setjmp = 0;
 
   aom_get_worker_interface()->init(&pbi->lf_worker);
+  aom_get_worker_interface()->init(&pbi->filter_worker);
+#if CONFIG_MULTITHREAD
+  pthread_mutex_init(&pbi->progress_mutex, NULL);
+  pthread_cond_init(&pbi->progress_cond, NULL);
+#endif
 
   return pbi;
 }
 
 void av1_decoder_remove(AV1Decoder *pbi) {
-  int i;
-
   if (!pbi) return;
 
+  av1_dec_sync_frame_filter(pbi);
+  aom_get_worker_interface()->end(&pbi->filter_worker);
+  if (pbi->filter_data != NULL) {
+    av1_dec_free_mi(&pbi->filter_data->cm);
+#if CONFIG_LOOP_RESTORATION
+    av1_free_restoration_buffers(&pbi->filter_data->cm);
+#endif  // CONFIG_LOOP_RESTORATION
+    aom_free(pbi->filter_data);
+  }
+#if CONFIG_MULTITHREAD
+  pthread_mutex_destroy(&pbi->progress_mutex);
+  pthread_cond_destroy(&pbi->progress_cond);
+#endif
+
   aom_get_worker_interface()->end(&pbi->lf_worker);
   aom_free(pbi->lf_worker.data1);
   aom_free(pbi->tile_data);
-  for (i = 0; i < pbi->num_tile_workers; ++i) {
-    AVxWorker *const worker = &pbi->tile_workers[i];
-    aom_get_worker_interface()->end(worker);
-  }
-  aom_free(pbi->tile_worker_info);
-  aom_free(pbi->tile_workers);
+  aom_free(pbi->tile_worker_data);
 
   if (pbi->num_tile_workers > 0) {
+    aom_task_group_destroy(&pbi->tasks);
+    aom_scheduler_release(pbi->scheduler);
     av1_loop_filter_dealloc(&pbi->lf_row_sync);
+    av1_filter_pipeline_dealloc(&pbi->filter_sync);
   }
+  av1_dec_row_mt_dealloc(&pbi->row_mt_sync);
+  av1_dec_free_sb_buffers(pbi);
 
 #if CONFIG_ACCOUNTING
   aom_accounting_clear(&pbi->accounting);
@@ -159,6 +176,163 @@ void av1_decoder_remove(AV1Decoder *pbi) {
   aom_free(pbi);
 }
 
+void av1_dec_free_sb_buffers(AV1Decoder *pbi) {
+  aom_free(pbi->sb_buffers);
+  pbi->sb_buffers = NULL;
+  aom_free(pbi->sb_dqcoeff);
+  pbi->sb_dqcoeff = NULL;
+  aom_free(pbi->sb_eob_info);
+  pbi->sb_eob_info = NULL;
+  aom_free(pbi->sb_color_index_map);
+  pbi->sb_color_index_map = NULL;
+  aom_free(pbi->sb_blocks);
+  pbi->sb_blocks = NULL;
+  pbi->sb_buffer_rows = 0;
+  pbi->sb_buffer_cols = 0;
+  pbi->sb_buffer_coeffs = 0;
+}
+
+void av1_dec_sync_frame_filter(AV1Decoder *pbi) {
+  FrameFilterData *const fd = pbi->filter_data;
+
+  aom_get_worker_interface()->sync(&pbi->filter_worker);
+  if (fd != NULL && fd->buf != NULL) {
+    BufferPool *const pool = pbi->common.buffer_pool;
+    lock_buffer_pool(pool);
+    decrease_ref_count((int)(fd->buf - pool->frame_bufs), pool->frame_bufs,
+                       pool);
+    unlock_buffer_pool(pool);
+    fd->buf = NULL;
+  }
+}
+
+// Called by the filter pipeline once superblock row sb_row is final.
+static void filter_row_done(void *priv, int sb_row) {
+  AV1Decoder *const pbi = (AV1Decoder *)priv;
+  FrameFilterData *const fd = pbi->filter_data;
+  YV12_BUFFER_CONFIG *const frame = &fd->buf->buf;
+  const int row_start = sb_row * MAX_MIB_SIZE * MI_SIZE;
+  const int row_end = row_start + MAX_MIB_SIZE * MI_SIZE;
+
+  if (fd->extend_borders)
+    aom_extend_frame_borders_rows(frame, row_start, row_end);
+  av1_frame_progress_update(pbi, fd->buf,
+                            row_end >= frame->y_crop_height ? INT_MAX : row_end);
+}
+
+static int frame_filter_hook(void *arg1, void *arg2) {
+  AV1Decoder *const pbi = (AV1Decoder *)arg1;
+  FrameFilterData *const fd = pbi->filter_data;
+  RefCntBuffer *const buf = fd->buf;
+  (void)arg2;
+
+  if (setjmp(fd->cm.error.jmp)) {
+    fd->cm.error.setjmp = 0;
+    buf->buf.corrupted = 1;
+    av1_frame_progress_update(pbi, buf, INT_MAX);
+    return 0;
+  }
+  fd->cm.error.setjmp = 1;
+
+  if (fd->stages) {
+    av1_filter_frame_pipeline_mt(
+        &buf->buf, &fd->cm, &fd->xd, fd->stages, pbi->scheduler,
+        pbi->num_tile_workers, &pbi->filter_sync,
+        (fd->stages & FILTER_STAGE_RESTORE) ? NULL : filter_row_done, pbi);
+  }
+  if (buf->row != INT_MAX) {
+    // TODO(debargha): Fix encoder side mv range, so that we can use the
+    // inner border extension. As of now use the larger extension.
+    if (fd->extend_borders) aom_extend_frame_borders(&buf->buf);
+    av1_frame_progress_update(pbi, buf, INT_MAX);
+  }
+
+  fd->cm.error.setjmp = 0;
+  return 1;
+}
+
+// Hands the in-loop filters and border extension of the frame just decoded
+// over to the filter worker. The worker gets a copy of the frame state and
+// the mode info and restoration arrays of the frame, and the decoder takes
+// over the arrays the worker used for the previous frame.
+static void start_frame_filter(AV1Decoder *pbi) {
+  AV1_COMMON *const cm = &pbi->common;
+  BufferPool *const pool = cm->buffer_pool;
+  const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+  AVxWorker *const worker = &pbi->filter_worker;
+  FrameFilterData *fd;
+  MODE_INFO *mip;
+  MODE_INFO **mi_grid_base;
+  int mi_alloc_size;
+#if CONFIG_LOOP_RESTORATION
+  RestorationInfo rst_info[MAX_MB_PLANE];
+  int32_t *rst_tmpbuf;
+  int p;
+#endif  // CONFIG_LOOP_RESTORATION
+
+  av1_dec_sync_frame_filter(pbi);
+  if (pbi->filter_data == NULL) {
+    CHECK_MEM_ERROR(cm, pbi->filter_data,
+                    aom_memalign(32, sizeof(*pbi->filter_data)));
+    av1_zero(*pbi->filter_data);
+    if (!winterface->reset(worker))
+      aom_internal_error(&cm->error, AOM_CODEC_ERROR,
+                         "Filter worker thread creation failed");
+  }
+  fd = pbi->filter_data;
+
+  mip = fd->cm.mip;
+  mi_grid_base = fd->cm.mi_grid_base;
+  mi_alloc_size = fd->cm.mi_alloc_size;
+#if CONFIG_LOOP_RESTORATION
+  memcpy(rst_info, fd->cm.rst_info, sizeof(rst_info));
+  rst_tmpbuf = fd->cm.rst_tmpbuf;
+#endif  // CONFIG_LOOP_RESTORATION
+
+  fd->cm = *cm;
+  fd->cm.error.setjmp = 0;
+  fd->xd = pbi->mb;
+  fd->xd.error_info = &fd->cm.error;
+
+  cm->mip = mip;
+  cm->mi_grid_base = mi_grid_base;
+  cm->mi_alloc_size = mi_alloc_size;
+#if CONFIG_LOOP_RESTORATION
+  for (p = 0; p < MAX_MB_PLANE; ++p) {
+    cm->rst_info[p].unit_info = rst_info[p].unit_info;
+    cm->rst_info[p].boundaries.stripe_boundary_above =
+        rst_info[p].boundaries.stripe_boundary_above;
+    cm->rst_info[p].boundaries.stripe_boundary_below =
+        rst_info[p].boundaries.stripe_boundary_below;
+  }
+  cm->rst_tmpbuf = rst_tmpbuf;
+#endif  // CONFIG_LOOP_RESTORATION
+  if (cm->mi_alloc_size < cm->mi_stride * calc_mi_size(cm->mi_rows)) {
+    cm->free_mi(cm);
+    if (cm->alloc_mi(cm, cm->mi_stride * calc_mi_size(cm->mi_rows)))
+      aom_internal_error(&cm->error, AOM_CODEC_MEM_ERROR,
+                         "Failed to allocate mode info");
+  }
+  cm->setup_mi(cm);
+
+  lock_buffer_pool(pool);
+  ++pbi->cur_buf->ref_count;
+  unlock_buffer_pool(pool);
+  fd->buf = pbi->cur_buf;
+  fd->stages = pbi->filter_stages;
+#if CONFIG_EXT_TILE
+  // For now, we only extend the frame borders when the whole frame is decoded.
+  fd->extend_borders = pbi->dec_tile_row == -1 && pbi->dec_tile_col == -1;
+#else
+  fd->extend_borders = 1;
+#endif  // CONFIG_EXT_TILE
+
+  worker->hook = (AVxWorkerHook)frame_filter_hook;
+  worker->data1 = pbi;
+  worker->data2 = NULL;
+  winterface->launch(worker);
+}
+
 static int equal_dimensions(const YV12_BUFFER_CONFIG *a,
                             const YV12_BUFFER_CONFIG *b) {
   return a->y_height == b->y_height && a->y_width == b->y_width &&
@@ -239,7 +413,7 @@ static void swap_frame_buffers(AV1Decoder *pbi) {
 
   // TODO(zoeliu): To fix the ref frame buffer update for the scenario of
   //               cm->frame_parellel_decode == 1
-  if (!cm->frame_parallel_decode || !cm->show_frame) {
+  if (!pbi->frame_parallel_decode || !cm->show_frame) {
     lock_buffer_pool(pool);
     --frame_bufs[cm->new_fb_idx].ref_count;
     unlock_buffer_pool(pool);
@@ -283,7 +457,7 @@ int av1_receive_compressed_data(AV1Decoder *pbi, size_t size,
 
   // Check if the previous frame was a frame without any references to it.
   // Release frame buffer if not decoding in frame parallel mode.
-  if (!cm->frame_parallel_decode && cm->new_fb_idx >= 0 &&
+  if (!pbi->frame_parallel_decode && cm->new_fb_idx >= 0 &&
       frame_bufs[cm->new_fb_idx].ref_count == 0)
     pool->release_fb_cb(pool->cb_priv,
                         &frame_bufs[cm->new_fb_idx].raw_frame_buffer);
@@ -296,22 +470,13 @@ int av1_receive_compressed_data(AV1Decoder *pbi, size_t size,
   cm->cur_frame = &pool->frame_bufs[cm->new_fb_idx];
 
   pbi->hold_ref_buf = 0;
-  if (cm->frame_parallel_decode) {
-    AVxWorker *const worker = pbi->frame_worker_owner;
-    av1_frameworker_lock_stats(worker);
-    frame_bufs[cm->new_fb_idx].frame_worker_owner = worker;
-    // Reset decoding progress.
-    pbi->cur_buf = &frame_bufs[cm->new_fb_idx];
-    pbi->cur_buf->row = -1;
-    pbi->cur_buf->col = -1;
-    av1_frameworker_unlock_stats(worker);
-  } else {
-    pbi->cur_buf = &frame_bufs[cm->new_fb_idx];
-  }
+  pbi->cur_buf = &frame_bufs[cm->new_fb_idx];
+  pbi->filter_stages = 0;
+  // Reset decoding progress.
+  if (pbi->frame_parallel_decode) av1_frame_progress_reset(pbi, pbi->cur_buf);
 
   if (setjmp(cm->error.jmp)) {
     const AVxWorkerInterface *const winterface = aom_get_worker_interface();
-    int i;
 
     cm->error.setjmp = 0;
     pbi->ready_for_new_data = 1;
@@ -319,9 +484,11 @@ int av1_receive_compressed_data(AV1Decoder *pbi, size_t size,
     // Synchronize all threads immediately as a subsequent decode call may
     // cause a resize invalidating some allocations.
     winterface->sync(&pbi->lf_worker);
-    for (i = 0; i < pbi->num_tile_workers; ++i) {
-      winterface->sync(&pbi->tile_workers[i]);
-    }
+    if (pbi->num_tile_workers > 0)
+      aom_scheduler_wait(pbi->scheduler, &pbi->tasks);
+    av1_dec_sync_frame_filter(pbi);
+    if (pbi->frame_parallel_decode)
+      av1_frame_progress_update(pbi, pbi->cur_buf, INT_MAX);
 
     lock_buffer_pool(pool);
     // Release all the reference buffers if worker thread is holding them.
@@ -376,16 +543,22 @@ int av1_receive_compressed_data(AV1Decoder *pbi, size_t size,
 
   swap_frame_buffers(pbi);
 
+  if (pbi->frame_parallel_decode) {
+    // The frame shown by show_existing_frame is already final, or being
+    // filtered.
+    if (!cm->show_existing_frame) start_frame_filter(pbi);
+  } else {
 #if CONFIG_EXT_TILE
-  // For now, we only extend the frame borders when the whole frame is decoded.
-  // Later, if needed, extend the border for the decoded tile on the frame
-  // border.
-  if (pbi->dec_tile_row == -1 && pbi->dec_tile_col == -1)
+    // For now, we only extend the frame borders when the whole frame is
+    // decoded. Later, if needed, extend the border for the decoded tile on the
+    // frame border.
+    if (pbi->dec_tile_row == -1 && pbi->dec_tile_col == -1)
 #endif  // CONFIG_EXT_TILE
-    // TODO(debargha): Fix encoder side mv range, so that we can use the
-    // inner border extension. As of now use the larger extension.
-    // aom_extend_frame_inner_borders(cm->frame_to_show);
-    aom_extend_frame_borders(cm->frame_to_show);
+      // TODO(debargha): Fix encoder side mv range, so that we can use the
+      // inner border extension. As of now use the larger extension.
+      // aom_extend_frame_inner_borders(cm->frame_to_show);
+      aom_extend_frame_borders(cm->frame_to_show);
+  }
 
   aom_clear_system_state();
 
@@ -395,7 +568,7 @@ int av1_receive_compressed_data(AV1Decoder *pbi, size_t size,
     // NOTE: It is not supposed to ref to any frame not used as reference
     if (cm->is_reference_frame) cm->prev_frame = cm->cur_frame;
 
-    if (cm->seg.enabled && !cm->frame_parallel_decode)
+    if (cm->seg.enabled)
 #if CONFIG_SEGMENT_PRED_LAST
       cm->last_frame_seg_map = cm->prev_frame->seg_map;
 #else
@@ -403,29 +576,12 @@ int av1_receive_compressed_data(AV1Decoder *pbi, size_t size,
 #endif
   }
 
-  // Update progress in frame parallel decode.
-  if (cm->frame_parallel_decode) {
-    // Need to lock the mutex here as another thread may
-    // be accessing this buffer.
-    AVxWorker *const worker = pbi->frame_worker_owner;
-    FrameWorkerData *const frame_worker_data = worker->data1;
-    av1_frameworker_lock_stats(worker);
-
-    if (cm->show_frame) {
-      cm->current_video_frame++;
-    }
-    frame_worker_data->frame_decoded = 1;
-    frame_worker_data->frame_context_ready = 1;
-    av1_frameworker_signal_stats(worker);
-    av1_frameworker_unlock_stats(worker);
-  } else {
-    cm->last_width = cm->width;
-    cm->last_height = cm->height;
-    cm->last_tile_cols = cm->tile_cols;
-    cm->last_tile_rows = cm->tile_rows;
-    if (cm->show_frame) {
-      cm->current_video_frame++;
-    }
+  cm->last_width = cm->width;
+  cm->last_height = cm->height;
+  cm->last_tile_cols = cm->tile_cols;
+  cm->last_tile_rows = cm->tile_rows;
+  if (cm->show_frame) {
+    cm->current_video_frame++;
   }
 
   cm->error.setjmp = 0;
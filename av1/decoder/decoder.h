@@ -51,6 +51,57 @@ typedef struct TileBufferDec {
   int col;                      // only used with multi-threaded decoding
 } TileBufferDec;
 
+typedef struct TileWorkerData {
+  struct AV1Decoder *pbi;
+  FRAME_COUNTS counts;
+  struct aom_internal_error_info error_info;
+  int start_tile, end_tile;  // Tile range of the current tile group.
+  // Row-based multi-threading: the tile being parsed, and the reconstruction
+  // state of this worker.
+  TileData *td;
+  DECLARE_ALIGNED(16, MACROBLOCKD, xd);
+  DECLARE_ALIGNED(16, tran_low_t, dqcoeff[MAX_TX_SQUARE]);
+} TileWorkerData;
+
+// Position of a coding block within a buffered superblock.
+typedef struct DecBlockInfo {
+  int mi_row;
+  int mi_col;
+  BLOCK_SIZE bsize;
+} DecBlockInfo;
+
+typedef struct DecEobInfo {
+  uint16_t eob;
+  int16_t max_scan_line;
+} DecEobInfo;
+
+// One superblock of row-based multi-threaded decoding. The parse stage stores
+// the coding blocks, dequantized coefficients and palette color indices of
+// the superblock; the reconstruction stage consumes them in the same order.
+// The coefficients of each transform block are packed up to the last nonzero
+// one in raster order, so that the stages only touch the coefficients coded.
+typedef struct DecSbBuffer {
+  DecBlockInfo *blocks;
+  int num_blocks;
+  tran_low_t *dqcoeff[MAX_MB_PLANE];
+  DecEobInfo *eob_info[MAX_MB_PLANE];
+  uint8_t *color_index_map[2];
+  // Positions of the stage currently walking the superblock.
+  int dqcoeff_pos[MAX_MB_PLANE];
+  int eob_pos[MAX_MB_PLANE];
+  int color_index_pos[2];
+} DecSbBuffer;
+
+// Frame parallel decoding: the state the in-loop filters of a frame need once
+// decoding has moved on to the next frame, owned by the filter worker.
+typedef struct FrameFilterData {
+  DECLARE_ALIGNED(16, AV1_COMMON, cm);
+  DECLARE_ALIGNED(16, MACROBLOCKD, xd);
+  RefCntBuffer *buf;  // The frame being filtered, holding a reference.
+  int stages;         // FILTER_STAGE_* flags of the frame.
+  int extend_borders;
+} FrameFilterData;
+
 typedef struct AV1Decoder {
   DECLARE_ALIGNED(16, MACROBLOCKD, mb);
 
@@ -64,10 +115,11 @@ typedef struct AV1Decoder {
   // the same.
   RefCntBuffer *cur_buf;  //  Current decoding frame buffer.
 
-  AVxWorker *frame_worker_owner;  // frame_worker that owns this pbi.
   AVxWorker lf_worker;
-  AVxWorker *tile_workers;
-  TileInfo *tile_worker_info;
+  aom_thread_pool_t thread_pool;  // Set by AOM_SET_THREAD_POOL.
+  AVxScheduler *scheduler;
+  AVxTaskGroup tasks;  // The tile workers, which take the jobs in turn.
+  TileWorkerData *tile_worker_data;
   int num_tile_workers;
 
   TileData *tile_data;
@@ -76,6 +128,33 @@ typedef struct AV1Decoder {
   TileBufferDec tile_buffers[MAX_TILE_ROWS][MAX_TILE_COLS];
 
   AV1LfSync lf_row_sync;
+  AV1FilterSync filter_sync;
+
+  // Frame parallel decoding: the in-loop filters and border extension of each
+  // frame run on filter_worker while the next frame is decoded. Progress is
+  // published in RefCntBuffer.row; inter prediction waits on the rows it
+  // reads.
+  int frame_parallel_decode;
+  AVxWorker filter_worker;
+  FrameFilterData *filter_data;
+  int filter_stages;  // Filter stages deferred to filter_worker.
+#if CONFIG_MULTITHREAD
+  pthread_mutex_t progress_mutex;
+  pthread_cond_t progress_cond;
+#endif
+
+  // Row-based multi-threaded decoding of single tile column streams. The
+  // superblock buffers form a ring of sb_buffer_rows superblock rows.
+  int row_mt;
+  AV1DecRowMTSync row_mt_sync;
+  DecSbBuffer *sb_buffers;
+  int sb_buffer_rows;
+  int sb_buffer_cols;
+  int sb_buffer_coeffs;  // Coefficients held by each superblock buffer.
+  tran_low_t *sb_dqcoeff;
+  DecEobInfo *sb_eob_info;
+  uint8_t *sb_color_index_map;
+  DecBlockInfo *sb_blocks;
 
   aom_decrypt_cb decrypt_cb;
   void *decrypt_state;
@@ -141,6 +220,11 @@ struct AV1Decoder *av1_decoder_create(BufferPool *const pool);
 
 void av1_decoder_remove(struct AV1Decoder *pbi);
 
+void av1_dec_free_sb_buffers(struct AV1Decoder *pbi);
+
+// Waits for the frame on the filter worker, if any, and releases it.
+void av1_dec_sync_frame_filter(struct AV1Decoder *pbi);
+
 static INLINE void decrease_ref_count(int idx, RefCntBuffer *const frame_bufs,
                                       BufferPool *const pool) {
   if (idx >= 0) {
@@ -15,183 +15,251 @@
 #include "av1/decoder/dthread.h"
 #include "av1/decoder/decoder.h"
 
-// #define DEBUG_THREAD
+void av1_frame_progress_reset(AV1Decoder *pbi, RefCntBuffer *buf) {
+  av1_frame_progress_update(pbi, buf, -1);
+}
 
-// TODO(hkuang): Clean up all the #ifdef in this file.
-void av1_frameworker_lock_stats(AVxWorker *const worker) {
+void av1_frame_progress_update(AV1Decoder *pbi, RefCntBuffer *buf, int row) {
 #if CONFIG_MULTITHREAD
-  FrameWorkerData *const worker_data = worker->data1;
-  pthread_mutex_lock(&worker_data->stats_mutex);
+  pthread_mutex_lock(&pbi->progress_mutex);
+  buf->row = row;
+// TODO(hkuang): Fix the pthread_cond_broadcast in windows wrapper.
+#if defined(_WIN32) && !HAVE_PTHREAD_H
+  pthread_cond_signal(&pbi->progress_cond);
 #else
-  (void)worker;
+  pthread_cond_broadcast(&pbi->progress_cond);
 #endif
+  pthread_mutex_unlock(&pbi->progress_mutex);
+#else
+  (void)pbi;
+  buf->row = row;
+#endif  // CONFIG_MULTITHREAD
 }
 
-void av1_frameworker_unlock_stats(AVxWorker *const worker) {
+void av1_frame_progress_wait(AV1Decoder *pbi, const RefCntBuffer *buf,
+                             int row) {
 #if CONFIG_MULTITHREAD
-  FrameWorkerData *const worker_data = worker->data1;
-  pthread_mutex_unlock(&worker_data->stats_mutex);
+  pthread_mutex_lock(&pbi->progress_mutex);
+  while (buf->row < row)
+    pthread_cond_wait(&pbi->progress_cond, &pbi->progress_mutex);
+  pthread_mutex_unlock(&pbi->progress_mutex);
 #else
-  (void)worker;
-#endif
+  // The filter worker runs on the calling thread, so the frame is final.
+  (void)pbi;
+  (void)buf;
+  (void)row;
+#endif  // CONFIG_MULTITHREAD
+}
+
+static INLINE int get_row_mt_sync_range(int width) {
+  // Same granularity as the loop filter row synchronization.
+  if (width < 640)
+    return 1;
+  else if (width <= 1280)
+    return 2;
+  else if (width <= 4096)
+    return 4;
+  else
+    return 8;
 }
 
-void av1_frameworker_signal_stats(AVxWorker *const worker) {
+void av1_dec_row_mt_alloc(AV1DecRowMTSync *row_mt_sync, AV1_COMMON *cm,
+                          int rows, int width) {
+  row_mt_sync->rows = rows;
 #if CONFIG_MULTITHREAD
-  FrameWorkerData *const worker_data = worker->data1;
+  {
+    int i;
 
-// TODO(hkuang): Fix the pthread_cond_broadcast in windows wrapper.
-#if defined(_WIN32) && !HAVE_PTHREAD_H
-  pthread_cond_signal(&worker_data->stats_cond);
-#else
-  pthread_cond_broadcast(&worker_data->stats_cond);
-#endif
+    pthread_mutex_init(&row_mt_sync->done_mutex_, NULL);
+    pthread_cond_init(&row_mt_sync->done_cond_, NULL);
 
-#else
-  (void)worker;
-#endif
+    CHECK_MEM_ERROR(cm, row_mt_sync->mutex_,
+                    aom_malloc(sizeof(*row_mt_sync->mutex_) * rows));
+    for (i = 0; i < rows; ++i)
+      pthread_mutex_init(&row_mt_sync->mutex_[i], NULL);
+
+    CHECK_MEM_ERROR(cm, row_mt_sync->parse_cond_,
+                    aom_malloc(sizeof(*row_mt_sync->parse_cond_) * rows));
+    for (i = 0; i < rows; ++i)
+      pthread_cond_init(&row_mt_sync->parse_cond_[i], NULL);
+
+    CHECK_MEM_ERROR(cm, row_mt_sync->recon_cond_,
+                    aom_malloc(sizeof(*row_mt_sync->recon_cond_) * rows));
+    for (i = 0; i < rows; ++i)
+      pthread_cond_init(&row_mt_sync->recon_cond_[i], NULL);
+  }
+#endif  // CONFIG_MULTITHREAD
+
+  CHECK_MEM_ERROR(cm, row_mt_sync->parsed_sb_cols,
+                  aom_calloc(rows, sizeof(*row_mt_sync->parsed_sb_cols)));
+  CHECK_MEM_ERROR(cm, row_mt_sync->recon_sb_cols,
+                  aom_calloc(rows, sizeof(*row_mt_sync->recon_sb_cols)));
+
+  row_mt_sync->sync_range = get_row_mt_sync_range(width);
 }
 
-// This macro prevents thread_sanitizer from reporting known concurrent writes.
-#if defined(__has_feature)
-#if __has_feature(thread_sanitizer)
-#define BUILDING_WITH_TSAN
-#endif
-#endif
+void av1_dec_row_mt_dealloc(AV1DecRowMTSync *row_mt_sync) {
+  if (row_mt_sync != NULL) {
+#if CONFIG_MULTITHREAD
+    int i;
+
+    if (row_mt_sync->mutex_ != NULL) {
+      for (i = 0; i < row_mt_sync->rows; ++i)
+        pthread_mutex_destroy(&row_mt_sync->mutex_[i]);
+      aom_free(row_mt_sync->mutex_);
+    }
+    if (row_mt_sync->parse_cond_ != NULL) {
+      for (i = 0; i < row_mt_sync->rows; ++i)
+        pthread_cond_destroy(&row_mt_sync->parse_cond_[i]);
+      aom_free(row_mt_sync->parse_cond_);
+    }
+    if (row_mt_sync->recon_cond_ != NULL) {
+      for (i = 0; i < row_mt_sync->rows; ++i)
+        pthread_cond_destroy(&row_mt_sync->recon_cond_[i]);
+      aom_free(row_mt_sync->recon_cond_);
+    }
+    if (row_mt_sync->rows > 0) {
+      pthread_mutex_destroy(&row_mt_sync->done_mutex_);
+      pthread_cond_destroy(&row_mt_sync->done_cond_);
+    }
+#endif  // CONFIG_MULTITHREAD
+    aom_free(row_mt_sync->parsed_sb_cols);
+    aom_free(row_mt_sync->recon_sb_cols);
+    // clear the structure as the source of this call may be a resize in which
+    // case this call will be followed by an _alloc() which may fail.
+    av1_zero(*row_mt_sync);
+  }
+}
+
+void av1_dec_row_mt_reset(AV1DecRowMTSync *row_mt_sync) {
+  memset(row_mt_sync->parsed_sb_cols, 0,
+         sizeof(*row_mt_sync->parsed_sb_cols) * row_mt_sync->rows);
+  memset(row_mt_sync->recon_sb_cols, 0,
+         sizeof(*row_mt_sync->recon_sb_cols) * row_mt_sync->rows);
+  row_mt_sync->recon_rows_done = 0;
+  row_mt_sync->abort = 0;
+}
 
-// TODO(hkuang): Remove worker parameter as it is only used in debug code.
-void av1_frameworker_wait(AVxWorker *const worker, RefCntBuffer *const ref_buf,
-                          int row) {
 #if CONFIG_MULTITHREAD
-  if (!ref_buf) return;
+// Publishes that superblock c of row r is done, in batches of sync_range
+// superblocks. The end of the row is published as sb_cols + sync_range so
+// that it satisfies every wait on that row.
+static void set_progress(AV1DecRowMTSync *row_mt_sync, int *sb_cols_done,
+                         pthread_cond_t *cond, int r, int c, int sb_cols) {
+  const int nsync = row_mt_sync->sync_range;
+  int cur;
 
-#ifndef BUILDING_WITH_TSAN
-  // The following line of code will get harmless tsan error but it is the key
-  // to get best performance.
-  if (ref_buf->row >= row && ref_buf->buf.corrupted != 1) return;
-#endif
+  if (c < sb_cols - 1) {
+    cur = c;
+    if (c % nsync) return;
+  } else {
+    cur = sb_cols + nsync;
+  }
 
-  {
-    // Find the worker thread that owns the reference frame. If the reference
-    // frame has been fully decoded, it may not have owner.
-    AVxWorker *const ref_worker = ref_buf->frame_worker_owner;
-    FrameWorkerData *const ref_worker_data =
-        (FrameWorkerData *)ref_worker->data1;
-    const AV1Decoder *const pbi = ref_worker_data->pbi;
-
-#ifdef DEBUG_THREAD
-    {
-      FrameWorkerData *const worker_data = (FrameWorkerData *)worker->data1;
-      printf("%d %p worker is waiting for %d %p worker (%d)  ref %d \r\n",
-             worker_data->worker_id, worker, ref_worker_data->worker_id,
-             ref_buf->frame_worker_owner, row, ref_buf->row);
-    }
-#endif
+  pthread_mutex_lock(&row_mt_sync->mutex_[r]);
+  sb_cols_done[r] = cur;
+  pthread_cond_signal(&cond[r]);
+  pthread_mutex_unlock(&row_mt_sync->mutex_[r]);
+}
 
-    av1_frameworker_lock_stats(ref_worker);
-    while (ref_buf->row < row && pbi->cur_buf == ref_buf &&
-           ref_buf->buf.corrupted != 1) {
-      pthread_cond_wait(&ref_worker_data->stats_cond,
-                        &ref_worker_data->stats_mutex);
-    }
+static int wait_progress(AV1DecRowMTSync *row_mt_sync, const int *sb_cols_done,
+                         pthread_cond_t *cond, int r, int c) {
+  const int nsync = row_mt_sync->sync_range;
+  int ok;
 
-    if (ref_buf->buf.corrupted == 1) {
-      FrameWorkerData *const worker_data = (FrameWorkerData *)worker->data1;
-      av1_frameworker_unlock_stats(ref_worker);
-      aom_internal_error(&worker_data->pbi->common.error,
-                         AOM_CODEC_CORRUPT_FRAME,
-                         "Worker %p failed to decode frame", worker);
-    }
-    av1_frameworker_unlock_stats(ref_worker);
+  pthread_mutex_lock(&row_mt_sync->mutex_[r]);
+  while (sb_cols_done[r] < c + nsync && !row_mt_sync->abort)
+    pthread_cond_wait(&cond[r], &row_mt_sync->mutex_[r]);
+  ok = !row_mt_sync->abort;
+  pthread_mutex_unlock(&row_mt_sync->mutex_[r]);
+  return ok;
+}
+#endif  // CONFIG_MULTITHREAD
+
+void av1_dec_row_mt_set_parsed(AV1DecRowMTSync *row_mt_sync, int r, int c,
+                               int sb_cols) {
+#if CONFIG_MULTITHREAD
+  set_progress(row_mt_sync, row_mt_sync->parsed_sb_cols,
+               row_mt_sync->parse_cond_, r, c, sb_cols);
+#else
+  (void)row_mt_sync;
+  (void)r;
+  (void)c;
+  (void)sb_cols;
+#endif  // CONFIG_MULTITHREAD
+}
+
+void av1_dec_row_mt_set_recon(AV1DecRowMTSync *row_mt_sync, int r, int c,
+                              int sb_cols) {
+#if CONFIG_MULTITHREAD
+  set_progress(row_mt_sync, row_mt_sync->recon_sb_cols,
+               row_mt_sync->recon_cond_, r, c, sb_cols);
+  if (c == sb_cols - 1) {
+    pthread_mutex_lock(&row_mt_sync->done_mutex_);
+    ++row_mt_sync->recon_rows_done;
+    pthread_cond_signal(&row_mt_sync->done_cond_);
+    pthread_mutex_unlock(&row_mt_sync->done_mutex_);
   }
 #else
-  (void)worker;
-  (void)ref_buf;
-  (void)row;
-  (void)ref_buf;
+  (void)row_mt_sync;
+  (void)r;
+  (void)c;
+  (void)sb_cols;
 #endif  // CONFIG_MULTITHREAD
 }
 
-void av1_frameworker_broadcast(RefCntBuffer *const buf, int row) {
+int av1_dec_row_mt_wait_recon(AV1DecRowMTSync *row_mt_sync, int r, int c) {
 #if CONFIG_MULTITHREAD
-  AVxWorker *worker = buf->frame_worker_owner;
+  const int nsync = row_mt_sync->sync_range;
 
-#ifdef DEBUG_THREAD
-  {
-    FrameWorkerData *const worker_data = (FrameWorkerData *)worker->data1;
-    printf("%d %p worker decode to (%d) \r\n", worker_data->worker_id,
-           buf->frame_worker_owner, row);
-  }
-#endif
+  // Each wait covers the next nsync superblocks.
+  if (c & (nsync - 1)) return 1;
+  if (!wait_progress(row_mt_sync, row_mt_sync->parsed_sb_cols,
+                     row_mt_sync->parse_cond_, r, c))
+    return 0;
+  if (r > 0 && !wait_progress(row_mt_sync, row_mt_sync->recon_sb_cols,
+                              row_mt_sync->recon_cond_, r - 1, c))
+    return 0;
+  return 1;
+#else
+  (void)r;
+  (void)c;
+  return !row_mt_sync->abort;
+#endif  // CONFIG_MULTITHREAD
+}
 
-  av1_frameworker_lock_stats(worker);
-  buf->row = row;
-  av1_frameworker_signal_stats(worker);
-  av1_frameworker_unlock_stats(worker);
+int av1_dec_row_mt_wait_rows_done(AV1DecRowMTSync *row_mt_sync, int rows) {
+#if CONFIG_MULTITHREAD
+  int ok;
+
+  pthread_mutex_lock(&row_mt_sync->done_mutex_);
+  while (row_mt_sync->recon_rows_done < rows && !row_mt_sync->abort)
+    pthread_cond_wait(&row_mt_sync->done_cond_, &row_mt_sync->done_mutex_);
+  ok = !row_mt_sync->abort;
+  pthread_mutex_unlock(&row_mt_sync->done_mutex_);
+  return ok;
 #else
-  (void)buf;
-  (void)row;
+  (void)rows;
+  return !row_mt_sync->abort;
 #endif  // CONFIG_MULTITHREAD
 }
 
-void av1_frameworker_copy_context(AVxWorker *const dst_worker,
-                                  AVxWorker *const src_worker) {
+void av1_dec_row_mt_abort(AV1DecRowMTSync *row_mt_sync) {
 #if CONFIG_MULTITHREAD
-  FrameWorkerData *const src_worker_data = (FrameWorkerData *)src_worker->data1;
-  FrameWorkerData *const dst_worker_data = (FrameWorkerData *)dst_worker->data1;
-  AV1_COMMON *const src_cm = &src_worker_data->pbi->common;
-  AV1_COMMON *const dst_cm = &dst_worker_data->pbi->common;
   int i;
 
-  // Wait until source frame's context is ready.
-  av1_frameworker_lock_stats(src_worker);
-  while (!src_worker_data->frame_context_ready) {
-    pthread_cond_wait(&src_worker_data->stats_cond,
-                      &src_worker_data->stats_mutex);
+  for (i = 0; i < row_mt_sync->rows; ++i) {
+    pthread_mutex_lock(&row_mt_sync->mutex_[i]);
+    row_mt_sync->abort = 1;
+    pthread_cond_signal(&row_mt_sync->parse_cond_[i]);
+    pthread_cond_signal(&row_mt_sync->recon_cond_[i]);
+    pthread_mutex_unlock(&row_mt_sync->mutex_[i]);
   }
-
-  dst_cm->last_frame_seg_map = src_cm->seg.enabled
-                                   ? src_cm->current_frame_seg_map
-                                   : src_cm->last_frame_seg_map;
-  dst_worker_data->pbi->need_resync = src_worker_data->pbi->need_resync;
-  av1_frameworker_unlock_stats(src_worker);
-
-  dst_cm->bit_depth = src_cm->bit_depth;
-#if CONFIG_HIGHBITDEPTH
-  dst_cm->use_highbitdepth = src_cm->use_highbitdepth;
-#endif
-  // TODO(zoeliu): To handle parallel decoding
-  dst_cm->prev_frame =
-      src_cm->show_existing_frame ? src_cm->prev_frame : src_cm->cur_frame;
-  dst_cm->last_width =
-      !src_cm->show_existing_frame ? src_cm->width : src_cm->last_width;
-  dst_cm->last_height =
-      !src_cm->show_existing_frame ? src_cm->height : src_cm->last_height;
-  dst_cm->subsampling_x = src_cm->subsampling_x;
-  dst_cm->subsampling_y = src_cm->subsampling_y;
-  dst_cm->frame_type = src_cm->frame_type;
-  dst_cm->last_show_frame = !src_cm->show_existing_frame
-                                ? src_cm->show_frame
-                                : src_cm->last_show_frame;
-  for (i = 0; i < REF_FRAMES; ++i)
-    dst_cm->ref_frame_map[i] = src_cm->next_ref_frame_map[i];
-
-  memcpy(dst_cm->lf_info.lfthr, src_cm->lf_info.lfthr,
-         (MAX_LOOP_FILTER + 1) * sizeof(loop_filter_thresh));
-  dst_cm->lf.last_sharpness_level = src_cm->lf.sharpness_level;
-#if CONFIG_LOOPFILTER_LEVEL
-  dst_cm->lf.filter_level[0] = src_cm->lf.filter_level[0];
-  dst_cm->lf.filter_level[1] = src_cm->lf.filter_level[1];
-#else
-  dst_cm->lf.filter_level = src_cm->lf.filter_level;
-#endif
-  memcpy(dst_cm->lf.ref_deltas, src_cm->lf.ref_deltas, TOTAL_REFS_PER_FRAME);
-  memcpy(dst_cm->lf.mode_deltas, src_cm->lf.mode_deltas, MAX_MODE_LF_DELTAS);
-  dst_cm->seg = src_cm->seg;
-  memcpy(dst_cm->frame_contexts, src_cm->frame_contexts,
-         FRAME_CONTEXTS * sizeof(dst_cm->frame_contexts[0]));
+  pthread_mutex_lock(&row_mt_sync->done_mutex_);
+  row_mt_sync->abort = 1;
+  pthread_cond_signal(&row_mt_sync->done_cond_);
+  pthread_mutex_unlock(&row_mt_sync->done_mutex_);
 #else
-  (void)dst_worker;
-  (void)src_worker;
+  row_mt_sync->abort = 1;
 #endif  // CONFIG_MULTITHREAD
 }
@@ -32,41 +32,74 @@ typedef struct FrameWorkerData {
   size_t data_size;
   void *user_priv;
   int result;
-  int worker_id;
   int received_frame;
+} FrameWorkerData;
 
-  // scratch_buffer is used in frame parallel mode only.
-  // It is used to make a copy of the compressed data.
-  uint8_t *scratch_buffer;
-  size_t scratch_buffer_size;
-
+// Progress of the two stages of row-based multi-threaded decoding of a tile.
+// One thread parses the tile superblock by superblock while the other threads
+// reconstruct whole superblock rows, each staying behind both the parser and
+// the reconstruction of the row above. Every condition variable has a single
+// waiter so that pthread_cond_signal() is sufficient.
+typedef struct AV1DecRowMTSync {
 #if CONFIG_MULTITHREAD
-  pthread_mutex_t stats_mutex;
-  pthread_cond_t stats_cond;
+  pthread_mutex_t *mutex_;
+  pthread_cond_t *parse_cond_;  // Waited on by the reconstruction of a row.
+  pthread_cond_t *recon_cond_;  // Waited on by the reconstruction below.
+  pthread_mutex_t done_mutex_;
+  pthread_cond_t done_cond_;  // Waited on by the parser.
 #endif
+  int *parsed_sb_cols;  // Published parse progress of each superblock row.
+  int *recon_sb_cols;   // Published reconstruction progress of each row.
+  int recon_rows_done;  // Superblock rows fully reconstructed.
+  int rows;             // Superblock rows allocated.
+  int sync_range;       // Superblocks between two progress updates.
+  int abort;
+} AV1DecRowMTSync;
 
-  int frame_context_ready;  // Current frame's context is ready to read.
-  int frame_decoded;        // Finished decoding current frame.
-} FrameWorkerData;
+// Frame parallel decoding progress, kept in RefCntBuffer.row under the
+// progress mutex of the decoder. The frame being filtered may be waited on by
+// several tile workers at once.
+
+// Marks buf as not decoded, before decoding into it begins.
+void av1_frame_progress_reset(struct AV1Decoder *pbi, RefCntBuffer *buf);
+
+// Publishes that the first row luma rows of buf are final, borders included.
+// INT_MAX marks the whole frame as final.
+void av1_frame_progress_update(struct AV1Decoder *pbi, RefCntBuffer *buf,
+                               int row);
+
+// Waits until the first row luma rows of buf are final.
+void av1_frame_progress_wait(struct AV1Decoder *pbi, const RefCntBuffer *buf,
+                             int row);
+
+// Allocates the row-based multi-threading sync for a tile of at most |rows|
+// superblock rows and |width| pixels.
+void av1_dec_row_mt_alloc(AV1DecRowMTSync *row_mt_sync,
+                          struct AV1Common *cm, int rows, int width);
+
+void av1_dec_row_mt_dealloc(AV1DecRowMTSync *row_mt_sync);
+
+// Clears the progress before decoding a new tile.
+void av1_dec_row_mt_reset(AV1DecRowMTSync *row_mt_sync);
 
-void av1_frameworker_lock_stats(AVxWorker *const worker);
-void av1_frameworker_unlock_stats(AVxWorker *const worker);
-void av1_frameworker_signal_stats(AVxWorker *const worker);
+// Superblock (r, c) has been parsed / reconstructed. |sb_cols| is the width
+// of the tile in superblocks.
+void av1_dec_row_mt_set_parsed(AV1DecRowMTSync *row_mt_sync, int r, int c,
+                               int sb_cols);
+void av1_dec_row_mt_set_recon(AV1DecRowMTSync *row_mt_sync, int r, int c,
+                              int sb_cols);
 
-// Wait until ref_buf has been decoded to row in real pixel unit.
-// Note: worker may already finish decoding ref_buf and release it in order to
-// start decoding next frame. So need to check whether worker is still decoding
-// ref_buf.
-void av1_frameworker_wait(AVxWorker *const worker, RefCntBuffer *const ref_buf,
-                          int row);
+// Waits until superblock (r, c) may be reconstructed: it has been parsed and
+// its above-right neighbour has been reconstructed. Returns 0 if decoding
+// was aborted.
+int av1_dec_row_mt_wait_recon(AV1DecRowMTSync *row_mt_sync, int r, int c);
 
-// FrameWorker broadcasts its decoding progress so other workers that are
-// waiting on it can resume decoding.
-void av1_frameworker_broadcast(RefCntBuffer *const buf, int row);
+// Waits until the first |rows| superblock rows have been reconstructed so
+// that their buffers can be reused. Returns 0 if decoding was aborted.
+int av1_dec_row_mt_wait_rows_done(AV1DecRowMTSync *row_mt_sync, int rows);
 
-// Copy necessary decoding context from src worker to dst worker.
-void av1_frameworker_copy_context(AVxWorker *const dst_worker,
-                                  AVxWorker *const src_worker);
+// Wakes up all the waiting threads and makes further waits fail.
+void av1_dec_row_mt_abort(AV1DecRowMTSync *row_mt_sync);
 
 #ifdef __cplusplus
 }  // extern "C"
@@ -1193,8 +1193,8 @@ static void write_cfl_alphas(FRAME_CONTEXT *const ec_ctx, int idx,
 }
 #endif
 
-static void write_cdef(AV1_COMMON *cm, aom_writer *w, int skip, int mi_col,
-                       int mi_row) {
+static void write_cdef(AV1_COMMON *cm, MACROBLOCKD *const xd, aom_writer *w,
+                       int skip, int mi_col, int mi_row) {
   if (cm->all_lossless) return;
 
   const int m = ~((1 << (6 - MI_SIZE_LOG2)) - 1);
@@ -1204,10 +1204,10 @@ static void write_cdef(AV1_COMMON *cm, aom_writer *w, int skip, int mi_col,
   if (!(mi_row & (cm->mib_size - 1)) &&
       !(mi_col & (cm->mib_size - 1))) {  // Top left?
 #if CONFIG_EXT_PARTITION
-    cm->cdef_preset[0] = cm->cdef_preset[1] = cm->cdef_preset[2] =
-        cm->cdef_preset[3] = -1;
+    xd->cdef_preset[0] = xd->cdef_preset[1] = xd->cdef_preset[2] =
+        xd->cdef_preset[3] = -1;
 #else
-    cm->cdef_preset = -1;
+    xd->cdef_preset = -1;
 #endif
   }
 
@@ -1217,14 +1217,14 @@ static void write_cdef(AV1_COMMON *cm, aom_writer *w, int skip, int mi_col,
   const int index = cm->sb_size == BLOCK_128X128
                         ? !!(mi_col & mask) + 2 * !!(mi_row & mask)
                         : 0;
-  if (cm->cdef_preset[index] == -1 && !skip) {
+  if (xd->cdef_preset[index] == -1 && !skip) {
     aom_write_literal(w, mbmi->cdef_strength, cm->cdef_bits);
-    cm->cdef_preset[index] = mbmi->cdef_strength;
+    xd->cdef_preset[index] = mbmi->cdef_strength;
   }
 #else
-  if (cm->cdef_preset == -1 && !skip) {
+  if (xd->cdef_preset == -1 && !skip) {
     aom_write_literal(w, mbmi->cdef_strength, cm->cdef_bits);
-    cm->cdef_preset = mbmi->cdef_strength;
+    xd->cdef_preset = mbmi->cdef_strength;
   }
 #endif
 }
@@ -1341,7 +1341,7 @@ static void pack_inter_mode_mvs(AV1_COMP *cpi, const int mi_row,
   write_inter_segment_id(cpi, w, seg, segp, mi_row, mi_col, skip, 0);
 #endif
 
-  write_cdef(cm, w, skip, mi_col, mi_row);
+  write_cdef(cm, xd, w, skip, mi_col, mi_row);
 
   if (cm->delta_q_present_flag) {
     int super_block_upper_left = ((mi_row & (cm->mib_size - 1)) == 0) &&
@@ -1676,7 +1676,7 @@ static void write_mb_modes_kf(AV1_COMP *cpi, MACROBLOCKD *xd,
     write_segment_id(cpi, mbmi, w, seg, segp, mi_row, mi_col, skip);
 #endif
 
-  write_cdef(cm, w, skip, mi_col, mi_row);
+  write_cdef(cm, xd, w, skip, mi_col, mi_row);
 
   if (cm->delta_q_present_flag) {
     int super_block_upper_left = ((mi_row & (cm->mib_size - 1)) == 0) &&
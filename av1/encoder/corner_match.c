@@ -14,6 +14,8 @@
 #include <math.h>
 
 #include "./av1_rtcd.h"
+#include "aom_dsp/aom_dsp_common.h"
+#include "aom_mem/aom_mem.h"
 #include "av1/encoder/corner_match.h"
 
 #define SEARCH_SZ 9
@@ -72,13 +74,119 @@ static int is_eligible_point(int pointx, int pointy, int width, int height) {
           pointx + MATCH_SZ_BY2 < width && pointy + MATCH_SZ_BY2 < height);
 }
 
+static int get_distance_thresh(int width, int height) {
+  return (width < height ? height : width) >> 4;
+}
+
 static int is_eligible_distance(int point1x, int point1y, int point2x,
                                 int point2y, int width, int height) {
-  const int thresh = (width < height ? height : width) >> 4;
+  const int thresh = get_distance_thresh(width, height);
   return ((point1x - point2x) * (point1x - point2x) +
           (point1y - point2y) * (point1y - point2y)) <= thresh * thresh;
 }
 
+// The eligible reference corners, bucketed into square cells as wide as the
+// largest distance allowed between matching corners, so that the candidates
+// for a corner all lie in the 3x3 cells around its own.
+typedef struct {
+  int cell_size;
+  int cols, rows;
+  // Cell c holds points[cell_start[c]] up to points[cell_start[c + 1]], in
+  // increasing order.
+  int *cell_start;
+  int *points;
+} CornerGrid;
+
+static int build_corner_grid(CornerGrid *grid, const int *corners,
+                             int num_corners, int width, int height) {
+  int i, c, num_cells;
+  grid->cell_size = AOMMAX(get_distance_thresh(width, height), 1);
+  grid->cols = (width - 1) / grid->cell_size + 1;
+  grid->rows = (height - 1) / grid->cell_size + 1;
+  num_cells = grid->cols * grid->rows;
+  grid->cell_start =
+      (int *)aom_calloc(num_cells + 1, sizeof(*grid->cell_start));
+  grid->points = (int *)aom_malloc(AOMMAX(num_corners, 1) *
+                                   sizeof(*grid->points));
+  if (!grid->cell_start || !grid->points) return 0;
+
+  // Counting sort of the corners by cell, which keeps each cell in order.
+  for (i = 0; i < num_corners; ++i) {
+    const int x = corners[2 * i], y = corners[2 * i + 1];
+    if (!is_eligible_point(x, y, width, height)) continue;
+    ++grid->cell_start[(y / grid->cell_size) * grid->cols +
+                       x / grid->cell_size + 1];
+  }
+  for (c = 0; c < num_cells; ++c)
+    grid->cell_start[c + 1] += grid->cell_start[c];
+  for (i = 0; i < num_corners; ++i) {
+    const int x = corners[2 * i], y = corners[2 * i + 1];
+    int *const next = &grid->cell_start[(y / grid->cell_size) * grid->cols +
+                                        x / grid->cell_size];
+    if (!is_eligible_point(x, y, width, height)) continue;
+    grid->points[(*next)++] = i;
+  }
+  // Each cell_start[c] now holds the end of cell c; shift them back.
+  for (c = num_cells; c > 0; --c)
+    grid->cell_start[c] = grid->cell_start[c - 1];
+  grid->cell_start[0] = 0;
+  return 1;
+}
+
+static void free_corner_grid(CornerGrid *grid) {
+  aom_free(grid->cell_start);
+  aom_free(grid->points);
+}
+
+// Gathers into |candidates| the reference corners close enough to (x, y) to
+// match it, and returns how many there are.
+static int get_candidates(const CornerGrid *grid, const int *ref_corners,
+                          int x, int y, int width, int height,
+                          int *candidates) {
+  const int cx = x / grid->cell_size, cy = y / grid->cell_size;
+  int num_candidates = 0;
+  int row, col, k;
+  for (row = AOMMAX(cy - 1, 0); row <= AOMMIN(cy + 1, grid->rows - 1); ++row) {
+    for (col = AOMMAX(cx - 1, 0); col <= AOMMIN(cx + 1, grid->cols - 1);
+         ++col) {
+      const int c = row * grid->cols + col;
+      for (k = grid->cell_start[c]; k < grid->cell_start[c + 1]; ++k) {
+        const int j = grid->points[k];
+        if (is_eligible_distance(x, y, ref_corners[2 * j],
+                                 ref_corners[2 * j + 1], width, height))
+          candidates[num_candidates++] = j;
+      }
+    }
+  }
+  return num_candidates;
+}
+
+// Scores a batch of candidate reference corners against the window of frm
+// at (x, y), and returns the best one, or -1 if none correlates positively.
+// Ties go to the earliest corner, as a scan over all of them in order would
+// pick.
+static int find_best_match(unsigned char *frm, int frm_stride, int x, int y,
+                           unsigned char *ref, int ref_stride,
+                           const int *ref_corners, const int *candidates,
+                           int num_candidates, double *best_match_ncc) {
+  int best_match_j = -1;
+  int k;
+  *best_match_ncc = 0.0;
+  for (k = 0; k < num_candidates; ++k) {
+    const int j = candidates[k];
+    const double match_ncc =
+        compute_cross_correlation(frm, frm_stride, x, y, ref, ref_stride,
+                                  ref_corners[2 * j], ref_corners[2 * j + 1]);
+    if (match_ncc > *best_match_ncc ||
+        (match_ncc == *best_match_ncc && best_match_j >= 0 &&
+         j < best_match_j)) {
+      *best_match_ncc = match_ncc;
+      best_match_j = j;
+    }
+  }
+  return best_match_j;
+}
+
 static void improve_correspondence(unsigned char *frm, unsigned char *ref,
                                    int width, int height, int frm_stride,
                                    int ref_stride,
@@ -144,33 +252,32 @@ int determine_correspondence(unsigned char *frm, int *frm_corners,
                              int height, int frm_stride, int ref_stride,
                              int *correspondence_pts) {
   // TODO(sarahparker) Improve this to include 2-way match
-  int i, j;
+  int i;
   Correspondence *correspondences = (Correspondence *)correspondence_pts;
   int num_correspondences = 0;
+  CornerGrid grid = { 0, 0, 0, NULL, NULL };
+  int *candidates =
+      (int *)aom_malloc(AOMMAX(num_ref_corners, 1) * sizeof(*candidates));
+  if (!candidates ||
+      !build_corner_grid(&grid, ref_corners, num_ref_corners, width, height)) {
+    aom_free(candidates);
+    free_corner_grid(&grid);
+    return 0;
+  }
   for (i = 0; i < num_frm_corners; ++i) {
-    double best_match_ncc = 0.0;
+    double best_match_ncc;
     double template_norm;
-    int best_match_j = -1;
+    int best_match_j, num_candidates;
     if (!is_eligible_point(frm_corners[2 * i], frm_corners[2 * i + 1], width,
                            height))
       continue;
-    for (j = 0; j < num_ref_corners; ++j) {
-      double match_ncc;
-      if (!is_eligible_point(ref_corners[2 * j], ref_corners[2 * j + 1], width,
-                             height))
-        continue;
-      if (!is_eligible_distance(frm_corners[2 * i], frm_corners[2 * i + 1],
-                                ref_corners[2 * j], ref_corners[2 * j + 1],
-                                width, height))
-        continue;
-      match_ncc = compute_cross_correlation(
-          frm, frm_stride, frm_corners[2 * i], frm_corners[2 * i + 1], ref,
-          ref_stride, ref_corners[2 * j], ref_corners[2 * j + 1]);
-      if (match_ncc > best_match_ncc) {
-        best_match_ncc = match_ncc;
-        best_match_j = j;
-      }
-    }
+    num_candidates =
+        get_candidates(&grid, ref_corners, frm_corners[2 * i],
+                       frm_corners[2 * i + 1], width, height, candidates);
+    best_match_j = find_best_match(frm, frm_stride, frm_corners[2 * i],
+                                   frm_corners[2 * i + 1], ref, ref_stride,
+                                   ref_corners, candidates, num_candidates,
+                                   &best_match_ncc);
     // Note: We want to test if the best correlation is >= THRESHOLD_NCC,
     // but need to account for the normalization in compute_cross_correlation.
     template_norm = compute_variance(frm, frm_stride, frm_corners[2 * i],
@@ -184,6 +291,8 @@ int determine_correspondence(unsigned char *frm, int *frm_corners,
       num_correspondences++;
     }
   }
+  aom_free(candidates);
+  free_corner_grid(&grid);
   improve_correspondence(frm, ref, width, height, frm_stride, ref_stride,
                          correspondences, num_correspondences);
   return num_correspondences;
@@ -3057,14 +3057,21 @@ static void rd_pick_partition(const AV1_COMP *const cpi, ThreadData *td,
   }
 }
 
+// Encodes a superblock row of a tile. When row_mt_sync is not NULL, each
+// superblock waits for its top-right neighbour in the row above to be encoded.
 static void encode_rd_sb_row(AV1_COMP *cpi, ThreadData *td,
                              TileDataEnc *tile_data, int mi_row,
-                             TOKENEXTRA **tp) {
+                             TOKENEXTRA **tp, AV1RowMTSync *row_mt_sync,
+                             int tile_col) {
   AV1_COMMON *const cm = &cpi->common;
   const TileInfo *const tile_info = &tile_data->tile_info;
   MACROBLOCK *const x = &td->mb;
   MACROBLOCKD *const xd = &x->e_mbd;
   SPEED_FEATURES *const sf = &cpi->sf;
+  const int cur_sb_row = mi_row >> cm->mib_size_log2;
+  const int sb_cols_in_tile =
+      (tile_info->mi_col_end - tile_info->mi_col_start + cm->mib_size - 1) >>
+      cm->mib_size_log2;
   int mi_col;
 #if CONFIG_EXT_PARTITION
   const int leaf_nodes = 256;
@@ -3102,6 +3109,11 @@ static void encode_rd_sb_row(AV1_COMP *cpi, ThreadData *td,
     const int idx_str = cm->mi_stride * mi_row + mi_col;
     MODE_INFO **mi = cm->mi_grid_visible + idx_str;
     PC_TREE *const pc_root = td->pc_root[cm->mib_size_log2 - MIN_MIB_SIZE_LOG2];
+    const int sb_col_in_tile =
+        (mi_col - tile_info->mi_col_start) >> cm->mib_size_log2;
+
+    if (row_mt_sync)
+      av1_row_mt_sync_read(row_mt_sync, tile_col, cur_sb_row, sb_col_in_tile);
 
 #if CONFIG_LV_MAP
     av1_fill_coeff_costs(&td->mb, xd->tile_ctx);
@@ -3271,6 +3283,10 @@ static void encode_rd_sb_row(AV1_COMP *cpi, ThreadData *td,
 #endif  // CONFIG_LOOPFILTER_LEVEL
     }
 #endif  // CONFIG_LPF_SB
+
+    if (row_mt_sync)
+      av1_row_mt_sync_write(row_mt_sync, tile_col, cur_sb_row, sb_col_in_tile,
+                            sb_cols_in_tile);
   }
 }
 
@@ -3417,7 +3433,7 @@ void av1_encode_tile(AV1_COMP *cpi, ThreadData *td, int tile_row,
 
   for (mi_row = tile_info->mi_row_start; mi_row < tile_info->mi_row_end;
        mi_row += cm->mib_size) {
-    encode_rd_sb_row(cpi, td, this_tile, mi_row, &tok);
+    encode_rd_sb_row(cpi, td, this_tile, mi_row, &tok, NULL, tile_col);
   }
 
 #if CONFIG_INTRABC
@@ -3431,6 +3447,103 @@ void av1_encode_tile(AV1_COMP *cpi, ThreadData *td, int tile_row,
                           av1_num_planes(cm)));
 }
 
+// Tokens point at the CDFs they were coded with, and the bitstream packer
+// adapts those CDFs in the tile's context while writing. Move the pointers of
+// tokens coded with a superblock row's private context over to the tile's.
+static void rebase_token_cdfs(TOKENEXTRA *tok, const TOKENEXTRA *tok_end,
+                              const FRAME_CONTEXT *from, FRAME_CONTEXT *to) {
+  const uint8_t *const start = (const uint8_t *)from;
+  const uint8_t *const end = start + sizeof(*from);
+  uint8_t *const dst = (uint8_t *)to;
+
+  for (; tok < tok_end; ++tok) {
+    const uint8_t *p = (const uint8_t *)tok->head_cdf;
+    if (p >= start && p < end) tok->head_cdf = (void *)(dst + (p - start));
+    p = (const uint8_t *)tok->tail_cdf;
+    if (p >= start && p < end) tok->tail_cdf = (void *)(dst + (p - start));
+    p = (const uint8_t *)tok->color_map_cdf;
+    if (p >= start && p < end) tok->color_map_cdf = (void *)(dst + (p - start));
+  }
+}
+
+void av1_encode_sb_row_mt(AV1_COMP *cpi, ThreadData *td,
+                          TileDataEnc *row_data, int tile_row, int tile_col,
+                          int mi_row) {
+  AV1_COMMON *const cm = &cpi->common;
+  AV1RowMTSync *const row_mt_sync = &cpi->row_mt_sync;
+  TileDataEnc *const this_tile =
+      &cpi->tile_data[tile_row * cm->tile_cols + tile_col];
+  const TileInfo *const tile_info = &this_tile->tile_info;
+  const int sb_row = mi_row >> cm->mib_size_log2;
+  const int sb_row_in_tile =
+      (mi_row - tile_info->mi_row_start) >> cm->mib_size_log2;
+  const int sb_cols_in_tile =
+      (tile_info->mi_col_end - tile_info->mi_col_start + cm->mib_size - 1) >>
+      cm->mib_size_log2;
+  const unsigned int row_tokens = allocated_sb_row_tokens(
+      *tile_info, cm->mib_size_log2 + MI_SIZE_LOG2, av1_num_planes(cm));
+  TOKENEXTRA *const row_tok =
+      cpi->tile_tok[tile_row][tile_col] + sb_row_in_tile * row_tokens;
+  TOKENEXTRA *tok = row_tok;
+
+  if (mi_row == tile_info->mi_row_start) {
+    // The above context is shared with the tile above, so it can only be
+    // reset once the last superblock row of that tile is fully encoded.
+    av1_row_mt_sync_read(row_mt_sync, tile_col, sb_row, sb_cols_in_tile);
+#if CONFIG_DEPENDENT_HORZTILES
+    if ((!cm->dependent_horz_tiles) || (tile_row == 0) ||
+        tile_info->tg_horz_boundary) {
+      av1_zero_above_context(cm, tile_info->mi_col_start,
+                             tile_info->mi_col_end);
+    }
+#else
+    av1_zero_above_context(cm, tile_info->mi_col_start, tile_info->mi_col_end);
+#endif
+
+#if CONFIG_LOOPFILTERING_ACROSS_TILES
+    if (!cm->loop_filter_across_tiles_enabled)
+      av1_setup_across_tile_boundary_info(cm, tile_info);
+#endif
+  }
+
+  // Every superblock row starts from the frame context and the mode search
+  // thresholds of the tile, the same snapshot a tile starts from, so the
+  // result does not depend on how rows are spread over the threads.
+  row_data->tile_info = *tile_info;
+  memcpy(row_data->thresh_freq_fact, this_tile->thresh_freq_fact,
+         sizeof(row_data->thresh_freq_fact));
+  memcpy(row_data->mode_map, this_tile->mode_map, sizeof(row_data->mode_map));
+  row_data->allow_update_cdf = this_tile->allow_update_cdf;
+  row_data->tctx = *cm->fc;
+  row_data->m_search_count = 0;
+  row_data->ex_search_count = 0;
+  td->mb.m_search_count_ptr = &row_data->m_search_count;
+  td->mb.ex_search_count_ptr = &row_data->ex_search_count;
+  td->mb.e_mbd.tile_ctx = &row_data->tctx;
+
+#if CONFIG_CFL
+  cfl_init(&td->mb.e_mbd.cfl, cm);
+#endif
+
+  av1_crc_calculator_init(&td->mb.tx_rd_record.crc_calculator, 24, 0x5D6DCB);
+
+  encode_rd_sb_row(cpi, td, row_data, mi_row, &tok, row_mt_sync, tile_col);
+  rebase_token_cdfs(row_tok, tok, &row_data->tctx, &this_tile->tctx);
+
+  row_mt_sync->tok_count[tile_col * row_mt_sync->rows + sb_row] =
+      (unsigned int)(tok - row_tok);
+  assert(tok - row_tok <= row_tokens);
+
+  // The last row of a tile can only finish after every other row of the tile
+  // has, so its thresholds are carried over to the next frame.
+  if (mi_row + cm->mib_size >= tile_info->mi_row_end) {
+    memcpy(this_tile->thresh_freq_fact, row_data->thresh_freq_fact,
+           sizeof(this_tile->thresh_freq_fact));
+    memcpy(this_tile->mode_map, row_data->mode_map,
+           sizeof(this_tile->mode_map));
+  }
+}
+
 static void encode_tiles(AV1_COMP *cpi) {
   AV1_COMMON *const cm = &cpi->common;
   int tile_col, tile_row;
@@ -3512,9 +3625,7 @@ static int gm_get_params_cost(const WarpedMotionParams *gm,
   return (params_cost << AV1_PROB_COST_SHIFT);
 }
 
-static int do_gm_search_logic(SPEED_FEATURES *const sf, int num_refs_using_gm,
-                              int frame) {
-  (void)num_refs_using_gm;
+static int do_gm_search_logic(SPEED_FEATURES *const sf, int frame) {
   (void)frame;
   switch (sf->gm_search_type) {
     case GM_FULL_SEARCH: return 1;
@@ -3526,6 +3637,132 @@ static int do_gm_search_logic(SPEED_FEATURES *const sf, int num_refs_using_gm,
   return 1;
 }
 
+// Searches the global motion of the reference |frame|, whose buffer is
+// |ref_buf|, and leaves it in cm->global_motion[frame]. Searches for
+// different buffers share only the source frame, whose corners must have
+// been found by prepare_global_motion_frame(), so they can run at once.
+int av1_compute_global_motion_for_ref(AV1_COMP *cpi, int frame,
+                                      YV12_BUFFER_CONFIG *ref_buf) {
+  AV1_COMMON *const cm = &cpi->common;
+  MACROBLOCKD *const xd = &cpi->td.mb.e_mbd;
+  const WarpedMotionParams *ref_params =
+      cm->error_resilient_mode ? &default_warp_params
+                               : &cm->prev_frame->global_motion[frame];
+  double params_by_motion[RANSAC_NUM_MOTIONS * (MAX_PARAMDIM - 1)];
+  const double *params_this_motion;
+  int inliers_by_motion[RANSAC_NUM_MOTIONS];
+  WarpedMotionParams tmp_wm_params;
+  static const double kIdentityParams[MAX_PARAMDIM - 1] = {
+    0.0, 0.0, 1.0, 0.0, 0.0, 1.0, 0.0, 0.0
+  };
+  TransformationType model;
+  int i;
+  const int64_t ref_frame_error = av1_frame_error(
+#if CONFIG_HIGHBITDEPTH
+      xd->cur_buf->flags & YV12_FLAG_HIGHBITDEPTH, xd->bd,
+#endif  // CONFIG_HIGHBITDEPTH
+      ref_buf->y_buffer, ref_buf->y_stride, cpi->source->y_buffer,
+      cpi->source->y_width, cpi->source->y_height, cpi->source->y_stride);
+
+  if (ref_frame_error == 0) return 1;
+
+  aom_clear_system_state();
+  for (model = ROTZOOM; model < GLOBAL_TRANS_TYPES_ENC; ++model) {
+    int64_t best_warp_error = INT64_MAX;
+    // Initially set all params to identity.
+    for (i = 0; i < RANSAC_NUM_MOTIONS; ++i) {
+      memcpy(params_by_motion + (MAX_PARAMDIM - 1) * i, kIdentityParams,
+             (MAX_PARAMDIM - 1) * sizeof(*params_by_motion));
+    }
+
+    compute_global_motion_feature_based(
+        model, cpi->source, ref_buf,
+#if CONFIG_HIGHBITDEPTH
+        cpi->common.bit_depth,
+#endif  // CONFIG_HIGHBITDEPTH
+        inliers_by_motion, params_by_motion, RANSAC_NUM_MOTIONS);
+
+    for (i = 0; i < RANSAC_NUM_MOTIONS; ++i) {
+      if (inliers_by_motion[i] == 0) continue;
+
+      params_this_motion = params_by_motion + (MAX_PARAMDIM - 1) * i;
+      convert_model_to_params(params_this_motion, &tmp_wm_params);
+
+      if (tmp_wm_params.wmtype != IDENTITY) {
+        const int64_t warp_error = refine_integerized_param(
+            &tmp_wm_params, tmp_wm_params.wmtype,
+#if CONFIG_HIGHBITDEPTH
+            xd->cur_buf->flags & YV12_FLAG_HIGHBITDEPTH, xd->bd,
+#endif  // CONFIG_HIGHBITDEPTH
+            ref_buf->y_buffer, ref_buf->y_width,
+            ref_buf->y_height, ref_buf->y_stride,
+            cpi->source->y_buffer, cpi->source->y_width,
+            cpi->source->y_height, cpi->source->y_stride, 5,
+            cpi->sf.gm_refine_sample_step, best_warp_error);
+        if (warp_error < best_warp_error) {
+          best_warp_error = warp_error;
+          // Save the wm_params modified by refine_integerized_param()
+          // rather than motion index to avoid rerunning refine() below.
+          memcpy(&(cm->global_motion[frame]), &tmp_wm_params,
+                 sizeof(WarpedMotionParams));
+        }
+      }
+    }
+    if (cm->global_motion[frame].wmtype <= AFFINE)
+      if (!get_shear_params(&cm->global_motion[frame]))
+        cm->global_motion[frame] = default_warp_params;
+
+    if (cm->global_motion[frame].wmtype == TRANSLATION) {
+      cm->global_motion[frame].wmmat[0] =
+          convert_to_trans_prec(cm->allow_high_precision_mv,
+                                cm->global_motion[frame].wmmat[0]) *
+          GM_TRANS_ONLY_DECODE_FACTOR;
+      cm->global_motion[frame].wmmat[1] =
+          convert_to_trans_prec(cm->allow_high_precision_mv,
+                                cm->global_motion[frame].wmmat[1]) *
+          GM_TRANS_ONLY_DECODE_FACTOR;
+    }
+
+    // If the best error advantage found doesn't meet the threshold for
+    // this motion type, revert to IDENTITY.
+    if (!is_enough_erroradvantage(
+            (double)best_warp_error / ref_frame_error,
+            gm_get_params_cost(&cm->global_motion[frame], ref_params,
+                               cm->allow_high_precision_mv))) {
+      cm->global_motion[frame] = default_warp_params;
+    }
+    if (cm->global_motion[frame].wmtype != IDENTITY) break;
+  }
+
+  aom_clear_system_state();
+  return 0;
+}
+
+#if CONFIG_HASH_ME
+// Hashes the blocks of block_size of the source from the hashes of half the
+// size, or the 2x2 blocks from the pixels when block_size is 2.
+static void generate_block_hash_value(AV1_COMP *cpi, int block_size,
+                                      uint32_t *src_pic_block_hash[2],
+                                      uint32_t *dst_pic_block_hash[2],
+                                      int8_t *src_pic_block_same_info[3],
+                                      int8_t *dst_pic_block_same_info[3]) {
+  const int rows = cpi->source->y_crop_height;
+  if (cpi->oxcf.max_threads > 1) {
+    av1_generate_block_hash_value_mt(cpi, block_size, src_pic_block_hash,
+                                     dst_pic_block_hash,
+                                     src_pic_block_same_info,
+                                     dst_pic_block_same_info);
+  } else if (block_size == 2) {
+    av1_generate_block_2x2_hash_value(cpi->source, dst_pic_block_hash,
+                                      dst_pic_block_same_info, 0, rows);
+  } else {
+    av1_generate_block_hash_value(cpi->source, block_size, src_pic_block_hash,
+                                  dst_pic_block_hash, src_pic_block_same_info,
+                                  dst_pic_block_same_info, 0, rows);
+  }
+}
+#endif  // CONFIG_HASH_ME
+
 // Estimate if the source frame is screen content, based on the portion of
 // blocks that have no more than 4 (experimentally selected) luma colors.
 static int is_screen_content(const uint8_t *src,
@@ -3719,8 +3956,13 @@ static void encode_frame_internal(AV1_COMP *cpi) {
     const int pic_height = cpi->source->y_crop_height;
     uint32_t *block_hash_values[2][2];
     int8_t *is_block_same[2][3];
+    int block_size, src_idx;
+    int hash_added = 1;
     int k, j;
 
+    if (!av1_hash_table_create(&cm->cur_frame->hash_table))
+      aom_internal_error(&cm->error, AOM_CODEC_MEM_ERROR,
+                         "Failed to allocate hash table");
     for (k = 0; k < 2; k++) {
       for (j = 0; j < 2; j++) {
         CHECK_MEM_ERROR(cm, block_hash_values[k][j],
@@ -3733,46 +3975,20 @@ static void encode_frame_internal(AV1_COMP *cpi) {
       }
     }
 
-    av1_hash_table_create(&cm->cur_frame->hash_table);
-    av1_generate_block_2x2_hash_value(cpi->source, block_hash_values[0],
-                                      is_block_same[0]);
-    av1_generate_block_hash_value(cpi->source, 4, block_hash_values[0],
-                                  block_hash_values[1], is_block_same[0],
-                                  is_block_same[1]);
-    av1_add_to_hash_map_by_row_with_precal_data(
-        &cm->cur_frame->hash_table, block_hash_values[1], is_block_same[1][2],
-        pic_width, pic_height, 4);
-    av1_generate_block_hash_value(cpi->source, 8, block_hash_values[1],
-                                  block_hash_values[0], is_block_same[1],
-                                  is_block_same[0]);
-    av1_add_to_hash_map_by_row_with_precal_data(
-        &cm->cur_frame->hash_table, block_hash_values[0], is_block_same[0][2],
-        pic_width, pic_height, 8);
-    av1_generate_block_hash_value(cpi->source, 16, block_hash_values[0],
-                                  block_hash_values[1], is_block_same[0],
-                                  is_block_same[1]);
-    av1_add_to_hash_map_by_row_with_precal_data(
-        &cm->cur_frame->hash_table, block_hash_values[1], is_block_same[1][2],
-        pic_width, pic_height, 16);
-    av1_generate_block_hash_value(cpi->source, 32, block_hash_values[1],
-                                  block_hash_values[0], is_block_same[1],
-                                  is_block_same[0]);
-    av1_add_to_hash_map_by_row_with_precal_data(
-        &cm->cur_frame->hash_table, block_hash_values[0], is_block_same[0][2],
-        pic_width, pic_height, 32);
-    av1_generate_block_hash_value(cpi->source, 64, block_hash_values[0],
-                                  block_hash_values[1], is_block_same[0],
-                                  is_block_same[1]);
-    av1_add_to_hash_map_by_row_with_precal_data(
-        &cm->cur_frame->hash_table, block_hash_values[1], is_block_same[1][2],
-        pic_width, pic_height, 64);
-
-    av1_generate_block_hash_value(cpi->source, 128, block_hash_values[1],
-                                  block_hash_values[0], is_block_same[1],
-                                  is_block_same[0]);
-    av1_add_to_hash_map_by_row_with_precal_data(
-        &cm->cur_frame->hash_table, block_hash_values[0], is_block_same[0][2],
-        pic_width, pic_height, 128);
+    generate_block_hash_value(cpi, 2, NULL, block_hash_values[0], NULL,
+                              is_block_same[0]);
+    // Each block size is hashed from the hashes of half its size, into the
+    // other of the two buffers.
+    for (block_size = 4, src_idx = 0; block_size <= 128 && hash_added;
+         block_size *= 2, src_idx = 1 - src_idx) {
+      generate_block_hash_value(
+          cpi, block_size, block_hash_values[src_idx],
+          block_hash_values[1 - src_idx], is_block_same[src_idx],
+          is_block_same[1 - src_idx]);
+      hash_added = av1_add_to_hash_map_by_row_with_precal_data(
+          &cm->cur_frame->hash_table, block_hash_values[1 - src_idx],
+          is_block_same[1 - src_idx][2], pic_width, pic_height, block_size);
+    }
 
     for (k = 0; k < 2; k++) {
       for (j = 0; j < 2; j++) {
@@ -3783,6 +3999,9 @@ static void encode_frame_internal(AV1_COMP *cpi) {
         aom_free(is_block_same[k][j]);
       }
     }
+    if (!hash_added)
+      aom_internal_error(&cm->error, AOM_CODEC_MEM_ERROR,
+                         "Failed to allocate hash table entries");
   }
 #endif
 
@@ -3792,114 +4011,57 @@ static void encode_frame_internal(AV1_COMP *cpi) {
       !cpi->global_motion_search_done) {
     YV12_BUFFER_CONFIG *ref_buf[TOTAL_REFS_PER_FRAME];
     int frame;
-    double params_by_motion[RANSAC_NUM_MOTIONS * (MAX_PARAMDIM - 1)];
-    const double *params_this_motion;
-    int inliers_by_motion[RANSAC_NUM_MOTIONS];
-    WarpedMotionParams tmp_wm_params;
-    static const double kIdentityParams[MAX_PARAMDIM - 1] = {
-      0.0, 0.0, 1.0, 0.0, 0.0, 1.0, 0.0, 0.0
-    };
-    int num_refs_using_gm = 0;
+    int frames[TOTAL_REFS_PER_FRAME];
+    int num_frames = 0;
+    int same_as_source[TOTAL_REFS_PER_FRAME] = { 0 };
 
+    // Pick out the references to search, one per distinct buffer.
     for (frame = LAST_FRAME; frame <= ALTREF_FRAME; ++frame) {
-      ref_buf[frame] = get_ref_frame_buffer(cpi, frame);
       int pframe;
+      ref_buf[frame] = get_ref_frame_buffer(cpi, frame);
       cm->global_motion[frame] = default_warp_params;
+      // check for duplicate buffer
+      for (pframe = LAST_FRAME; pframe < frame; ++pframe) {
+        if (ref_buf[frame] == ref_buf[pframe]) break;
+      }
+      if (pframe == frame && ref_buf[frame] &&
+          ref_buf[frame]->y_crop_width == cpi->source->y_crop_width &&
+          ref_buf[frame]->y_crop_height == cpi->source->y_crop_height &&
+          do_gm_search_logic(&cpi->sf, frame))
+        frames[num_frames++] = frame;
+    }
+
+    if (num_frames > 0) {
+      prepare_global_motion_frame(cpi->source, cm->bit_depth);
+      if (cpi->oxcf.max_threads > 1 && num_frames > 1) {
+        av1_global_motion_search_mt(cpi, frames, num_frames, ref_buf,
+                                    same_as_source);
+      } else {
+        for (i = 0; i < num_frames; ++i) {
+          same_as_source[frames[i]] = av1_compute_global_motion_for_ref(
+              cpi, frames[i], ref_buf[frames[i]]);
+        }
+      }
+    }
+
+    // Each search wrote only its own reference, so the results are merged in
+    // reference order whichever way they were found.
+    for (frame = LAST_FRAME; frame <= ALTREF_FRAME; ++frame) {
+      int pframe;
       const WarpedMotionParams *ref_params =
           cm->error_resilient_mode ? &default_warp_params
                                    : &cm->prev_frame->global_motion[frame];
-      // check for duplicate buffer
       for (pframe = LAST_FRAME; pframe < frame; ++pframe) {
         if (ref_buf[frame] == ref_buf[pframe]) break;
       }
       if (pframe < frame) {
         memcpy(&cm->global_motion[frame], &cm->global_motion[pframe],
                sizeof(WarpedMotionParams));
-      } else if (ref_buf[frame] &&
-                 ref_buf[frame]->y_crop_width == cpi->source->y_crop_width &&
-                 ref_buf[frame]->y_crop_height == cpi->source->y_crop_height &&
-                 do_gm_search_logic(&cpi->sf, num_refs_using_gm, frame)) {
-        TransformationType model;
-        const int64_t ref_frame_error = av1_frame_error(
-#if CONFIG_HIGHBITDEPTH
-            xd->cur_buf->flags & YV12_FLAG_HIGHBITDEPTH, xd->bd,
-#endif  // CONFIG_HIGHBITDEPTH
-            ref_buf[frame]->y_buffer, ref_buf[frame]->y_stride,
-            cpi->source->y_buffer, cpi->source->y_width, cpi->source->y_height,
-            cpi->source->y_stride);
-
-        if (ref_frame_error == 0) continue;
-
-        aom_clear_system_state();
-        for (model = ROTZOOM; model < GLOBAL_TRANS_TYPES_ENC; ++model) {
-          int64_t best_warp_error = INT64_MAX;
-          // Initially set all params to identity.
-          for (i = 0; i < RANSAC_NUM_MOTIONS; ++i) {
-            memcpy(params_by_motion + (MAX_PARAMDIM - 1) * i, kIdentityParams,
-                   (MAX_PARAMDIM - 1) * sizeof(*params_by_motion));
-          }
-
-          compute_global_motion_feature_based(
-              model, cpi->source, ref_buf[frame],
-#if CONFIG_HIGHBITDEPTH
-              cpi->common.bit_depth,
-#endif  // CONFIG_HIGHBITDEPTH
-              inliers_by_motion, params_by_motion, RANSAC_NUM_MOTIONS);
-
-          for (i = 0; i < RANSAC_NUM_MOTIONS; ++i) {
-            if (inliers_by_motion[i] == 0) continue;
-
-            params_this_motion = params_by_motion + (MAX_PARAMDIM - 1) * i;
-            convert_model_to_params(params_this_motion, &tmp_wm_params);
-
-            if (tmp_wm_params.wmtype != IDENTITY) {
-              const int64_t warp_error = refine_integerized_param(
-                  &tmp_wm_params, tmp_wm_params.wmtype,
-#if CONFIG_HIGHBITDEPTH
-                  xd->cur_buf->flags & YV12_FLAG_HIGHBITDEPTH, xd->bd,
-#endif  // CONFIG_HIGHBITDEPTH
-                  ref_buf[frame]->y_buffer, ref_buf[frame]->y_width,
-                  ref_buf[frame]->y_height, ref_buf[frame]->y_stride,
-                  cpi->source->y_buffer, cpi->source->y_width,
-                  cpi->source->y_height, cpi->source->y_stride, 5,
-                  best_warp_error);
-              if (warp_error < best_warp_error) {
-                best_warp_error = warp_error;
-                // Save the wm_params modified by refine_integerized_param()
-                // rather than motion index to avoid rerunning refine() below.
-                memcpy(&(cm->global_motion[frame]), &tmp_wm_params,
-                       sizeof(WarpedMotionParams));
-              }
-            }
-          }
-          if (cm->global_motion[frame].wmtype <= AFFINE)
-            if (!get_shear_params(&cm->global_motion[frame]))
-              cm->global_motion[frame] = default_warp_params;
-
-          if (cm->global_motion[frame].wmtype == TRANSLATION) {
-            cm->global_motion[frame].wmmat[0] =
-                convert_to_trans_prec(cm->allow_high_precision_mv,
-                                      cm->global_motion[frame].wmmat[0]) *
-                GM_TRANS_ONLY_DECODE_FACTOR;
-            cm->global_motion[frame].wmmat[1] =
-                convert_to_trans_prec(cm->allow_high_precision_mv,
-                                      cm->global_motion[frame].wmmat[1]) *
-                GM_TRANS_ONLY_DECODE_FACTOR;
-          }
-
-          // If the best error advantage found doesn't meet the threshold for
-          // this motion type, revert to IDENTITY.
-          if (!is_enough_erroradvantage(
-                  (double)best_warp_error / ref_frame_error,
-                  gm_get_params_cost(&cm->global_motion[frame], ref_params,
-                                     cm->allow_high_precision_mv))) {
-            cm->global_motion[frame] = default_warp_params;
-          }
-          if (cm->global_motion[frame].wmtype != IDENTITY) break;
-        }
-        aom_clear_system_state();
+      } else if (same_as_source[frame]) {
+        // Left at zero, as for a reference that is not searched. Duplicates
+        // of it still count the cost of its (identity) parameters.
+        continue;
       }
-      if (cm->global_motion[frame].wmtype != IDENTITY) num_refs_using_gm++;
       cpi->gmparams_cost[frame] =
           gm_get_params_cost(&cm->global_motion[frame], ref_params,
                              cm->allow_high_precision_mv) +
@@ -4066,7 +4228,12 @@ static void encode_frame_internal(AV1_COMP *cpi) {
     // TODO(geza.lore): The multi-threaded encoder is not safe with more than
     // 1 tile rows, as it uses the single above_context et al arrays from
     // cpi->common
-    if (AOMMIN(cpi->oxcf.max_threads, cm->tile_cols) > 1 && cm->tile_rows == 1)
+    // Row based multi-threading orders the tile rows itself, so it supports
+    // any tile layout.
+    if (cpi->oxcf.row_mt && !CONFIG_LPF_SB)
+      av1_encode_tiles_row_mt(cpi);
+    else if (AOMMIN(cpi->oxcf.max_threads, cm->tile_cols) > 1 &&
+             cm->tile_rows == 1)
       av1_encode_tiles_mt(cpi);
     else
       encode_tiles(cpi);
@@ -24,6 +24,7 @@ struct macroblock;
 struct yv12_buffer_config;
 struct AV1_COMP;
 struct ThreadData;
+struct TileDataEnc;
 
 void av1_setup_src_planes(struct macroblock *x,
                           const struct yv12_buffer_config *src, int mi_row,
@@ -34,6 +35,17 @@ void av1_encode_frame(struct AV1_COMP *cpi);
 void av1_init_tile_data(struct AV1_COMP *cpi);
 void av1_encode_tile(struct AV1_COMP *cpi, struct ThreadData *td, int tile_row,
                      int tile_col);
+// Encodes one superblock row of a tile in row based multi-threading mode,
+// using row_data as the tile state of the row.
+void av1_encode_sb_row_mt(struct AV1_COMP *cpi, struct ThreadData *td,
+                          struct TileDataEnc *row_data, int tile_row,
+                          int tile_col, int mi_row);
+
+// Searches the global motion of reference frame |frame|, whose buffer is
+// |ref_buf|, against the source, and leaves it in cm->global_motion[frame].
+// Returns 1 without searching if the reference is identical to the source.
+int av1_compute_global_motion_for_ref(struct AV1_COMP *cpi, int frame,
+                                      struct yv12_buffer_config *ref_buf);
 
 void av1_update_tx_type_count(const struct AV1Common *cm, MACROBLOCKD *xd,
 #if CONFIG_TXK_SEL
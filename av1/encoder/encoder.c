@@ -3232,11 +3232,9 @@ void av1_remove_compressor(AV1_COMP *cpi) {
   }
 
   for (t = 0; t < cpi->num_workers; ++t) {
-    AVxWorker *const worker = &cpi->workers[t];
     EncWorkerData *const thread_data = &cpi->tile_thr_data[t];
 
-    // Deallocate allocated threads.
-    aom_get_worker_interface()->end(worker);
+    aom_free(thread_data->row_tile_data);
 
     // Deallocate allocated thread data.
     if (t < cpi->num_workers - 1) {
@@ -3251,9 +3249,16 @@ void av1_remove_compressor(AV1_COMP *cpi) {
     }
   }
   aom_free(cpi->tile_thr_data);
-  aom_free(cpi->workers);
+  if (cpi->num_workers > 0) {
+    aom_task_group_destroy(&cpi->tasks);
+    aom_scheduler_release(cpi->scheduler);
+  }
+  av1_row_mt_sync_dealloc(&cpi->row_mt_sync);
 
-  if (cpi->num_workers > 1) av1_loop_filter_dealloc(&cpi->lf_row_sync);
+  if (cpi->num_workers > 1) {
+    av1_loop_filter_dealloc(&cpi->lf_row_sync);
+    av1_filter_pipeline_dealloc(&cpi->filter_sync);
+  }
 
   dealloc_compressor_data(cpi);
 
@@ -4711,7 +4716,13 @@ static void loopfilter_frame(AV1_COMP *cpi, AV1_COMMON *cm) {
                     cpi->sf.fast_cdef_search);
 
     // Apply the filter
-    av1_cdef_frame(cm->frame_to_show, cm, xd);
+    if (cpi->num_workers > 1)
+      av1_filter_frame_pipeline_mt(cm->frame_to_show, cm, xd,
+                                   FILTER_STAGE_CDEF, cpi->scheduler,
+                                   cpi->num_workers, &cpi->filter_sync, NULL,
+                                   NULL);
+    else
+      av1_cdef_frame(cm->frame_to_show, cm, xd);
   }
 
 #if CONFIG_HORZONLY_FRAME_SUPERRES
@@ -4731,7 +4742,13 @@ static void loopfilter_frame(AV1_COMP *cpi, AV1_COMMON *cm) {
     if (cm->rst_info[0].frame_restoration_type != RESTORE_NONE ||
         cm->rst_info[1].frame_restoration_type != RESTORE_NONE ||
         cm->rst_info[2].frame_restoration_type != RESTORE_NONE) {
-      av1_loop_restoration_filter_frame(cm->frame_to_show, cm);
+      if (cpi->num_workers > 1)
+        av1_filter_frame_pipeline_mt(cm->frame_to_show, cm, xd,
+                                     FILTER_STAGE_RESTORE, cpi->scheduler,
+                                     cpi->num_workers, &cpi->filter_sync, NULL,
+                                     NULL);
+      else
+        av1_loop_restoration_filter_frame(cm->frame_to_show, cm);
     }
   }
 #endif  // CONFIG_LOOP_RESTORATION
@@ -4763,6 +4780,7 @@ static void encode_without_recode_loop(AV1_COMP *cpi) {
 #if CONFIG_HIGHBITDEPTH
   cpi->source->buf_8bit_valid = 0;
 #endif
+  cpi->source->corners_valid = 0;
 
   if (frame_is_intra_only(cm) == 0) {
     scale_references(cpi);
@@ -4819,6 +4837,7 @@ static void encode_with_recode_loop(AV1_COMP *cpi, size_t *size,
 #if CONFIG_HIGHBITDEPTH
   cpi->source->buf_8bit_valid = 0;
 #endif
+  cpi->source->corners_valid = 0;
 
   aom_clear_system_state();
   setup_frame_size(cpi);
@@ -4857,6 +4876,8 @@ static void encode_with_recode_loop(AV1_COMP *cpi, size_t *size,
         cpi->global_motion_search_done = 0;
     cpi->source =
         av1_scale_if_required(cm, cpi->unscaled_source, &cpi->scaled_source);
+    // The scaled source may have been written again.
+    cpi->source->corners_valid = 0;
     if (cpi->unscaled_last_source != NULL)
       cpi->last_source = av1_scale_if_required(cm, cpi->unscaled_last_source,
                                                &cpi->scaled_last_source);
@@ -6595,6 +6616,7 @@ int av1_get_compressed_data(AV1_COMP *cpi, unsigned int *frame_flags,
 #if CONFIG_HIGHBITDEPTH
   cm->cur_frame->buf.buf_8bit_valid = 0;
 #endif
+  cm->cur_frame->buf.corners_valid = 0;
 
   // Start with a 0 size frame.
   *size = 0;
@@ -26,6 +26,7 @@
 #include "av1/encoder/av1_quantize.h"
 #include "av1/encoder/context_tree.h"
 #include "av1/encoder/encodemb.h"
+#include "av1/encoder/ethread.h"
 #include "av1/encoder/firstpass.h"
 #include "av1/encoder/lookahead.h"
 #include "av1/encoder/mbgraph.h"
@@ -43,6 +44,7 @@
 #endif
 #include "aom_dsp/variance.h"
 #include "aom/internal/aom_codec_internal.h"
+#include "aom_util/aom_scheduler.h"
 #include "aom_util/aom_thread.h"
 
 #ifdef __cplusplus
@@ -269,6 +271,7 @@ typedef struct AV1EncoderConfig {
 #endif  // CONFIG_LOOPFILTERING_ACROSS_TILES
 
   int max_threads;
+  unsigned int row_mt;
 
   aom_fixed_buf_t two_pass_stats_in;
   struct aom_codec_pkt_list *output_pkt_list;
@@ -581,9 +584,13 @@ typedef struct AV1_COMP {
 
   // Multi-threading
   int num_workers;
-  AVxWorker *workers;
+  aom_thread_pool_t thread_pool;  // Set by AOM_SET_THREAD_POOL.
+  AVxScheduler *scheduler;
+  AVxTaskGroup tasks;
   struct EncWorkerData *tile_thr_data;
   AV1LfSync lf_row_sync;
+  AV1FilterSync filter_sync;
+  AV1RowMTSync row_mt_sync;
   int refresh_frame_mask;
   int existing_fb_idx_to_show;
   int is_arf_filter_off[MAX_EXT_ARFS + 1];
@@ -742,6 +749,18 @@ static INLINE unsigned int allocated_tokens(TileInfo tile, int sb_size_log2,
   return get_token_alloc(tile_mb_rows, tile_mb_cols, sb_size_log2, num_planes);
 }
 
+// Get the allocated token size for one superblock row of a tile. In row based
+// multi-threading each superblock row writes its tokens to its own slice of
+// the tile's token buffer, so the tile allocation is a whole number of these.
+static INLINE unsigned int allocated_sb_row_tokens(TileInfo tile,
+                                                   int sb_size_log2,
+                                                   int num_planes) {
+  int tile_mb_cols = (tile.mi_col_end - tile.mi_col_start + 2) >> 2;
+
+  return get_token_alloc(1 << (sb_size_log2 - 4), tile_mb_cols, sb_size_log2,
+                         num_planes);
+}
+
 #if CONFIG_TEMPMV_SIGNALING
 void av1_set_temporal_mv_prediction(AV1_COMP *cpi, int allow_tempmv_prediction);
 #endif
@@ -9,10 +9,14 @@
  * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
  */
 
+#include <string.h>
+
 #include "av1/encoder/encodeframe.h"
 #include "av1/encoder/encoder.h"
 #include "av1/encoder/ethread.h"
+#include "av1/encoder/temporal_filter.h"
 #include "aom_dsp/aom_dsp_common.h"
+#include "aom_mem/aom_mem.h"
 
 static void accumulate_rd_opt(ThreadData *td, ThreadData *td_t) {
   for (int i = 0; i < REFERENCE_MODES; i++)
@@ -41,106 +45,239 @@ static int enc_worker_hook(EncWorkerData *const thread_data, void *unused) {
 
   (void)unused;
 
-  for (t = thread_data->start; t < tile_rows * tile_cols;
-       t += cpi->num_workers) {
+  while ((t = aom_task_group_next_job(&cpi->tasks)) < tile_rows * tile_cols) {
     int tile_row = t / tile_cols;
     int tile_col = t % tile_cols;
 
     av1_encode_tile(cpi, thread_data->td, tile_row, tile_col);
   }
 
-  return 0;
+  return 1;
 }
 
-void av1_encode_tiles_mt(AV1_COMP *cpi) {
-  AV1_COMMON *const cm = &cpi->common;
-  const int tile_cols = cm->tile_cols;
-  const AVxWorkerInterface *const winterface = aom_get_worker_interface();
-  const int num_workers = AOMMIN(cpi->oxcf.max_threads, tile_cols);
+#if CONFIG_MULTITHREAD
+static INLINE void mutex_lock(pthread_mutex_t *const mutex) {
+  const int kMaxTryLocks = 4000;
+  int locked = 0;
   int i;
 
-  av1_init_tile_data(cpi);
+  for (i = 0; i < kMaxTryLocks; ++i) {
+    if (!pthread_mutex_trylock(mutex)) {
+      locked = 1;
+      break;
+    }
+  }
+
+  if (!locked) pthread_mutex_lock(mutex);
+}
+#endif  // CONFIG_MULTITHREAD
+
+void av1_row_mt_sync_read(AV1RowMTSync *row_mt_sync, int tile_col,
+                          int sb_row, int c) {
+#if CONFIG_MULTITHREAD
+  if (sb_row) {
+    const int r = tile_col * row_mt_sync->rows + sb_row - 1;
+    pthread_mutex_t *const mutex = &row_mt_sync->mutex_[r];
+    mutex_lock(mutex);
+
+    while (row_mt_sync->cur_sb_col[r] < c + 2) {
+      pthread_cond_wait(&row_mt_sync->cond_[r], mutex);
+    }
+    pthread_mutex_unlock(mutex);
+  }
+#else
+  (void)row_mt_sync;
+  (void)tile_col;
+  (void)sb_row;
+  (void)c;
+#endif  // CONFIG_MULTITHREAD
+}
+
+void av1_row_mt_sync_write(AV1RowMTSync *row_mt_sync, int tile_col,
+                           int sb_row, int c, int sb_cols) {
+#if CONFIG_MULTITHREAD
+  const int r = tile_col * row_mt_sync->rows + sb_row;
+  // A finished row releases every superblock of the row below, including a
+  // wait for the whole row.
+  const int cur = c < sb_cols - 1 ? c + 1 : sb_cols + 2;
+
+  mutex_lock(&row_mt_sync->mutex_[r]);
+
+  row_mt_sync->cur_sb_col[r] = cur;
 
-  // Only run once to create threads and allocate thread data.
-  if (cpi->num_workers == 0) {
-    CHECK_MEM_ERROR(cm, cpi->workers,
-                    aom_malloc(num_workers * sizeof(*cpi->workers)));
+  pthread_cond_signal(&row_mt_sync->cond_[r]);
+  pthread_mutex_unlock(&row_mt_sync->mutex_[r]);
+#else
+  (void)row_mt_sync;
+  (void)tile_col;
+  (void)sb_row;
+  (void)c;
+  (void)sb_cols;
+#endif  // CONFIG_MULTITHREAD
+}
 
-    CHECK_MEM_ERROR(cm, cpi->tile_thr_data,
-                    aom_calloc(num_workers, sizeof(*cpi->tile_thr_data)));
+void av1_row_mt_sync_alloc(AV1RowMTSync *row_mt_sync, AV1_COMMON *cm,
+                           int rows, int tile_cols) {
+  const int num_rows = rows * tile_cols;
+
+  row_mt_sync->rows = rows;
+  row_mt_sync->tile_cols = tile_cols;
+#if CONFIG_MULTITHREAD
+  {
+    int i;
+
+    CHECK_MEM_ERROR(cm, row_mt_sync->mutex_,
+                    aom_malloc(sizeof(*row_mt_sync->mutex_) * num_rows));
+    if (row_mt_sync->mutex_) {
+      for (i = 0; i < num_rows; ++i) {
+        pthread_mutex_init(&row_mt_sync->mutex_[i], NULL);
+      }
+    }
 
-    for (i = 0; i < num_workers; i++) {
-      AVxWorker *const worker = &cpi->workers[i];
-      EncWorkerData *const thread_data = &cpi->tile_thr_data[i];
+    CHECK_MEM_ERROR(cm, row_mt_sync->cond_,
+                    aom_malloc(sizeof(*row_mt_sync->cond_) * num_rows));
+    if (row_mt_sync->cond_) {
+      for (i = 0; i < num_rows; ++i) {
+        pthread_cond_init(&row_mt_sync->cond_[i], NULL);
+      }
+    }
+  }
+#endif  // CONFIG_MULTITHREAD
 
-      ++cpi->num_workers;
-      winterface->init(worker);
+  CHECK_MEM_ERROR(cm, row_mt_sync->cur_sb_col,
+                  aom_malloc(sizeof(*row_mt_sync->cur_sb_col) * num_rows));
+  CHECK_MEM_ERROR(cm, row_mt_sync->tok_count,
+                  aom_malloc(sizeof(*row_mt_sync->tok_count) * num_rows));
+}
 
-      thread_data->cpi = cpi;
+void av1_row_mt_sync_dealloc(AV1RowMTSync *row_mt_sync) {
+  if (row_mt_sync != NULL) {
+#if CONFIG_MULTITHREAD
+    const int num_rows = row_mt_sync->rows * row_mt_sync->tile_cols;
+    int i;
 
-      if (i < num_workers - 1) {
-        // Allocate thread data.
-        CHECK_MEM_ERROR(cm, thread_data->td,
-                        aom_memalign(32, sizeof(*thread_data->td)));
-        av1_zero(*thread_data->td);
+    if (row_mt_sync->mutex_ != NULL) {
+      for (i = 0; i < num_rows; ++i) {
+        pthread_mutex_destroy(&row_mt_sync->mutex_[i]);
+      }
+      aom_free(row_mt_sync->mutex_);
+    }
+    if (row_mt_sync->cond_ != NULL) {
+      for (i = 0; i < num_rows; ++i) {
+        pthread_cond_destroy(&row_mt_sync->cond_[i]);
+      }
+      aom_free(row_mt_sync->cond_);
+    }
+#endif  // CONFIG_MULTITHREAD
+    aom_free(row_mt_sync->cur_sb_col);
+    aom_free(row_mt_sync->tok_count);
+    av1_zero(*row_mt_sync);
+  }
+}
 
-        // Set up pc_tree.
-        thread_data->td->pc_tree = NULL;
-        av1_setup_pc_tree(cm, thread_data->td);
+// Superblock rows are handed out in raster order over the whole frame, one
+// superblock row of every tile column at a time. A row only waits on rows
+// earlier in that order, which have been taken by workers already running.
+static int enc_row_mt_worker_hook(EncWorkerData *const thread_data,
+                                  void *unused) {
+  AV1_COMP *const cpi = thread_data->cpi;
+  const AV1_COMMON *const cm = &cpi->common;
+  const int tile_cols = cm->tile_cols;
+  const int num_jobs = cpi->row_mt_sync.rows * tile_cols;
+  int tile_row = 0;
+  int t;
+
+  (void)unused;
+
+  while ((t = aom_task_group_next_job(&cpi->tasks)) < num_jobs) {
+    const int mi_row = (t / tile_cols) << cm->mib_size_log2;
+    const int tile_col = t % tile_cols;
+
+    while (mi_row >= cpi->tile_data[tile_row * tile_cols].tile_info.mi_row_end)
+      ++tile_row;
+
+    av1_encode_sb_row_mt(cpi, thread_data->td, thread_data->row_tile_data,
+                         tile_row, tile_col, mi_row);
+    if (t == num_jobs - 1) cpi->row_mt_sync.last_td = thread_data->td;
+  }
+
+  return 0;
+}
+
+// Only run once to allocate the thread data of the workers. The workers run
+// as tasks on the application thread pool if one is set, and otherwise on the
+// shared scheduler, which is given a thread for each worker but the one run
+// by the main thread.
+static void create_enc_workers(AV1_COMP *cpi, int num_workers) {
+  AV1_COMMON *const cm = &cpi->common;
+  int i;
+
+  CHECK_MEM_ERROR(cm, cpi->scheduler,
+                  aom_scheduler_acquire(&cpi->thread_pool, num_workers - 1));
+  aom_task_group_init(&cpi->tasks);
+
+  CHECK_MEM_ERROR(cm, cpi->tile_thr_data,
+                  aom_calloc(num_workers, sizeof(*cpi->tile_thr_data)));
+
+  for (i = 0; i < num_workers; i++) {
+    EncWorkerData *const thread_data = &cpi->tile_thr_data[i];
+
+    ++cpi->num_workers;
+    thread_data->cpi = cpi;
+
+    if (i < num_workers - 1) {
+      // Allocate thread data.
+      CHECK_MEM_ERROR(cm, thread_data->td,
+                      aom_memalign(32, sizeof(*thread_data->td)));
+      av1_zero(*thread_data->td);
+
+      // Set up pc_tree.
+      thread_data->td->pc_tree = NULL;
+      av1_setup_pc_tree(cm, thread_data->td);
 
 #if CONFIG_HIGHBITDEPTH
-        int buf_scaler = 2;
+      int buf_scaler = 2;
 #else
-        int buf_scaler = 1;
+      int buf_scaler = 1;
 #endif
-        CHECK_MEM_ERROR(cm, thread_data->td->above_pred_buf,
-                        (uint8_t *)aom_memalign(
-                            16,
-                            buf_scaler * MAX_MB_PLANE * MAX_SB_SQUARE *
-                                sizeof(*thread_data->td->above_pred_buf)));
-        CHECK_MEM_ERROR(cm, thread_data->td->left_pred_buf,
-                        (uint8_t *)aom_memalign(
-                            16,
-                            buf_scaler * MAX_MB_PLANE * MAX_SB_SQUARE *
-                                sizeof(*thread_data->td->left_pred_buf)));
-        CHECK_MEM_ERROR(
-            cm, thread_data->td->wsrc_buf,
-            (int32_t *)aom_memalign(
-                16, MAX_SB_SQUARE * sizeof(*thread_data->td->wsrc_buf)));
-        CHECK_MEM_ERROR(
-            cm, thread_data->td->mask_buf,
-            (int32_t *)aom_memalign(
-                16, MAX_SB_SQUARE * sizeof(*thread_data->td->mask_buf)));
-        // Allocate frame counters in thread data.
-        CHECK_MEM_ERROR(cm, thread_data->td->counts,
-                        aom_calloc(1, sizeof(*thread_data->td->counts)));
-
-        // Allocate buffers used by palette coding mode.
-        CHECK_MEM_ERROR(
-            cm, thread_data->td->palette_buffer,
-            aom_memalign(16, sizeof(*thread_data->td->palette_buffer)));
-
-        // Create threads
-        if (!winterface->reset(worker))
-          aom_internal_error(&cm->error, AOM_CODEC_ERROR,
-                             "Tile encoder thread creation failed");
-      } else {
-        // Main thread acts as a worker and uses the thread data in cpi.
-        thread_data->td = &cpi->td;
-      }
-
-      winterface->sync(worker);
+      CHECK_MEM_ERROR(cm, thread_data->td->above_pred_buf,
+                      (uint8_t *)aom_memalign(
+                          16,
+                          buf_scaler * MAX_MB_PLANE * MAX_SB_SQUARE *
+                              sizeof(*thread_data->td->above_pred_buf)));
+      CHECK_MEM_ERROR(cm, thread_data->td->left_pred_buf,
+                      (uint8_t *)aom_memalign(
+                          16,
+                          buf_scaler * MAX_MB_PLANE * MAX_SB_SQUARE *
+                              sizeof(*thread_data->td->left_pred_buf)));
+      CHECK_MEM_ERROR(
+          cm, thread_data->td->wsrc_buf,
+          (int32_t *)aom_memalign(
+              16, MAX_SB_SQUARE * sizeof(*thread_data->td->wsrc_buf)));
+      CHECK_MEM_ERROR(
+          cm, thread_data->td->mask_buf,
+          (int32_t *)aom_memalign(
+              16, MAX_SB_SQUARE * sizeof(*thread_data->td->mask_buf)));
+      // Allocate frame counters in thread data.
+      CHECK_MEM_ERROR(cm, thread_data->td->counts,
+                      aom_calloc(1, sizeof(*thread_data->td->counts)));
+
+      // Allocate buffers used by palette coding mode.
+      CHECK_MEM_ERROR(
+          cm, thread_data->td->palette_buffer,
+          aom_memalign(16, sizeof(*thread_data->td->palette_buffer)));
+    } else {
+      // The last worker uses the thread data in cpi.
+      thread_data->td = &cpi->td;
     }
   }
+}
 
-  for (i = 0; i < num_workers; i++) {
-    AVxWorker *const worker = &cpi->workers[i];
-    EncWorkerData *thread_data;
+static void prepare_enc_workers(AV1_COMP *cpi, int num_workers) {
+  int i;
 
-    worker->hook = (AVxWorkerHook)enc_worker_hook;
-    worker->data1 = &cpi->tile_thr_data[i];
-    worker->data2 = NULL;
-    thread_data = (EncWorkerData *)worker->data1;
+  for (i = 0; i < num_workers; i++) {
+    EncWorkerData *const thread_data = &cpi->tile_thr_data[i];
 
     // Before encoding a frame, copy the thread data from cpi.
     if (thread_data->td != &cpi->td) {
@@ -159,30 +296,31 @@ void av1_encode_tiles_mt(AV1_COMP *cpi) {
     if (i < num_workers - 1)
       thread_data->td->mb.palette_buffer = thread_data->td->palette_buffer;
   }
+}
 
-  // Encode a frame
-  for (i = 0; i < num_workers; i++) {
-    AVxWorker *const worker = &cpi->workers[i];
-    EncWorkerData *const thread_data = (EncWorkerData *)worker->data1;
-
-    // Set the starting tile for each thread.
-    thread_data->start = i;
+// Runs hook(thread data, data) for each worker on the scheduler. The workers
+// take their jobs from cpi->tasks, so they need not all run at once, and the
+// workers queued before a failure to queue one still finish the jobs.
+static void run_enc_workers(AV1_COMP *cpi, AVxWorkerHook hook, void *data,
+                            int num_workers) {
+  int queued = 1;
+  int i;
 
-    if (i == cpi->num_workers - 1)
-      winterface->execute(worker);
-    else
-      winterface->launch(worker);
-  }
+  for (i = 0; i < num_workers && queued; i++)
+    queued = aom_scheduler_submit(cpi->scheduler, &cpi->tasks, hook,
+                                  &cpi->tile_thr_data[i], data);
+  aom_scheduler_wait(cpi->scheduler, &cpi->tasks);
+  if (!queued)
+    aom_internal_error(&cpi->common.error, AOM_CODEC_MEM_ERROR,
+                       "Failed to queue encoder worker tasks");
+}
 
-  // Encoding ends.
-  for (i = 0; i < num_workers; i++) {
-    AVxWorker *const worker = &cpi->workers[i];
-    winterface->sync(worker);
-  }
+static void accumulate_enc_workers(AV1_COMP *cpi, int num_workers) {
+  AV1_COMMON *const cm = &cpi->common;
+  int i;
 
   for (i = 0; i < num_workers; i++) {
-    AVxWorker *const worker = &cpi->workers[i];
-    EncWorkerData *const thread_data = (EncWorkerData *)worker->data1;
+    EncWorkerData *const thread_data = &cpi->tile_thr_data[i];
 
     // Accumulate counters.
     if (i < cpi->num_workers - 1) {
@@ -192,3 +330,275 @@ void av1_encode_tiles_mt(AV1_COMP *cpi) {
     }
   }
 }
+
+void av1_encode_tiles_mt(AV1_COMP *cpi) {
+  AV1_COMMON *const cm = &cpi->common;
+  const int tile_cols = cm->tile_cols;
+  const int num_workers = AOMMIN(cpi->oxcf.max_threads, tile_cols);
+
+  av1_init_tile_data(cpi);
+
+  if (cpi->num_workers == 0) create_enc_workers(cpi, num_workers);
+
+  prepare_enc_workers(cpi, num_workers);
+  run_enc_workers(cpi, (AVxWorkerHook)enc_worker_hook, NULL, num_workers);
+  accumulate_enc_workers(cpi, num_workers);
+}
+
+static void reset_row_mt_sync(AV1_COMP *cpi, int rows, int tile_cols) {
+  AV1RowMTSync *const row_mt_sync = &cpi->row_mt_sync;
+
+  if (row_mt_sync->rows != rows || row_mt_sync->tile_cols != tile_cols) {
+    av1_row_mt_sync_dealloc(row_mt_sync);
+    av1_row_mt_sync_alloc(row_mt_sync, &cpi->common, rows, tile_cols);
+  }
+  memset(row_mt_sync->cur_sb_col, 0,
+         sizeof(*row_mt_sync->cur_sb_col) * rows * tile_cols);
+}
+
+void av1_encode_tiles_row_mt(AV1_COMP *cpi) {
+  AV1_COMMON *const cm = &cpi->common;
+  AV1RowMTSync *const row_mt_sync = &cpi->row_mt_sync;
+  const int tile_cols = cm->tile_cols;
+  const int tile_rows = cm->tile_rows;
+  const int sb_rows = (cm->mi_rows + cm->mib_size - 1) >> cm->mib_size_log2;
+  const int num_planes = av1_num_planes(cm);
+  int num_workers;
+  int tile_row, tile_col, i;
+
+  av1_init_tile_data(cpi);
+
+  if (cpi->num_workers == 0)
+    create_enc_workers(cpi, AOMMAX(cpi->oxcf.max_threads, 1));
+  num_workers = cpi->num_workers;
+
+  reset_row_mt_sync(cpi, sb_rows, tile_cols);
+
+  for (i = 0; i < num_workers; i++) {
+    EncWorkerData *const thread_data = &cpi->tile_thr_data[i];
+    if (thread_data->row_tile_data == NULL)
+      CHECK_MEM_ERROR(cm, thread_data->row_tile_data,
+                      aom_memalign(32, sizeof(*thread_data->row_tile_data)));
+#if CONFIG_INTRABC
+    thread_data->td->intrabc_used_this_tile = 0;
+#endif  // CONFIG_INTRABC
+  }
+
+  prepare_enc_workers(cpi, num_workers);
+  run_enc_workers(cpi, (AVxWorkerHook)enc_row_mt_worker_hook, NULL,
+                  num_workers);
+  accumulate_enc_workers(cpi, num_workers);
+
+  // The loop filter and restoration searches, and the partition costs of the
+  // following inter frames, read the rate state left in the main thread's
+  // macroblock. Take it from the worker that encoded the last superblock
+  // row, so that it does not depend on the number of threads.
+  {
+    const MACROBLOCK *const last_x = &row_mt_sync->last_td->mb;
+    MACROBLOCK *const x = &cpi->td.mb;
+    x->rdmult = last_x->rdmult;
+    av1_copy(x->partition_cost, last_x->partition_cost);
+    av1_copy(x->switchable_restore_cost, last_x->switchable_restore_cost);
+    av1_copy(x->wiener_restore_cost, last_x->wiener_restore_cost);
+    av1_copy(x->sgrproj_restore_cost, last_x->sgrproj_restore_cost);
+  }
+
+#if CONFIG_INTRABC
+  for (i = 0; i < num_workers; i++)
+    cpi->intrabc_used |= cpi->tile_thr_data[i].td->intrabc_used_this_tile;
+#endif  // CONFIG_INTRABC
+
+  // Each superblock row wrote its tokens to its own slice of the tile's token
+  // buffer. Pack them so that the tile's tokens are contiguous again.
+  for (tile_row = 0; tile_row < tile_rows; ++tile_row) {
+    for (tile_col = 0; tile_col < tile_cols; ++tile_col) {
+      const TileInfo *const tile_info =
+          &cpi->tile_data[tile_row * tile_cols + tile_col].tile_info;
+      const unsigned int row_tokens = allocated_sb_row_tokens(
+          *tile_info, cm->mib_size_log2 + MI_SIZE_LOG2, num_planes);
+      TOKENEXTRA *const tile_tok = cpi->tile_tok[tile_row][tile_col];
+      unsigned int tok_count = 0;
+      int mi_row, r = 0;
+
+      for (mi_row = tile_info->mi_row_start; mi_row < tile_info->mi_row_end;
+           mi_row += cm->mib_size, ++r) {
+        const unsigned int row_count =
+            row_mt_sync->tok_count[tile_col * sb_rows +
+                                   (mi_row >> cm->mib_size_log2)];
+        if (r > 0)
+          memmove(tile_tok + tok_count, tile_tok + r * row_tokens,
+                  row_count * sizeof(*tile_tok));
+        tok_count += row_count;
+      }
+      cpi->tok_count[tile_row][tile_col] = tok_count;
+    }
+  }
+}
+
+typedef struct {
+  FIRSTPASS_ROW_STATS *row_stats;
+  int *raw_motion_err_list;
+  FIRSTPASS_MB_FACTORS *mb_factors;
+} FirstPassRowData;
+
+// Macroblock rows of the first pass are handed out in order, like the
+// superblock rows of row based multi-threading.
+static int fp_row_worker_hook(EncWorkerData *const thread_data,
+                              FirstPassRowData *const data) {
+  AV1_COMP *const cpi = thread_data->cpi;
+  const AV1_COMMON *const cm = &cpi->common;
+  int mb_row;
+
+  while ((mb_row = aom_task_group_next_job(&cpi->tasks)) < cm->mb_rows) {
+    av1_first_pass_row(cpi, thread_data->td, &cpi->row_mt_sync, mb_row,
+                       &data->row_stats[mb_row],
+                       data->raw_motion_err_list + mb_row * cm->mb_cols,
+                       data->mb_factors + mb_row * cm->mb_cols);
+  }
+  return 1;
+}
+
+void av1_first_pass_rows_mt(AV1_COMP *cpi, FIRSTPASS_ROW_STATS *row_stats,
+                            int *raw_motion_err_list,
+                            FIRSTPASS_MB_FACTORS *mb_factors) {
+  FirstPassRowData data;
+  int num_workers;
+
+  if (cpi->num_workers == 0)
+    create_enc_workers(cpi, AOMMAX(cpi->oxcf.max_threads, 1));
+  num_workers = cpi->num_workers;
+
+  reset_row_mt_sync(cpi, cpi->common.mb_rows, 1);
+
+  data.row_stats = row_stats;
+  data.raw_motion_err_list = raw_motion_err_list;
+  data.mb_factors = mb_factors;
+
+  prepare_enc_workers(cpi, num_workers);
+  run_enc_workers(cpi, (AVxWorkerHook)fp_row_worker_hook, &data, num_workers);
+}
+
+static int tf_row_worker_hook(EncWorkerData *const thread_data,
+                              const TemporalFilterData *const tf_data) {
+  AV1_COMP *const cpi = thread_data->cpi;
+  const YV12_BUFFER_CONFIG *const f = tf_data->frames[tf_data->alt_ref_index];
+  const int mb_rows = (f->y_crop_height + 15) >> 4;
+  int mb_row;
+
+  while ((mb_row = aom_task_group_next_job(&cpi->tasks)) < mb_rows)
+    av1_temporal_filter_row(cpi, thread_data->td, tf_data, mb_row);
+  return 1;
+}
+
+void av1_temporal_filter_rows_mt(AV1_COMP *cpi,
+                                 const TemporalFilterData *tf_data) {
+  int num_workers;
+
+  if (cpi->num_workers == 0)
+    create_enc_workers(cpi, AOMMAX(cpi->oxcf.max_threads, 1));
+  num_workers = cpi->num_workers;
+
+  prepare_enc_workers(cpi, num_workers);
+  run_enc_workers(cpi, (AVxWorkerHook)tf_row_worker_hook, (void *)tf_data,
+                  num_workers);
+}
+
+typedef struct {
+  const int *frames;
+  int num_frames;
+  YV12_BUFFER_CONFIG **ref_buf;
+  int *same_as_source;
+} GlobalMotionJobs;
+
+// Each job searches one reference. The references have distinct buffers, and
+// share only the source, whose corners were found before the jobs started.
+static int gm_worker_hook(EncWorkerData *const thread_data,
+                          GlobalMotionJobs *const jobs) {
+  AV1_COMP *const cpi = thread_data->cpi;
+  int job;
+
+  while ((job = aom_task_group_next_job(&cpi->tasks)) < jobs->num_frames) {
+    const int frame = jobs->frames[job];
+    jobs->same_as_source[frame] =
+        av1_compute_global_motion_for_ref(cpi, frame, jobs->ref_buf[frame]);
+  }
+  return 1;
+}
+
+void av1_global_motion_search_mt(AV1_COMP *cpi, const int *frames,
+                                 int num_frames, YV12_BUFFER_CONFIG **ref_buf,
+                                 int *same_as_source) {
+  GlobalMotionJobs jobs;
+  int num_workers;
+
+  if (cpi->num_workers == 0)
+    create_enc_workers(cpi, AOMMAX(cpi->oxcf.max_threads, 1));
+  num_workers = AOMMIN(cpi->num_workers, num_frames);
+
+  jobs.frames = frames;
+  jobs.num_frames = num_frames;
+  jobs.ref_buf = ref_buf;
+  jobs.same_as_source = same_as_source;
+
+  run_enc_workers(cpi, (AVxWorkerHook)gm_worker_hook, &jobs, num_workers);
+}
+
+#if CONFIG_HASH_ME
+// The rows of a block size are hashed in bands of this many rows, which each
+// take a few thousand block hashes.
+#define HASH_ROWS_PER_JOB 16
+
+typedef struct {
+  int block_size;
+  uint32_t **src_pic_block_hash;
+  uint32_t **dst_pic_block_hash;
+  int8_t **src_pic_block_same_info;
+  int8_t **dst_pic_block_same_info;
+} BlockHashData;
+
+static int hash_worker_hook(EncWorkerData *const thread_data,
+                            BlockHashData *const data) {
+  AV1_COMP *const cpi = thread_data->cpi;
+  const YV12_BUFFER_CONFIG *const source = cpi->source;
+  const int num_jobs =
+      (source->y_crop_height + HASH_ROWS_PER_JOB - 1) / HASH_ROWS_PER_JOB;
+  int job;
+
+  while ((job = aom_task_group_next_job(&cpi->tasks)) < num_jobs) {
+    const int row_start = job * HASH_ROWS_PER_JOB;
+    const int row_end = row_start + HASH_ROWS_PER_JOB;
+    if (data->block_size == 2) {
+      av1_generate_block_2x2_hash_value(source, data->dst_pic_block_hash,
+                                        data->dst_pic_block_same_info,
+                                        row_start, row_end);
+    } else {
+      av1_generate_block_hash_value(
+          source, data->block_size, data->src_pic_block_hash,
+          data->dst_pic_block_hash, data->src_pic_block_same_info,
+          data->dst_pic_block_same_info, row_start, row_end);
+    }
+  }
+  return 1;
+}
+
+void av1_generate_block_hash_value_mt(AV1_COMP *cpi, int block_size,
+                                      uint32_t *src_pic_block_hash[2],
+                                      uint32_t *dst_pic_block_hash[2],
+                                      int8_t *src_pic_block_same_info[3],
+                                      int8_t *dst_pic_block_same_info[3]) {
+  BlockHashData data;
+  int num_workers;
+
+  if (cpi->num_workers == 0)
+    create_enc_workers(cpi, AOMMAX(cpi->oxcf.max_threads, 1));
+  num_workers = cpi->num_workers;
+
+  data.block_size = block_size;
+  data.src_pic_block_hash = src_pic_block_hash;
+  data.dst_pic_block_hash = dst_pic_block_hash;
+  data.src_pic_block_same_info = src_pic_block_same_info;
+  data.dst_pic_block_same_info = dst_pic_block_same_info;
+
+  run_enc_workers(cpi, (AVxWorkerHook)hash_worker_hook, &data, num_workers);
+}
+#endif  // CONFIG_HASH_ME
@@ -12,20 +12,91 @@
 #ifndef AV1_ENCODER_ETHREAD_H_
 #define AV1_ENCODER_ETHREAD_H_
 
+#include "./aom_config.h"
+#include "aom/aom_integer.h"
+#include "aom_util/aom_thread.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 struct AV1_COMP;
+struct AV1Common;
+struct FIRSTPASS_ROW_STATS;
+struct FIRSTPASS_MB_FACTORS;
+struct TemporalFilterData;
 struct ThreadData;
+struct TileDataEnc;
+struct yv12_buffer_config;
 
 typedef struct EncWorkerData {
   struct AV1_COMP *cpi;
   struct ThreadData *td;
-  int start;
+  // Private tile state used to encode one superblock row at a time in row
+  // based multi-threading mode.
+  struct TileDataEnc *row_tile_data;
 } EncWorkerData;
 
+// Superblock row synchronization for row based multi-threading. Rows of each
+// tile column are indexed by tile_col * rows + sb_row.
+typedef struct AV1RowMTSync {
+#if CONFIG_MULTITHREAD
+  pthread_mutex_t *mutex_;
+  pthread_cond_t *cond_;
+#endif
+  // Number of superblocks encoded so far in each superblock row.
+  int *cur_sb_col;
+  // Number of tokens written by each superblock row.
+  unsigned int *tok_count;
+  int rows;
+  int tile_cols;
+  // The thread data of the worker which encoded the last superblock row.
+  struct ThreadData *last_td;
+} AV1RowMTSync;
+
+void av1_row_mt_sync_alloc(AV1RowMTSync *row_mt_sync, struct AV1Common *cm,
+                           int rows, int tile_cols);
+void av1_row_mt_sync_dealloc(AV1RowMTSync *row_mt_sync);
+
+// Waits until the superblock row above has encoded the superblocks up to and
+// including the top-right neighbour of superblock c, which keeps rows two
+// superblocks apart. Passing the superblock column count waits for the whole
+// row above.
+void av1_row_mt_sync_read(AV1RowMTSync *row_mt_sync, int tile_col,
+                          int sb_row, int c);
+void av1_row_mt_sync_write(AV1RowMTSync *row_mt_sync, int tile_col,
+                           int sb_row, int c, int sb_cols);
+
 void av1_encode_tiles_mt(struct AV1_COMP *cpi);
+void av1_encode_tiles_row_mt(struct AV1_COMP *cpi);
+
+// Codes the macroblock rows of a first pass frame on the encoder workers.
+void av1_first_pass_rows_mt(struct AV1_COMP *cpi,
+                            struct FIRSTPASS_ROW_STATS *row_stats,
+                            int *raw_motion_err_list,
+                            struct FIRSTPASS_MB_FACTORS *mb_factors);
+
+// Filters the macroblock rows of an ARF on the encoder workers.
+void av1_temporal_filter_rows_mt(struct AV1_COMP *cpi,
+                                 const struct TemporalFilterData *tf_data);
+
+#if CONFIG_HASH_ME
+// Hashes the blocks of block_size of the source, as generate_block_hash_value()
+// in encodeframe.c does, a band of rows at a time on the encoder workers.
+void av1_generate_block_hash_value_mt(struct AV1_COMP *cpi, int block_size,
+                                      uint32_t *src_pic_block_hash[2],
+                                      uint32_t *dst_pic_block_hash[2],
+                                      int8_t *src_pic_block_same_info[3],
+                                      int8_t *dst_pic_block_same_info[3]);
+#endif  // CONFIG_HASH_ME
+
+// Searches the global motion of the num_frames references listed in frames,
+// whose buffers are ref_buf[frame], on the encoder workers. Sets
+// same_as_source[frame] to what av1_compute_global_motion_for_ref() returns.
+void av1_global_motion_search_mt(struct AV1_COMP *cpi, const int *frames,
+                                 int num_frames,
+                                 struct yv12_buffer_config **ref_buf,
+                                 int *same_as_source);
 
 #ifdef __cplusplus
 }  // extern "C"
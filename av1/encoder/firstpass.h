@@ -93,6 +93,42 @@ typedef struct {
   double raw_error_stdev;
 } FIRSTPASS_STATS;
 
+// Raw sums gathered by the first pass over one row of macroblocks. The rows
+// of a frame are merged in raster order, so the frame's stats do not depend
+// on which thread coded each row.
+typedef struct FIRSTPASS_ROW_STATS {
+  int64_t intra_error;
+  int64_t coded_error;
+  int64_t sr_coded_error;
+  int64_t sum_mvrs;
+  int64_t sum_mvcs;
+  int sum_mvr;
+  int sum_mvc;
+  int sum_mvr_abs;
+  int sum_mvc_abs;
+  int mvcount;
+  int intercount;
+  int second_ref_count;
+  int intra_skip_count;
+  int new_mv_count;
+  int sum_in_vectors;
+  int image_data_start_row;
+  int raw_motion_err_counts;
+  // First and last non-zero motion vectors, used to carry new_mv_count across
+  // rows.
+  MV first_mv;
+  MV last_mv;
+} FIRSTPASS_ROW_STATS;
+
+// Floating point factors of one macroblock of the first pass. Summing them
+// by row would round differently from the serial sum over the frame, so they
+// are kept per macroblock and summed over the frame in raster order.
+typedef struct FIRSTPASS_MB_FACTORS {
+  double intra_factor;
+  double brightness_factor;
+  double neutral_count;
+} FIRSTPASS_MB_FACTORS;
+
 typedef enum {
   KF_UPDATE = 0,
   LF_UPDATE = 1,
@@ -176,10 +212,20 @@ typedef struct {
 } TWO_PASS;
 
 struct AV1_COMP;
+struct AV1RowMTSync;
+struct ThreadData;
 
 void av1_init_first_pass(struct AV1_COMP *cpi);
 void av1_rc_get_first_pass_params(struct AV1_COMP *cpi);
 void av1_first_pass(struct AV1_COMP *cpi, const struct lookahead_entry *source);
+// Codes one row of macroblocks of the first pass frame. raw_motion_err_list
+// receives the row's raw motion errors and mb_factors the factors of each of
+// its macroblocks. When row_mt_sync is not NULL each macroblock waits for the
+// row above to be two macroblocks ahead.
+void av1_first_pass_row(struct AV1_COMP *cpi, struct ThreadData *td,
+                        struct AV1RowMTSync *row_mt_sync, int mb_row,
+                        FIRSTPASS_ROW_STATS *stats, int *raw_motion_err_list,
+                        FIRSTPASS_MB_FACTORS *mb_factors);
 void av1_end_first_pass(struct AV1_COMP *cpi);
 
 void av1_init_second_pass(struct AV1_COMP *cpi);
@@ -17,6 +17,7 @@
 
 #include "av1/encoder/global_motion.h"
 
+#include "aom_mem/aom_mem.h"
 #include "av1/common/warped_motion.h"
 
 #include "av1/encoder/segmentation.h"
@@ -128,6 +129,64 @@ static void force_wmtype(WarpedMotionParams *wm, TransformationType wmtype) {
   wm->wmtype = wmtype;
 }
 
+// Returns the error of "wm" over the frame, less the border, measuring only
+// one in every "sample_step" error blocks across and down it.
+static int64_t refine_warp_error(WarpedMotionParams *wm,
+#if CONFIG_HIGHBITDEPTH
+                                 int use_hbd, int bd,
+#endif  // CONFIG_HIGHBITDEPTH
+                                 uint8_t *ref, int r_width, int r_height,
+                                 int r_stride, uint8_t *dst, int d_width,
+                                 int d_height, int d_stride, int sample_step,
+                                 int64_t best_error) {
+  const int border = ERRORADV_BORDER;
+  return av1_warp_error(wm,
+#if CONFIG_HIGHBITDEPTH
+                        use_hbd, bd,
+#endif  // CONFIG_HIGHBITDEPTH
+                        ref, r_width, r_height, r_stride,
+                        dst + border * d_stride + border, border, border,
+                        d_width - 2 * border, d_height - 2 * border, d_stride,
+                        0, 0, sample_step, best_error);
+}
+
+// Returns 1 if "wm" has a lower error than "*best_error", and updates it.
+// With a "sample_step" above 1, "wm" must first beat "*best_sampled_error",
+// the error of the best parameters on the sampled blocks, so that most
+// rejected steps cost only the sampled blocks. Steps that pass are confirmed
+// on the whole frame, so "*best_error" is always that of the full frame.
+static int is_better_warp(WarpedMotionParams *wm,
+#if CONFIG_HIGHBITDEPTH
+                          int use_hbd, int bd,
+#endif  // CONFIG_HIGHBITDEPTH
+                          uint8_t *ref, int r_width, int r_height,
+                          int r_stride, uint8_t *dst, int d_width,
+                          int d_height, int d_stride, int sample_step,
+                          int64_t *best_error, int64_t *best_sampled_error) {
+  int64_t sampled_error = 0;
+  int64_t error;
+  if (sample_step > 1) {
+    sampled_error =
+        refine_warp_error(wm,
+#if CONFIG_HIGHBITDEPTH
+                          use_hbd, bd,
+#endif  // CONFIG_HIGHBITDEPTH
+                          ref, r_width, r_height, r_stride, dst, d_width,
+                          d_height, d_stride, sample_step, *best_sampled_error);
+    if (sampled_error >= *best_sampled_error) return 0;
+  }
+  error = refine_warp_error(wm,
+#if CONFIG_HIGHBITDEPTH
+                            use_hbd, bd,
+#endif  // CONFIG_HIGHBITDEPTH
+                            ref, r_width, r_height, r_stride, dst, d_width,
+                            d_height, d_stride, 1, *best_error);
+  if (error >= *best_error) return 0;
+  *best_error = error;
+  *best_sampled_error = sampled_error;
+  return 1;
+}
+
 int64_t refine_integerized_param(WarpedMotionParams *wm,
                                  TransformationType wmtype,
 #if CONFIG_HIGHBITDEPTH
@@ -136,30 +195,36 @@ int64_t refine_integerized_param(WarpedMotionParams *wm,
                                  uint8_t *ref, int r_width, int r_height,
                                  int r_stride, uint8_t *dst, int d_width,
                                  int d_height, int d_stride, int n_refinements,
-                                 int64_t best_frame_error) {
+                                 int sample_step, int64_t best_frame_error) {
   static const int max_trans_model_params[TRANS_TYPES] = {
     0, 2, 4, 6,
   };
-  const int border = ERRORADV_BORDER;
   int i = 0, p;
   int n_params = max_trans_model_params[wmtype];
   int32_t *param_mat = wm->wmmat;
-  int64_t step_error, best_error;
+  int64_t best_error, best_sampled_error = 0;
   int32_t step;
   int32_t *param;
   int32_t curr_param;
   int32_t best_param;
 
   force_wmtype(wm, wmtype);
-  best_error = av1_warp_error(wm,
+  best_error = refine_warp_error(wm,
 #if CONFIG_HIGHBITDEPTH
-                              use_hbd, bd,
+                                 use_hbd, bd,
 #endif  // CONFIG_HIGHBITDEPTH
-                              ref, r_width, r_height, r_stride,
-                              dst + border * d_stride + border, border, border,
-                              d_width - 2 * border, d_height - 2 * border,
-                              d_stride, 0, 0, best_frame_error);
+                                 ref, r_width, r_height, r_stride, dst, d_width,
+                                 d_height, d_stride, 1, best_frame_error);
   best_error = AOMMIN(best_error, best_frame_error);
+  if (sample_step > 1) {
+    best_sampled_error =
+        refine_warp_error(wm,
+#if CONFIG_HIGHBITDEPTH
+                          use_hbd, bd,
+#endif  // CONFIG_HIGHBITDEPTH
+                          ref, r_width, r_height, r_stride, dst, d_width,
+                          d_height, d_stride, sample_step, INT64_MAX);
+  }
   step = 1 << (n_refinements - 1);
   for (i = 0; i < n_refinements; i++, step >>= 1) {
     for (p = 0; p < n_params; ++p) {
@@ -170,32 +235,26 @@ int64_t refine_integerized_param(WarpedMotionParams *wm,
       best_param = curr_param;
       // look to the left
       *param = add_param_offset(p, curr_param, -step);
-      step_error = av1_warp_error(
-          wm,
+      if (is_better_warp(wm,
 #if CONFIG_HIGHBITDEPTH
-          use_hbd, bd,
+                         use_hbd, bd,
 #endif  // CONFIG_HIGHBITDEPTH
-          ref, r_width, r_height, r_stride, dst + border * d_stride + border,
-          border, border, d_width - 2 * border, d_height - 2 * border, d_stride,
-          0, 0, best_error);
-      if (step_error < best_error) {
-        best_error = step_error;
+                         ref, r_width, r_height, r_stride, dst, d_width,
+                         d_height, d_stride, sample_step, &best_error,
+                         &best_sampled_error)) {
         best_param = *param;
         step_dir = -1;
       }
 
       // look to the right
       *param = add_param_offset(p, curr_param, step);
-      step_error = av1_warp_error(
-          wm,
+      if (is_better_warp(wm,
 #if CONFIG_HIGHBITDEPTH
-          use_hbd, bd,
+                         use_hbd, bd,
 #endif  // CONFIG_HIGHBITDEPTH
-          ref, r_width, r_height, r_stride, dst + border * d_stride + border,
-          border, border, d_width - 2 * border, d_height - 2 * border, d_stride,
-          0, 0, best_error);
-      if (step_error < best_error) {
-        best_error = step_error;
+                         ref, r_width, r_height, r_stride, dst, d_width,
+                         d_height, d_stride, sample_step, &best_error,
+                         &best_sampled_error)) {
         best_param = *param;
         step_dir = 1;
       }
@@ -205,16 +264,13 @@ int64_t refine_integerized_param(WarpedMotionParams *wm,
       // for the biggest step size
       while (step_dir) {
         *param = add_param_offset(p, best_param, step * step_dir);
-        step_error = av1_warp_error(
-            wm,
+        if (is_better_warp(wm,
 #if CONFIG_HIGHBITDEPTH
-            use_hbd, bd,
+                           use_hbd, bd,
 #endif  // CONFIG_HIGHBITDEPTH
-            ref, r_width, r_height, r_stride, dst + border * d_stride + border,
-            border, border, d_width - 2 * border, d_height - 2 * border,
-            d_stride, 0, 0, best_error);
-        if (step_error < best_error) {
-          best_error = step_error;
+                           ref, r_width, r_height, r_stride, dst, d_width,
+                           d_height, d_stride, sample_step, &best_error,
+                           &best_sampled_error)) {
           best_param = *param;
         } else {
           *param = best_param;
@@ -257,6 +313,46 @@ static unsigned char *downconvert_frame(YV12_BUFFER_CONFIG *frm,
 }
 #endif
 
+// Returns the FAST corners of the luma plane of |frm|, whose 8-bit version is
+// |buf|, detecting them the first time they are asked for after the frame
+// was written. Returns NULL if they cannot be allocated.
+static int *get_frame_corners(YV12_BUFFER_CONFIG *frm, unsigned char *buf,
+                              int *num_corners) {
+  *num_corners = 0;
+  if (!frm->corners_valid) {
+    if (!frm->corners) {
+      frm->corners =
+          (int *)aom_malloc(2 * MAX_CORNERS * sizeof(*frm->corners));
+      if (!frm->corners) return NULL;
+    }
+    frm->num_corners =
+        fast_corner_detect(buf, frm->y_width, frm->y_height, frm->y_stride,
+                           frm->corners, MAX_CORNERS);
+    frm->corners_valid = 1;
+  }
+  *num_corners = frm->num_corners;
+  return frm->corners;
+}
+
+static unsigned char *get_frame_luma_8bit(YV12_BUFFER_CONFIG *frm,
+                                          int bit_depth) {
+#if CONFIG_HIGHBITDEPTH
+  if (frm->flags & YV12_FLAG_HIGHBITDEPTH) {
+    // The frame buffer is 16-bit, so we need to convert to 8 bits for the
+    // following code. We cache the result until the frame is released.
+    return downconvert_frame(frm, bit_depth);
+  }
+#else
+  (void)bit_depth;
+#endif
+  return frm->y_buffer;
+}
+
+void prepare_global_motion_frame(YV12_BUFFER_CONFIG *frm, int bit_depth) {
+  int num_corners;
+  get_frame_corners(frm, get_frame_luma_8bit(frm, bit_depth), &num_corners);
+}
+
 int compute_global_motion_feature_based(
     TransformationType type, YV12_BUFFER_CONFIG *frm, YV12_BUFFER_CONFIG *ref,
 #if CONFIG_HIGHBITDEPTH
@@ -267,35 +363,29 @@ int compute_global_motion_feature_based(
   int num_frm_corners, num_ref_corners;
   int num_correspondences;
   int *correspondences;
-  int frm_corners[2 * MAX_CORNERS], ref_corners[2 * MAX_CORNERS];
+  int *frm_corners, *ref_corners;
   unsigned char *frm_buffer = frm->y_buffer;
   unsigned char *ref_buffer = ref->y_buffer;
   RansacFunc ransac = get_ransac_type(type);
 
 #if CONFIG_HIGHBITDEPTH
-  if (frm->flags & YV12_FLAG_HIGHBITDEPTH) {
-    // The frame buffer is 16-bit, so we need to convert to 8 bits for the
-    // following code. We cache the result until the frame is released.
-    frm_buffer = downconvert_frame(frm, bit_depth);
-  }
-  if (ref->flags & YV12_FLAG_HIGHBITDEPTH) {
-    ref_buffer = downconvert_frame(ref, bit_depth);
-  }
+  frm_buffer = get_frame_luma_8bit(frm, bit_depth);
+  ref_buffer = get_frame_luma_8bit(ref, bit_depth);
 #endif
 
-  // compute interest points in images using FAST features
-  num_frm_corners = fast_corner_detect(frm_buffer, frm->y_width, frm->y_height,
-                                       frm->y_stride, frm_corners, MAX_CORNERS);
-  num_ref_corners = fast_corner_detect(ref_buffer, ref->y_width, ref->y_height,
-                                       ref->y_stride, ref_corners, MAX_CORNERS);
+  // compute interest points in images using FAST features, or reuse those
+  // found for an earlier model or reference
+  frm_corners = get_frame_corners(frm, frm_buffer, &num_frm_corners);
+  ref_corners = get_frame_corners(ref, ref_buffer, &num_ref_corners);
+  if (!frm_corners || !ref_corners) num_frm_corners = num_ref_corners = 0;
 
   // find correspondences between the two images
   correspondences =
       (int *)malloc(num_frm_corners * 4 * sizeof(*correspondences));
   num_correspondences = determine_correspondence(
-      frm_buffer, (int *)frm_corners, num_frm_corners, ref_buffer,
-      (int *)ref_corners, num_ref_corners, frm->y_width, frm->y_height,
-      frm->y_stride, ref->y_stride, correspondences);
+      frm_buffer, frm_corners, num_frm_corners, ref_buffer, ref_corners,
+      num_ref_corners, frm->y_width, frm->y_height, frm->y_stride,
+      ref->y_stride, correspondences);
 
   ransac(correspondences, num_correspondences, num_inliers_by_motion,
          params_by_motion, num_motions);
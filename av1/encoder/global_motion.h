@@ -28,7 +28,9 @@ int is_enough_erroradvantage(double erroradv, int params_cost);
 
 // Returns the av1_warp_error between "dst" and the result of applying the
 // motion params that result from fine-tuning "wm" to "ref". Note that "wm" is
-// modified in place.
+// modified in place. With a "sample_step" above 1, each step is first tried
+// on one in every "sample_step" error blocks across and down the frame, and
+// only steps that improve on those are measured on the whole frame.
 int64_t refine_integerized_param(WarpedMotionParams *wm,
                                  TransformationType wmtype,
 #if CONFIG_HIGHBITDEPTH
@@ -37,7 +39,7 @@ int64_t refine_integerized_param(WarpedMotionParams *wm,
                                  uint8_t *ref, int r_width, int r_height,
                                  int r_stride, uint8_t *dst, int d_width,
                                  int d_height, int d_stride, int n_refinements,
-                                 int64_t best_frame_error);
+                                 int sample_step, int64_t best_frame_error);
 
 /*
   Computes "num_motions" candidate global motion parameters between two frames.
@@ -60,6 +62,11 @@ int compute_global_motion_feature_based(
     int bit_depth,
 #endif
     int *num_inliers_by_motion, double *params_by_motion, int num_motions);
+
+// Finds and caches the corners of "frm", and its 8-bit copy, which
+// compute_global_motion_feature_based() would otherwise make on first use,
+// so that the searches against several references can run at once.
+void prepare_global_motion_frame(YV12_BUFFER_CONFIG *frm, int bit_depth);
 #ifdef __cplusplus
 }  // extern "C"
 #endif
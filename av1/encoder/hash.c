@@ -11,25 +11,24 @@
 
 #include "av1/encoder/hash.h"
 
-static void crc_calculator_process_data(CRC_CALCULATOR *p_crc_calculator,
-                                        uint8_t *pData, uint32_t dataLength) {
+// Returns the remainder after adding the data to "remainder". The calculator
+// is only read, so that several threads can hash with it at once.
+static uint32_t crc_calculator_process_data(
+    const CRC_CALCULATOR *p_crc_calculator, uint32_t remainder, uint8_t *pData,
+    uint32_t dataLength) {
   for (uint32_t i = 0; i < dataLength; i++) {
     const uint8_t index =
-        (p_crc_calculator->remainder >> (p_crc_calculator->bits - 8)) ^
-        pData[i];
-    p_crc_calculator->remainder <<= 8;
-    p_crc_calculator->remainder ^= p_crc_calculator->table[index];
+        (remainder >> (p_crc_calculator->bits - 8)) ^ pData[i];
+    remainder <<= 8;
+    remainder ^= p_crc_calculator->table[index];
   }
+  return remainder;
 }
 
 void crc_calculator_reset(CRC_CALCULATOR *p_crc_calculator) {
   p_crc_calculator->remainder = 0;
 }
 
-static uint32_t crc_calculator_get_crc(CRC_CALCULATOR *p_crc_calculator) {
-  return p_crc_calculator->remainder & p_crc_calculator->final_result_mask;
-}
-
 static void crc_calculator_init_table(CRC_CALCULATOR *p_crc_calculator) {
   const uint32_t high_bit = 1 << (p_crc_calculator->bits - 1);
   const uint32_t byte_high_bit = 1 << (8 - 1);
@@ -63,7 +62,6 @@ void av1_crc_calculator_init(CRC_CALCULATOR *p_crc_calculator, uint32_t bits,
 
 uint32_t av1_get_crc_value(CRC_CALCULATOR *p_crc_calculator, uint8_t *p,
                            int length) {
-  crc_calculator_reset(p_crc_calculator);
-  crc_calculator_process_data(p_crc_calculator, p, length);
-  return crc_calculator_get_crc(p_crc_calculator);
+  return crc_calculator_process_data(p_crc_calculator, 0, p, length) &
+         p_crc_calculator->final_result_mask;
 }
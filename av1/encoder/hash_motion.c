@@ -2,6 +2,8 @@
 #include "av1/encoder/hash.h"
 #include "av1/encoder/hash_motion.h"
 #include "./av1_rtcd.h"
+#include "aom_dsp/aom_dsp_common.h"
+#include "aom_mem/aom_mem.h"
 
 static const int crc_bits = 16;
 static const int block_size_bits = 3;
@@ -9,18 +11,20 @@ static CRC_CALCULATOR crc_calculator1;
 static CRC_CALCULATOR crc_calculator2;
 static int g_crc_initialized = 0;
 
+// Empties the buckets of the block sizes added, which are the only ones that
+// can have entries.
 static void hash_table_clear_all(hash_table *p_hash_table) {
-  if (p_hash_table->p_lookup_table == NULL) {
+  if (p_hash_table->p_buckets == NULL) {
     return;
   }
-  int max_addr = 1 << (crc_bits + block_size_bits);
-  for (int i = 0; i < max_addr; i++) {
-    if (p_hash_table->p_lookup_table[i] != NULL) {
-      vector_destroy(p_hash_table->p_lookup_table[i]);
-      aom_free(p_hash_table->p_lookup_table[i]);
-      p_hash_table->p_lookup_table[i] = NULL;
+  for (int i = 0; i < (1 << block_size_bits); i++) {
+    if (p_hash_table->block_sizes_added & (1 << i)) {
+      memset(p_hash_table->p_buckets + (i << crc_bits), 0,
+             sizeof(p_hash_table->p_buckets[0]) << crc_bits);
     }
   }
+  p_hash_table->block_sizes_added = 0;
+  p_hash_table->num_entries = 0;
 }
 
 // TODO(youzhou@microsoft.com): is higher than 8 bits screen content supported?
@@ -74,64 +78,72 @@ void av1_hash_table_init(hash_table *p_hash_table) {
     av1_crc_calculator_init(&crc_calculator2, 24, 0x864CFB);
     g_crc_initialized = 1;
   }
-  p_hash_table->p_lookup_table = NULL;
+  p_hash_table->p_buckets = NULL;
+  p_hash_table->p_entries = NULL;
+  p_hash_table->num_entries = 0;
+  p_hash_table->max_entries = 0;
+  p_hash_table->block_sizes_added = 0;
 }
 
 void av1_hash_table_destroy(hash_table *p_hash_table) {
-  hash_table_clear_all(p_hash_table);
-  aom_free(p_hash_table->p_lookup_table);
-  p_hash_table->p_lookup_table = NULL;
+  aom_free(p_hash_table->p_buckets);
+  aom_free(p_hash_table->p_entries);
+  av1_hash_table_init(p_hash_table);
 }
 
-void av1_hash_table_create(hash_table *p_hash_table) {
-  if (p_hash_table->p_lookup_table != NULL) {
+int av1_hash_table_create(hash_table *p_hash_table) {
+  if (p_hash_table->p_buckets != NULL) {
     hash_table_clear_all(p_hash_table);
-    return;
+    return 1;
   }
   const int max_addr = 1 << (crc_bits + block_size_bits);
-  p_hash_table->p_lookup_table =
-      (Vector **)aom_malloc(sizeof(p_hash_table->p_lookup_table[0]) * max_addr);
-  memset(p_hash_table->p_lookup_table, 0,
-         sizeof(p_hash_table->p_lookup_table[0]) * max_addr);
+  p_hash_table->p_buckets = (hash_bucket *)aom_calloc(
+      max_addr, sizeof(p_hash_table->p_buckets[0]));
+  return p_hash_table->p_buckets != NULL;
 }
 
-static void hash_table_add_to_table(hash_table *p_hash_table,
-                                    uint32_t hash_value,
-                                    block_hash *curr_block_hash) {
-  if (p_hash_table->p_lookup_table[hash_value] == NULL) {
-    p_hash_table->p_lookup_table[hash_value] =
-        aom_malloc(sizeof(p_hash_table->p_lookup_table[0][0]));
-    vector_setup(p_hash_table->p_lookup_table[hash_value], 10,
-                 sizeof(curr_block_hash[0]));
-    vector_push_back(p_hash_table->p_lookup_table[hash_value], curr_block_hash);
-  } else {
-    vector_push_back(p_hash_table->p_lookup_table[hash_value], curr_block_hash);
+// Makes room for num_entries more entries after those already added. Returns
+// 0 if the entries cannot be allocated, leaving the table unchanged.
+static int hash_table_reserve(hash_table *p_hash_table, int num_entries) {
+  const int needed = p_hash_table->num_entries + num_entries;
+  const int max_entries = p_hash_table->max_entries;
+  const int new_max_entries = AOMMAX(needed, max_entries + (max_entries >> 1));
+  block_hash *p_entries;
+  if (needed <= max_entries) return 1;
+  p_entries = (block_hash *)aom_malloc(sizeof(*p_entries) * new_max_entries);
+  if (p_entries == NULL) return 0;
+  if (p_hash_table->num_entries > 0) {
+    memcpy(p_entries, p_hash_table->p_entries,
+           sizeof(*p_entries) * p_hash_table->num_entries);
   }
+  aom_free(p_hash_table->p_entries);
+  p_hash_table->p_entries = p_entries;
+  p_hash_table->max_entries = new_max_entries;
+  return 1;
 }
 
 int32_t av1_hash_table_count(hash_table *p_hash_table, uint32_t hash_value) {
-  if (p_hash_table->p_lookup_table[hash_value] == NULL) {
+  if (p_hash_table->p_buckets == NULL) {
     return 0;
-  } else {
-    return (int32_t)(p_hash_table->p_lookup_table[hash_value]->size);
   }
+  return (int32_t)p_hash_table->p_buckets[hash_value].count;
 }
 
-Iterator av1_hash_get_first_iterator(hash_table *p_hash_table,
-                                     uint32_t hash_value) {
+const block_hash *av1_hash_get_first_entry(hash_table *p_hash_table,
+                                           uint32_t hash_value) {
   assert(av1_hash_table_count(p_hash_table, hash_value) > 0);
-  return vector_begin(p_hash_table->p_lookup_table[hash_value]);
+  return p_hash_table->p_entries + p_hash_table->p_buckets[hash_value].start;
 }
 
 int32_t av1_has_exact_match(hash_table *p_hash_table, uint32_t hash_value1,
                             uint32_t hash_value2) {
-  if (p_hash_table->p_lookup_table[hash_value1] == NULL) {
+  const int32_t count = av1_hash_table_count(p_hash_table, hash_value1);
+  if (count == 0) {
     return 0;
   }
-  Iterator iterator = vector_begin(p_hash_table->p_lookup_table[hash_value1]);
-  Iterator last = vector_end(p_hash_table->p_lookup_table[hash_value1]);
-  for (; !iterator_equals(&iterator, &last); iterator_increment(&iterator)) {
-    if ((*(block_hash *)iterator_get(&iterator)).hash_value2 == hash_value2) {
+  const block_hash *entry = av1_hash_get_first_entry(p_hash_table, hash_value1);
+  for (int32_t i = 0; i < count; i++) {
+    if (entry[i].hash_value2 == hash_value2) {
       return 1;
     }
   }
@@ -140,17 +152,18 @@ int32_t av1_has_exact_match(hash_table *p_hash_table, uint32_t hash_value1,
 
 void av1_generate_block_2x2_hash_value(const YV12_BUFFER_CONFIG *picture,
                                        uint32_t *pic_block_hash[2],
-                                       int8_t *pic_block_same_info[3]) {
+                                       int8_t *pic_block_same_info[3],
+                                       int row_start, int row_end) {
   const int width = 2;
   const int height = 2;
   const int x_end = picture->y_crop_width - width + 1;
-  const int y_end = picture->y_crop_height - height + 1;
+  const int y_end = AOMMIN(picture->y_crop_height - height + 1, row_end);
 
   const int length = width * 2;
   uint8_t p[4];
 
-  int pos = 0;
-  for (int y_pos = 0; y_pos < y_end; y_pos++) {
+  int pos = row_start * picture->y_crop_width;
+  for (int y_pos = row_start; y_pos < y_end; y_pos++) {
     for (int x_pos = 0; x_pos < x_end; x_pos++) {
       get_pixels_in_1D_char_array_by_block_2x2(
           picture->y_buffer + y_pos * picture->y_stride + x_pos,
@@ -174,10 +187,11 @@ void av1_generate_block_hash_value(const YV12_BUFFER_CONFIG *picture,
                                    uint32_t *src_pic_block_hash[2],
                                    uint32_t *dst_pic_block_hash[2],
                                    int8_t *src_pic_block_same_info[3],
-                                   int8_t *dst_pic_block_same_info[3]) {
+                                   int8_t *dst_pic_block_same_info[3],
+                                   int row_start, int row_end) {
   const int pic_width = picture->y_crop_width;
   const int x_end = picture->y_crop_width - block_size + 1;
-  const int y_end = picture->y_crop_height - block_size + 1;
+  const int y_end = AOMMIN(picture->y_crop_height - block_size + 1, row_end);
 
   const int src_size = block_size >> 1;
   const int quad_size = block_size >> 2;
@@ -185,8 +199,8 @@ void av1_generate_block_hash_value(const YV12_BUFFER_CONFIG *picture,
   uint32_t p[4];
   const int length = sizeof(p);
 
-  int pos = 0;
-  for (int y_pos = 0; y_pos < y_end; y_pos++) {
+  int pos = row_start * pic_width;
+  for (int y_pos = row_start; y_pos < y_end; y_pos++) {
     for (int x_pos = 0; x_pos < x_end; x_pos++) {
       p[0] = src_pic_block_hash[0][pos];
       p[1] = src_pic_block_hash[0][pos + src_size];
@@ -224,8 +238,8 @@ void av1_generate_block_hash_value(const YV12_BUFFER_CONFIG *picture,
 
   if (block_size >= 4) {
     const int size_minus1 = block_size - 1;
-    pos = 0;
-    for (int y_pos = 0; y_pos < y_end; y_pos++) {
+    pos = row_start * pic_width;
+    for (int y_pos = row_start; y_pos < y_end; y_pos++) {
       for (int x_pos = 0; x_pos < x_end; x_pos++) {
         dst_pic_block_same_info[2][pos] =
             (!dst_pic_block_same_info[0][pos] &&
@@ -238,38 +252,74 @@ void av1_generate_block_hash_value(const YV12_BUFFER_CONFIG *picture,
   }
 }
 
-void av1_add_to_hash_map_by_row_with_precal_data(hash_table *p_hash_table,
-                                                 uint32_t *pic_hash[2],
-                                                 int8_t *pic_is_same,
-                                                 int pic_width, int pic_height,
-                                                 int block_size) {
+int av1_add_to_hash_map_by_row_with_precal_data(hash_table *p_hash_table,
+                                                uint32_t *pic_hash[2],
+                                                int8_t *pic_is_same,
+                                                int pic_width, int pic_height,
+                                                int block_size) {
   const int x_end = pic_width - block_size + 1;
   const int y_end = pic_height - block_size + 1;
 
   const int8_t *src_is_added = pic_is_same;
   const uint32_t *src_hash[2] = { pic_hash[0], pic_hash[1] };
 
-  int add_value = hash_block_size_to_index(block_size);
-  assert(add_value >= 0);
-  add_value <<= crc_bits;
+  const int size_index = hash_block_size_to_index(block_size);
+  assert(size_index >= 0);
+  assert(p_hash_table->p_buckets != NULL);
+  assert(!(p_hash_table->block_sizes_added & (1 << size_index)));
+  const int add_value = size_index << crc_bits;
   const int crc_mask = (1 << crc_bits) - 1;
+  // the buckets of this block size, which are empty
+  hash_bucket *const buckets = p_hash_table->p_buckets + add_value;
+  int num_added = 0;
 
+  // count the entries of each bucket, a row at a time
+  for (int y_pos = 0; y_pos < y_end; y_pos++) {
+    for (int x_pos = 0; x_pos < x_end; x_pos++) {
+      const int pos = y_pos * pic_width + x_pos;
+      if (src_is_added[pos]) {
+        buckets[src_hash[0][pos] & crc_mask].count++;
+        num_added++;
+      }
+    }
+  }
+  if (num_added == 0) return 1;
+
+  if (!hash_table_reserve(p_hash_table, num_added)) {
+    // leave the buckets of this block size empty, as clearing the table only
+    // empties those of the block sizes added
+    memset(buckets, 0, sizeof(*buckets) << crc_bits);
+    return 0;
+  }
+
+  // place the buckets one after the other past the entries already added,
+  // using their starts as the positions to add at
+  uint32_t start = p_hash_table->num_entries;
+  for (int i = 0; i <= crc_mask; i++) {
+    buckets[i].start = start;
+    start += buckets[i].count;
+  }
+
+  // add the entries a column at a time, the order they are searched in
   for (int x_pos = 0; x_pos < x_end; x_pos++) {
     for (int y_pos = 0; y_pos < y_end; y_pos++) {
       const int pos = y_pos * pic_width + x_pos;
       // valid data
       if (src_is_added[pos]) {
-        block_hash curr_block_hash;
-        curr_block_hash.x = x_pos;
-        curr_block_hash.y = y_pos;
-
-        const uint32_t hash_value1 = (src_hash[0][pos] & crc_mask) + add_value;
-        curr_block_hash.hash_value2 = src_hash[1][pos];
-
-        hash_table_add_to_table(p_hash_table, hash_value1, &curr_block_hash);
+        hash_bucket *const bucket = &buckets[src_hash[0][pos] & crc_mask];
+        block_hash *const curr_block_hash =
+            &p_hash_table->p_entries[bucket->start++];
+        curr_block_hash->x = x_pos;
+        curr_block_hash->y = y_pos;
+        curr_block_hash->hash_value2 = src_hash[1][pos];
       }
     }
   }
+  for (int i = 0; i <= crc_mask; i++) buckets[i].start -= buckets[i].count;
+
+  p_hash_table->num_entries += num_added;
+  p_hash_table->block_sizes_added |= 1 << size_index;
+  return 1;
 }
 
 int av1_hash_is_horizontal_perfect(const YV12_BUFFER_CONFIG *picture,
@@ -15,7 +15,6 @@
 #include "./aom_config.h"
 #include "aom/aom_integer.h"
 #include "aom_scale/yv12config.h"
-#include "third_party/vector/vector.h"
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -29,30 +28,59 @@ typedef struct _block_hash {
   uint32_t hash_value2;
 } block_hash;
 
-typedef struct _hash_table { Vector **p_lookup_table; } hash_table;
+// the entries of bucket hash_value1 are entries[start, start + count)
+typedef struct _hash_bucket {
+  uint32_t start;
+  uint32_t count;
+} hash_bucket;
+
+// A frame's block hashes, indexed by hash_value1. The entries of all buckets
+// are kept in one array, grouped by bucket, and both arrays are kept from
+// frame to frame of a frame buffer so that they are allocated only once.
+typedef struct _hash_table {
+  hash_bucket *p_buckets;
+  block_hash *p_entries;
+  int num_entries;
+  int max_entries;
+  // the block sizes added since the table was last created, as a mask of
+  // their indices
+  int block_sizes_added;
+} hash_table;
 
 void av1_hash_table_init(hash_table *p_hash_table);
 void av1_hash_table_destroy(hash_table *p_hash_table);
-void av1_hash_table_create(hash_table *p_hash_table);
+// Allocates the table, or empties it if it is allocated already. Returns 0 if
+// the table cannot be allocated.
+int av1_hash_table_create(hash_table *p_hash_table);
 int32_t av1_hash_table_count(hash_table *p_hash_table, uint32_t hash_value);
-Iterator av1_hash_get_first_iterator(hash_table *p_hash_table,
-                                     uint32_t hash_value);
+// returns the first of the av1_hash_table_count() entries with hash_value,
+// which follow it in the order they were added
+const block_hash *av1_hash_get_first_entry(hash_table *p_hash_table,
+                                           uint32_t hash_value);
 int32_t av1_has_exact_match(hash_table *p_hash_table, uint32_t hash_value1,
                             uint32_t hash_value2);
+// The hashes below are made for the blocks whose top rows are from row_start
+// up to but excluding row_end. Each row only reads rows of the previous block
+// size, so that the rows of a block size can be hashed on several threads.
 void av1_generate_block_2x2_hash_value(const YV12_BUFFER_CONFIG *picture,
                                        uint32_t *pic_block_hash[2],
-                                       int8_t *pic_block_same_info[3]);
+                                       int8_t *pic_block_same_info[3],
+                                       int row_start, int row_end);
 void av1_generate_block_hash_value(const YV12_BUFFER_CONFIG *picture,
                                    int block_size,
                                    uint32_t *src_pic_block_hash[2],
                                    uint32_t *dst_pic_block_hash[2],
                                    int8_t *src_pic_block_same_info[3],
-                                   int8_t *dst_pic_block_same_info[3]);
-void av1_add_to_hash_map_by_row_with_precal_data(hash_table *p_hash_table,
-                                                 uint32_t *pic_hash[2],
-                                                 int8_t *pic_is_same,
-                                                 int pic_width, int pic_height,
-                                                 int block_size);
+                                   int8_t *dst_pic_block_same_info[3],
+                                   int row_start, int row_end);
+// Adds the blocks of block_size marked in pic_is_same, once per frame for
+// each block size. Returns 0 if the entries cannot be allocated, in which
+// case none of the blocks are added.
+int av1_add_to_hash_map_by_row_with_precal_data(hash_table *p_hash_table,
+                                                uint32_t *pic_hash[2],
+                                                int8_t *pic_is_same,
+                                                int pic_width, int pic_height,
+                                                int block_size);
 
 // check whether the block starts from (x_start, y_start) with the size of
 // block_size x block_size has the same color in all rows
@@ -201,6 +201,7 @@ static void set_good_speed_features_framesize_independent(AV1_COMP *cpi,
     sf->use_transform_domain_distortion = 1;
     sf->disable_wedge_search_var_thresh = 100;
     sf->fast_wedge_sign_estimate = 1;
+    sf->gm_refine_sample_step = 2;
   }
 
   if (speed >= 3) {
@@ -502,6 +503,7 @@ void av1_set_speed_features_framesize_independent(AV1_COMP *cpi) {
   // Set this at the appropriate speed levels
   sf->use_transform_domain_distortion = 0;
   sf->gm_search_type = GM_FULL_SEARCH;
+  sf->gm_refine_sample_step = 1;
   sf->use_fast_interpolation_filter_search = 0;
 
   set_dev_sf(cpi, sf, oxcf->dev_sf);
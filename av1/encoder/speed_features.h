@@ -516,6 +516,11 @@ typedef struct SPEED_FEATURES {
 
   GM_SEARCH_TYPE gm_search_type;
 
+  // Try each step of the global motion refinement on one in every
+  // gm_refine_sample_step error blocks across and down the frame, and
+  // measure it on the whole frame only if it improves on those.
+  int gm_refine_sample_step;
+
   // Do limited interpolation filter search for dual filters, since best choice
   // usually includes EIGHTTAP_REGULAR.
   int use_fast_interpolation_filter_search;
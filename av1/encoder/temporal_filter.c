@@ -220,11 +220,10 @@ void av1_highbd_temporal_filter_apply_c(
 }
 #endif  // CONFIG_HIGHBITDEPTH
 
-static int temporal_filter_find_matching_mb_c(AV1_COMP *cpi,
+static int temporal_filter_find_matching_mb_c(AV1_COMP *cpi, MACROBLOCK *x,
                                               uint8_t *arf_frame_buf,
                                               uint8_t *frame_ptr_buf,
                                               int stride) {
-  MACROBLOCK *const x = &cpi->td.mb;
   MACROBLOCKD *const xd = &x->e_mbd;
   const MV_SPEED_FEATURES *const mv_sf = &cpi->sf.mv;
   int step_param;
@@ -300,25 +299,26 @@ static int temporal_filter_find_matching_mb_c(AV1_COMP *cpi,
   return bestsme;
 }
 
-static void temporal_filter_iterate_c(AV1_COMP *cpi,
+void av1_temporal_filter_row(AV1_COMP *cpi, ThreadData *td,
+                             const TemporalFilterData *tf_data, int mb_row) {
 #if CONFIG_BGSPRITE
-                                      YV12_BUFFER_CONFIG *target,
+  YV12_BUFFER_CONFIG *const target = tf_data->target;
 #endif  // CONFIG_BGSPRITE
-                                      YV12_BUFFER_CONFIG **frames,
-                                      int frame_count, int alt_ref_index,
-                                      int strength,
-                                      struct scale_factors *scale) {
+  YV12_BUFFER_CONFIG **const frames = tf_data->frames;
+  const int frame_count = tf_data->frame_count;
+  const int alt_ref_index = tf_data->alt_ref_index;
+  const int strength = tf_data->strength;
+  struct scale_factors *const scale = tf_data->scale;
   int byte;
   int frame;
-  int mb_col, mb_row;
+  int mb_col;
   unsigned int filter_weight;
   int mb_cols = (frames[alt_ref_index]->y_crop_width + 15) >> 4;
   int mb_rows = (frames[alt_ref_index]->y_crop_height + 15) >> 4;
-  int mb_y_offset = 0;
-  int mb_uv_offset = 0;
   DECLARE_ALIGNED(16, unsigned int, accumulator[16 * 16 * 3]);
   DECLARE_ALIGNED(16, uint16_t, count[16 * 16 * 3]);
-  MACROBLOCKD *mbd = &cpi->td.mb.e_mbd;
+  MACROBLOCK *const x = &td->mb;
+  MACROBLOCKD *mbd = &x->e_mbd;
   YV12_BUFFER_CONFIG *f = frames[alt_ref_index];
   uint8_t *dst1, *dst2;
 #if CONFIG_HIGHBITDEPTH
@@ -330,6 +330,14 @@ static void temporal_filter_iterate_c(AV1_COMP *cpi,
 #endif
   const int mb_uv_height = 16 >> mbd->plane[1].subsampling_y;
   const int mb_uv_width = 16 >> mbd->plane[1].subsampling_x;
+  int mb_y_offset = mb_row * 16 * f->y_stride;
+  int mb_uv_offset = mb_row * mb_uv_height * f->uv_stride;
+
+  // The motion search writes its result to the mode info. Use a private copy
+  // so that rows can be filtered by different threads.
+  MODE_INFO mi = *mbd->mi[0];
+  MODE_INFO *mi_ptr = &mi;
+  MODE_INFO **const input_mi = mbd->mi;
 
   // Save input state
   uint8_t *input_buffer[MAX_MB_PLANE];
@@ -343,218 +351,229 @@ static void temporal_filter_iterate_c(AV1_COMP *cpi,
 #endif
 
   for (i = 0; i < MAX_MB_PLANE; i++) input_buffer[i] = mbd->plane[i].pre[0].buf;
+  mbd->mi = &mi_ptr;
+
+  // Source frames are extended to 16 pixels. This is different than
+  //  L/A/G reference frames that have a border of 32 (AV1ENCBORDERINPIXELS)
+  // A 6/8 tap filter is used for motion search.  This requires 2 pixels
+  //  before and 3 pixels after.  So the largest Y mv on a border would
+  //  then be 16 - AOM_INTERP_EXTEND. The UV blocks are half the size of the
+  //  Y and therefore only extended by 8.  The largest mv that a UV block
+  //  can support is 8 - AOM_INTERP_EXTEND.  A UV mv is half of a Y mv.
+  //  (16 - AOM_INTERP_EXTEND) >> 1 which is greater than
+  //  8 - AOM_INTERP_EXTEND.
+  // To keep the mv in play for both Y and UV planes the max that it
+  //  can be on a border is therefore 16 - (2*AOM_INTERP_EXTEND+1).
+  x->mv_limits.row_min = -((mb_row * 16) + (17 - 2 * AOM_INTERP_EXTEND));
+  x->mv_limits.row_max =
+      ((mb_rows - 1 - mb_row) * 16) + (17 - 2 * AOM_INTERP_EXTEND);
+
+  for (mb_col = 0; mb_col < mb_cols; mb_col++) {
+    int j, k;
+    int stride;
+
+    memset(accumulator, 0, 16 * 16 * 3 * sizeof(accumulator[0]));
+    memset(count, 0, 16 * 16 * 3 * sizeof(count[0]));
+
+    x->mv_limits.col_min = -((mb_col * 16) + (17 - 2 * AOM_INTERP_EXTEND));
+    x->mv_limits.col_max =
+        ((mb_cols - 1 - mb_col) * 16) + (17 - 2 * AOM_INTERP_EXTEND);
+
+    for (frame = 0; frame < frame_count; frame++) {
+      const int thresh_low = 10000;
+      const int thresh_high = 20000;
+
+      if (frames[frame] == NULL) continue;
+
+      mbd->mi[0]->mbmi.mv[0].as_mv.row = 0;
+      mbd->mi[0]->mbmi.mv[0].as_mv.col = 0;
+
+      if (frame == alt_ref_index) {
+        filter_weight = 2;
+      } else {
+        // Find best match in this frame by MC
+        int err = temporal_filter_find_matching_mb_c(
+            cpi, x, frames[alt_ref_index]->y_buffer + mb_y_offset,
+            frames[frame]->y_buffer + mb_y_offset, frames[frame]->y_stride);
+
+        // Assign higher weight to matching MB if it's error
+        // score is lower. If not applying MC default behavior
+        // is to weight all MBs equal.
+        filter_weight = err < thresh_low ? 2 : err < thresh_high ? 1 : 0;
+      }
 
-  for (mb_row = 0; mb_row < mb_rows; mb_row++) {
-    // Source frames are extended to 16 pixels. This is different than
-    //  L/A/G reference frames that have a border of 32 (AV1ENCBORDERINPIXELS)
-    // A 6/8 tap filter is used for motion search.  This requires 2 pixels
-    //  before and 3 pixels after.  So the largest Y mv on a border would
-    //  then be 16 - AOM_INTERP_EXTEND. The UV blocks are half the size of the
-    //  Y and therefore only extended by 8.  The largest mv that a UV block
-    //  can support is 8 - AOM_INTERP_EXTEND.  A UV mv is half of a Y mv.
-    //  (16 - AOM_INTERP_EXTEND) >> 1 which is greater than
-    //  8 - AOM_INTERP_EXTEND.
-    // To keep the mv in play for both Y and UV planes the max that it
-    //  can be on a border is therefore 16 - (2*AOM_INTERP_EXTEND+1).
-    cpi->td.mb.mv_limits.row_min =
-        -((mb_row * 16) + (17 - 2 * AOM_INTERP_EXTEND));
-    cpi->td.mb.mv_limits.row_max =
-        ((mb_rows - 1 - mb_row) * 16) + (17 - 2 * AOM_INTERP_EXTEND);
-
-    for (mb_col = 0; mb_col < mb_cols; mb_col++) {
-      int j, k;
-      int stride;
-
-      memset(accumulator, 0, 16 * 16 * 3 * sizeof(accumulator[0]));
-      memset(count, 0, 16 * 16 * 3 * sizeof(count[0]));
-
-      cpi->td.mb.mv_limits.col_min =
-          -((mb_col * 16) + (17 - 2 * AOM_INTERP_EXTEND));
-      cpi->td.mb.mv_limits.col_max =
-          ((mb_cols - 1 - mb_col) * 16) + (17 - 2 * AOM_INTERP_EXTEND);
-
-      for (frame = 0; frame < frame_count; frame++) {
-        const int thresh_low = 10000;
-        const int thresh_high = 20000;
-
-        if (frames[frame] == NULL) continue;
-
-        mbd->mi[0]->mbmi.mv[0].as_mv.row = 0;
-        mbd->mi[0]->mbmi.mv[0].as_mv.col = 0;
-
-        if (frame == alt_ref_index) {
-          filter_weight = 2;
-        } else {
-          // Find best match in this frame by MC
-          int err = temporal_filter_find_matching_mb_c(
-              cpi, frames[alt_ref_index]->y_buffer + mb_y_offset,
-              frames[frame]->y_buffer + mb_y_offset, frames[frame]->y_stride);
-
-          // Assign higher weight to matching MB if it's error
-          // score is lower. If not applying MC default behavior
-          // is to weight all MBs equal.
-          filter_weight = err < thresh_low ? 2 : err < thresh_high ? 1 : 0;
-        }
-
-        if (filter_weight != 0) {
-          // Construct the predictors
-          temporal_filter_predictors_mb_c(
-              mbd, frames[frame]->y_buffer + mb_y_offset,
-              frames[frame]->u_buffer + mb_uv_offset,
-              frames[frame]->v_buffer + mb_uv_offset, frames[frame]->y_stride,
-              mb_uv_width, mb_uv_height, mbd->mi[0]->mbmi.mv[0].as_mv.row,
-              mbd->mi[0]->mbmi.mv[0].as_mv.col, predictor, scale, mb_col * 16,
-              mb_row * 16);
+      if (filter_weight != 0) {
+        // Construct the predictors
+        temporal_filter_predictors_mb_c(
+            mbd, frames[frame]->y_buffer + mb_y_offset,
+            frames[frame]->u_buffer + mb_uv_offset,
+            frames[frame]->v_buffer + mb_uv_offset, frames[frame]->y_stride,
+            mb_uv_width, mb_uv_height, mbd->mi[0]->mbmi.mv[0].as_mv.row,
+            mbd->mi[0]->mbmi.mv[0].as_mv.col, predictor, scale, mb_col * 16,
+            mb_row * 16);
 
 // Apply the filter (YUV)
 #if CONFIG_HIGHBITDEPTH
-          if (mbd->cur_buf->flags & YV12_FLAG_HIGHBITDEPTH) {
-            int adj_strength = strength + 2 * (mbd->bd - 8);
-            av1_highbd_temporal_filter_apply(
-                f->y_buffer + mb_y_offset, f->y_stride, predictor, 16, 16,
-                adj_strength, filter_weight, accumulator, count);
-            av1_highbd_temporal_filter_apply(
-                f->u_buffer + mb_uv_offset, f->uv_stride, predictor + 256,
-                mb_uv_width, mb_uv_height, adj_strength, filter_weight,
-                accumulator + 256, count + 256);
-            av1_highbd_temporal_filter_apply(
-                f->v_buffer + mb_uv_offset, f->uv_stride, predictor + 512,
-                mb_uv_width, mb_uv_height, adj_strength, filter_weight,
-                accumulator + 512, count + 512);
-          } else {
+        if (mbd->cur_buf->flags & YV12_FLAG_HIGHBITDEPTH) {
+          int adj_strength = strength + 2 * (mbd->bd - 8);
+          av1_highbd_temporal_filter_apply(
+              f->y_buffer + mb_y_offset, f->y_stride, predictor, 16, 16,
+              adj_strength, filter_weight, accumulator, count);
+          av1_highbd_temporal_filter_apply(
+              f->u_buffer + mb_uv_offset, f->uv_stride, predictor + 256,
+              mb_uv_width, mb_uv_height, adj_strength, filter_weight,
+              accumulator + 256, count + 256);
+          av1_highbd_temporal_filter_apply(
+              f->v_buffer + mb_uv_offset, f->uv_stride, predictor + 512,
+              mb_uv_width, mb_uv_height, adj_strength, filter_weight,
+              accumulator + 512, count + 512);
+        } else {
 #endif  // CONFIG_HIGHBITDEPTH
-            av1_temporal_filter_apply_c(f->y_buffer + mb_y_offset, f->y_stride,
-                                        predictor, 16, 16, strength,
-                                        filter_weight, accumulator, count);
-            av1_temporal_filter_apply_c(
-                f->u_buffer + mb_uv_offset, f->uv_stride, predictor + 256,
-                mb_uv_width, mb_uv_height, strength, filter_weight,
-                accumulator + 256, count + 256);
-            av1_temporal_filter_apply_c(
-                f->v_buffer + mb_uv_offset, f->uv_stride, predictor + 512,
-                mb_uv_width, mb_uv_height, strength, filter_weight,
-                accumulator + 512, count + 512);
+          av1_temporal_filter_apply_c(f->y_buffer + mb_y_offset, f->y_stride,
+                                      predictor, 16, 16, strength,
+                                      filter_weight, accumulator, count);
+          av1_temporal_filter_apply_c(
+              f->u_buffer + mb_uv_offset, f->uv_stride, predictor + 256,
+              mb_uv_width, mb_uv_height, strength, filter_weight,
+              accumulator + 256, count + 256);
+          av1_temporal_filter_apply_c(
+              f->v_buffer + mb_uv_offset, f->uv_stride, predictor + 512,
+              mb_uv_width, mb_uv_height, strength, filter_weight,
+              accumulator + 512, count + 512);
 #if CONFIG_HIGHBITDEPTH
-          }
-#endif  // CONFIG_HIGHBITDEPTH
         }
+#endif  // CONFIG_HIGHBITDEPTH
       }
+    }
 
 // Normalize filter output to produce AltRef frame
 #if CONFIG_HIGHBITDEPTH
-      if (mbd->cur_buf->flags & YV12_FLAG_HIGHBITDEPTH) {
-        uint16_t *dst1_16;
-        uint16_t *dst2_16;
+    if (mbd->cur_buf->flags & YV12_FLAG_HIGHBITDEPTH) {
+      uint16_t *dst1_16;
+      uint16_t *dst2_16;
 #if CONFIG_BGSPRITE
-        dst1 = target->y_buffer;
+      dst1 = target->y_buffer;
 #else
-        dst1 = cpi->alt_ref_buffer.y_buffer;
+      dst1 = cpi->alt_ref_buffer.y_buffer;
 #endif  // CONFIG_BGSPRITE
-        dst1_16 = CONVERT_TO_SHORTPTR(dst1);
+      dst1_16 = CONVERT_TO_SHORTPTR(dst1);
 #if CONFIG_BGSPRITE
-        stride = target->y_stride;
+      stride = target->y_stride;
 #else
-        stride = cpi->alt_ref_buffer.y_stride;
+      stride = cpi->alt_ref_buffer.y_stride;
 #endif  // CONFIG_BGSPRITE
-        byte = mb_y_offset;
-        for (i = 0, k = 0; i < 16; i++) {
-          for (j = 0; j < 16; j++, k++) {
-            dst1_16[byte] =
-                (uint16_t)OD_DIVU(accumulator[k] + (count[k] >> 1), count[k]);
-
-            // move to next pixel
-            byte++;
-          }
-
-          byte += stride - 16;
+      byte = mb_y_offset;
+      for (i = 0, k = 0; i < 16; i++) {
+        for (j = 0; j < 16; j++, k++) {
+          dst1_16[byte] =
+              (uint16_t)OD_DIVU(accumulator[k] + (count[k] >> 1), count[k]);
+
+          // move to next pixel
+          byte++;
         }
 
-        dst1 = cpi->alt_ref_buffer.u_buffer;
-        dst2 = cpi->alt_ref_buffer.v_buffer;
-        dst1_16 = CONVERT_TO_SHORTPTR(dst1);
-        dst2_16 = CONVERT_TO_SHORTPTR(dst2);
-        stride = cpi->alt_ref_buffer.uv_stride;
-        byte = mb_uv_offset;
-        for (i = 0, k = 256; i < mb_uv_height; i++) {
-          for (j = 0; j < mb_uv_width; j++, k++) {
-            int m = k + 256;
-
-            // U
-            dst1_16[byte] =
-                (uint16_t)OD_DIVU(accumulator[k] + (count[k] >> 1), count[k]);
-
-            // V
-            dst2_16[byte] =
-                (uint16_t)OD_DIVU(accumulator[m] + (count[m] >> 1), count[m]);
-
-            // move to next pixel
-            byte++;
-          }
+        byte += stride - 16;
+      }
+
+      dst1 = cpi->alt_ref_buffer.u_buffer;
+      dst2 = cpi->alt_ref_buffer.v_buffer;
+      dst1_16 = CONVERT_TO_SHORTPTR(dst1);
+      dst2_16 = CONVERT_TO_SHORTPTR(dst2);
+      stride = cpi->alt_ref_buffer.uv_stride;
+      byte = mb_uv_offset;
+      for (i = 0, k = 256; i < mb_uv_height; i++) {
+        for (j = 0; j < mb_uv_width; j++, k++) {
+          int m = k + 256;
+
+          // U
+          dst1_16[byte] =
+              (uint16_t)OD_DIVU(accumulator[k] + (count[k] >> 1), count[k]);
 
-          byte += stride - mb_uv_width;
+          // V
+          dst2_16[byte] =
+              (uint16_t)OD_DIVU(accumulator[m] + (count[m] >> 1), count[m]);
+
+          // move to next pixel
+          byte++;
         }
-      } else {
+
+        byte += stride - mb_uv_width;
+      }
+    } else {
 #endif  // CONFIG_HIGHBITDEPTH
 #if CONFIG_BGSPRITE
-        dst1 = target->y_buffer;
-        stride = target->y_stride;
+      dst1 = target->y_buffer;
+      stride = target->y_stride;
 #else
-      dst1 = cpi->alt_ref_buffer.y_buffer;
-      stride = cpi->alt_ref_buffer.y_stride;
+    dst1 = cpi->alt_ref_buffer.y_buffer;
+    stride = cpi->alt_ref_buffer.y_stride;
 #endif  // CONFIG_BGSPRITE
-        byte = mb_y_offset;
-        for (i = 0, k = 0; i < 16; i++) {
-          for (j = 0; j < 16; j++, k++) {
-            dst1[byte] =
-                (uint8_t)OD_DIVU(accumulator[k] + (count[k] >> 1), count[k]);
-
-            // move to next pixel
-            byte++;
-          }
-          byte += stride - 16;
+      byte = mb_y_offset;
+      for (i = 0, k = 0; i < 16; i++) {
+        for (j = 0; j < 16; j++, k++) {
+          dst1[byte] =
+              (uint8_t)OD_DIVU(accumulator[k] + (count[k] >> 1), count[k]);
+
+          // move to next pixel
+          byte++;
         }
+        byte += stride - 16;
+      }
 #if CONFIG_BGSPRITE
-        dst1 = target->u_buffer;
-        dst2 = target->v_buffer;
-        stride = target->uv_stride;
+      dst1 = target->u_buffer;
+      dst2 = target->v_buffer;
+      stride = target->uv_stride;
 #else
-      dst1 = cpi->alt_ref_buffer.u_buffer;
-      dst2 = cpi->alt_ref_buffer.v_buffer;
-      stride = cpi->alt_ref_buffer.uv_stride;
+    dst1 = cpi->alt_ref_buffer.u_buffer;
+    dst2 = cpi->alt_ref_buffer.v_buffer;
+    stride = cpi->alt_ref_buffer.uv_stride;
 #endif  // CONFIG_BGSPRITE
-        byte = mb_uv_offset;
-        for (i = 0, k = 256; i < mb_uv_height; i++) {
-          for (j = 0; j < mb_uv_width; j++, k++) {
-            int m = k + 256;
+      byte = mb_uv_offset;
+      for (i = 0, k = 256; i < mb_uv_height; i++) {
+        for (j = 0; j < mb_uv_width; j++, k++) {
+          int m = k + 256;
 
-            // U
-            dst1[byte] =
-                (uint8_t)OD_DIVU(accumulator[k] + (count[k] >> 1), count[k]);
+          // U
+          dst1[byte] =
+              (uint8_t)OD_DIVU(accumulator[k] + (count[k] >> 1), count[k]);
 
-            // V
-            dst2[byte] =
-                (uint8_t)OD_DIVU(accumulator[m] + (count[m] >> 1), count[m]);
+          // V
+          dst2[byte] =
+              (uint8_t)OD_DIVU(accumulator[m] + (count[m] >> 1), count[m]);
 
-            // move to next pixel
-            byte++;
-          }
-          byte += stride - mb_uv_width;
+          // move to next pixel
+          byte++;
         }
-#if CONFIG_HIGHBITDEPTH
+        byte += stride - mb_uv_width;
       }
-#endif  // CONFIG_HIGHBITDEPTH
-      mb_y_offset += 16;
-      mb_uv_offset += mb_uv_width;
+#if CONFIG_HIGHBITDEPTH
     }
-    mb_y_offset += 16 * (f->y_stride - mb_cols);
-    mb_uv_offset += mb_uv_height * f->uv_stride - mb_uv_width * mb_cols;
+#endif  // CONFIG_HIGHBITDEPTH
+    mb_y_offset += 16;
+    mb_uv_offset += mb_uv_width;
   }
 
   // Restore input state
   for (i = 0; i < MAX_MB_PLANE; i++) mbd->plane[i].pre[0].buf = input_buffer[i];
+  mbd->mi = input_mi;
+}
+
+static void temporal_filter_iterate_c(AV1_COMP *cpi,
+                                      const TemporalFilterData *tf_data) {
+  const YV12_BUFFER_CONFIG *const f = tf_data->frames[tf_data->alt_ref_index];
+  const int mb_rows = (f->y_crop_height + 15) >> 4;
+  int mb_row;
+
+  // Every macroblock is filtered independently, so the rows can be shared
+  // out between the encoder workers.
+  if (cpi->oxcf.max_threads > 1 && mb_rows > 1) {
+    av1_temporal_filter_rows_mt(cpi, tf_data);
+  } else {
+    for (mb_row = 0; mb_row < mb_rows; mb_row++)
+      av1_temporal_filter_row(cpi, &cpi->td, tf_data, mb_row);
+  }
 }
 
-// Apply buffer limits and context specific adjustments to arnr filter.
 static void adjust_arnr_filter(AV1_COMP *cpi, int distance, int group_boost,
                                int *arnr_frames, int *arnr_strength) {
   const AV1EncoderConfig *const oxcf = &cpi->oxcf;
@@ -700,10 +719,16 @@ void av1_temporal_filter(AV1_COMP *cpi,
 #endif  // CONFIG_HIGHBITDEPTH
   }
 
-  temporal_filter_iterate_c(cpi,
+  {
+    TemporalFilterData tf_data;
 #if CONFIG_BGSPRITE
-                            target,
+    tf_data.target = target;
 #endif  // CONFIG_BGSPRITE
-                            frames, frames_to_blur, frames_to_blur_backward,
-                            strength, &sf);
+    tf_data.frames = frames;
+    tf_data.frame_count = frames_to_blur;
+    tf_data.alt_ref_index = frames_to_blur_backward;
+    tf_data.strength = strength;
+    tf_data.scale = &sf;
+    temporal_filter_iterate_c(cpi, &tf_data);
+  }
 }
@@ -16,6 +16,22 @@
 extern "C" {
 #endif
 
+// Parameters of one temporal filter run, shared by the threads that filter
+// its macroblock rows.
+typedef struct TemporalFilterData {
+#if CONFIG_BGSPRITE
+  YV12_BUFFER_CONFIG *target;
+#endif  // CONFIG_BGSPRITE
+  YV12_BUFFER_CONFIG **frames;
+  int frame_count;
+  int alt_ref_index;
+  int strength;
+  struct scale_factors *scale;
+} TemporalFilterData;
+
+void av1_temporal_filter_row(AV1_COMP *cpi, ThreadData *td,
+                             const TemporalFilterData *tf_data, int mb_row);
+
 void av1_temporal_filter(AV1_COMP *cpi,
 #if CONFIG_BGSPRITE
                          YV12_BUFFER_CONFIG *bg, YV12_BUFFER_CONFIG *target,
@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2017, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <math.h>
+
+#include <immintrin.h>
+
+#include "./av1_rtcd.h"
+#include "aom_ports/mem.h"
+#include "av1/encoder/corner_match.h"
+
+DECLARE_ALIGNED(32, static const uint8_t, byte_mask[32]) = {
+  255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 0, 0, 0,
+  255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 0, 0, 0
+};
+#if MATCH_SZ != 13
+#error "Need to change byte_mask in corner_match_avx2.c if MATCH_SZ != 13"
+#endif
+
+// Loads a row of each of two windows into the two lanes.
+static INLINE __m256i load_rows(const unsigned char *row0,
+                                const unsigned char *row1) {
+  return _mm256_inserti128_si256(
+      _mm256_castsi128_si256(_mm_loadu_si128((const __m128i *)row0)),
+      _mm_loadu_si128((const __m128i *)row1), 1);
+}
+
+/* Compute corr(im1, im2) * MATCH_SZ * stddev(im1), where the
+   correlation/standard deviation are taken over MATCH_SZ by MATCH_SZ windows
+   of each image, centered at (x1, y1) and (x2, y2) respectively.
+   The same sums as compute_cross_correlation_sse4_1(), over two rows at a
+   time; the last row goes in the low lane with zeros in the high one.
+*/
+double compute_cross_correlation_avx2(unsigned char *im1, int stride1, int x1,
+                                      int y1, unsigned char *im2, int stride2,
+                                      int x2, int y2) {
+  const __m256i mask = _mm256_load_si256((const __m256i *)byte_mask);
+  const __m256i zero = _mm256_setzero_si256();
+  // 64-bit partial sums
+  __m256i sum1_vec = zero;
+  __m256i sum2_vec = zero;
+  // 32-bit partial sums
+  __m256i sumsq2_vec = zero;
+  __m256i cross_vec = zero;
+  __m256i sums_vec;
+  __m128i sums, prods;
+  int i, sum1, sum2, sumsq2, cross, var2, cov;
+
+  im1 += (y1 - MATCH_SZ_BY2) * stride1 + (x1 - MATCH_SZ_BY2);
+  im2 += (y2 - MATCH_SZ_BY2) * stride2 + (x2 - MATCH_SZ_BY2);
+
+  for (i = 0; i < MATCH_SZ; i += 2) {
+    __m256i v1, v2, v1_l, v1_r, v2_l, v2_r;
+    if (i + 1 < MATCH_SZ) {
+      v1 = load_rows(im1 + i * stride1, im1 + (i + 1) * stride1);
+      v2 = load_rows(im2 + i * stride2, im2 + (i + 1) * stride2);
+    } else {
+      v1 = _mm256_inserti128_si256(
+          zero, _mm_loadu_si128((const __m128i *)(im1 + i * stride1)), 0);
+      v2 = _mm256_inserti128_si256(
+          zero, _mm_loadu_si128((const __m128i *)(im2 + i * stride2)), 0);
+    }
+    v1 = _mm256_and_si256(v1, mask);
+    v2 = _mm256_and_si256(v2, mask);
+
+    sum1_vec = _mm256_add_epi64(sum1_vec, _mm256_sad_epu8(v1, zero));
+    sum2_vec = _mm256_add_epi64(sum2_vec, _mm256_sad_epu8(v2, zero));
+
+    v1_l = _mm256_unpacklo_epi8(v1, zero);
+    v1_r = _mm256_unpackhi_epi8(v1, zero);
+    v2_l = _mm256_unpacklo_epi8(v2, zero);
+    v2_r = _mm256_unpackhi_epi8(v2, zero);
+
+    sumsq2_vec = _mm256_add_epi32(
+        sumsq2_vec, _mm256_add_epi32(_mm256_madd_epi16(v2_l, v2_l),
+                                     _mm256_madd_epi16(v2_r, v2_r)));
+    cross_vec = _mm256_add_epi32(
+        cross_vec, _mm256_add_epi32(_mm256_madd_epi16(v1_l, v2_l),
+                                    _mm256_madd_epi16(v1_r, v2_r)));
+  }
+
+  // Sum horizontally: sum1 and sum2 end up in the low 32 bits of the two
+  // 64-bit halves of sums, and sumsq2 and cross in the two low words of prods.
+  sums_vec = _mm256_add_epi64(_mm256_unpacklo_epi64(sum1_vec, sum2_vec),
+                              _mm256_unpackhi_epi64(sum1_vec, sum2_vec));
+  sums = _mm_add_epi64(_mm256_castsi256_si128(sums_vec),
+                       _mm256_extracti128_si256(sums_vec, 1));
+  prods = _mm_hadd_epi32(
+      _mm_add_epi32(_mm256_castsi256_si128(sumsq2_vec),
+                    _mm256_extracti128_si256(sumsq2_vec, 1)),
+      _mm_add_epi32(_mm256_castsi256_si128(cross_vec),
+                    _mm256_extracti128_si256(cross_vec, 1)));
+  prods = _mm_hadd_epi32(prods, prods);
+
+  sum1 = _mm_cvtsi128_si32(sums);
+  sum2 = _mm_extract_epi32(sums, 2);
+  sumsq2 = _mm_cvtsi128_si32(prods);
+  cross = _mm_extract_epi32(prods, 1);
+
+  var2 = sumsq2 * MATCH_SZ_SQ - sum2 * sum2;
+  cov = cross * MATCH_SZ_SQ - sum1 * sum2;
+  return cov / sqrt((double)var2);
+}
@@ -72,7 +72,10 @@ aomdec.SRCS                 += aom_ports/msvc.h
 aomdec.SRCS                 += aom_ports/aom_timer.h
 aomdec.SRCS                 += aom/aom_integer.h
 aomdec.SRCS                 += args.c args.h
+aomdec.SRCS                 += image_queue.c image_queue.h
 aomdec.SRCS                 += ivfdec.c ivfdec.h
+aomdec.SRCS                 += mapped_file.c mapped_file.h
+aomdec.SRCS                 += rawdec.c rawdec.h
 aomdec.SRCS                 += tools_common.c tools_common.h
 aomdec.SRCS                 += y4menc.c y4menc.h
 ifeq ($(CONFIG_LIBYUV),yes)
@@ -91,7 +94,16 @@ aomdec.GUID                  = BA5FE66F-38DD-E034-F542-B1578C5FB950
 aomdec.DESCRIPTION           = Full featured decoder
 UTILS-$(CONFIG_AV1_ENCODER) += aomenc.c
 aomenc.SRCS                 += args.c args.h y4minput.c y4minput.h aomenc.h
+aomenc.SRCS                 += y4minput_dsp.h
+ifeq ($(HAVE_SSE2),yes)
+  aomenc.SRCS                 += y4minput_sse2.c
+endif
+ifeq ($(HAVE_AVX2),yes)
+  aomenc.SRCS                 += y4minput_avx2.c
+endif
+aomenc.SRCS                 += image_queue.c image_queue.h
 aomenc.SRCS                 += ivfdec.c ivfdec.h
+aomenc.SRCS                 += mapped_file.c mapped_file.h
 aomenc.SRCS                 += ivfenc.c ivfenc.h
 aomenc.SRCS                 += rate_hist.c rate_hist.h
 aomenc.SRCS                 += tools_common.c tools_common.h
@@ -129,6 +141,7 @@ ifeq ($(CONFIG_INSPECTION),yes)
 EXAMPLES-$(CONFIG_AV1_DECODER) += inspect.c
 inspect.GUID                   = FA46A420-3356-441F-B0FD-60AA1345C181
 inspect.SRCS                   += ivfdec.h ivfdec.c
+inspect.SRCS                   += mapped_file.c mapped_file.h
 inspect.SRCS                   += args.c args.h
 inspect.SRCS                   += tools_common.h tools_common.c
 inspect.SRCS                   += video_common.h
@@ -142,6 +155,7 @@ endif
 EXAMPLES-$(CONFIG_AV1_DECODER)     += simple_decoder.c
 simple_decoder.GUID                 = D3BBF1E9-2427-450D-BBFF-B2843C1D44CC
 simple_decoder.SRCS                += ivfdec.h ivfdec.c
+simple_decoder.SRCS                += mapped_file.c mapped_file.h
 simple_decoder.SRCS                += tools_common.h tools_common.c
 simple_decoder.SRCS                += video_common.h
 simple_decoder.SRCS                += video_reader.h video_reader.c
@@ -152,6 +166,7 @@ simple_decoder.DESCRIPTION          = Simplified decoder loop
 EXAMPLES-$(CONFIG_AV1_DECODER)     += decode_to_md5.c
 decode_to_md5.SRCS                 += md5_utils.h md5_utils.c
 decode_to_md5.SRCS                 += ivfdec.h ivfdec.c
+decode_to_md5.SRCS                 += mapped_file.c mapped_file.h
 decode_to_md5.SRCS                 += tools_common.h tools_common.c
 decode_to_md5.SRCS                 += video_common.h
 decode_to_md5.SRCS                 += video_reader.h video_reader.c
@@ -186,6 +201,7 @@ twopass_encoder.GUID             = 73494FA6-4AF9-4763-8FBB-265C92402FD8
 twopass_encoder.DESCRIPTION      = Two-pass encoder loop
 EXAMPLES-$(CONFIG_AV1_DECODER)  += decode_with_drops.c
 decode_with_drops.SRCS          += ivfdec.h ivfdec.c
+decode_with_drops.SRCS          += mapped_file.c mapped_file.h
 decode_with_drops.SRCS          += tools_common.h tools_common.c
 decode_with_drops.SRCS          += video_common.h
 decode_with_drops.SRCS          += video_reader.h video_reader.c
@@ -213,6 +229,7 @@ lightfield_encoder.GUID             = 73494FA6-4AF9-4763-8FBB-265C92402FD8
 lightfield_encoder.DESCRIPTION      = Lightfield encoder loop
 EXAMPLES-$(CONFIG_AV1_DECODER)     += lightfield_decoder.c
 lightfield_decoder.SRCS            += ivfdec.h ivfdec.c
+lightfield_decoder.SRCS            += mapped_file.c mapped_file.h
 lightfield_decoder.SRCS            += tools_common.h tools_common.c
 lightfield_decoder.SRCS            += video_common.h
 lightfield_decoder.SRCS            += video_reader.h video_reader.c
@@ -0,0 +1,231 @@
+/*
+ * Copyright (c) 2017, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "./image_queue.h"
+#include "aom_util/aom_thread.h"
+
+#if CONFIG_MULTITHREAD
+
+struct AvxImageQueue {
+  pthread_mutex_t mutex;
+  // Each side waits on its own condition, so there is never more than one
+  // waiter to signal.
+  pthread_cond_t not_empty;
+  pthread_cond_t not_full;
+  aom_image_t *images;
+  int depth;
+  int head;   // The next image to pop.
+  int count;  // The number of images queued.
+  int finished;
+  int stopped;
+
+  pthread_t thread;
+  int has_thread;
+  AvxImageQueueThreadFn thread_fn;
+  void *thread_arg;
+
+  // Statistics.
+  int pushed;
+  int64_t depth_sum;  // The sum of the depths after each push.
+  int max_depth;
+  int producer_waits;  // Times the queue was full.
+  int consumer_waits;  // Times the queue was empty.
+};
+
+AvxImageQueue *image_queue_create(int depth) {
+  AvxImageQueue *const queue = (AvxImageQueue *)calloc(1, sizeof(*queue));
+  if (queue == NULL) return NULL;
+  queue->images = (aom_image_t *)calloc(depth, sizeof(*queue->images));
+  if (queue->images == NULL) {
+    free(queue);
+    return NULL;
+  }
+  queue->depth = depth;
+  pthread_mutex_init(&queue->mutex, NULL);
+  pthread_cond_init(&queue->not_empty, NULL);
+  pthread_cond_init(&queue->not_full, NULL);
+  return queue;
+}
+
+void image_queue_destroy(AvxImageQueue *queue) {
+  int i;
+  if (queue == NULL) return;
+  if (queue->has_thread) pthread_join(queue->thread, NULL);
+  for (i = 0; i < queue->depth; ++i) aom_img_free(&queue->images[i]);
+  free(queue->images);
+  pthread_mutex_destroy(&queue->mutex);
+  pthread_cond_destroy(&queue->not_empty);
+  pthread_cond_destroy(&queue->not_full);
+  free(queue);
+}
+
+static THREADFN thread_main(void *arg) {
+  AvxImageQueue *const queue = (AvxImageQueue *)arg;
+  queue->thread_fn(queue, queue->thread_arg);
+  return THREAD_RETURN(NULL);
+}
+
+int image_queue_start_thread(AvxImageQueue *queue, AvxImageQueueThreadFn fn,
+                             void *arg) {
+  queue->thread_fn = fn;
+  queue->thread_arg = arg;
+  queue->has_thread = !pthread_create(&queue->thread, NULL, thread_main, queue);
+  return queue->has_thread;
+}
+
+aom_image_t *image_queue_get_free(AvxImageQueue *queue) {
+  aom_image_t *img = NULL;
+
+  pthread_mutex_lock(&queue->mutex);
+  if (queue->count == queue->depth && !queue->stopped) {
+    ++queue->producer_waits;
+    while (queue->count == queue->depth && !queue->stopped)
+      pthread_cond_wait(&queue->not_full, &queue->mutex);
+  }
+  if (!queue->stopped)
+    img = &queue->images[(queue->head + queue->count) % queue->depth];
+  pthread_mutex_unlock(&queue->mutex);
+  return img;
+}
+
+void image_queue_push(AvxImageQueue *queue) {
+  pthread_mutex_lock(&queue->mutex);
+  ++queue->count;
+  ++queue->pushed;
+  queue->depth_sum += queue->count;
+  if (queue->count > queue->max_depth) queue->max_depth = queue->count;
+  pthread_cond_signal(&queue->not_empty);
+  pthread_mutex_unlock(&queue->mutex);
+}
+
+void image_queue_finish(AvxImageQueue *queue) {
+  pthread_mutex_lock(&queue->mutex);
+  queue->finished = 1;
+  pthread_cond_signal(&queue->not_empty);
+  pthread_mutex_unlock(&queue->mutex);
+}
+
+aom_image_t *image_queue_front(AvxImageQueue *queue) {
+  aom_image_t *img = NULL;
+
+  pthread_mutex_lock(&queue->mutex);
+  if (queue->count == 0 && !queue->finished) {
+    ++queue->consumer_waits;
+    while (queue->count == 0 && !queue->finished)
+      pthread_cond_wait(&queue->not_empty, &queue->mutex);
+  }
+  if (queue->count > 0) img = &queue->images[queue->head];
+  pthread_mutex_unlock(&queue->mutex);
+  return img;
+}
+
+void image_queue_pop(AvxImageQueue *queue) {
+  pthread_mutex_lock(&queue->mutex);
+  queue->head = (queue->head + 1) % queue->depth;
+  --queue->count;
+  pthread_cond_signal(&queue->not_full);
+  pthread_mutex_unlock(&queue->mutex);
+}
+
+void image_queue_stop(AvxImageQueue *queue) {
+  pthread_mutex_lock(&queue->mutex);
+  queue->stopped = 1;
+  pthread_cond_signal(&queue->not_full);
+  pthread_mutex_unlock(&queue->mutex);
+}
+
+void image_queue_print_stats(AvxImageQueue *queue, const char *name,
+                             FILE *file) {
+  pthread_mutex_lock(&queue->mutex);
+  fprintf(file,
+          "%s: %d frames through a queue of %d, depth %.2f average %d max, "
+          "%d waits for a free slot, %d waits for a frame\n",
+          name, queue->pushed, queue->depth,
+          queue->pushed ? (double)queue->depth_sum / queue->pushed : 0.0,
+          queue->max_depth, queue->producer_waits, queue->consumer_waits);
+  pthread_mutex_unlock(&queue->mutex);
+}
+
+#else
+
+AvxImageQueue *image_queue_create(int depth) {
+  (void)depth;
+  return NULL;
+}
+
+void image_queue_destroy(AvxImageQueue *queue) { (void)queue; }
+
+int image_queue_start_thread(AvxImageQueue *queue, AvxImageQueueThreadFn fn,
+                             void *arg) {
+  (void)queue;
+  (void)fn;
+  (void)arg;
+  return 0;
+}
+
+aom_image_t *image_queue_get_free(AvxImageQueue *queue) {
+  (void)queue;
+  return NULL;
+}
+
+void image_queue_push(AvxImageQueue *queue) { (void)queue; }
+
+void image_queue_finish(AvxImageQueue *queue) { (void)queue; }
+
+aom_image_t *image_queue_front(AvxImageQueue *queue) {
+  (void)queue;
+  return NULL;
+}
+
+void image_queue_pop(AvxImageQueue *queue) { (void)queue; }
+
+void image_queue_stop(AvxImageQueue *queue) { (void)queue; }
+
+void image_queue_print_stats(AvxImageQueue *queue, const char *name,
+                             FILE *file) {
+  (void)queue;
+  (void)name;
+  (void)file;
+}
+
+#endif  // CONFIG_MULTITHREAD
+
+int image_queue_copy_image(aom_image_t *dst, const aom_image_t *src) {
+  const int bytes_per_sample = (src->fmt & AOM_IMG_FMT_HIGHBITDEPTH) ? 2 : 1;
+  int plane;
+
+  if (dst->img_data == NULL || dst->fmt != src->fmt || dst->d_w != src->d_w ||
+      dst->d_h != src->d_h) {
+    aom_img_free(dst);
+    if (!aom_img_alloc(dst, src->fmt, src->d_w, src->d_h, 32)) return 0;
+  }
+  dst->bit_depth = src->bit_depth;
+  dst->cs = src->cs;
+  dst->range = src->range;
+
+  for (plane = 0; plane < 3; ++plane) {
+    const int w = aom_img_plane_width(src, plane) * bytes_per_sample;
+    const int h = aom_img_plane_height(src, plane);
+    const unsigned char *s = src->planes[plane];
+    unsigned char *d = dst->planes[plane];
+    int y;
+
+    for (y = 0; y < h; ++y) {
+      memcpy(d, s, w);
+      s += src->stride[plane];
+      d += dst->stride[plane];
+    }
+  }
+  return 1;
+}
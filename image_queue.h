@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2017, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+#ifndef IMAGE_QUEUE_H_
+#define IMAGE_QUEUE_H_
+
+#include <stdio.h>
+
+#include "./tools_common.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// A bounded queue of images between the main thread of a tool and an I/O
+// thread: aomenc reads its input frames ahead on a thread, aomdec writes its
+// output frames behind on one. The queue owns its images and reuses them.
+//
+// The producer fills the image returned by image_queue_get_free() and queues
+// it with image_queue_push(). The consumer uses the image returned by
+// image_queue_front() and frees it with image_queue_pop().
+typedef struct AvxImageQueue AvxImageQueue;
+
+typedef void (*AvxImageQueueThreadFn)(AvxImageQueue *queue, void *arg);
+
+// Returns NULL on failure, or without CONFIG_MULTITHREAD.
+AvxImageQueue *image_queue_create(int depth);
+
+// Waits for the thread, if any, and frees the queue.
+void image_queue_destroy(AvxImageQueue *queue);
+
+// Runs fn(queue, arg) on a new thread, as either side of the queue. Returns 0
+// on failure.
+int image_queue_start_thread(AvxImageQueue *queue, AvxImageQueueThreadFn fn,
+                             void *arg);
+
+// Waits for a free image. Returns NULL once the consumer has stopped.
+aom_image_t *image_queue_get_free(AvxImageQueue *queue);
+void image_queue_push(AvxImageQueue *queue);
+// Marks the end of the images.
+void image_queue_finish(AvxImageQueue *queue);
+
+// Waits for a queued image. Returns NULL once the producer has finished and
+// all the images have been popped.
+aom_image_t *image_queue_front(AvxImageQueue *queue);
+void image_queue_pop(AvxImageQueue *queue);
+// Tells the producer no more images are wanted.
+void image_queue_stop(AvxImageQueue *queue);
+
+// Copies src into dst, reallocating dst if the format or size differ.
+// Returns 0 on failure.
+int image_queue_copy_image(aom_image_t *dst, const aom_image_t *src);
+
+// Prints the number of images queued, the average and maximum depth of the
+// queue, and how often either side had to wait for the other.
+void image_queue_print_stats(AvxImageQueue *queue, const char *name,
+                             FILE *file);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // IMAGE_QUEUE_H_
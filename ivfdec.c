@@ -100,3 +100,31 @@ int ivf_read_frame(FILE *infile, uint8_t **buffer, size_t *bytes_read,
 
   return 1;
 }
+
+int ivf_read_frame_mapped(AvxMappedFile *mapped, const uint8_t **buffer,
+                          size_t *bytes_read) {
+  const uint8_t *const raw_header = mapped_file_read(mapped, IVF_FRAME_HDR_SZ);
+  const uint8_t *frame;
+  size_t frame_size;
+
+  if (raw_header == NULL) {
+    if (mapped_file_bytes_left(mapped) > 0) warn("Failed to read frame size\n");
+    return 1;
+  }
+
+  frame_size = mem_get_le32(raw_header);
+  if (frame_size > 256 * 1024 * 1024) {
+    warn("Read invalid frame size (%u)\n", (unsigned int)frame_size);
+    frame_size = 0;
+  }
+
+  frame = mapped_file_read(mapped, frame_size);
+  if (frame == NULL) {
+    warn("Failed to read full frame\n");
+    return 1;
+  }
+
+  *buffer = frame;
+  *bytes_read = frame_size;
+  return 0;
+}
@@ -11,6 +11,7 @@
 #ifndef IVFDEC_H_
 #define IVFDEC_H_
 
+#include "./mapped_file.h"
 #include "./tools_common.h"
 
 #ifdef __cplusplus
@@ -22,6 +23,10 @@ int file_is_ivf(struct AvxInputContext *input);
 int ivf_read_frame(FILE *infile, uint8_t **buffer, size_t *bytes_read,
                    size_t *buffer_size);
 
+// Like ivf_read_frame(), but sets *buffer to the frame in the mapped file.
+int ivf_read_frame_mapped(AvxMappedFile *mapped, const uint8_t **buffer,
+                          size_t *bytes_read);
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
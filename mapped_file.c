@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2017, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#define _POSIX_C_SOURCE 200809L  // fileno(), posix_madvise()
+#include <string.h>
+
+#include "./mapped_file.h"
+
+#if CONFIG_OS_SUPPORT
+#if defined(_WIN32)
+#include <io.h>
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+#endif  // CONFIG_OS_SUPPORT
+
+int mapped_file_open(AvxMappedFile *mapped, FILE *file) {
+  const FileOffset position = ftello(file);
+
+  memset(mapped, 0, sizeof(*mapped));
+  if (position < 0) return 0;
+
+#if CONFIG_OS_SUPPORT && defined(_WIN32)
+  {
+    const HANDLE handle = (HANDLE)_get_osfhandle(_fileno(file));
+    LARGE_INTEGER size;
+    HANDLE mapping;
+    void *data;
+
+    if (handle == INVALID_HANDLE_VALUE ||
+        GetFileType(handle) != FILE_TYPE_DISK ||
+        !GetFileSizeEx(handle, &size) || size.QuadPart <= 0 ||
+        (uint64_t)size.QuadPart > (size_t)-1) {
+      return 0;
+    }
+    mapping = CreateFileMapping(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mapping == NULL) return 0;
+    data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (data == NULL) {
+      CloseHandle(mapping);
+      return 0;
+    }
+    mapped->data = (const uint8_t *)data;
+    mapped->size = (size_t)size.QuadPart;
+    mapped->mapping = mapping;
+  }
+#elif CONFIG_OS_SUPPORT
+  {
+    const int fd = fileno(file);
+    struct stat st;
+    void *data;
+
+    if (fstat(fd, &st) || !S_ISREG(st.st_mode) || st.st_size <= 0 ||
+        (uint64_t)st.st_size > (size_t)-1) {
+      return 0;
+    }
+    data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) return 0;
+#if defined(POSIX_MADV_SEQUENTIAL)
+    // The file is read front to back, once.
+    posix_madvise(data, (size_t)st.st_size, POSIX_MADV_SEQUENTIAL);
+#endif
+    mapped->data = (const uint8_t *)data;
+    mapped->size = (size_t)st.st_size;
+  }
+#else
+  (void)file;
+  return 0;
+#endif  // CONFIG_OS_SUPPORT
+
+  if ((uint64_t)position > mapped->size) {
+    mapped_file_close(mapped);
+    return 0;
+  }
+  mapped->position = (size_t)position;
+  return 1;
+}
+
+void mapped_file_close(AvxMappedFile *mapped) {
+  if (mapped->data == NULL) return;
+#if CONFIG_OS_SUPPORT && defined(_WIN32)
+  UnmapViewOfFile(mapped->data);
+  CloseHandle(mapped->mapping);
+#elif CONFIG_OS_SUPPORT
+  munmap((void *)mapped->data, mapped->size);
+#endif
+  memset(mapped, 0, sizeof(*mapped));
+}
+
+const uint8_t *mapped_file_read(AvxMappedFile *mapped, size_t size) {
+  const uint8_t *const data = mapped->data + mapped->position;
+  if (size > mapped_file_bytes_left(mapped)) return NULL;
+  mapped->position += size;
+  return data;
+}
@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2017, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+#ifndef MAPPED_FILE_H_
+#define MAPPED_FILE_H_
+
+#include "./tools_common.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// A read-only memory mapping of a whole input file. The readers of the
+// container formats return pointers into the mapping instead of copying each
+// frame into a buffer of their own.
+typedef struct AvxMappedFile {
+  const uint8_t *data;  // NULL if the file is not mapped.
+  size_t size;
+  size_t position;  // The offset of the next byte to read.
+#if defined(_WIN32)
+  void *mapping;
+#endif
+} AvxMappedFile;
+
+// Maps the file open as file, and starts reading it at the current position
+// of file. Returns 0 if the file cannot be mapped, e.g. because it is a pipe
+// or empty, in which case it must be read with fread() instead.
+int mapped_file_open(AvxMappedFile *mapped, FILE *file);
+
+void mapped_file_close(AvxMappedFile *mapped);
+
+// Returns a pointer to the next size bytes of the file and skips over them,
+// or NULL if fewer than size bytes are left.
+const uint8_t *mapped_file_read(AvxMappedFile *mapped, size_t size);
+
+// Returns the number of bytes left to read.
+static INLINE size_t mapped_file_bytes_left(const AvxMappedFile *mapped) {
+  return mapped->size - mapped->position;
+}
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif  // MAPPED_FILE_H_
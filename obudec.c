@@ -80,6 +80,45 @@ int obu_read_temporal_unit(FILE *infile, uint8_t **buffer, size_t *bytes_read,
   return 0;
 }
 
+int obu_read_temporal_unit_mapped(AvxMappedFile *mapped,
+                                  const uint8_t **buffer, size_t *bytes_read) {
+  const size_t obu_length_header_size =
+      PRE_OBU_SIZE_BYTES + OBU_HEADER_SIZE_BYTES;
+  const uint8_t *const start = mapped->data + mapped->position;
+
+  if (mapped_file_bytes_left(mapped) == 0) return 1;
+
+  *bytes_read = 0;
+  while (mapped_file_bytes_left(mapped) > 0) {
+    const uint8_t *const data =
+        mapped_file_read(mapped, obu_length_header_size);
+    uint32_t obu_size;
+
+    if (data == NULL) {
+      warn("Failed to read OBU Header\n");
+      return 1;
+    }
+    if (((data[PRE_OBU_SIZE_BYTES] >> 3) & 0xF) == OBU_TEMPORAL_DELIMITER) {
+      // Stop when a temporal delimiter is found. It is not part of the
+      // temporal unit.
+      break;
+    }
+    *bytes_read += obu_length_header_size;
+
+    // The payload follows the byte of the header already read.
+    obu_size = mem_get_le32(data);
+    if (obu_size > 1) {
+      if (mapped_file_read(mapped, obu_size - 1) == NULL) {
+        warn("Failed to read OBU Payload\n");
+        return 1;
+      }
+      *bytes_read += obu_size - 1;
+    }
+  }
+  *buffer = start;
+  return 0;
+}
+
 int file_is_obu(struct AvxInputContext *input_ctx) {
   uint8_t obutd[PRE_OBU_SIZE_BYTES + OBU_HEADER_SIZE_BYTES];
   int size;
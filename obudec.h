@@ -11,6 +11,7 @@
 #ifndef OBUDEC_H_
 #define OBUDEC_H_
 
+#include "./mapped_file.h"
 #include "./tools_common.h"
 
 #ifdef __cplusplus
@@ -22,6 +23,11 @@ int file_is_obu(struct AvxInputContext *input_ctx);
 int obu_read_temporal_unit(FILE *infile, uint8_t **buffer, size_t *bytes_read,
                            size_t *buffer_size);
 
+// Like obu_read_temporal_unit(), but sets *buffer to the temporal unit in the
+// mapped file.
+int obu_read_temporal_unit_mapped(AvxMappedFile *mapped,
+                                  const uint8_t **buffer, size_t *bytes_read);
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2017, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "./rawdec.h"
+
+#include "aom_ports/mem_ops.h"
+
+int raw_read_frame(FILE *infile, uint8_t **buffer, size_t *bytes_read,
+                   size_t *buffer_size) {
+  char raw_hdr[RAW_FRAME_HDR_SZ];
+  size_t frame_size = 0;
+
+  if (fread(raw_hdr, RAW_FRAME_HDR_SZ, 1, infile) != 1) {
+    if (!feof(infile)) warn("Failed to read RAW frame size\n");
+  } else {
+    const size_t kCorruptFrameThreshold = 256 * 1024 * 1024;
+    const size_t kFrameTooSmallThreshold = 256 * 1024;
+    frame_size = mem_get_le32(raw_hdr);
+
+    if (frame_size > kCorruptFrameThreshold) {
+      warn("Read invalid frame size (%u)\n", (unsigned int)frame_size);
+      frame_size = 0;
+    }
+
+    if (frame_size < kFrameTooSmallThreshold) {
+      warn("Warning: Read invalid frame size (%u) - not a raw file?\n",
+           (unsigned int)frame_size);
+    }
+
+    if (frame_size > *buffer_size) {
+      uint8_t *new_buf = realloc(*buffer, 2 * frame_size);
+      if (new_buf) {
+        *buffer = new_buf;
+        *buffer_size = 2 * frame_size;
+      } else {
+        warn("Failed to allocate compressed data buffer\n");
+        frame_size = 0;
+      }
+    }
+  }
+
+  if (!feof(infile)) {
+    if (fread(*buffer, 1, frame_size, infile) != frame_size) {
+      warn("Failed to read full frame\n");
+      return 1;
+    }
+    *bytes_read = frame_size;
+  }
+
+  return 0;
+}
+
+int raw_read_frame_mapped(AvxMappedFile *mapped, const uint8_t **buffer,
+                          size_t *bytes_read) {
+  const uint8_t *const raw_hdr = mapped_file_read(mapped, RAW_FRAME_HDR_SZ);
+  const size_t kCorruptFrameThreshold = 256 * 1024 * 1024;
+  const size_t kFrameTooSmallThreshold = 256 * 1024;
+  const uint8_t *frame;
+  size_t frame_size;
+
+  if (raw_hdr == NULL) {
+    if (mapped_file_bytes_left(mapped) > 0)
+      warn("Failed to read RAW frame size\n");
+    return 1;
+  }
+
+  frame_size = mem_get_le32(raw_hdr);
+  if (frame_size > kCorruptFrameThreshold) {
+    warn("Read invalid frame size (%u)\n", (unsigned int)frame_size);
+    frame_size = 0;
+  }
+
+  if (frame_size < kFrameTooSmallThreshold) {
+    warn("Warning: Read invalid frame size (%u) - not a raw file?\n",
+         (unsigned int)frame_size);
+  }
+
+  frame = mapped_file_read(mapped, frame_size);
+  if (frame == NULL) {
+    warn("Failed to read full frame\n");
+    return 1;
+  }
+  *buffer = frame;
+  *bytes_read = frame_size;
+  return 0;
+}
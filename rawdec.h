@@ -0,0 +1,35 @@
+/*
+ * Copyright (c) 2017, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#ifndef RAWDEC_H_
+#define RAWDEC_H_
+
+#include "./mapped_file.h"
+#include "./tools_common.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Reads a frame of a raw stream, in which each frame follows its size as a
+// 32-bit little-endian integer.
+int raw_read_frame(FILE *infile, uint8_t **buffer, size_t *bytes_read,
+                   size_t *buffer_size);
+
+// Like raw_read_frame(), but sets *buffer to the frame in the mapped file.
+int raw_read_frame_mapped(AvxMappedFile *mapped, const uint8_t **buffer,
+                          size_t *bytes_read);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif  // RAWDEC_H_
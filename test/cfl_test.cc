@@ -0,0 +1,502 @@
+/*
+ * Copyright (c) 2017, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "third_party/googletest/src/googletest/include/gtest/gtest.h"
+
+#include "./aom_config.h"
+#include "./av1_rtcd.h"
+#include "aom_ports/aom_timer.h"
+#include "av1/common/cfl.h"
+#include "test/acm_random.h"
+#include "test/clear_system_state.h"
+#include "test/register_state_check.h"
+#include "test/util.h"
+
+namespace {
+using libaom_test::ACMRandom;
+using std::tr1::make_tuple;
+
+// Luma block dimensions covered by CfL. Chroma dimensions are derived from
+// these by the subsampling.
+const int kDims[] = { 4, 8, 16, 32 };
+const int kNumDims = sizeof(kDims) / sizeof(kDims[0]);
+const int kNumTests = 100;
+const int kNumSpeedTests = 100000;
+const int kLumaStride = 2 * CFL_PRED_BUF_LINE;
+
+static int get_log2(int v) {
+  int log2 = 0;
+  while (v > 1) {
+    v >>= 1;
+    ++log2;
+  }
+  return log2;
+}
+
+typedef void (*SubtractAverageFunc)(int16_t *pred_buf_q3, int width,
+                                    int height, int num_pel_log2);
+typedef std::tr1::tuple<SubtractAverageFunc, SubtractAverageFunc>
+    SubtractAverageParam;
+
+class CFLSubtractAverageTest
+    : public ::testing::TestWithParam<SubtractAverageParam> {
+ public:
+  virtual void SetUp() {
+    ref_func_ = GET_PARAM(0);
+    tst_func_ = GET_PARAM(1);
+  }
+
+  virtual void TearDown() { libaom_test::ClearSystemState(); }
+
+ protected:
+  SubtractAverageFunc ref_func_;
+  SubtractAverageFunc tst_func_;
+  int16_t ref_buf_[CFL_PRED_BUF_SQUARE];
+  int16_t tst_buf_[CFL_PRED_BUF_SQUARE];
+};
+
+TEST_P(CFLSubtractAverageTest, MatchesReference) {
+  ACMRandom rnd(ACMRandom::DeterministicSeed());
+  for (int h = 0; h < kNumDims; ++h) {
+    for (int w = 0; w < kNumDims; ++w) {
+      const int width = kDims[w];
+      const int height = kDims[h];
+      const int num_pel_log2 = get_log2(width) + get_log2(height);
+      for (int k = 0; k < kNumTests; ++k) {
+        // Values of a 12-bit 4:2:0 block stored in Q3.
+        for (int i = 0; i < CFL_PRED_BUF_SQUARE; ++i)
+          ref_buf_[i] = tst_buf_[i] = rnd.Rand16() % (4096 << 3);
+        ref_func_(ref_buf_, width, height, num_pel_log2);
+        ASM_REGISTER_STATE_CHECK(
+            tst_func_(tst_buf_, width, height, num_pel_log2));
+        ASSERT_EQ(0, memcmp(ref_buf_, tst_buf_, sizeof(ref_buf_)))
+            << "width " << width << " height " << height;
+      }
+    }
+  }
+}
+
+TEST_P(CFLSubtractAverageTest, DISABLED_Speed) {
+  ACMRandom rnd(ACMRandom::DeterministicSeed());
+  for (int i = 0; i < CFL_PRED_BUF_SQUARE; ++i)
+    ref_buf_[i] = tst_buf_[i] = rnd.Rand16() % (256 << 3);
+  for (int s = 0; s < kNumDims; ++s) {
+    const int size = kDims[s];
+    const int num_pel_log2 = 2 * get_log2(size);
+    aom_usec_timer ref_timer, tst_timer;
+    aom_usec_timer_start(&ref_timer);
+    for (int k = 0; k < kNumSpeedTests; ++k)
+      ref_func_(ref_buf_, size, size, num_pel_log2);
+    aom_usec_timer_mark(&ref_timer);
+    aom_usec_timer_start(&tst_timer);
+    for (int k = 0; k < kNumSpeedTests; ++k)
+      tst_func_(tst_buf_, size, size, num_pel_log2);
+    aom_usec_timer_mark(&tst_timer);
+    printf("%2dx%-2d ref %7d us, tst %7d us\n", size, size,
+           static_cast<int>(aom_usec_timer_elapsed(&ref_timer)),
+           static_cast<int>(aom_usec_timer_elapsed(&tst_timer)));
+  }
+}
+
+typedef void (*SubsampleLbdFunc)(const uint8_t *input, int input_stride,
+                                 int16_t *output_q3, int width, int height);
+// sub_x, sub_y, reference, tested
+typedef std::tr1::tuple<int, int, SubsampleLbdFunc, SubsampleLbdFunc>
+    SubsampleLbdParam;
+
+class CFLSubsampleLbdTest : public ::testing::TestWithParam<SubsampleLbdParam> {
+ public:
+  virtual void SetUp() {
+    sub_x_ = GET_PARAM(0);
+    sub_y_ = GET_PARAM(1);
+    ref_func_ = GET_PARAM(2);
+    tst_func_ = GET_PARAM(3);
+  }
+
+  virtual void TearDown() { libaom_test::ClearSystemState(); }
+
+ protected:
+  int sub_x_, sub_y_;
+  SubsampleLbdFunc ref_func_;
+  SubsampleLbdFunc tst_func_;
+  uint8_t luma_[kLumaStride * 2 * CFL_PRED_BUF_LINE];
+  int16_t ref_buf_[CFL_PRED_BUF_SQUARE];
+  int16_t tst_buf_[CFL_PRED_BUF_SQUARE];
+};
+
+TEST_P(CFLSubsampleLbdTest, MatchesReference) {
+  ACMRandom rnd(ACMRandom::DeterministicSeed());
+  for (int h = 0; h < kNumDims; ++h) {
+    for (int w = 0; w < kNumDims; ++w) {
+      const int width = kDims[w] >> sub_x_;
+      const int height = kDims[h] >> sub_y_;
+      for (int k = 0; k < kNumTests; ++k) {
+        for (size_t i = 0; i < sizeof(luma_); ++i) luma_[i] = rnd.Rand8();
+        memset(ref_buf_, 0, sizeof(ref_buf_));
+        memset(tst_buf_, 0, sizeof(tst_buf_));
+        ref_func_(luma_, kLumaStride, ref_buf_, width, height);
+        ASM_REGISTER_STATE_CHECK(
+            tst_func_(luma_, kLumaStride, tst_buf_, width, height));
+        ASSERT_EQ(0, memcmp(ref_buf_, tst_buf_, sizeof(ref_buf_)))
+            << "width " << width << " height " << height;
+      }
+    }
+  }
+}
+
+TEST_P(CFLSubsampleLbdTest, DISABLED_Speed) {
+  ACMRandom rnd(ACMRandom::DeterministicSeed());
+  for (size_t i = 0; i < sizeof(luma_); ++i) luma_[i] = rnd.Rand8();
+  for (int s = 0; s < kNumDims; ++s) {
+    const int width = kDims[s] >> sub_x_;
+    const int height = kDims[s] >> sub_y_;
+    aom_usec_timer ref_timer, tst_timer;
+    aom_usec_timer_start(&ref_timer);
+    for (int k = 0; k < kNumSpeedTests; ++k)
+      ref_func_(luma_, kLumaStride, ref_buf_, width, height);
+    aom_usec_timer_mark(&ref_timer);
+    aom_usec_timer_start(&tst_timer);
+    for (int k = 0; k < kNumSpeedTests; ++k)
+      tst_func_(luma_, kLumaStride, tst_buf_, width, height);
+    aom_usec_timer_mark(&tst_timer);
+    printf("%2dx%-2d ref %7d us, tst %7d us\n", width, height,
+           static_cast<int>(aom_usec_timer_elapsed(&ref_timer)),
+           static_cast<int>(aom_usec_timer_elapsed(&tst_timer)));
+  }
+}
+
+typedef void (*PredictLbdFunc)(const int16_t *pred_buf_q3, uint8_t *dst,
+                               int dst_stride, int width, int height,
+                               int alpha_q3);
+typedef std::tr1::tuple<PredictLbdFunc, PredictLbdFunc> PredictLbdParam;
+
+class CFLPredictLbdTest : public ::testing::TestWithParam<PredictLbdParam> {
+ public:
+  virtual void SetUp() {
+    ref_func_ = GET_PARAM(0);
+    tst_func_ = GET_PARAM(1);
+  }
+
+  virtual void TearDown() { libaom_test::ClearSystemState(); }
+
+ protected:
+  PredictLbdFunc ref_func_;
+  PredictLbdFunc tst_func_;
+  int16_t pred_buf_q3_[CFL_PRED_BUF_SQUARE];
+  uint8_t ref_dst_[CFL_PRED_BUF_SQUARE];
+  uint8_t tst_dst_[CFL_PRED_BUF_SQUARE];
+};
+
+TEST_P(CFLPredictLbdTest, MatchesReference) {
+  ACMRandom rnd(ACMRandom::DeterministicSeed());
+  for (int h = 0; h < kNumDims; ++h) {
+    for (int w = 0; w < kNumDims; ++w) {
+      const int width = kDims[w];
+      const int height = kDims[h];
+      for (int alpha_q3 = -16; alpha_q3 <= 16; ++alpha_q3) {
+        for (int i = 0; i < CFL_PRED_BUF_SQUARE; ++i) {
+          pred_buf_q3_[i] = (rnd.Rand16() % (511 << 3)) - (255 << 3);
+          ref_dst_[i] = tst_dst_[i] = rnd.Rand8();
+        }
+        ref_func_(pred_buf_q3_, ref_dst_, CFL_PRED_BUF_LINE, width, height,
+                  alpha_q3);
+        ASM_REGISTER_STATE_CHECK(tst_func_(pred_buf_q3_, tst_dst_,
+                                           CFL_PRED_BUF_LINE, width, height,
+                                           alpha_q3));
+        ASSERT_EQ(0, memcmp(ref_dst_, tst_dst_, sizeof(ref_dst_)))
+            << "width " << width << " height " << height << " alpha "
+            << alpha_q3;
+      }
+    }
+  }
+}
+
+TEST_P(CFLPredictLbdTest, DISABLED_Speed) {
+  ACMRandom rnd(ACMRandom::DeterministicSeed());
+  for (int i = 0; i < CFL_PRED_BUF_SQUARE; ++i) {
+    pred_buf_q3_[i] = (rnd.Rand16() % (511 << 3)) - (255 << 3);
+    ref_dst_[i] = tst_dst_[i] = rnd.Rand8();
+  }
+  for (int s = 0; s < kNumDims; ++s) {
+    const int size = kDims[s];
+    aom_usec_timer ref_timer, tst_timer;
+    aom_usec_timer_start(&ref_timer);
+    for (int k = 0; k < kNumSpeedTests; ++k)
+      ref_func_(pred_buf_q3_, ref_dst_, CFL_PRED_BUF_LINE, size, size, 5);
+    aom_usec_timer_mark(&ref_timer);
+    aom_usec_timer_start(&tst_timer);
+    for (int k = 0; k < kNumSpeedTests; ++k)
+      tst_func_(pred_buf_q3_, tst_dst_, CFL_PRED_BUF_LINE, size, size, 5);
+    aom_usec_timer_mark(&tst_timer);
+    printf("%2dx%-2d ref %7d us, tst %7d us\n", size, size,
+           static_cast<int>(aom_usec_timer_elapsed(&ref_timer)),
+           static_cast<int>(aom_usec_timer_elapsed(&tst_timer)));
+  }
+}
+
+#if CONFIG_HIGHBITDEPTH
+typedef void (*SubsampleHbdFunc)(const uint16_t *input, int input_stride,
+                                 int16_t *output_q3, int width, int height);
+// sub_x, sub_y, reference, tested
+typedef std::tr1::tuple<int, int, SubsampleHbdFunc, SubsampleHbdFunc>
+    SubsampleHbdParam;
+
+class CFLSubsampleHbdTest : public ::testing::TestWithParam<SubsampleHbdParam> {
+ public:
+  virtual void SetUp() {
+    sub_x_ = GET_PARAM(0);
+    sub_y_ = GET_PARAM(1);
+    ref_func_ = GET_PARAM(2);
+    tst_func_ = GET_PARAM(3);
+  }
+
+  virtual void TearDown() { libaom_test::ClearSystemState(); }
+
+ protected:
+  int sub_x_, sub_y_;
+  SubsampleHbdFunc ref_func_;
+  SubsampleHbdFunc tst_func_;
+  uint16_t luma_[kLumaStride * 2 * CFL_PRED_BUF_LINE];
+  int16_t ref_buf_[CFL_PRED_BUF_SQUARE];
+  int16_t tst_buf_[CFL_PRED_BUF_SQUARE];
+};
+
+TEST_P(CFLSubsampleHbdTest, MatchesReference) {
+  ACMRandom rnd(ACMRandom::DeterministicSeed());
+  for (int bd = 8; bd <= 12; bd += 2) {
+    for (int h = 0; h < kNumDims; ++h) {
+      for (int w = 0; w < kNumDims; ++w) {
+        const int width = kDims[w] >> sub_x_;
+        const int height = kDims[h] >> sub_y_;
+        for (int k = 0; k < kNumTests; ++k) {
+          for (size_t i = 0; i < kLumaStride * 2 * CFL_PRED_BUF_LINE; ++i)
+            luma_[i] = rnd.Rand16() & ((1 << bd) - 1);
+          memset(ref_buf_, 0, sizeof(ref_buf_));
+          memset(tst_buf_, 0, sizeof(tst_buf_));
+          ref_func_(luma_, kLumaStride, ref_buf_, width, height);
+          ASM_REGISTER_STATE_CHECK(
+              tst_func_(luma_, kLumaStride, tst_buf_, width, height));
+          ASSERT_EQ(0, memcmp(ref_buf_, tst_buf_, sizeof(ref_buf_)))
+              << "bd " << bd << " width " << width << " height " << height;
+        }
+      }
+    }
+  }
+}
+
+TEST_P(CFLSubsampleHbdTest, DISABLED_Speed) {
+  ACMRandom rnd(ACMRandom::DeterministicSeed());
+  for (size_t i = 0; i < kLumaStride * 2 * CFL_PRED_BUF_LINE; ++i)
+    luma_[i] = rnd.Rand16() & 1023;
+  for (int s = 0; s < kNumDims; ++s) {
+    const int width = kDims[s] >> sub_x_;
+    const int height = kDims[s] >> sub_y_;
+    aom_usec_timer ref_timer, tst_timer;
+    aom_usec_timer_start(&ref_timer);
+    for (int k = 0; k < kNumSpeedTests; ++k)
+      ref_func_(luma_, kLumaStride, ref_buf_, width, height);
+    aom_usec_timer_mark(&ref_timer);
+    aom_usec_timer_start(&tst_timer);
+    for (int k = 0; k < kNumSpeedTests; ++k)
+      tst_func_(luma_, kLumaStride, tst_buf_, width, height);
+    aom_usec_timer_mark(&tst_timer);
+    printf("%2dx%-2d ref %7d us, tst %7d us\n", width, height,
+           static_cast<int>(aom_usec_timer_elapsed(&ref_timer)),
+           static_cast<int>(aom_usec_timer_elapsed(&tst_timer)));
+  }
+}
+
+typedef void (*PredictHbdFunc)(const int16_t *pred_buf_q3, uint16_t *dst,
+                               int dst_stride, int width, int height,
+                               int alpha_q3, int bit_depth);
+typedef std::tr1::tuple<PredictHbdFunc, PredictHbdFunc> PredictHbdParam;
+
+class CFLPredictHbdTest : public ::testing::TestWithParam<PredictHbdParam> {
+ public:
+  virtual void SetUp() {
+    ref_func_ = GET_PARAM(0);
+    tst_func_ = GET_PARAM(1);
+  }
+
+  virtual void TearDown() { libaom_test::ClearSystemState(); }
+
+ protected:
+  PredictHbdFunc ref_func_;
+  PredictHbdFunc tst_func_;
+  int16_t pred_buf_q3_[CFL_PRED_BUF_SQUARE];
+  uint16_t ref_dst_[CFL_PRED_BUF_SQUARE];
+  uint16_t tst_dst_[CFL_PRED_BUF_SQUARE];
+};
+
+TEST_P(CFLPredictHbdTest, MatchesReference) {
+  ACMRandom rnd(ACMRandom::DeterministicSeed());
+  for (int bd = 8; bd <= 12; bd += 2) {
+    const int max_ac_q3 = ((1 << bd) - 1) << 3;
+    for (int h = 0; h < kNumDims; ++h) {
+      for (int w = 0; w < kNumDims; ++w) {
+        const int width = kDims[w];
+        const int height = kDims[h];
+        for (int alpha_q3 = -16; alpha_q3 <= 16; ++alpha_q3) {
+          for (int i = 0; i < CFL_PRED_BUF_SQUARE; ++i) {
+            pred_buf_q3_[i] = (rnd.Rand16() % (2 * max_ac_q3 + 1)) - max_ac_q3;
+            ref_dst_[i] = tst_dst_[i] = rnd.Rand16() & ((1 << bd) - 1);
+          }
+          ref_func_(pred_buf_q3_, ref_dst_, CFL_PRED_BUF_LINE, width, height,
+                    alpha_q3, bd);
+          ASM_REGISTER_STATE_CHECK(tst_func_(pred_buf_q3_, tst_dst_,
+                                             CFL_PRED_BUF_LINE, width, height,
+                                             alpha_q3, bd));
+          ASSERT_EQ(0, memcmp(ref_dst_, tst_dst_, sizeof(ref_dst_)))
+              << "bd " << bd << " width " << width << " height " << height
+              << " alpha " << alpha_q3;
+        }
+      }
+    }
+  }
+}
+
+TEST_P(CFLPredictHbdTest, DISABLED_Speed) {
+  ACMRandom rnd(ACMRandom::DeterministicSeed());
+  for (int i = 0; i < CFL_PRED_BUF_SQUARE; ++i) {
+    pred_buf_q3_[i] = (rnd.Rand16() % (2047 << 3)) - (1023 << 3);
+    ref_dst_[i] = tst_dst_[i] = rnd.Rand16() & 1023;
+  }
+  for (int s = 0; s < kNumDims; ++s) {
+    const int size = kDims[s];
+    aom_usec_timer ref_timer, tst_timer;
+    aom_usec_timer_start(&ref_timer);
+    for (int k = 0; k < kNumSpeedTests; ++k)
+      ref_func_(pred_buf_q3_, ref_dst_, CFL_PRED_BUF_LINE, size, size, 5, 10);
+    aom_usec_timer_mark(&ref_timer);
+    aom_usec_timer_start(&tst_timer);
+    for (int k = 0; k < kNumSpeedTests; ++k)
+      tst_func_(pred_buf_q3_, tst_dst_, CFL_PRED_BUF_LINE, size, size, 5, 10);
+    aom_usec_timer_mark(&tst_timer);
+    printf("%2dx%-2d ref %7d us, tst %7d us\n", size, size,
+           static_cast<int>(aom_usec_timer_elapsed(&ref_timer)),
+           static_cast<int>(aom_usec_timer_elapsed(&tst_timer)));
+  }
+}
+#endif  // CONFIG_HIGHBITDEPTH
+
+#if HAVE_SSE2
+INSTANTIATE_TEST_CASE_P(
+    SSE2, CFLSubtractAverageTest,
+    ::testing::Values(make_tuple(&cfl_subtract_average_c,
+                                 &cfl_subtract_average_sse2)));
+
+INSTANTIATE_TEST_CASE_P(
+    SSE2, CFLSubsampleLbdTest,
+    ::testing::Values(make_tuple(1, 1, &cfl_luma_subsampling_420_lbd_c,
+                                 &cfl_luma_subsampling_420_lbd_sse2),
+                      make_tuple(1, 0, &cfl_luma_subsampling_422_lbd_c,
+                                 &cfl_luma_subsampling_422_lbd_sse2),
+                      make_tuple(0, 1, &cfl_luma_subsampling_440_lbd_c,
+                                 &cfl_luma_subsampling_440_lbd_sse2),
+                      make_tuple(0, 0, &cfl_luma_subsampling_444_lbd_c,
+                                 &cfl_luma_subsampling_444_lbd_sse2)));
+
+INSTANTIATE_TEST_CASE_P(
+    SSE2, CFLPredictLbdTest,
+    ::testing::Values(make_tuple(&cfl_build_prediction_lbd_c,
+                                 &cfl_build_prediction_lbd_sse2)));
+
+#if CONFIG_HIGHBITDEPTH
+INSTANTIATE_TEST_CASE_P(
+    SSE2, CFLSubsampleHbdTest,
+    ::testing::Values(make_tuple(1, 1, &cfl_luma_subsampling_420_hbd_c,
+                                 &cfl_luma_subsampling_420_hbd_sse2),
+                      make_tuple(1, 0, &cfl_luma_subsampling_422_hbd_c,
+                                 &cfl_luma_subsampling_422_hbd_sse2),
+                      make_tuple(0, 1, &cfl_luma_subsampling_440_hbd_c,
+                                 &cfl_luma_subsampling_440_hbd_sse2),
+                      make_tuple(0, 0, &cfl_luma_subsampling_444_hbd_c,
+                                 &cfl_luma_subsampling_444_hbd_sse2)));
+
+INSTANTIATE_TEST_CASE_P(
+    SSE2, CFLPredictHbdTest,
+    ::testing::Values(make_tuple(&cfl_build_prediction_hbd_c,
+                                 &cfl_build_prediction_hbd_sse2)));
+#endif  // CONFIG_HIGHBITDEPTH
+#endif  // HAVE_SSE2
+
+#if HAVE_SSSE3
+INSTANTIATE_TEST_CASE_P(
+    SSSE3, CFLSubsampleLbdTest,
+    ::testing::Values(make_tuple(1, 1, &cfl_luma_subsampling_420_lbd_c,
+                                 &cfl_luma_subsampling_420_lbd_ssse3),
+                      make_tuple(1, 0, &cfl_luma_subsampling_422_lbd_c,
+                                 &cfl_luma_subsampling_422_lbd_ssse3)));
+
+INSTANTIATE_TEST_CASE_P(
+    SSSE3, CFLPredictLbdTest,
+    ::testing::Values(make_tuple(&cfl_build_prediction_lbd_c,
+                                 &cfl_build_prediction_lbd_ssse3)));
+
+#if CONFIG_HIGHBITDEPTH
+INSTANTIATE_TEST_CASE_P(
+    SSSE3, CFLSubsampleHbdTest,
+    ::testing::Values(make_tuple(1, 1, &cfl_luma_subsampling_420_hbd_c,
+                                 &cfl_luma_subsampling_420_hbd_ssse3),
+                      make_tuple(1, 0, &cfl_luma_subsampling_422_hbd_c,
+                                 &cfl_luma_subsampling_422_hbd_ssse3)));
+
+INSTANTIATE_TEST_CASE_P(
+    SSSE3, CFLPredictHbdTest,
+    ::testing::Values(make_tuple(&cfl_build_prediction_hbd_c,
+                                 &cfl_build_prediction_hbd_ssse3)));
+#endif  // CONFIG_HIGHBITDEPTH
+#endif  // HAVE_SSSE3
+
+#if HAVE_AVX2
+INSTANTIATE_TEST_CASE_P(
+    AVX2, CFLSubtractAverageTest,
+    ::testing::Values(make_tuple(&cfl_subtract_average_c,
+                                 &cfl_subtract_average_avx2)));
+
+INSTANTIATE_TEST_CASE_P(
+    AVX2, CFLSubsampleLbdTest,
+    ::testing::Values(make_tuple(1, 1, &cfl_luma_subsampling_420_lbd_c,
+                                 &cfl_luma_subsampling_420_lbd_avx2),
+                      make_tuple(1, 0, &cfl_luma_subsampling_422_lbd_c,
+                                 &cfl_luma_subsampling_422_lbd_avx2),
+                      make_tuple(0, 1, &cfl_luma_subsampling_440_lbd_c,
+                                 &cfl_luma_subsampling_440_lbd_avx2),
+                      make_tuple(0, 0, &cfl_luma_subsampling_444_lbd_c,
+                                 &cfl_luma_subsampling_444_lbd_avx2)));
+
+INSTANTIATE_TEST_CASE_P(
+    AVX2, CFLPredictLbdTest,
+    ::testing::Values(make_tuple(&cfl_build_prediction_lbd_c,
+                                 &cfl_build_prediction_lbd_avx2)));
+
+#if CONFIG_HIGHBITDEPTH
+INSTANTIATE_TEST_CASE_P(
+    AVX2, CFLSubsampleHbdTest,
+    ::testing::Values(make_tuple(1, 1, &cfl_luma_subsampling_420_hbd_c,
+                                 &cfl_luma_subsampling_420_hbd_avx2),
+                      make_tuple(1, 0, &cfl_luma_subsampling_422_hbd_c,
+                                 &cfl_luma_subsampling_422_hbd_avx2),
+                      make_tuple(0, 1, &cfl_luma_subsampling_440_hbd_c,
+                                 &cfl_luma_subsampling_440_hbd_avx2),
+                      make_tuple(0, 0, &cfl_luma_subsampling_444_hbd_c,
+                                 &cfl_luma_subsampling_444_hbd_avx2)));
+
+INSTANTIATE_TEST_CASE_P(
+    AVX2, CFLPredictHbdTest,
+    ::testing::Values(make_tuple(&cfl_build_prediction_hbd_c,
+                                 &cfl_build_prediction_hbd_avx2)));
+#endif  // CONFIG_HIGHBITDEPTH
+#endif  // HAVE_AVX2
+}  // namespace
@@ -26,7 +26,10 @@ using libaom_test::ACMRandom;
 
 using std::tr1::tuple;
 using std::tr1::make_tuple;
-typedef tuple<int> CornerMatchParam;
+typedef double (*ComputeCrossCorrFunc)(unsigned char *im1, int stride1, int x1,
+                                       int y1, unsigned char *im2, int stride2,
+                                       int x2, int y2);
+typedef tuple<int, ComputeCrossCorrFunc> CornerMatchParam;
 
 class AV1CornerMatchTest : public ::testing::TestWithParam<CornerMatchParam> {
  public:
@@ -57,6 +60,7 @@ void AV1CornerMatchTest::RunCheckOutput() {
   // i) Random data, should have correlation close to 0
   // ii) Linearly related data + noise, should have correlation close to 1
   int mode = GET_PARAM(0);
+  ComputeCrossCorrFunc target_func = GET_PARAM(1);
   if (mode == 0) {
     for (i = 0; i < h; ++i)
       for (j = 0; j < w; ++j) {
@@ -80,10 +84,9 @@ void AV1CornerMatchTest::RunCheckOutput() {
 
     double res_c =
         compute_cross_correlation_c(input1, w, x1, y1, input2, w, x2, y2);
-    double res_sse4 =
-        compute_cross_correlation_sse4_1(input1, w, x1, y1, input2, w, x2, y2);
+    double res_simd = target_func(input1, w, x1, y1, input2, w, x2, y2);
 
-    ASSERT_EQ(res_sse4, res_c);
+    ASSERT_EQ(res_simd, res_c);
   }
 
   delete[] input1;
@@ -92,8 +95,17 @@ void AV1CornerMatchTest::RunCheckOutput() {
 
 TEST_P(AV1CornerMatchTest, CheckOutput) { RunCheckOutput(); }
 
-INSTANTIATE_TEST_CASE_P(SSE4_1, AV1CornerMatchTest,
-                        ::testing::Values(make_tuple(0), make_tuple(1)));
+INSTANTIATE_TEST_CASE_P(
+    SSE4_1, AV1CornerMatchTest,
+    ::testing::Values(make_tuple(0, compute_cross_correlation_sse4_1),
+                      make_tuple(1, compute_cross_correlation_sse4_1)));
+
+#if HAVE_AVX2
+INSTANTIATE_TEST_CASE_P(
+    AVX2, AV1CornerMatchTest,
+    ::testing::Values(make_tuple(0, compute_cross_correlation_avx2),
+                      make_tuple(1, compute_cross_correlation_avx2)));
+#endif
 
 }  // namespace AV1CornerMatch
 
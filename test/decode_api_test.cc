@@ -57,4 +57,36 @@ TEST(DecodeAPI, InvalidParams) {
   }
 }
 
+#if CONFIG_AV1_DECODER
+int SubmitNothing(void * /*priv*/, aom_thread_pool_task_fn_t /*fn*/,
+                  void * /*arg*/) {
+  return -1;
+}
+
+void WaitNothing(void * /*priv*/) {}
+
+TEST(DecodeAPI, SetThreadPool) {
+  aom_thread_pool_t pool = { NULL, 2, SubmitNothing, WaitNothing };
+  aom_codec_dec_cfg_t cfg = aom_codec_dec_cfg_t();
+  aom_codec_ctx_t dec;
+
+  cfg.threads = 2;
+  EXPECT_EQ(AOM_CODEC_OK,
+            aom_codec_dec_init(&dec, &aom_codec_av1_dx_algo, &cfg, 0));
+  EXPECT_EQ(AOM_CODEC_OK, aom_codec_control(&dec, AOM_SET_THREAD_POOL, &pool));
+  EXPECT_EQ(AOM_CODEC_OK, aom_codec_destroy(&dec));
+
+  // Frame parallel decoding filters frames on a thread of its own.
+  EXPECT_EQ(AOM_CODEC_OK,
+            aom_codec_dec_init(&dec, &aom_codec_av1_dx_algo, &cfg,
+                               AOM_CODEC_USE_FRAME_THREADING));
+  EXPECT_EQ(AOM_CODEC_INCAPABLE,
+            aom_codec_control(&dec, AOM_SET_THREAD_POOL, &pool));
+  EXPECT_EQ(AOM_CODEC_OK, aom_codec_control(
+                              &dec, AOM_SET_THREAD_POOL,
+                              static_cast<aom_thread_pool_t *>(NULL)));
+  EXPECT_EQ(AOM_CODEC_OK, aom_codec_destroy(&dec));
+}
+#endif  // CONFIG_AV1_DECODER
+
 }  // namespace
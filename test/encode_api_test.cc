@@ -59,4 +59,71 @@ TEST(EncodeAPI, InvalidParams) {
   }
 }
 
+#if CONFIG_AV1_ENCODER
+// Counts the tasks submitted to it and runs them when waited on.
+struct DeferredThreadPool {
+  static const int kMaxTasks = 256;
+
+  static int Submit(void *priv, aom_thread_pool_task_fn_t fn, void *arg) {
+    DeferredThreadPool *const p = reinterpret_cast<DeferredThreadPool *>(priv);
+    if (p->num_tasks == kMaxTasks) return -1;
+    p->fns[p->num_tasks] = fn;
+    p->args[p->num_tasks] = arg;
+    ++p->num_tasks;
+    ++p->submitted;
+    return 0;
+  }
+
+  static void Wait(void *priv) {
+    DeferredThreadPool *const p = reinterpret_cast<DeferredThreadPool *>(priv);
+    for (int i = 0; i < p->num_tasks; ++i) p->fns[i](p->args[i]);
+    p->num_tasks = 0;
+  }
+
+  aom_thread_pool_task_fn_t fns[kMaxTasks];
+  void *args[kMaxTasks];
+  int num_tasks;
+  int submitted;
+};
+
+TEST(EncodeAPI, SetThreadPool) {
+  const int kWidth = 352;
+  const int kHeight = 288;
+  DeferredThreadPool deferred = DeferredThreadPool();
+  aom_thread_pool_t pool = { &deferred, 2, DeferredThreadPool::Submit,
+                             DeferredThreadPool::Wait };
+  aom_thread_pool_t no_wait = pool;
+  aom_codec_ctx_t enc;
+  aom_codec_enc_cfg_t cfg;
+  aom_image_t img;
+
+  no_wait.wait = NULL;
+  ASSERT_TRUE(aom_img_alloc(&img, AOM_IMG_FMT_I420, kWidth, kHeight, 1) !=
+              NULL);
+  memset(img.img_data, 128, kWidth * kHeight * 3 / 2);
+
+  EXPECT_EQ(AOM_CODEC_OK,
+            aom_codec_enc_config_default(&aom_codec_av1_cx_algo, &cfg, 0));
+  cfg.g_w = kWidth;
+  cfg.g_h = kHeight;
+  cfg.g_threads = 2;
+  cfg.g_lag_in_frames = 0;
+  EXPECT_EQ(AOM_CODEC_OK,
+            aom_codec_enc_init(&enc, &aom_codec_av1_cx_algo, &cfg, 0));
+  EXPECT_EQ(AOM_CODEC_INVALID_PARAM,
+            aom_codec_control(&enc, AOM_SET_THREAD_POOL, &no_wait));
+  EXPECT_EQ(AOM_CODEC_OK, aom_codec_control(&enc, AV1E_SET_TILE_COLUMNS, 1));
+  EXPECT_EQ(AOM_CODEC_OK, aom_codec_control(&enc, AOM_SET_THREAD_POOL, &pool));
+  EXPECT_EQ(AOM_CODEC_OK, aom_codec_encode(&enc, &img, 0, 1, 0, 0));
+  EXPECT_GT(deferred.submitted, 0);
+
+  // The workers have been started on the pool.
+  EXPECT_EQ(AOM_CODEC_ERROR,
+            aom_codec_control(&enc, AOM_SET_THREAD_POOL, &pool));
+
+  EXPECT_EQ(AOM_CODEC_OK, aom_codec_destroy(&enc));
+  aom_img_free(&img);
+}
+#endif  // CONFIG_AV1_ENCODER
+
 }  // namespace
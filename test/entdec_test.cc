@@ -0,0 +1,201 @@
+/*
+ * Copyright (c) 2017, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <stdio.h>
+#include <algorithm>
+#include <vector>
+
+#include "third_party/googletest/src/googletest/include/gtest/gtest.h"
+
+#include "./aom_dsp_rtcd.h"
+#include "test/acm_random.h"
+#include "aom_dsp/bitreader.h"
+#include "aom_dsp/bitwriter.h"
+#include "aom_dsp/entdec.h"
+#include "aom_ports/aom_timer.h"
+
+using libaom_test::ACMRandom;
+
+namespace {
+
+const int kMaxSymbols = 16;
+
+// Fills |cdf| with a random inverse CDF of |nsyms| symbols, in the form the
+// coder tables use: decreasing from at most 32768 down to 0, then the
+// adaptation counter.
+void RandomCdf(ACMRandom *rnd, int nsyms, aom_cdf_prob *cdf) {
+  int values[kMaxSymbols];
+  for (int i = 0; i < nsyms - 1; ++i) values[i] = rnd->Rand16() & 32767;
+  std::sort(values, values + nsyms - 1);
+  for (int i = 0; i < nsyms - 1; ++i) cdf[i] = AOM_ICDF(values[i]);
+  for (int i = nsyms - 1; i < kMaxSymbols; ++i) cdf[i] = AOM_ICDF(32768);
+  cdf[kMaxSymbols] = 0;
+}
+
+// A uniform CDF, as the adapted tables start from.
+void UniformCdf(int nsyms, aom_cdf_prob *cdf) {
+  for (int i = 0; i < nsyms; ++i)
+    cdf[i] = AOM_ICDF(CDF_PROB_TOP * (i + 1) / nsyms);
+  cdf[nsyms] = 0;
+}
+
+// Symbols skewed towards the start of the alphabet, as most of those coded
+// are.
+int SkewedSymbol(ACMRandom *rnd, int nsyms) {
+  const int a = rnd->PseudoUniform(nsyms);
+  const int b = rnd->PseudoUniform(nsyms);
+  return std::min(a, b);
+}
+
+TEST(AV1, TestSymbolIO) {
+  const int kSymbols = 20000;
+  ACMRandom rnd(ACMRandom::DeterministicSeed());
+  std::vector<uint8_t> buffer(kSymbols * 2);
+  std::vector<int> symbols(kSymbols);
+
+  for (int nsyms = 2; nsyms <= kMaxSymbols; ++nsyms) {
+    aom_cdf_prob cdf[CDF_SIZE(kMaxSymbols)];
+    aom_writer bw;
+    aom_reader br;
+
+    for (int i = 0; i < kSymbols; ++i) symbols[i] = SkewedSymbol(&rnd, nsyms);
+
+    UniformCdf(nsyms, cdf);
+    aom_start_encode(&bw, &buffer[0]);
+    bw.allow_update_cdf = 1;
+    for (int i = 0; i < kSymbols; ++i)
+      aom_write_symbol(&bw, symbols[i], cdf, nsyms);
+    aom_stop_encode(&bw);
+
+    UniformCdf(nsyms, cdf);
+    aom_reader_init(&br, &buffer[0], bw.pos, NULL, NULL);
+    br.allow_update_cdf = 1;
+    for (int i = 0; i < kSymbols; ++i) {
+      GTEST_ASSERT_EQ(symbols[i], aom_read_symbol(&br, cdf, nsyms, NULL))
+          << "pos: " << i << " nsyms: " << nsyms;
+    }
+  }
+}
+
+// Decodes a stream of 16-symbol values with adaptation, as coefficient
+// tokens and intra modes are.
+TEST(AV1, DISABLED_SymbolDecodeSpeed) {
+  const int kSymbols = 1 << 20;
+  const int kRuns = 10;
+  ACMRandom rnd(ACMRandom::DeterministicSeed());
+  std::vector<uint8_t> buffer(kSymbols);
+  aom_cdf_prob cdf[CDF_SIZE(kMaxSymbols)];
+  aom_writer bw;
+
+  UniformCdf(kMaxSymbols, cdf);
+  aom_start_encode(&bw, &buffer[0]);
+  bw.allow_update_cdf = 1;
+  for (int i = 0; i < kSymbols; ++i)
+    aom_write_symbol(&bw, SkewedSymbol(&rnd, kMaxSymbols), cdf, kMaxSymbols);
+  aom_stop_encode(&bw);
+
+  aom_usec_timer timer;
+  int sum = 0;
+  aom_usec_timer_start(&timer);
+  for (int run = 0; run < kRuns; ++run) {
+    aom_reader br;
+    UniformCdf(kMaxSymbols, cdf);
+    aom_reader_init(&br, &buffer[0], bw.pos, NULL, NULL);
+    br.allow_update_cdf = 1;
+    for (int i = 0; i < kSymbols; ++i)
+      sum += aom_read_symbol(&br, cdf, kMaxSymbols, NULL);
+  }
+  aom_usec_timer_mark(&timer);
+  const int elapsed = static_cast<int>(aom_usec_timer_elapsed(&timer));
+  printf("%d symbols of %u bytes: %7d us, %.1f Msymbols/s (sum %d)\n",
+         kRuns * kSymbols, bw.pos, elapsed,
+         static_cast<double>(kRuns) * kSymbols / std::max(elapsed, 1), sum);
+}
+
+typedef int (*CdfSearchFunc)(unsigned c, unsigned r, const uint16_t *icdf,
+                             int nsyms);
+
+class CdfSearchTest : public ::testing::TestWithParam<CdfSearchFunc> {
+ protected:
+  virtual void SetUp() { search_ = GetParam(); }
+
+  CdfSearchFunc search_;
+};
+
+TEST_P(CdfSearchTest, MatchesC) {
+  const int kIterations = 100000;
+  ACMRandom rnd(ACMRandom::DeterministicSeed());
+  aom_cdf_prob cdf[CDF_SIZE(kMaxSymbols)];
+
+  for (int iter = 0; iter < kIterations; ++iter) {
+    const int nsyms = OD_EC_CDF_SEARCH_MIN_SYMS +
+                      rnd.PseudoUniform(kMaxSymbols -
+                                        OD_EC_CDF_SEARCH_MIN_SYMS + 1);
+    const unsigned r = 32768 + (rnd.Rand16() & 32767);
+    const unsigned c = rnd.Rand16() % r;
+    RandomCdf(&rnd, nsyms, cdf);
+    // The first symbols of an alphabet may have no probability left.
+    if (iter % 16 == 0) cdf[0] = AOM_ICDF(0);
+    ASSERT_EQ(od_ec_cdf_search_c(c, r, cdf, nsyms),
+              search_(c, r, cdf, nsyms))
+        << "nsyms: " << nsyms << " r: " << r << " c: " << c;
+  }
+}
+
+TEST_P(CdfSearchTest, DISABLED_Speed) {
+  const int kCases = 1024;
+  const int kRuns = 1000;
+  ACMRandom rnd(ACMRandom::DeterministicSeed());
+  std::vector<aom_cdf_prob> cdfs(kCases * CDF_SIZE(kMaxSymbols));
+  std::vector<unsigned> cs(kCases), rs(kCases);
+
+  for (int nsyms = OD_EC_CDF_SEARCH_MIN_SYMS; nsyms <= kMaxSymbols;
+       nsyms += OD_EC_CDF_SEARCH_MIN_SYMS) {
+    aom_usec_timer ref_timer, tst_timer;
+    int ref_sum = 0, tst_sum = 0;
+    for (int i = 0; i < kCases; ++i) {
+      RandomCdf(&rnd, nsyms, &cdfs[i * CDF_SIZE(kMaxSymbols)]);
+      rs[i] = 32768 + (rnd.Rand16() & 32767);
+      cs[i] = rnd.Rand16() % rs[i];
+    }
+    aom_usec_timer_start(&ref_timer);
+    for (int k = 0; k < kRuns; ++k) {
+      for (int i = 0; i < kCases; ++i) {
+        ref_sum += od_ec_cdf_search_c(
+            cs[i], rs[i], &cdfs[i * CDF_SIZE(kMaxSymbols)], nsyms);
+      }
+    }
+    aom_usec_timer_mark(&ref_timer);
+    aom_usec_timer_start(&tst_timer);
+    for (int k = 0; k < kRuns; ++k) {
+      for (int i = 0; i < kCases; ++i)
+        tst_sum += search_(cs[i], rs[i], &cdfs[i * CDF_SIZE(kMaxSymbols)],
+                           nsyms);
+    }
+    aom_usec_timer_mark(&tst_timer);
+    EXPECT_EQ(ref_sum, tst_sum);
+    printf("%2d symbols: ref %7d us, tst %7d us\n", nsyms,
+           static_cast<int>(aom_usec_timer_elapsed(&ref_timer)),
+           static_cast<int>(aom_usec_timer_elapsed(&tst_timer)));
+  }
+}
+
+#if HAVE_SSE2
+INSTANTIATE_TEST_CASE_P(SSE2, CdfSearchTest,
+                        ::testing::Values(od_ec_cdf_search_sse2));
+#endif
+
+#if HAVE_AVX2
+INSTANTIATE_TEST_CASE_P(AVX2, CdfSearchTest,
+                        ::testing::Values(od_ec_cdf_search_avx2));
+#endif
+
+}  // namespace
@@ -20,12 +20,14 @@
 
 namespace {
 class AVxEncoderThreadTest
-    : public ::libaom_test::CodecTestWith2Params<libaom_test::TestMode, int>,
+    : public ::libaom_test::CodecTestWith3Params<libaom_test::TestMode, int,
+                                                 int>,
       public ::libaom_test::EncoderTest {
  protected:
   AVxEncoderThreadTest()
       : EncoderTest(GET_PARAM(0)), encoder_initialized_(false),
-        encoding_mode_(GET_PARAM(1)), set_cpu_used_(GET_PARAM(2)) {
+        encoding_mode_(GET_PARAM(1)), set_cpu_used_(GET_PARAM(2)),
+        row_mt_(GET_PARAM(3)), tile_cols_(2), tile_rows_(0) {
     init_flags_ = AOM_CODEC_USE_PSNR;
     aom_codec_dec_cfg_t cfg = aom_codec_dec_cfg_t();
     cfg.w = 1280;
@@ -75,6 +77,7 @@ class AVxEncoderThreadTest
       encoder->Control(AV1E_SET_TILE_LOOPFILTER, 0);
 #endif  // CONFIG_LOOPFILTERING_ACROSS_TILES
       encoder->Control(AOME_SET_CPUUSED, set_cpu_used_);
+      encoder->Control(AV1E_SET_ROW_MT, row_mt_);
       if (encoding_mode_ != ::libaom_test::kRealTime) {
         encoder->Control(AOME_SET_ENABLEAUTOALTREF, 1);
         encoder->Control(AOME_SET_ARNR_MAXFRAMES, 7);
@@ -89,9 +92,9 @@ class AVxEncoderThreadTest
   }
 
   virtual void SetTileSize(libaom_test::Encoder *encoder) {
-    // Encode 4 tile columns.
-    encoder->Control(AV1E_SET_TILE_COLUMNS, 2);
-    encoder->Control(AV1E_SET_TILE_ROWS, 0);
+    // Encode 4 tile columns by default.
+    encoder->Control(AV1E_SET_TILE_COLUMNS, tile_cols_);
+    encoder->Control(AV1E_SET_TILE_ROWS, tile_rows_);
   }
 
   virtual void FramePktHook(const aom_codec_cx_pkt_t *pkt) {
@@ -121,11 +124,21 @@ class AVxEncoderThreadTest
     ::libaom_test::YUVVideoSource video(
         "niklas_640_480_30.yuv", AOM_IMG_FMT_I420, 640, 480, 30, 1, 15, 18);
     cfg_.rc_target_bitrate = 1000;
+    DoTest(&video);
+  }
+
+  void DoTest(::libaom_test::VideoSource *video) {
+    // Row based multi-threading is also checked with a number of threads
+    // that does not divide the number of superblock rows.
+    const int kTileThreads[] = { 1, 4 };
+    const int kRowThreads[] = { 1, 2, 4 };
+    const int *const threads = row_mt_ ? kRowThreads : kTileThreads;
+    const int num_runs = row_mt_ ? 3 : 2;
 
     // Encode using single thread.
-    cfg_.g_threads = 1;
+    cfg_.g_threads = threads[0];
     init_flags_ = AOM_CODEC_USE_PSNR;
-    ASSERT_NO_FATAL_FAILURE(RunLoop(&video));
+    ASSERT_NO_FATAL_FAILURE(RunLoop(video));
     std::vector<size_t> single_thr_size_enc;
     std::vector<std::string> single_thr_md5_enc;
     std::vector<std::string> single_thr_md5_dec;
@@ -137,27 +150,35 @@ class AVxEncoderThreadTest
     md5_dec_.clear();
 
     // Encode using multiple threads.
-    cfg_.g_threads = 4;
-    ASSERT_NO_FATAL_FAILURE(RunLoop(&video));
-    std::vector<size_t> multi_thr_size_enc;
-    std::vector<std::string> multi_thr_md5_enc;
-    std::vector<std::string> multi_thr_md5_dec;
-    multi_thr_size_enc = size_enc_;
-    multi_thr_md5_enc = md5_enc_;
-    multi_thr_md5_dec = md5_dec_;
-    size_enc_.clear();
-    md5_enc_.clear();
-    md5_dec_.clear();
+    for (int i = 1; i < num_runs; ++i) {
+      cfg_.g_threads = threads[i];
+      ASSERT_NO_FATAL_FAILURE(RunLoop(video));
+      std::vector<size_t> multi_thr_size_enc;
+      std::vector<std::string> multi_thr_md5_enc;
+      std::vector<std::string> multi_thr_md5_dec;
+      multi_thr_size_enc = size_enc_;
+      multi_thr_md5_enc = md5_enc_;
+      multi_thr_md5_dec = md5_dec_;
+      size_enc_.clear();
+      md5_enc_.clear();
+      md5_dec_.clear();
 
-    // Check that the vectors are equal.
-    ASSERT_EQ(single_thr_size_enc, multi_thr_size_enc);
-    ASSERT_EQ(single_thr_md5_enc, multi_thr_md5_enc);
-    ASSERT_EQ(single_thr_md5_dec, multi_thr_md5_dec);
+      // Check that the vectors are equal.
+      ASSERT_EQ(single_thr_size_enc, multi_thr_size_enc)
+          << "threads: " << threads[i];
+      ASSERT_EQ(single_thr_md5_enc, multi_thr_md5_enc)
+          << "threads: " << threads[i];
+      ASSERT_EQ(single_thr_md5_dec, multi_thr_md5_dec)
+          << "threads: " << threads[i];
+    }
   }
 
   bool encoder_initialized_;
   ::libaom_test::TestMode encoding_mode_;
   int set_cpu_used_;
+  int row_mt_;
+  int tile_cols_;
+  int tile_rows_;
   ::libaom_test::Decoder *decoder_;
   std::vector<size_t> size_enc_;
   std::vector<std::string> md5_enc_;
@@ -180,16 +201,82 @@ TEST_P(AVxEncoderThreadTestLarge, EncoderResultTest) {
   DoTest();
 }
 
+// Row based multi-threading, over tile layouts of one or two tile columns
+// and rows.
+class AVxEncoderRowMTTest : public AVxEncoderThreadTest {};
+
+TEST_P(AVxEncoderRowMTTest, TileLayoutTest) {
+  // log2 of the numbers of tile columns and rows.
+  const int kTileLayouts[][2] = { { 0, 0 }, { 1, 0 }, { 0, 1 }, { 1, 1 } };
+  ::libaom_test::YUVVideoSource video("hantro_collage_w352h288.yuv",
+                                      AOM_IMG_FMT_I420, 352, 288, 30, 1, 0, 4);
+  cfg_.rc_target_bitrate = 500;
+#if CONFIG_AV1 && CONFIG_EXT_TILE
+  cfg_.large_scale_tile = 0;
+#endif  // CONFIG_AV1 && CONFIG_EXT_TILE
+  for (size_t i = 0; i < sizeof(kTileLayouts) / sizeof(kTileLayouts[0]); ++i) {
+    tile_cols_ = kTileLayouts[i][0];
+    tile_rows_ = kTileLayouts[i][1];
+    SCOPED_TRACE(testing::Message() << "tile_cols: " << tile_cols_
+                                    << " tile_rows: " << tile_rows_);
+    ASSERT_NO_FATAL_FAILURE(DoTest(&video));
+  }
+}
+
+// The first pass codes its macroblock rows on the encoder workers. Its stats
+// must be the same as those of the serial first pass, so that the second pass
+// makes the same decisions.
+class AVxFirstPassThreadTest : public AVxEncoderThreadTest {
+ protected:
+  // Runs the first pass alone over video and returns its stats.
+  std::string FirstPassStats(::libaom_test::VideoSource *video, int threads) {
+    ::libaom_test::TwopassStatsStore stats;
+    cfg_.g_pass = AOM_RC_FIRST_PASS;
+    cfg_.g_threads = threads;
+    testing::internal::scoped_ptr< ::libaom_test::Encoder> encoder(
+        codec_->CreateEncoder(cfg_, deadline_, init_flags_, &stats));
+    video->Begin();
+    encoder->InitEncoder(video);
+    for (; video->img() != NULL; video->Next()) encoder->EncodeFrame(video);
+    // Flush the frames held in the lookahead.
+    encoder->EncodeFrame(video);
+    const aom_fixed_buf_t buf = stats.buf();
+    return std::string(static_cast<const char *>(buf.buf), buf.sz);
+  }
+};
+
+TEST_P(AVxFirstPassThreadTest, StatsMatchSerial) {
+  ::libaom_test::YUVVideoSource video("niklas_640_480_30.yuv", AOM_IMG_FMT_I420,
+                                      640, 480, 30, 1, 0, 10);
+  const std::string serial_stats = FirstPassStats(&video, 1);
+  ASSERT_FALSE(HasFailure());
+  ASSERT_FALSE(serial_stats.empty());
+  // Neither thread count divides the 30 macroblock rows.
+  const int kThreads[] = { 4, 7 };
+  for (size_t i = 0; i < sizeof(kThreads) / sizeof(kThreads[0]); ++i) {
+    EXPECT_TRUE(serial_stats == FirstPassStats(&video, kThreads[i]))
+        << "threads: " << kThreads[i];
+  }
+}
+
 // For AV1, only test speed 0 to 3.
 AV1_INSTANTIATE_TEST_CASE(AVxEncoderThreadTest,
                           ::testing::Values(::libaom_test::kTwoPassGood,
                                             ::libaom_test::kOnePassGood),
-                          ::testing::Range(2, 4));
+                          ::testing::Range(2, 4), ::testing::Values(0, 1));
 
 AV1_INSTANTIATE_TEST_CASE(AVxEncoderThreadTestLarge,
                           ::testing::Values(::libaom_test::kTwoPassGood,
                                             ::libaom_test::kOnePassGood),
-                          ::testing::Range(0, 2));
+                          ::testing::Range(0, 2), ::testing::Values(0, 1));
+
+AV1_INSTANTIATE_TEST_CASE(AVxEncoderRowMTTest,
+                          ::testing::Values(::libaom_test::kOnePassGood),
+                          ::testing::Values(3), ::testing::Values(1));
+
+AV1_INSTANTIATE_TEST_CASE(AVxFirstPassThreadTest,
+                          ::testing::Values(::libaom_test::kTwoPassGood),
+                          ::testing::Values(2), ::testing::Values(0));
 
 #if CONFIG_AV1 && CONFIG_EXT_TILE
 class AVxEncoderThreadLSTest : public AVxEncoderThreadTest {
@@ -216,10 +303,10 @@ TEST_P(AVxEncoderThreadLSTestLarge, EncoderResultTest) {
 AV1_INSTANTIATE_TEST_CASE(AVxEncoderThreadLSTest,
                           ::testing::Values(::libaom_test::kTwoPassGood,
                                             ::libaom_test::kOnePassGood),
-                          ::testing::Range(2, 4));
+                          ::testing::Range(2, 4), ::testing::Values(0));
 AV1_INSTANTIATE_TEST_CASE(AVxEncoderThreadLSTestLarge,
                           ::testing::Values(::libaom_test::kTwoPassGood,
                                             ::libaom_test::kOnePassGood),
-                          ::testing::Range(0, 2));
+                          ::testing::Range(0, 2), ::testing::Values(0));
 #endif  // CONFIG_AV1 && CONFIG_EXT_TILE
 }  // namespace
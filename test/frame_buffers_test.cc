@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2017, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include "third_party/googletest/src/googletest/include/gtest/gtest.h"
+
+#include "av1/common/frame_buffers.h"
+
+namespace {
+
+const size_t kSmallSize = 100000;
+const size_t kLargeSize = 400000;
+
+class FrameBuffersTest : public ::testing::Test {
+ protected:
+  virtual void SetUp() {
+    list_ = InternalFrameBufferList();
+    ASSERT_EQ(0, av1_alloc_internal_frame_buffers(&list_));
+  }
+
+  virtual void TearDown() { av1_free_internal_frame_buffers(&list_); }
+
+  aom_codec_frame_buffer_t Get(size_t size) {
+    aom_codec_frame_buffer_t fb = aom_codec_frame_buffer_t();
+    EXPECT_EQ(0, av1_get_frame_buffer(&list_, size, &fb));
+    EXPECT_TRUE(fb.data != NULL);
+    EXPECT_GE(fb.size, size);
+    return fb;
+  }
+
+  void Release(aom_codec_frame_buffer_t *fb) {
+    EXPECT_EQ(0, av1_release_frame_buffer(&list_, fb));
+  }
+
+  InternalFrameBufferList list_;
+};
+
+TEST_F(FrameBuffersTest, ReusesAcrossSizeChanges) {
+  aom_codec_frame_buffer_t small = Get(kSmallSize);
+  Release(&small);
+  EXPECT_EQ(0u, list_.pool_hits);
+  EXPECT_EQ(1u, list_.pool_misses);
+
+  // A larger frame cannot use the small buffer, and grows another one.
+  aom_codec_frame_buffer_t large = Get(kLargeSize);
+  EXPECT_NE(small.data, large.data);
+  EXPECT_EQ(2u, list_.pool_misses);
+
+  // Switching back to the small size reuses its buffer while the large one is
+  // in use, and the large one after.
+  aom_codec_frame_buffer_t small2 = Get(kSmallSize);
+  EXPECT_EQ(small.data, small2.data);
+  Release(&large);
+  Release(&small2);
+  aom_codec_frame_buffer_t large2 = Get(kLargeSize);
+  EXPECT_EQ(large.data, large2.data);
+  Release(&large2);
+  EXPECT_EQ(2u, list_.pool_hits);
+  EXPECT_EQ(2u, list_.pool_misses);
+}
+
+TEST_F(FrameBuffersTest, SlightlyLargerFramesShareBuffers) {
+  aom_codec_frame_buffer_t fb = Get(kSmallSize);
+  Release(&fb);
+  fb = Get(kSmallSize + 64);
+  Release(&fb);
+  EXPECT_EQ(1u, list_.pool_hits);
+  EXPECT_EQ(1u, list_.pool_misses);
+}
+
+TEST_F(FrameBuffersTest, PreallocatedBuffersAreHits) {
+  aom_codec_frame_buffer_t fbs[AOM_MAXIMUM_REF_BUFFERS];
+
+  ASSERT_EQ(0, av1_prealloc_internal_frame_buffers(&list_, kLargeSize));
+  for (int i = 0; i < AOM_MAXIMUM_REF_BUFFERS; ++i)
+    fbs[i] = Get(i & 1 ? kSmallSize : kLargeSize);
+  for (int i = 0; i < AOM_MAXIMUM_REF_BUFFERS; ++i) Release(&fbs[i]);
+  EXPECT_EQ(static_cast<unsigned int>(AOM_MAXIMUM_REF_BUFFERS),
+            list_.pool_hits);
+  EXPECT_EQ(0u, list_.pool_misses);
+}
+
+TEST_F(FrameBuffersTest, FailsWhenAllInUse) {
+  aom_codec_frame_buffer_t fbs[AOM_MAXIMUM_REF_BUFFERS +
+                               AOM_MAXIMUM_WORK_BUFFERS];
+  aom_codec_frame_buffer_t extra = aom_codec_frame_buffer_t();
+  const int num = list_.num_internal_frame_buffers;
+
+  ASSERT_LE(num, static_cast<int>(sizeof(fbs) / sizeof(fbs[0])));
+  for (int i = 0; i < num; ++i) fbs[i] = Get(kSmallSize);
+  EXPECT_EQ(-1, av1_get_frame_buffer(&list_, kSmallSize, &extra));
+  for (int i = 0; i < num; ++i) Release(&fbs[i]);
+}
+
+}  // namespace
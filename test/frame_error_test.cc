@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2017, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <stdio.h>
+#include <vector>
+
+#include "third_party/googletest/src/googletest/include/gtest/gtest.h"
+
+#include "./av1_rtcd.h"
+#include "test/acm_random.h"
+#include "test/clear_system_state.h"
+#include "aom_dsp/aom_dsp_common.h"
+#include "aom_ports/aom_timer.h"
+
+using libaom_test::ACMRandom;
+
+namespace {
+
+typedef int64_t (*FrameErrorFunc)(const uint8_t *const ref, int stride,
+                                  const uint8_t *const dst, int p_width,
+                                  int p_height, int p_stride);
+
+const int kMaxWidth = 128;
+const int kMaxHeight = 64;
+const int kMaxStride = kMaxWidth + 8;
+
+class FrameErrorTest : public ::testing::TestWithParam<FrameErrorFunc> {
+ protected:
+  virtual void SetUp() {
+    frame_error_ = GetParam();
+    rnd_.Reset(ACMRandom::DeterministicSeed());
+  }
+  virtual void TearDown() { libaom_test::ClearSystemState(); }
+
+  FrameErrorFunc frame_error_;
+  ACMRandom rnd_;
+};
+
+TEST_P(FrameErrorTest, MatchesC) {
+  const int kIterations = 10000;
+  std::vector<uint8_t> ref(kMaxStride * kMaxHeight);
+  std::vector<uint8_t> dst(kMaxStride * kMaxHeight);
+
+  for (int iter = 0; iter < kIterations; ++iter) {
+    const int w = 1 + rnd_.PseudoUniform(kMaxWidth);
+    const int h = 1 + rnd_.PseudoUniform(kMaxHeight);
+    const int ref_stride = w + rnd_.PseudoUniform(kMaxStride - w + 1);
+    const int dst_stride = w + rnd_.PseudoUniform(kMaxStride - w + 1);
+    // Alternate between unrelated frames, whose differences cover the whole
+    // table, and close ones, as a good warp gives.
+    for (size_t i = 0; i < ref.size(); ++i) ref[i] = rnd_.Rand8();
+    for (size_t i = 0; i < dst.size(); ++i) {
+      dst[i] = (iter & 1) ? clamp(ref[i] + rnd_.PseudoUniform(9) - 4, 0, 255)
+                          : rnd_.Rand8();
+    }
+    // Extremes of the table.
+    if (iter % 16 == 0) {
+      for (size_t i = 0; i < ref.size(); ++i) {
+        ref[i] = (i & 1) ? 255 : 0;
+        dst[i] = (i & 1) ? 0 : 255;
+      }
+    }
+    ASSERT_EQ(av1_calc_frame_error_c(&ref[0], ref_stride, &dst[0], w, h,
+                                     dst_stride),
+              frame_error_(&ref[0], ref_stride, &dst[0], w, h, dst_stride))
+        << "w: " << w << " h: " << h;
+  }
+}
+
+TEST_P(FrameErrorTest, DISABLED_Speed) {
+  const int kRuns = 100000;
+  const int kBlock = 32;
+  std::vector<uint8_t> ref(kBlock * kBlock);
+  std::vector<uint8_t> dst(kBlock * kBlock);
+  for (size_t i = 0; i < ref.size(); ++i) ref[i] = rnd_.Rand8();
+  for (size_t i = 0; i < dst.size(); ++i) dst[i] = rnd_.Rand8();
+
+  aom_usec_timer ref_timer, tst_timer;
+  int64_t ref_sum = 0, tst_sum = 0;
+  aom_usec_timer_start(&ref_timer);
+  for (int i = 0; i < kRuns; ++i) {
+    ref_sum += av1_calc_frame_error_c(&ref[0], kBlock, &dst[0], kBlock, kBlock,
+                                      kBlock);
+  }
+  aom_usec_timer_mark(&ref_timer);
+  aom_usec_timer_start(&tst_timer);
+  for (int i = 0; i < kRuns; ++i)
+    tst_sum += frame_error_(&ref[0], kBlock, &dst[0], kBlock, kBlock, kBlock);
+  aom_usec_timer_mark(&tst_timer);
+  EXPECT_EQ(ref_sum, tst_sum);
+  printf("%dx%d: ref %7d us, tst %7d us\n", kBlock, kBlock,
+         static_cast<int>(aom_usec_timer_elapsed(&ref_timer)),
+         static_cast<int>(aom_usec_timer_elapsed(&tst_timer)));
+}
+
+#if HAVE_AVX2
+INSTANTIATE_TEST_CASE_P(AVX2, FrameErrorTest,
+                        ::testing::Values(av1_calc_frame_error_avx2));
+#endif
+
+}  // namespace
@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2017, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+*/
+
+#include <string>
+#include <vector>
+#include "third_party/googletest/src/googletest/include/gtest/gtest.h"
+#include "test/codec_factory.h"
+#include "test/decode_test_driver.h"
+#include "test/encode_test_driver.h"
+#include "test/i420_video_source.h"
+#include "test/md5_helper.h"
+#include "test/util.h"
+
+namespace {
+
+typedef std::vector<std::string> FrameMd5s;
+
+// Encodes a clip and checks that decoding it in frame parallel mode outputs
+// the same frames as serial decoding, one decode call later.
+class AV1FrameParallelTest
+    : public ::libaom_test::CodecTestWithParam<libaom_test::TestMode>,
+      public ::libaom_test::EncoderTest {
+ protected:
+  AV1FrameParallelTest() : EncoderTest(GET_PARAM(0)) {}
+  virtual ~AV1FrameParallelTest() {}
+
+  virtual void SetUp() {
+    InitializeConfig();
+    SetMode(GET_PARAM(1));
+    // Alt-refs are shown again with show_existing_frame.
+    cfg_.g_lag_in_frames = 10;
+    // Random frame sizes (RESIZE_RANDOM) make inter frames predict from
+    // scaled references.
+    cfg_.rc_resize_mode = 2;
+    cfg_.rc_target_bitrate = 500;
+    packets_.clear();
+  }
+
+  virtual void PreEncodeFrameHook(::libaom_test::VideoSource *video,
+                                  ::libaom_test::Encoder *encoder) {
+    if (video->frame() == 0) {
+      encoder->Control(AOME_SET_CPUUSED, 2);
+      encoder->Control(AOME_SET_ENABLEAUTOALTREF, 1);
+      encoder->Control(AV1E_SET_TILE_COLUMNS, 1);
+#if CONFIG_LOOPFILTERING_ACROSS_TILES
+      encoder->Control(AV1E_SET_TILE_LOOPFILTER, 0);
+#endif  // CONFIG_LOOPFILTERING_ACROSS_TILES
+    }
+  }
+
+  virtual void FramePktHook(const aom_codec_cx_pkt_t *pkt) {
+    const uint8_t *const buf =
+        static_cast<const uint8_t *>(pkt->data.frame.buf);
+    packets_.push_back(std::vector<uint8_t>(buf, buf + pkt->data.frame.sz));
+  }
+
+  // Decodes all packets and then flushes the decoder. Element i of md5s
+  // holds the frames output after decode call i, the last one those output
+  // after the flush.
+  void DecodePackets(aom_codec_flags_t flags, std::vector<FrameMd5s> *md5s,
+                     std::vector<unsigned int> *widths) {
+    aom_codec_dec_cfg_t cfg = aom_codec_dec_cfg_t();
+    cfg.threads = 4;
+    cfg.allow_lowbitdepth = 1;
+    ::libaom_test::Decoder *const decoder = codec_->CreateDecoder(cfg, flags);
+    md5s->clear();
+    for (size_t i = 0; i <= packets_.size(); ++i) {
+      const aom_codec_err_t res =
+          i < packets_.size()
+              ? decoder->DecodeFrame(&packets_[i][0], packets_[i].size())
+              : decoder->DecodeFrame(NULL, 0);
+      EXPECT_EQ(AOM_CODEC_OK, res) << decoder->DecodeError();
+      if (res != AOM_CODEC_OK) break;
+
+      ::libaom_test::DxDataIterator dec_iter = decoder->GetDxData();
+      FrameMd5s frame_md5s;
+      const aom_image_t *img;
+      while ((img = dec_iter.Next()) != NULL) {
+        ::libaom_test::MD5 md5;
+        md5.Add(img);
+        frame_md5s.push_back(md5.Get());
+        if (widths != NULL) widths->push_back(img->d_w);
+      }
+      md5s->push_back(frame_md5s);
+    }
+    delete decoder;
+  }
+
+  std::vector<std::vector<uint8_t> > packets_;
+};
+
+TEST_P(AV1FrameParallelTest, MatchesSerialDecoding) {
+  ::libaom_test::I420VideoSource video("hantro_collage_w352h288.yuv", 352, 288,
+                                       30, 1, 0, 10);
+  ASSERT_NO_FATAL_FAILURE(RunLoop(&video));
+  ASSERT_FALSE(packets_.empty());
+
+  std::vector<FrameMd5s> serial_md5s;
+  std::vector<unsigned int> widths;
+  ASSERT_NO_FATAL_FAILURE(DecodePackets(0, &serial_md5s, &widths));
+  // The stream must change the frame size to exercise scaled references.
+  bool resized = false;
+  for (size_t i = 1; i < widths.size(); ++i) resized |= widths[i] != widths[0];
+  ASSERT_TRUE(resized);
+  ASSERT_TRUE(serial_md5s.back().empty());
+
+  std::vector<FrameMd5s> parallel_md5s;
+  ASSERT_NO_FATAL_FAILURE(
+      DecodePackets(AOM_CODEC_USE_FRAME_THREADING, &parallel_md5s, NULL));
+  ASSERT_EQ(serial_md5s.size(), parallel_md5s.size());
+
+  // Each frame is held back by one decode call, and the flush outputs the
+  // last one.
+  EXPECT_TRUE(parallel_md5s.front().empty());
+  for (size_t i = 1; i < parallel_md5s.size(); ++i)
+    EXPECT_EQ(serial_md5s[i - 1], parallel_md5s[i]) << "decode call: " << i;
+}
+
+// Only two pass encoding builds the GF groups that use show_existing_frame.
+AV1_INSTANTIATE_TEST_CASE(AV1FrameParallelTest,
+                          ::testing::Values(::libaom_test::kTwoPassGood));
+}  // namespace
@@ -0,0 +1,338 @@
+/*
+ * Copyright (c) 2017, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <iostream>
+#include <vector>
+
+#include "third_party/googletest/src/googletest/include/gtest/gtest.h"
+
+#include "./aom_config.h"
+#include "./ivfdec.h"
+#include "./mapped_file.h"
+#if CONFIG_OBU_NO_IVF
+#include "./obudec.h"
+#endif
+#include "./rawdec.h"
+#include "aom/aom_codec.h"
+#include "aom_ports/aom_timer.h"
+#include "aom_ports/mem_ops.h"
+#include "test/acm_random.h"
+#include "test/video_source.h"
+
+namespace {
+
+using libaom_test::ACMRandom;
+
+class MappedFileTest : public ::testing::Test {
+ protected:
+  // Writes an IVF file header and num_frames frames of up to max_size bytes,
+  // and leaves the file positioned at the first frame like file_is_ivf().
+  void WriteIvf(int num_frames, size_t max_size) {
+    ACMRandom rnd(ACMRandom::DeterministicSeed());
+    uint8_t header[IVF_FILE_HDR_SZ] = { 'D', 'K', 'I', 'F' };
+    std::vector<uint8_t> frame(max_size);
+
+    ASSERT_TRUE(file_.file() != NULL);
+    ASSERT_EQ(1u, fwrite(header, sizeof(header), 1, file_.file()));
+    frame_sizes_.clear();
+    for (int i = 0; i < num_frames; ++i) {
+      const size_t size = 1 + rnd(static_cast<int>(max_size));
+      uint8_t frame_header[IVF_FRAME_HDR_SZ] = { 0 };
+
+      mem_put_le32(frame_header, static_cast<int>(size));
+      for (size_t j = 0; j < size; ++j) frame[j] = rnd.Rand8();
+      ASSERT_EQ(1u, fwrite(frame_header, sizeof(frame_header), 1,
+                           file_.file()));
+      ASSERT_EQ(size, fwrite(&frame[0], 1, size, file_.file()));
+      frame_sizes_.push_back(size);
+    }
+    fflush(file_.file());
+    ASSERT_EQ(0, fseek(file_.file(), IVF_FILE_HDR_SZ, SEEK_SET));
+  }
+
+  // Builds a raw stream of num_frames frames of up to max_size bytes, each
+  // following its size.
+  void MakeRaw(int num_frames, size_t max_size) {
+    ACMRandom rnd(ACMRandom::DeterministicSeed());
+
+    data_.clear();
+    frame_sizes_.clear();
+    for (int i = 0; i < num_frames; ++i) {
+      const size_t size = 1 + rnd(static_cast<int>(max_size));
+      uint8_t frame_header[RAW_FRAME_HDR_SZ];
+
+      mem_put_le32(frame_header, static_cast<int>(size));
+      data_.insert(data_.end(), frame_header,
+                   frame_header + sizeof(frame_header));
+      for (size_t j = 0; j < size; ++j) data_.push_back(rnd.Rand8());
+      frame_sizes_.push_back(size);
+    }
+  }
+
+  // Builds an OBU stream of num_units temporal units, each made of a
+  // temporal delimiter and one to three OBUs of up to max_size bytes.
+  void MakeObu(int num_units, size_t max_size) {
+    ACMRandom rnd(ACMRandom::DeterministicSeed());
+
+    data_.clear();
+    frame_sizes_.clear();
+    for (int i = 0; i < num_units; ++i) {
+      const int num_obus = 1 + rnd(3);
+      size_t unit_size = 0;
+
+      AddObu(OBU_TEMPORAL_DELIMITER, 0, &rnd);
+      for (int j = 0; j < num_obus; ++j) {
+        const size_t payload_size = 1 + rnd(static_cast<int>(max_size));
+        AddObu(j == 0 ? OBU_FRAME_HEADER : OBU_TILE_GROUP, payload_size, &rnd);
+        unit_size += kObuLengthHeaderSize + payload_size;
+      }
+      frame_sizes_.push_back(unit_size);
+    }
+  }
+
+  // Writes the first size bytes of data_ to file, and leaves file positioned
+  // at offset.
+  void WriteData(FILE *file, size_t size, long offset) {
+    ASSERT_TRUE(file != NULL);
+    ASSERT_LE(size, data_.size());
+    ASSERT_EQ(size, fwrite(&data_[0], 1, size, file));
+    fflush(file);
+    ASSERT_EQ(0, fseek(file, offset, SEEK_SET));
+  }
+
+  // The size field and the header byte that precede each OBU payload.
+  static const size_t kObuLengthHeaderSize = 4 + 1;
+
+  void AddObu(OBU_TYPE type, size_t payload_size, ACMRandom *rnd) {
+    uint8_t obu_header[kObuLengthHeaderSize];
+
+    last_obu_offset_ = data_.size();
+    mem_put_le32(obu_header, static_cast<int>(payload_size + 1));
+    obu_header[4] = static_cast<uint8_t>(type << 3);
+    data_.insert(data_.end(), obu_header, obu_header + sizeof(obu_header));
+    for (size_t i = 0; i < payload_size; ++i) data_.push_back(rnd->Rand8());
+  }
+
+  libaom_test::TempOutFile file_;
+  std::vector<uint8_t> data_;
+  size_t last_obu_offset_;
+  std::vector<size_t> frame_sizes_;
+};
+
+TEST_F(MappedFileTest, ReadsSameFramesAsFread) {
+  const int kNumFrames = 50;
+  AvxMappedFile mapped;
+  uint8_t *buffer = NULL;
+  size_t buffer_size = 0;
+  const uint8_t *frame;
+  size_t frame_size;
+  size_t mapped_size;
+
+  WriteIvf(kNumFrames, 4096);
+  ASSERT_EQ(1, mapped_file_open(&mapped, file_.file()));
+  for (int i = 0; i < kNumFrames; ++i) {
+    ASSERT_EQ(0, ivf_read_frame(file_.file(), &buffer, &frame_size,
+                                &buffer_size));
+    ASSERT_EQ(0, ivf_read_frame_mapped(&mapped, &frame, &mapped_size));
+    ASSERT_EQ(frame_sizes_[i], frame_size);
+    ASSERT_EQ(frame_size, mapped_size);
+    ASSERT_EQ(0, memcmp(buffer, frame, frame_size));
+  }
+  EXPECT_NE(0, ivf_read_frame(file_.file(), &buffer, &frame_size,
+                              &buffer_size));
+  EXPECT_NE(0, ivf_read_frame_mapped(&mapped, &frame, &mapped_size));
+
+  mapped_file_close(&mapped);
+  EXPECT_TRUE(mapped.data == NULL);
+  free(buffer);
+}
+
+TEST_F(MappedFileTest, ReadsSameRawFramesAsFread) {
+  const int kNumFrames = 20;
+  AvxMappedFile mapped;
+  uint8_t *buffer = NULL;
+  size_t buffer_size = 0;
+  const uint8_t *frame;
+  size_t frame_size;
+  size_t mapped_size;
+
+  MakeRaw(kNumFrames, 4096);
+  WriteData(file_.file(), data_.size(), 0);
+  ASSERT_EQ(1, mapped_file_open(&mapped, file_.file()));
+  for (int i = 0; i < kNumFrames; ++i) {
+    ASSERT_EQ(0, raw_read_frame(file_.file(), &buffer, &frame_size,
+                                &buffer_size));
+    ASSERT_EQ(0, raw_read_frame_mapped(&mapped, &frame, &mapped_size));
+    ASSERT_EQ(frame_sizes_[i], frame_size);
+    ASSERT_EQ(frame_size, mapped_size);
+    ASSERT_EQ(0, memcmp(buffer, frame, frame_size));
+  }
+  EXPECT_NE(0, raw_read_frame_mapped(&mapped, &frame, &mapped_size));
+
+  mapped_file_close(&mapped);
+  free(buffer);
+}
+
+TEST_F(MappedFileTest, StopsAtTruncatedRawFrame) {
+  const int kNumFrames = 4;
+  AvxMappedFile mapped;
+  uint8_t *buffer = NULL;
+  size_t buffer_size = 0;
+  const uint8_t *frame;
+  size_t frame_size;
+  size_t mapped_size;
+
+  // Cut the last frame short of one byte of its payload.
+  MakeRaw(kNumFrames, 4096);
+  WriteData(file_.file(), data_.size() - 1, 0);
+  ASSERT_EQ(1, mapped_file_open(&mapped, file_.file()));
+  for (int i = 0; i < kNumFrames - 1; ++i) {
+    ASSERT_EQ(0, raw_read_frame(file_.file(), &buffer, &frame_size,
+                                &buffer_size));
+    ASSERT_EQ(0, raw_read_frame_mapped(&mapped, &frame, &mapped_size));
+    ASSERT_EQ(frame_size, mapped_size);
+    ASSERT_EQ(0, memcmp(buffer, frame, frame_size));
+  }
+  EXPECT_NE(0, raw_read_frame(file_.file(), &buffer, &frame_size,
+                              &buffer_size));
+  EXPECT_NE(0, raw_read_frame_mapped(&mapped, &frame, &mapped_size));
+  mapped_file_close(&mapped);
+  free(buffer);
+}
+
+TEST_F(MappedFileTest, StopsAtTruncatedRawFrameSize) {
+  AvxMappedFile mapped;
+  const uint8_t *frame;
+  size_t mapped_size;
+
+  // Follow a frame with half a frame size. raw_read_frame() takes this for
+  // the end of the stream and the mapped reader for an error, so both stop.
+  MakeRaw(1, 4096);
+  data_.resize(data_.size() + RAW_FRAME_HDR_SZ / 2, 0);
+  WriteData(file_.file(), data_.size(), 0);
+  ASSERT_EQ(1, mapped_file_open(&mapped, file_.file()));
+  EXPECT_EQ(0, raw_read_frame_mapped(&mapped, &frame, &mapped_size));
+  EXPECT_EQ(frame_sizes_[0], mapped_size);
+  EXPECT_NE(0, raw_read_frame_mapped(&mapped, &frame, &mapped_size));
+  mapped_file_close(&mapped);
+}
+
+#if CONFIG_OBU_NO_IVF && CONFIG_ADD_4BYTES_OBUSIZE
+TEST_F(MappedFileTest, ReadsSameTemporalUnitsAsFread) {
+  const int kNumUnits = 20;
+  AvxMappedFile mapped;
+  uint8_t *buffer = NULL;
+  size_t buffer_size = 0;
+  const uint8_t *unit;
+  size_t unit_size;
+  size_t mapped_size;
+
+  // Start after the first temporal delimiter, like file_is_obu().
+  MakeObu(kNumUnits, 4096);
+  WriteData(file_.file(), data_.size(), kObuLengthHeaderSize);
+  ASSERT_EQ(1, mapped_file_open(&mapped, file_.file()));
+  for (int i = 0; i < kNumUnits; ++i) {
+    ASSERT_EQ(0, obu_read_temporal_unit(file_.file(), &buffer, &unit_size,
+                                        &buffer_size));
+    ASSERT_EQ(0, obu_read_temporal_unit_mapped(&mapped, &unit, &mapped_size));
+    ASSERT_EQ(frame_sizes_[i], unit_size);
+    ASSERT_EQ(unit_size, mapped_size);
+    ASSERT_EQ(0, memcmp(buffer, unit, unit_size));
+  }
+  EXPECT_NE(0, obu_read_temporal_unit(file_.file(), &buffer, &unit_size,
+                                      &buffer_size));
+  EXPECT_NE(0, obu_read_temporal_unit_mapped(&mapped, &unit, &mapped_size));
+
+  mapped_file_close(&mapped);
+  free(buffer);
+}
+
+TEST_F(MappedFileTest, StopsAtTruncatedTemporalUnit) {
+  const int kNumUnits = 4;
+  const uint8_t *unit;
+  size_t unit_size;
+  size_t mapped_size;
+
+  MakeObu(kNumUnits, 4096);
+  // Cut the stream in the payload, then in the header, of its last OBU.
+  const size_t sizes[] = { data_.size() - 1, last_obu_offset_ + 3 };
+  for (int n = 0; n < 2; ++n) {
+    libaom_test::TempOutFile file;
+    AvxMappedFile mapped;
+    uint8_t *buffer = NULL;
+    size_t buffer_size = 0;
+
+    WriteData(file.file(), sizes[n], kObuLengthHeaderSize);
+    ASSERT_EQ(1, mapped_file_open(&mapped, file.file()));
+    for (int i = 0; i < kNumUnits - 1; ++i) {
+      ASSERT_EQ(0, obu_read_temporal_unit(file.file(), &buffer, &unit_size,
+                                          &buffer_size));
+      ASSERT_EQ(0,
+                obu_read_temporal_unit_mapped(&mapped, &unit, &mapped_size));
+      ASSERT_EQ(unit_size, mapped_size);
+      ASSERT_EQ(0, memcmp(buffer, unit, unit_size));
+    }
+    EXPECT_NE(0, obu_read_temporal_unit(file.file(), &buffer, &unit_size,
+                                        &buffer_size));
+    EXPECT_NE(0, obu_read_temporal_unit_mapped(&mapped, &unit, &mapped_size));
+    mapped_file_close(&mapped);
+    free(buffer);
+  }
+}
+#endif  // CONFIG_OBU_NO_IVF && CONFIG_ADD_4BYTES_OBUSIZE
+
+TEST_F(MappedFileTest, DISABLED_Speed) {
+  const int kNumFrames = 2000;
+  const int kNumPasses = 10;
+  AvxMappedFile mapped;
+  uint8_t *buffer = NULL;
+  size_t buffer_size = 0;
+  const uint8_t *frame;
+  size_t frame_size;
+  uint32_t fread_sum = 0, mapped_sum = 0;
+
+  // About 64 MB, read as a decoder would: each frame once, a byte at a time.
+  WriteIvf(kNumFrames, 64 * 1024);
+
+  aom_usec_timer fread_timer;
+  aom_usec_timer_start(&fread_timer);
+  for (int n = 0; n < kNumPasses; ++n) {
+    ASSERT_EQ(0, fseek(file_.file(), IVF_FILE_HDR_SZ, SEEK_SET));
+    while (!ivf_read_frame(file_.file(), &buffer, &frame_size, &buffer_size)) {
+      for (size_t i = 0; i < frame_size; ++i) fread_sum += buffer[i];
+    }
+  }
+  aom_usec_timer_mark(&fread_timer);
+  const int64_t fread_time = aom_usec_timer_elapsed(&fread_timer);
+
+  aom_usec_timer mapped_timer;
+  aom_usec_timer_start(&mapped_timer);
+  for (int n = 0; n < kNumPasses; ++n) {
+    ASSERT_EQ(0, fseek(file_.file(), IVF_FILE_HDR_SZ, SEEK_SET));
+    ASSERT_EQ(1, mapped_file_open(&mapped, file_.file()));
+    while (!ivf_read_frame_mapped(&mapped, &frame, &frame_size)) {
+      for (size_t i = 0; i < frame_size; ++i) mapped_sum += frame[i];
+    }
+    mapped_file_close(&mapped);
+  }
+  aom_usec_timer_mark(&mapped_timer);
+  const int64_t mapped_time = aom_usec_timer_elapsed(&mapped_timer);
+
+  EXPECT_EQ(fread_sum, mapped_sum);
+  std::cout << "[          ] fread time = " << fread_time / 1000
+            << " ms, mapped time = " << mapped_time / 1000 << " ms\n";
+  free(buffer);
+}
+
+}  // namespace
@@ -0,0 +1,292 @@
+/*
+ * Copyright (c) 2017, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include "third_party/googletest/src/googletest/include/gtest/gtest.h"
+
+#include "./aom_config.h"
+#include "aom_util/aom_scheduler.h"
+
+namespace {
+
+const int kNumTasks = 16;
+const int kNumJobs = 100;
+
+struct JobState {
+#if CONFIG_MULTITHREAD
+  pthread_mutex_t mutex;
+#endif
+  int done;
+};
+
+int GetJobsDone(JobState *state) {
+#if CONFIG_MULTITHREAD
+  pthread_mutex_lock(&state->mutex);
+  const int done = state->done;
+  pthread_mutex_unlock(&state->mutex);
+  return done;
+#else
+  return state->done;
+#endif
+}
+
+void SetJobsDone(JobState *state, int done) {
+#if CONFIG_MULTITHREAD
+  pthread_mutex_lock(&state->mutex);
+  state->done = done;
+  pthread_mutex_unlock(&state->mutex);
+#else
+  state->done = done;
+#endif
+}
+
+struct TaskData {
+  AVxTaskGroup *group;
+  int runs;
+  int jobs;
+  int result;
+};
+
+int CountRuns(void *data1, void *data2) {
+  TaskData *const task = reinterpret_cast<TaskData *>(data1);
+  (void)data2;
+  ++task->runs;
+  return task->result;
+}
+
+// Takes jobs from the group until there are none left. Each job waits for the
+// previous one to finish, as the row based encoder and decoder workers do.
+int RunJobs(void *data1, void *data2) {
+  TaskData *const task = reinterpret_cast<TaskData *>(data1);
+  JobState *const state = reinterpret_cast<JobState *>(data2);
+  int job;
+
+  while ((job = aom_task_group_next_job(task->group)) < kNumJobs) {
+    while (GetJobsDone(state) < job) {
+    }
+    ++task->jobs;
+    SetJobsDone(state, job + 1);
+  }
+  return 1;
+}
+
+class AVxSchedulerTest : public ::testing::TestWithParam<int> {
+ protected:
+  virtual void SetUp() {
+    scheduler_ = aom_scheduler_create(GetParam());
+    ASSERT_TRUE(scheduler_ != NULL);
+    aom_task_group_init(&group_);
+  }
+
+  virtual void TearDown() {
+    aom_task_group_destroy(&group_);
+    aom_scheduler_destroy(scheduler_);
+  }
+
+  AVxScheduler *scheduler_;
+  AVxTaskGroup group_;
+};
+
+TEST_P(AVxSchedulerTest, RunsEveryTaskOnce) {
+  TaskData tasks[kNumTasks] = {};
+
+  for (int n = 0; n < 3; ++n) {
+    for (int i = 0; i < kNumTasks; ++i) {
+      tasks[i].result = 1;
+      aom_scheduler_submit(scheduler_, &group_, CountRuns, &tasks[i], NULL);
+    }
+    EXPECT_TRUE(aom_scheduler_wait(scheduler_, &group_));
+    for (int i = 0; i < kNumTasks; ++i) EXPECT_EQ(n + 1, tasks[i].runs);
+  }
+}
+
+TEST_P(AVxSchedulerTest, ReportsErrors) {
+  TaskData tasks[kNumTasks] = {};
+
+  for (int i = 0; i < kNumTasks; ++i) {
+    tasks[i].result = i != kNumTasks / 2;
+    aom_scheduler_submit(scheduler_, &group_, CountRuns, &tasks[i], NULL);
+  }
+  EXPECT_FALSE(aom_scheduler_wait(scheduler_, &group_));
+
+  // The error is cleared for the next set of tasks.
+  tasks[kNumTasks / 2].result = 1;
+  aom_scheduler_submit(scheduler_, &group_, CountRuns, &tasks[kNumTasks / 2],
+                       NULL);
+  EXPECT_TRUE(aom_scheduler_wait(scheduler_, &group_));
+}
+
+TEST_P(AVxSchedulerTest, SharesOutDependentJobs) {
+  TaskData tasks[kNumTasks] = {};
+  JobState state;
+
+#if CONFIG_MULTITHREAD
+  pthread_mutex_init(&state.mutex, NULL);
+#endif
+  for (int n = 0; n < 3; ++n) {
+    int total = 0;
+
+    state.done = 0;
+    for (int i = 0; i < kNumTasks; ++i) {
+      tasks[i].group = &group_;
+      tasks[i].jobs = 0;
+      aom_scheduler_submit(scheduler_, &group_, RunJobs, &tasks[i], &state);
+    }
+    EXPECT_TRUE(aom_scheduler_wait(scheduler_, &group_));
+    for (int i = 0; i < kNumTasks; ++i) total += tasks[i].jobs;
+    EXPECT_EQ(kNumJobs, state.done);
+    EXPECT_EQ(kNumJobs, total);
+  }
+#if CONFIG_MULTITHREAD
+  pthread_mutex_destroy(&state.mutex);
+#endif
+}
+
+TEST(AVxSchedulerSharedTest, GrowsAndIsShared) {
+  AVxScheduler *const s1 = aom_scheduler_acquire(NULL, 1);
+  AVxScheduler *const s2 = aom_scheduler_acquire(NULL, 3);
+  ASSERT_TRUE(s1 != NULL);
+  EXPECT_EQ(s1, s2);
+#if CONFIG_MULTITHREAD
+  EXPECT_GE(aom_scheduler_num_threads(s2), 3);
+#else
+  EXPECT_EQ(0, aom_scheduler_num_threads(s2));
+#endif
+  aom_scheduler_release(s2);
+  aom_scheduler_release(s1);
+}
+
+#if CONFIG_MULTITHREAD
+const int kPoolThreads = 3;
+
+// A minimal application thread pool: a queue of tasks run by kPoolThreads
+// threads.
+class TestThreadPool {
+ public:
+  TestThreadPool() : head_(0), tail_(0), running_(0), shutdown_(0) {
+    pthread_mutex_init(&mutex_, NULL);
+    pthread_cond_init(&cond_, NULL);
+    for (int i = 0; i < kPoolThreads; ++i)
+      pthread_create(&threads_[i], NULL, ThreadLoop, this);
+    pool_.priv = this;
+    pool_.num_threads = kPoolThreads;
+    pool_.submit = Submit;
+    pool_.wait = Wait;
+  }
+
+  ~TestThreadPool() {
+    pthread_mutex_lock(&mutex_);
+    shutdown_ = 1;
+    pthread_cond_broadcast(&cond_);
+    pthread_mutex_unlock(&mutex_);
+    for (int i = 0; i < kPoolThreads; ++i) pthread_join(threads_[i], NULL);
+    pthread_cond_destroy(&cond_);
+    pthread_mutex_destroy(&mutex_);
+  }
+
+  const aom_thread_pool_t *pool() const { return &pool_; }
+  int submitted() const { return tail_; }
+
+ private:
+  static const int kMaxTasks = 1024;
+
+  static int Submit(void *priv, aom_thread_pool_task_fn_t fn, void *arg) {
+    TestThreadPool *const p = reinterpret_cast<TestThreadPool *>(priv);
+    pthread_mutex_lock(&p->mutex_);
+    if (p->tail_ == kMaxTasks) {
+      pthread_mutex_unlock(&p->mutex_);
+      return -1;
+    }
+    p->tasks_[p->tail_].fn = fn;
+    p->tasks_[p->tail_].arg = arg;
+    ++p->tail_;
+    pthread_cond_broadcast(&p->cond_);
+    pthread_mutex_unlock(&p->mutex_);
+    return 0;
+  }
+
+  static void Wait(void *priv) {
+    TestThreadPool *const p = reinterpret_cast<TestThreadPool *>(priv);
+    pthread_mutex_lock(&p->mutex_);
+    while (p->head_ < p->tail_ || p->running_ > 0)
+      pthread_cond_wait(&p->cond_, &p->mutex_);
+    pthread_mutex_unlock(&p->mutex_);
+  }
+
+  static void *ThreadLoop(void *arg) {
+    TestThreadPool *const p = reinterpret_cast<TestThreadPool *>(arg);
+    pthread_mutex_lock(&p->mutex_);
+    while (!p->shutdown_) {
+      if (p->head_ < p->tail_) {
+        const Task task = p->tasks_[p->head_++];
+        ++p->running_;
+        pthread_mutex_unlock(&p->mutex_);
+        task.fn(task.arg);
+        pthread_mutex_lock(&p->mutex_);
+        --p->running_;
+        pthread_cond_broadcast(&p->cond_);
+      } else {
+        pthread_cond_wait(&p->cond_, &p->mutex_);
+      }
+    }
+    pthread_mutex_unlock(&p->mutex_);
+    return NULL;
+  }
+
+  struct Task {
+    aom_thread_pool_task_fn_t fn;
+    void *arg;
+  };
+
+  aom_thread_pool_t pool_;
+  pthread_t threads_[kPoolThreads];
+  pthread_mutex_t mutex_;
+  pthread_cond_t cond_;
+  Task tasks_[kMaxTasks];
+  int head_;
+  int tail_;
+  int running_;
+  int shutdown_;
+};
+
+TEST(AVxSchedulerPoolTest, RunsTasksOnPool) {
+  TestThreadPool pool;
+  AVxScheduler *const s = aom_scheduler_acquire(pool.pool(), 0);
+  AVxTaskGroup group;
+  TaskData tasks[kNumTasks] = {};
+  JobState state;
+
+  ASSERT_TRUE(s != NULL);
+  EXPECT_EQ(kPoolThreads, aom_scheduler_num_threads(s));
+  aom_task_group_init(&group);
+  pthread_mutex_init(&state.mutex, NULL);
+  state.done = 0;
+  for (int i = 0; i < kNumTasks; ++i) {
+    tasks[i].group = &group;
+    aom_scheduler_submit(s, &group, RunJobs, &tasks[i], &state);
+  }
+  EXPECT_TRUE(aom_scheduler_wait(s, &group));
+  EXPECT_EQ(kNumJobs, state.done);
+  EXPECT_EQ(kNumTasks, pool.submitted());
+
+  pthread_mutex_destroy(&state.mutex);
+  aom_task_group_destroy(&group);
+  aom_scheduler_release(s);
+}
+#endif  // CONFIG_MULTITHREAD
+
+#if CONFIG_MULTITHREAD
+INSTANTIATE_TEST_CASE_P(Scheduler, AVxSchedulerTest,
+                        ::testing::Values(0, 1, 4));
+#else
+INSTANTIATE_TEST_CASE_P(Scheduler, AVxSchedulerTest, ::testing::Values(0));
+#endif
+
+}  // namespace
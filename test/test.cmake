@@ -86,11 +86,16 @@ if (NOT BUILD_SHARED_LIBS)
         "${AOM_ROOT}/test/warp_filter_test_util.cc"
         "${AOM_ROOT}/test/warp_filter_test_util.h")
   endif ()
+
+  set(AOM_UNIT_TEST_COMMON_SOURCES
+      ${AOM_UNIT_TEST_COMMON_SOURCES}
+      "${AOM_ROOT}/test/frame_error_test.cc")
 endif ()
 
 set(AOM_UNIT_TEST_DECODER_SOURCES
     "${AOM_ROOT}/test/decode_api_test.cc"
-    "${AOM_ROOT}/test/ivf_video_source.h")
+    "${AOM_ROOT}/test/ivf_video_source.h"
+    "${AOM_ROOT}/test/mapped_file_test.cc")
 
 set(AOM_UNIT_TEST_ENCODER_SOURCES
     "${AOM_ROOT}/test/altref_test.cc"
@@ -102,6 +107,7 @@ set(AOM_UNIT_TEST_ENCODER_SOURCES
     "${AOM_ROOT}/test/error_resilience_test.cc"
     "${AOM_ROOT}/test/i420_video_source.h"
     "${AOM_ROOT}/test/resize_test.cc"
+    "${AOM_ROOT}/test/y4m_filter_test.cc"
     "${AOM_ROOT}/test/y4m_test.cc"
     "${AOM_ROOT}/test/y4m_video_source.h"
     "${AOM_ROOT}/test/yuv_video_source.h")
@@ -128,8 +134,10 @@ if (NOT BUILD_SHARED_LIBS)
         ${AOM_UNIT_TEST_COMMON_SOURCES}
         "${AOM_ROOT}/test/av1_convolve_optimz_test.cc"
         "${AOM_ROOT}/test/av1_convolve_test.cc"
+        "${AOM_ROOT}/test/frame_buffers_test.cc"
         "${AOM_ROOT}/test/intrapred_test.cc"
         "${AOM_ROOT}/test/lpf_test.cc"
+        "${AOM_ROOT}/test/scheduler_test.cc"
         "${AOM_ROOT}/test/simd_cmp_impl.h")
 
     set(AOM_UNIT_TEST_ENCODER_SOURCES
@@ -153,6 +161,12 @@ if (NOT BUILD_SHARED_LIBS)
             "${AOM_ROOT}/test/intrabc_test.cc")
     endif ()
 
+    if (CONFIG_CFL)
+      set(AOM_UNIT_TEST_COMMON_SOURCES
+          ${AOM_UNIT_TEST_COMMON_SOURCES}
+          "${AOM_ROOT}/test/cfl_test.cc")
+    endif ()
+
     if (CONFIG_LOOP_RESTORATION)
       set(AOM_UNIT_TEST_COMMON_SOURCES
           ${AOM_UNIT_TEST_COMMON_SOURCES}
@@ -287,6 +301,7 @@ if (NOT BUILD_SHARED_LIBS)
         ${AOM_UNIT_TEST_COMMON_SOURCES}
         "${AOM_ROOT}/test/divu_small_test.cc"
         "${AOM_ROOT}/test/ethread_test.cc"
+        "${AOM_ROOT}/test/frame_parallel_test.cc"
         "${AOM_ROOT}/test/coding_path_sync.cc"
         "${AOM_ROOT}/test/idct8x8_test.cc"
         "${AOM_ROOT}/test/partial_idct_test.cc"
@@ -296,7 +311,9 @@ if (NOT BUILD_SHARED_LIBS)
     set(AOM_UNIT_TEST_COMMON_SOURCES
         ${AOM_UNIT_TEST_COMMON_SOURCES}
         "${AOM_ROOT}/test/binary_codes_test.cc"
-        "${AOM_ROOT}/test/boolcoder_test.cc")
+        "${AOM_ROOT}/test/boolcoder_test.cc"
+        "${AOM_ROOT}/test/entdec_test.cc"
+        "${AOM_ROOT}/test/update_cdf_test.cc")
 
     if (CONFIG_EXT_TILE)
       set(AOM_UNIT_TEST_COMMON_SOURCES
@@ -29,6 +29,11 @@ LIBAOM_TEST_SRCS-yes += function_equivalence_test.h
 LIBAOM_TEST_SRCS-yes                   += ../md5_utils.h ../md5_utils.c
 LIBAOM_TEST_SRCS-$(CONFIG_AV1_DECODER)    += ivf_video_source.h
 LIBAOM_TEST_SRCS-$(CONFIG_AV1_ENCODER)    += ../y4minput.h ../y4minput.c
+LIBAOM_TEST_SRCS-$(CONFIG_AV1_ENCODER)    += ../y4minput_dsp.h
+ifeq ($(CONFIG_AV1_ENCODER),yes)
+LIBAOM_TEST_SRCS-$(HAVE_SSE2)             += ../y4minput_sse2.c
+LIBAOM_TEST_SRCS-$(HAVE_AVX2)             += ../y4minput_avx2.c
+endif
 LIBAOM_TEST_SRCS-$(CONFIG_AV1_ENCODER)    += altref_test.cc
 LIBAOM_TEST_SRCS-$(CONFIG_AV1_ENCODER)    += aq_segment_test.cc
 LIBAOM_TEST_SRCS-$(CONFIG_AV1_ENCODER)    += datarate_test.cc
@@ -58,6 +63,7 @@ LIBAOM_TEST_SRCS-$(CONFIG_AV1_ENCODER)    += ../ivfenc.c ../ivfenc.h
 
 ## Y4m parsing.
 LIBAOM_TEST_SRCS-$(CONFIG_AV1_ENCODER)    += y4m_test.cc ../y4menc.c ../y4menc.h
+LIBAOM_TEST_SRCS-$(CONFIG_AV1_ENCODER)    += y4m_filter_test.cc
 
 ## WebM Parsing
 ifeq ($(CONFIG_WEBM_IO), yes)
@@ -112,12 +118,15 @@ LIBAOM_TEST_SRCS-yes                   += partial_idct_test.cc
 LIBAOM_TEST_SRCS-yes                   += superframe_test.cc
 LIBAOM_TEST_SRCS-yes                   += tile_independence_test.cc
 LIBAOM_TEST_SRCS-yes                   += ethread_test.cc
+LIBAOM_TEST_SRCS-yes                   += frame_parallel_test.cc
 LIBAOM_TEST_SRCS-yes                   += motion_vector_test.cc
 LIBAOM_TEST_SRCS-yes                   += binary_codes_test.cc
 ifeq ($(CONFIG_EXT_TILE),yes)
 LIBAOM_TEST_SRCS-yes                   += av1_ext_tile_test.cc
 endif
 LIBAOM_TEST_SRCS-yes                   += boolcoder_test.cc
+LIBAOM_TEST_SRCS-yes                   += entdec_test.cc
+LIBAOM_TEST_SRCS-yes                   += update_cdf_test.cc
 ifeq ($(CONFIG_ACCOUNTING),yes)
 LIBAOM_TEST_SRCS-yes                   += accounting_test.cc
 endif
@@ -147,8 +156,11 @@ LIBAOM_TEST_SRCS-$(HAVE_SSE4_1)        += simd_sse4_test.cc
 LIBAOM_TEST_SRCS-$(HAVE_AVX2)          += simd_avx2_test.cc
 LIBAOM_TEST_SRCS-$(HAVE_NEON)          += simd_neon_test.cc
 LIBAOM_TEST_SRCS-yes                   += intrapred_test.cc
+LIBAOM_TEST_SRCS-yes                   += scheduler_test.cc
+LIBAOM_TEST_SRCS-yes                   += frame_buffers_test.cc
 LIBAOM_TEST_SRCS-$(CONFIG_LV_MAP)      += txb_test.cc
 LIBAOM_TEST_SRCS-$(CONFIG_INTRABC)     += intrabc_test.cc
+LIBAOM_TEST_SRCS-$(CONFIG_CFL)         += cfl_test.cc
 #LIBAOM_TEST_SRCS-$(CONFIG_AV1_DECODER) += av1_thread_test.cc
 LIBAOM_TEST_SRCS-$(CONFIG_AV1_ENCODER) += dct16x16_test.cc
 LIBAOM_TEST_SRCS-$(CONFIG_AV1_ENCODER) += dct32x32_test.cc
@@ -221,6 +233,7 @@ LIBAOM_TEST_SRCS-$(CONFIG_AV1) += av1_convolve_test.cc
 LIBAOM_TEST_SRCS-$(CONFIG_AV1) += av1_convolve_optimz_test.cc
 LIBAOM_TEST_SRCS-$(HAVE_SSE2) += warp_filter_test_util.h
 LIBAOM_TEST_SRCS-$(HAVE_SSE2) += warp_filter_test.cc warp_filter_test_util.cc
+LIBAOM_TEST_SRCS-$(CONFIG_AV1) += frame_error_test.cc
 ifeq ($(CONFIG_LOOP_RESTORATION),yes)
 LIBAOM_TEST_SRCS-$(HAVE_SSE2) += hiprec_convolve_test_util.h
 LIBAOM_TEST_SRCS-$(HAVE_SSE2) += hiprec_convolve_test.cc
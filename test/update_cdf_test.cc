@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2017, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+
+#include "third_party/googletest/src/googletest/include/gtest/gtest.h"
+
+#include "./aom_dsp_rtcd.h"
+#include "test/acm_random.h"
+#include "aom_dsp/prob.h"
+#include "aom_ports/aom_timer.h"
+
+using libaom_test::ACMRandom;
+
+namespace {
+
+const int kMaxSymbols = 16;
+// Room for the entries past the CDF, which the kernels must not touch.
+const int kCdfBufferSize = CDF_SIZE(kMaxSymbols) + 8;
+
+typedef void (*UpdateCdfFunc)(uint16_t *cdf, int val, int nsymbs);
+
+class UpdateCdfTest : public ::testing::TestWithParam<UpdateCdfFunc> {
+ protected:
+  virtual void SetUp() { update_ = GetParam(); }
+
+  // Fills |cdf| with a random inverse CDF of |nsyms| symbols, with a random
+  // adaptation counter, and the rest of the buffer with noise.
+  void RandomCdf(ACMRandom *rnd, int nsyms, aom_cdf_prob *cdf) {
+    int values[kMaxSymbols];
+    for (int i = 0; i < nsyms - 1; ++i) values[i] = rnd->Rand16() & 32767;
+    std::sort(values, values + nsyms - 1);
+    for (int i = 0; i < nsyms - 1; ++i) cdf[i] = AOM_ICDF(values[i]);
+    cdf[nsyms - 1] = AOM_ICDF(CDF_PROB_TOP);
+    cdf[nsyms] = rnd->PseudoUniform(33);
+    for (int i = nsyms + 1; i < kCdfBufferSize; ++i) cdf[i] = rnd->Rand16();
+  }
+
+  UpdateCdfFunc update_;
+};
+
+TEST_P(UpdateCdfTest, MatchesC) {
+  const int kIterations = 100000;
+  ACMRandom rnd(ACMRandom::DeterministicSeed());
+  aom_cdf_prob ref[kCdfBufferSize];
+  aom_cdf_prob tst[kCdfBufferSize];
+
+  for (int iter = 0; iter < kIterations; ++iter) {
+    const int nsyms =
+        AOM_UPDATE_CDF_MIN_SYMS +
+        rnd.PseudoUniform(kMaxSymbols - AOM_UPDATE_CDF_MIN_SYMS + 1);
+    const int val = rnd.PseudoUniform(nsyms);
+    RandomCdf(&rnd, nsyms, ref);
+    // Symbols may have no probability left at either end of the alphabet.
+    if (iter % 16 == 0) ref[0] = AOM_ICDF(0);
+    if (iter % 16 == 1) ref[nsyms - 2] = AOM_ICDF(CDF_PROB_TOP);
+    memcpy(tst, ref, sizeof(ref));
+    aom_update_cdf_c(ref, val, nsyms);
+    update_(tst, val, nsyms);
+    for (int i = 0; i < kCdfBufferSize; ++i) {
+      ASSERT_EQ(ref[i], tst[i]) << "nsyms: " << nsyms << " val: " << val
+                                << " entry: " << i;
+    }
+  }
+}
+
+TEST_P(UpdateCdfTest, DISABLED_Speed) {
+  const int kRuns = 10000000;
+  ACMRandom rnd(ACMRandom::DeterministicSeed());
+
+  for (int nsyms = AOM_UPDATE_CDF_MIN_SYMS; nsyms <= kMaxSymbols; nsyms += 4) {
+    aom_cdf_prob ref[kCdfBufferSize];
+    aom_cdf_prob tst[kCdfBufferSize];
+    aom_usec_timer ref_timer, tst_timer;
+    RandomCdf(&rnd, nsyms, ref);
+    memcpy(tst, ref, sizeof(ref));
+    aom_usec_timer_start(&ref_timer);
+    for (int k = 0; k < kRuns; ++k) aom_update_cdf_c(ref, k % nsyms, nsyms);
+    aom_usec_timer_mark(&ref_timer);
+    aom_usec_timer_start(&tst_timer);
+    for (int k = 0; k < kRuns; ++k) update_(tst, k % nsyms, nsyms);
+    aom_usec_timer_mark(&tst_timer);
+    EXPECT_EQ(0, memcmp(ref, tst, sizeof(ref)));
+    printf("%2d symbols: ref %7d us, tst %7d us\n", nsyms,
+           static_cast<int>(aom_usec_timer_elapsed(&ref_timer)),
+           static_cast<int>(aom_usec_timer_elapsed(&tst_timer)));
+  }
+}
+
+#if HAVE_SSE2
+INSTANTIATE_TEST_CASE_P(SSE2, UpdateCdfTest,
+                        ::testing::Values(aom_update_cdf_sse2));
+#endif
+
+#if HAVE_AVX2
+INSTANTIATE_TEST_CASE_P(AVX2, UpdateCdfTest,
+                        ::testing::Values(aom_update_cdf_avx2));
+#endif
+
+}  // namespace
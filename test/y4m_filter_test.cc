@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2017, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <string.h>
+
+#include "third_party/googletest/src/googletest/include/gtest/gtest.h"
+
+#include "./y4minput_dsp.h"
+#include "test/acm_random.h"
+
+using libaom_test::ACMRandom;
+
+namespace {
+
+const int kMaxWidth = 200;
+// Room for the taps either side of the filtered samples.
+const int kBorder = 4;
+const int kRows = 6;
+const int kStride = kMaxWidth + 2 * kBorder;
+const int kIterations = 200;
+
+struct Y4mFilters {
+  y4m_filter_42xmpeg2_func filter_42xmpeg2;
+  y4m_filter_422_420_func filter_422_420;
+  y4m_filter_444_422_func filter_444_422;
+  y4m_filter_411_422_func filter_411_422;
+};
+
+class Y4mFilterTest : public ::testing::TestWithParam<Y4mFilters> {
+ protected:
+  // Fills the source with random samples, or with runs of 0 and 255 to reach
+  // both clamps.
+  void FillSource(ACMRandom *rnd, int extremes) {
+    for (int i = 0; i < kRows * kStride; ++i) {
+      src_[i] = extremes ? (rnd->Rand8() & 1) * 255 : rnd->Rand8();
+    }
+    memset(ref_, 0xa5, sizeof(ref_));
+    memset(dst_, 0xa5, sizeof(dst_));
+  }
+
+  void CheckOutput(const char *name, int n) {
+    for (int i = 0; i < static_cast<int>(sizeof(ref_)); ++i) {
+      ASSERT_EQ(ref_[i], dst_[i]) << name << " n=" << n << " at " << i;
+    }
+  }
+
+  // The middle of the source, with kBorder columns and two rows above it.
+  const uint8_t *Source() const { return src_ + 2 * kStride + kBorder; }
+
+  uint8_t src_[kRows * kStride];
+  uint8_t ref_[2 * kMaxWidth];
+  uint8_t dst_[2 * kMaxWidth];
+};
+
+TEST_P(Y4mFilterTest, MatchesC) {
+  const Y4mFilters filters = GetParam();
+  ACMRandom rnd(ACMRandom::DeterministicSeed());
+
+  for (int iter = 0; iter < kIterations; ++iter) {
+    const int n = 1 + rnd.PseudoUniform(kMaxWidth / 2);
+
+    FillSource(&rnd, iter & 1);
+    y4m_filter_42xmpeg2_c(ref_, Source(), n);
+    filters.filter_42xmpeg2(dst_, Source(), n);
+    CheckOutput("42xmpeg2", n);
+
+    FillSource(&rnd, iter & 1);
+    y4m_filter_422_420_c(ref_, Source(), kStride, n);
+    filters.filter_422_420(dst_, Source(), kStride, n);
+    CheckOutput("422_420", n);
+
+    FillSource(&rnd, iter & 1);
+    y4m_filter_444_422_c(ref_, Source(), n);
+    filters.filter_444_422(dst_, Source(), n);
+    CheckOutput("444_422", n);
+
+    FillSource(&rnd, iter & 1);
+    y4m_filter_411_422_c(ref_, Source(), n);
+    filters.filter_411_422(dst_, Source(), n);
+    CheckOutput("411_422", n);
+  }
+}
+
+#if HAVE_SSE2
+const Y4mFilters kY4mFiltersSse2 = {
+  y4m_filter_42xmpeg2_sse2, y4m_filter_422_420_sse2, y4m_filter_444_422_sse2,
+  y4m_filter_411_422_sse2
+};
+INSTANTIATE_TEST_CASE_P(SSE2, Y4mFilterTest,
+                        ::testing::Values(kY4mFiltersSse2));
+#endif
+
+#if HAVE_AVX2
+const Y4mFilters kY4mFiltersAvx2 = {
+  y4m_filter_42xmpeg2_avx2, y4m_filter_422_420_avx2, y4m_filter_444_422_avx2,
+  y4m_filter_411_422_avx2
+};
+INSTANTIATE_TEST_CASE_P(AVX2, Y4mFilterTest,
+                        ::testing::Values(kY4mFiltersAvx2));
+#endif
+
+}  // namespace
@@ -22,8 +22,10 @@ static const char *const kIVFSignature = "DKIF";
 struct AvxVideoReaderStruct {
   AvxVideoInfo info;
   FILE *file;
+  AvxMappedFile mapped;  // Read instead of file if it could be mapped.
   uint8_t *buffer;
   size_t buffer_size;
+  const uint8_t *frame;
   size_t frame_size;
 };
 
@@ -49,12 +51,14 @@ AvxVideoReader *aom_video_reader_open(const char *filename) {
   reader->info.frame_height = mem_get_le16(header + 14);
   reader->info.time_base.numerator = mem_get_le32(header + 16);
   reader->info.time_base.denominator = mem_get_le32(header + 20);
+  mapped_file_open(&reader->mapped, file);
 
   return reader;
 }
 
 void aom_video_reader_close(AvxVideoReader *reader) {
   if (reader) {
+    mapped_file_close(&reader->mapped);
     fclose(reader->file);
     free(reader->buffer);
     free(reader);
@@ -62,15 +66,23 @@ void aom_video_reader_close(AvxVideoReader *reader) {
 }
 
 int aom_video_reader_read_frame(AvxVideoReader *reader) {
-  return !ivf_read_frame(reader->file, &reader->buffer, &reader->frame_size,
-                         &reader->buffer_size);
+  if (reader->mapped.data) {
+    return !ivf_read_frame_mapped(&reader->mapped, &reader->frame,
+                                  &reader->frame_size);
+  }
+  if (ivf_read_frame(reader->file, &reader->buffer, &reader->frame_size,
+                     &reader->buffer_size)) {
+    return 0;
+  }
+  reader->frame = reader->buffer;
+  return 1;
 }
 
 const uint8_t *aom_video_reader_get_frame(AvxVideoReader *reader,
                                           size_t *size) {
   if (size) *size = reader->frame_size;
 
-  return reader->buffer;
+  return reader->frame;
 }
 
 const AvxVideoInfo *aom_video_reader_get_info(AvxVideoReader *reader) {
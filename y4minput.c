@@ -15,8 +15,13 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "./aom_config.h"
 #include "aom/aom_integer.h"
+#if ARCH_X86 || ARCH_X86_64
+#include "aom_ports/x86.h"
+#endif
 #include "y4minput.h"
+#include "y4minput_dsp.h"
 
 // Reads 'size' bytes from 'file' into 'buf' with some fault tolerance.
 // Returns true on success.
@@ -139,6 +144,94 @@ static int y4m_parse_tags(y4m_input *_y4m, char *_tags) {
 #define OC_MAXI(_a, _b) ((_a) < (_b) ? (_b) : (_a))
 #define OC_CLAMPI(_a, _b, _c) (OC_MAXI(_a, OC_MINI(_b, _c)))
 
+void y4m_filter_42xmpeg2_c(unsigned char *_dst, const unsigned char *_src,
+                           int _n) {
+  int x;
+  for (x = 0; x < _n; x++) {
+    _dst[x] = (unsigned char)OC_CLAMPI(
+        0,
+        (4 * _src[x - 2] - 17 * _src[x - 1] + 114 * _src[x] + 35 * _src[x + 1] -
+         9 * _src[x + 2] + _src[x + 3] + 64) >>
+            7,
+        255);
+  }
+}
+
+void y4m_filter_422_420_c(unsigned char *_dst, const unsigned char *_src,
+                          int _stride, int _n) {
+  int x;
+  for (x = 0; x < _n; x++) {
+    _dst[x] = (unsigned char)OC_CLAMPI(
+        0,
+        (3 * (_src[x - 2 * _stride] + _src[x + 3 * _stride]) -
+         17 * (_src[x - _stride] + _src[x + 2 * _stride]) +
+         78 * (_src[x] + _src[x + _stride]) + 64) >>
+            7,
+        255);
+  }
+}
+
+void y4m_filter_444_422_c(unsigned char *_dst, const unsigned char *_src,
+                          int _n) {
+  int x;
+  for (x = 0; x < _n; x++) {
+    _dst[x] = (unsigned char)OC_CLAMPI(
+        0,
+        (3 * (_src[2 * x - 2] + _src[2 * x + 3]) -
+         17 * (_src[2 * x - 1] + _src[2 * x + 2]) +
+         78 * (_src[2 * x] + _src[2 * x + 1]) + 64) >>
+            7,
+        255);
+  }
+}
+
+void y4m_filter_411_422_c(unsigned char *_dst, const unsigned char *_src,
+                          int _n) {
+  int x;
+  for (x = 0; x < _n; x++) {
+    _dst[x << 1] = (unsigned char)OC_CLAMPI(
+        0,
+        (_src[x - 1] + 110 * _src[x] + 18 * _src[x + 1] - _src[x + 2] + 64) >>
+            7,
+        255);
+    _dst[x << 1 | 1] = (unsigned char)OC_CLAMPI(
+        0,
+        (-3 * _src[x - 1] + 50 * _src[x] + 86 * _src[x + 1] - 5 * _src[x + 2] +
+         64) >>
+            7,
+        255);
+  }
+}
+
+/*The filters used by the conversions, picked once for the host CPU.*/
+static y4m_filter_42xmpeg2_func y4m_filter_42xmpeg2 = y4m_filter_42xmpeg2_c;
+static y4m_filter_422_420_func y4m_filter_422_420 = y4m_filter_422_420_c;
+static y4m_filter_444_422_func y4m_filter_444_422 = y4m_filter_444_422_c;
+static y4m_filter_411_422_func y4m_filter_411_422 = y4m_filter_411_422_c;
+
+static void y4m_init_filters(void) {
+#if ARCH_X86 || ARCH_X86_64
+  const int simd_caps = x86_simd_caps();
+  (void)simd_caps;
+#if HAVE_SSE2
+  if (simd_caps & HAS_SSE2) {
+    y4m_filter_42xmpeg2 = y4m_filter_42xmpeg2_sse2;
+    y4m_filter_422_420 = y4m_filter_422_420_sse2;
+    y4m_filter_444_422 = y4m_filter_444_422_sse2;
+    y4m_filter_411_422 = y4m_filter_411_422_sse2;
+  }
+#endif
+#if HAVE_AVX2
+  if (simd_caps & HAS_AVX2) {
+    y4m_filter_42xmpeg2 = y4m_filter_42xmpeg2_avx2;
+    y4m_filter_422_420 = y4m_filter_422_420_avx2;
+    y4m_filter_444_422 = y4m_filter_444_422_avx2;
+    y4m_filter_411_422 = y4m_filter_411_422_avx2;
+  }
+#endif
+#endif
+}
+
 /*420jpeg chroma samples are sited like:
   Y-------Y-------Y-------Y-------
   |       |       |       |
@@ -198,13 +291,9 @@ static void y4m_42xmpeg2_42xjpeg_helper(unsigned char *_dst,
               7,
           255);
     }
-    for (; x < _c_w - 3; x++) {
-      _dst[x] = (unsigned char)OC_CLAMPI(
-          0,
-          (4 * _src[x - 2] - 17 * _src[x - 1] + 114 * _src[x] +
-           35 * _src[x + 1] - 9 * _src[x + 2] + _src[x + 3] + 64) >>
-              7,
-          255);
+    if (x < _c_w - 3) {
+      y4m_filter_42xmpeg2(_dst + x, _src + x, _c_w - 3 - x);
+      x = _c_w - 3;
     }
     for (; x < _c_w; x++) {
       _dst[x] = (unsigned char)OC_CLAMPI(
@@ -400,38 +489,36 @@ static void y4m_422jpeg_420jpeg_helper(unsigned char *_dst,
                                        int _c_h) {
   int y;
   int x;
-  /*Filter: [3 -17 78 78 -17 3]/128, derived from a 6-tap Lanczos window.*/
-  for (x = 0; x < _c_w; x++) {
-    for (y = 0; y < OC_MINI(_c_h, 2); y += 2) {
-      _dst[(y >> 1) * _c_w] =
-          OC_CLAMPI(0,
-                    (64 * _src[0] + 78 * _src[OC_MINI(1, _c_h - 1) * _c_w] -
-                     17 * _src[OC_MINI(2, _c_h - 1) * _c_w] +
-                     3 * _src[OC_MINI(3, _c_h - 1) * _c_w] + 64) >>
-                        7,
-                    255);
-    }
-    for (; y < _c_h - 3; y += 2) {
-      _dst[(y >> 1) * _c_w] =
-          OC_CLAMPI(0,
-                    (3 * (_src[(y - 2) * _c_w] + _src[(y + 3) * _c_w]) -
-                     17 * (_src[(y - 1) * _c_w] + _src[(y + 2) * _c_w]) +
-                     78 * (_src[y * _c_w] + _src[(y + 1) * _c_w]) + 64) >>
-                        7,
-                    255);
+  /*Filter: [3 -17 78 78 -17 3]/128, derived from a 6-tap Lanczos window.
+    The rows away from the top and bottom edges are filtered a whole row at a
+     time.*/
+  for (y = 0; y < OC_MINI(_c_h, 2); y += 2) {
+    for (x = 0; x < _c_w; x++) {
+      _dst[(y >> 1) * _c_w + x] = OC_CLAMPI(
+          0,
+          (64 * _src[x] + 78 * _src[OC_MINI(1, _c_h - 1) * _c_w + x] -
+           17 * _src[OC_MINI(2, _c_h - 1) * _c_w + x] +
+           3 * _src[OC_MINI(3, _c_h - 1) * _c_w + x] + 64) >>
+              7,
+          255);
     }
-    for (; y < _c_h; y += 2) {
-      _dst[(y >> 1) * _c_w] = OC_CLAMPI(
+  }
+  for (; y < _c_h - 3; y += 2) {
+    y4m_filter_422_420(_dst + (y >> 1) * _c_w, _src + y * _c_w, _c_w, _c_w);
+  }
+  for (; y < _c_h; y += 2) {
+    for (x = 0; x < _c_w; x++) {
+      _dst[(y >> 1) * _c_w + x] = OC_CLAMPI(
           0,
-          (3 * (_src[(y - 2) * _c_w] + _src[(_c_h - 1) * _c_w]) -
-           17 * (_src[(y - 1) * _c_w] + _src[OC_MINI(y + 2, _c_h - 1) * _c_w]) +
-           78 * (_src[y * _c_w] + _src[OC_MINI(y + 1, _c_h - 1) * _c_w]) +
+          (3 * (_src[(y - 2) * _c_w + x] + _src[(_c_h - 1) * _c_w + x]) -
+           17 * (_src[(y - 1) * _c_w + x] +
+                 _src[OC_MINI(y + 2, _c_h - 1) * _c_w + x]) +
+           78 * (_src[y * _c_w + x] +
+                 _src[OC_MINI(y + 1, _c_h - 1) * _c_w + x]) +
            64) >>
               7,
           255);
     }
-    _src++;
-    _dst++;
   }
 }
 
@@ -656,19 +743,9 @@ static void y4m_convert_411_420jpeg(y4m_input *_y4m, unsigned char *_dst,
                 7,
             255);
       }
-      for (; x < c_w - 2; x++) {
-        tmp[x << 1] =
-            (unsigned char)OC_CLAMPI(0,
-                                     (_aux[x - 1] + 110 * _aux[x] +
-                                      18 * _aux[x + 1] - _aux[x + 2] + 64) >>
-                                         7,
-                                     255);
-        tmp[x << 1 | 1] = (unsigned char)OC_CLAMPI(
-            0,
-            (-3 * _aux[x - 1] + 50 * _aux[x] + 86 * _aux[x + 1] -
-             5 * _aux[x + 2] + 64) >>
-                7,
-            255);
+      if (x < c_w - 2) {
+        y4m_filter_411_422(tmp + (x << 1), _aux + x, c_w - 2 - x);
+        x = c_w - 2;
       }
       for (; x < c_w; x++) {
         tmp[x << 1] = (unsigned char)OC_CLAMPI(
@@ -732,13 +809,10 @@ static void y4m_convert_444_420jpeg(y4m_input *_y4m, unsigned char *_dst,
                                     7,
                                 255);
       }
-      for (; x < c_w - 3; x += 2) {
-        tmp[x >> 1] = OC_CLAMPI(0,
-                                (3 * (_aux[x - 2] + _aux[x + 3]) -
-                                 17 * (_aux[x - 1] + _aux[x + 2]) +
-                                 78 * (_aux[x] + _aux[x + 1]) + 64) >>
-                                    7,
-                                255);
+      if (x < c_w - 3) {
+        const int n = (c_w - 2 - x) >> 1;
+        y4m_filter_444_422(tmp + (x >> 1), _aux + x, n);
+        x += n << 1;
       }
       for (; x < c_w; x += 2) {
         tmp[x >> 1] =
@@ -783,6 +857,7 @@ int y4m_input_open(y4m_input *_y4m, FILE *_fin, char *_skip, int _nskip,
   char buffer[80] = { 0 };
   int ret;
   int i;
+  y4m_init_filters();
   /*Read until newline, or 80 cols, whichever happens first.*/
   for (i = 0; i < 79; i++) {
     if (_nskip > 0) {
@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) 2017, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <immintrin.h>
+
+#include "y4minput_dsp.h"
+
+/*The same arithmetic as the SSE2 versions, 16 outputs at a time.*/
+
+static INLINE __m256i load_16_to_16(const unsigned char *p) {
+  return _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)p));
+}
+
+static INLINE __m256i round_shift(__m256i pos, __m256i neg) {
+  return _mm256_srli_epi16(_mm256_subs_epu16(pos, neg), 7);
+}
+
+/*Packs 16 words to bytes, undoing the interleave of the 128-bit lanes.*/
+static INLINE void store_16(unsigned char *dst, __m256i res) {
+  const __m256i packed =
+      _mm256_permute4x64_epi64(_mm256_packus_epi16(res, res), 0xd8);
+  _mm_storeu_si128((__m128i *)dst, _mm256_castsi256_si128(packed));
+}
+
+void y4m_filter_42xmpeg2_avx2(unsigned char *_dst, const unsigned char *_src,
+                              int _n) {
+  const __m256i k4 = _mm256_set1_epi16(4);
+  const __m256i k17 = _mm256_set1_epi16(17);
+  const __m256i k114 = _mm256_set1_epi16(114);
+  const __m256i k35 = _mm256_set1_epi16(35);
+  const __m256i k9 = _mm256_set1_epi16(9);
+  const __m256i k64 = _mm256_set1_epi16(64);
+  int x;
+  for (x = 0; x + 16 <= _n; x += 16) {
+    const __m256i s0 = load_16_to_16(_src + x - 2);
+    const __m256i s1 = load_16_to_16(_src + x - 1);
+    const __m256i s2 = load_16_to_16(_src + x);
+    const __m256i s3 = load_16_to_16(_src + x + 1);
+    const __m256i s4 = load_16_to_16(_src + x + 2);
+    const __m256i s5 = load_16_to_16(_src + x + 3);
+    const __m256i pos = _mm256_add_epi16(
+        _mm256_add_epi16(_mm256_mullo_epi16(s0, k4),
+                         _mm256_mullo_epi16(s2, k114)),
+        _mm256_add_epi16(_mm256_add_epi16(_mm256_mullo_epi16(s3, k35), s5),
+                         k64));
+    const __m256i neg = _mm256_add_epi16(_mm256_mullo_epi16(s1, k17),
+                                         _mm256_mullo_epi16(s4, k9));
+    store_16(_dst + x, round_shift(pos, neg));
+  }
+  if (x < _n) y4m_filter_42xmpeg2_sse2(_dst + x, _src + x, _n - x);
+}
+
+void y4m_filter_422_420_avx2(unsigned char *_dst, const unsigned char *_src,
+                             int _stride, int _n) {
+  const __m256i k3 = _mm256_set1_epi16(3);
+  const __m256i k17 = _mm256_set1_epi16(17);
+  const __m256i k78 = _mm256_set1_epi16(78);
+  const __m256i k64 = _mm256_set1_epi16(64);
+  int x;
+  for (x = 0; x + 16 <= _n; x += 16) {
+    const unsigned char *const src = _src + x;
+    const __m256i s0 = load_16_to_16(src - 2 * _stride);
+    const __m256i s1 = load_16_to_16(src - _stride);
+    const __m256i s2 = load_16_to_16(src);
+    const __m256i s3 = load_16_to_16(src + _stride);
+    const __m256i s4 = load_16_to_16(src + 2 * _stride);
+    const __m256i s5 = load_16_to_16(src + 3 * _stride);
+    const __m256i pos = _mm256_add_epi16(
+        _mm256_add_epi16(_mm256_mullo_epi16(_mm256_add_epi16(s0, s5), k3),
+                         _mm256_mullo_epi16(_mm256_add_epi16(s2, s3), k78)),
+        k64);
+    const __m256i neg = _mm256_mullo_epi16(_mm256_add_epi16(s1, s4), k17);
+    store_16(_dst + x, round_shift(pos, neg));
+  }
+  if (x < _n) y4m_filter_422_420_sse2(_dst + x, _src + x, _stride, _n - x);
+}
+
+void y4m_filter_444_422_avx2(unsigned char *_dst, const unsigned char *_src,
+                             int _n) {
+  const __m256i k3 = _mm256_set1_epi16(3);
+  const __m256i k17 = _mm256_set1_epi16(17);
+  const __m256i k78 = _mm256_set1_epi16(78);
+  const __m256i k64 = _mm256_set1_epi16(64);
+  const __m256i even_mask = _mm256_set1_epi16(0xff);
+  int x;
+  for (x = 0; x + 16 <= _n; x += 16) {
+    const __m256i m = _mm256_loadu_si256((const __m256i *)(_src + 2 * x - 2));
+    const __m256i c = _mm256_loadu_si256((const __m256i *)(_src + 2 * x));
+    const __m256i p = _mm256_loadu_si256((const __m256i *)(_src + 2 * x + 2));
+    const __m256i outer = _mm256_add_epi16(_mm256_and_si256(m, even_mask),
+                                           _mm256_srli_epi16(p, 8));
+    const __m256i inner = _mm256_add_epi16(_mm256_srli_epi16(m, 8),
+                                           _mm256_and_si256(p, even_mask));
+    const __m256i center = _mm256_add_epi16(_mm256_and_si256(c, even_mask),
+                                            _mm256_srli_epi16(c, 8));
+    const __m256i pos =
+        _mm256_add_epi16(_mm256_add_epi16(_mm256_mullo_epi16(outer, k3),
+                                          _mm256_mullo_epi16(center, k78)),
+                         k64);
+    const __m256i neg = _mm256_mullo_epi16(inner, k17);
+    store_16(_dst + x, round_shift(pos, neg));
+  }
+  if (x < _n) y4m_filter_444_422_sse2(_dst + x, _src + 2 * x, _n - x);
+}
+
+void y4m_filter_411_422_avx2(unsigned char *_dst, const unsigned char *_src,
+                             int _n) {
+  const __m256i k110 = _mm256_set1_epi16(110);
+  const __m256i k18 = _mm256_set1_epi16(18);
+  const __m256i k3 = _mm256_set1_epi16(3);
+  const __m256i k50 = _mm256_set1_epi16(50);
+  const __m256i k86 = _mm256_set1_epi16(86);
+  const __m256i k5 = _mm256_set1_epi16(5);
+  const __m256i k64 = _mm256_set1_epi16(64);
+  int x;
+  for (x = 0; x + 16 <= _n; x += 16) {
+    const __m256i s0 = load_16_to_16(_src + x - 1);
+    const __m256i s1 = load_16_to_16(_src + x);
+    const __m256i s2 = load_16_to_16(_src + x + 1);
+    const __m256i s3 = load_16_to_16(_src + x + 2);
+    const __m256i even = round_shift(
+        _mm256_add_epi16(_mm256_add_epi16(s0, _mm256_mullo_epi16(s1, k110)),
+                         _mm256_add_epi16(_mm256_mullo_epi16(s2, k18), k64)),
+        s3);
+    const __m256i odd = round_shift(
+        _mm256_add_epi16(_mm256_add_epi16(_mm256_mullo_epi16(s1, k50),
+                                          _mm256_mullo_epi16(s2, k86)),
+                         k64),
+        _mm256_add_epi16(_mm256_mullo_epi16(s0, k3),
+                         _mm256_mullo_epi16(s3, k5)));
+    /*Interleaving within each 128-bit lane leaves the 32 outputs in order
+       after the pack.*/
+    _mm256_storeu_si256(
+        (__m256i *)(_dst + 2 * x),
+        _mm256_packus_epi16(_mm256_unpacklo_epi16(even, odd),
+                            _mm256_unpackhi_epi16(even, odd)));
+  }
+  if (x < _n) y4m_filter_411_422_sse2(_dst + 2 * x, _src + x, _n - x);
+}
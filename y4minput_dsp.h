@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2017, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#ifndef Y4MINPUT_DSP_H_
+#define Y4MINPUT_DSP_H_
+
+#include "./aom_config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*The chroma resampling filters of y4minput.c, away from the plane edges where
+   none of the taps need clamping.
+  Each produces _n outputs, and the SIMD versions are bit-exact with the C
+   ones.*/
+
+/*[4 -17 114 35 -9 1]/128 over _src[-2..3]: moves 4:2:x mpeg2 chroma sites to
+   jpeg ones.*/
+typedef void (*y4m_filter_42xmpeg2_func)(unsigned char *_dst,
+                                         const unsigned char *_src, int _n);
+/*[3 -17 78 78 -17 3]/128 down each column over rows -2..3 of _src: decimates
+   4:2:2 to 4:2:0 vertically.*/
+typedef void (*y4m_filter_422_420_func)(unsigned char *_dst,
+                                        const unsigned char *_src, int _stride,
+                                        int _n);
+/*The same filter along a row, decimating by 2: _dst[i] uses
+   _src[2*i-2..2*i+3].*/
+typedef void (*y4m_filter_444_422_func)(unsigned char *_dst,
+                                        const unsigned char *_src, int _n);
+/*[1 110 18 -1]/128 and [-3 50 86 -5]/128 over _src[i-1..i+2]: upsamples 4:1:1
+   to 4:2:2, writing _dst[2*i] and _dst[2*i+1].*/
+typedef void (*y4m_filter_411_422_func)(unsigned char *_dst,
+                                        const unsigned char *_src, int _n);
+
+void y4m_filter_42xmpeg2_c(unsigned char *_dst, const unsigned char *_src,
+                           int _n);
+void y4m_filter_422_420_c(unsigned char *_dst, const unsigned char *_src,
+                          int _stride, int _n);
+void y4m_filter_444_422_c(unsigned char *_dst, const unsigned char *_src,
+                          int _n);
+void y4m_filter_411_422_c(unsigned char *_dst, const unsigned char *_src,
+                          int _n);
+
+#if HAVE_SSE2
+void y4m_filter_42xmpeg2_sse2(unsigned char *_dst, const unsigned char *_src,
+                              int _n);
+void y4m_filter_422_420_sse2(unsigned char *_dst, const unsigned char *_src,
+                             int _stride, int _n);
+void y4m_filter_444_422_sse2(unsigned char *_dst, const unsigned char *_src,
+                             int _n);
+void y4m_filter_411_422_sse2(unsigned char *_dst, const unsigned char *_src,
+                             int _n);
+#endif
+
+#if HAVE_AVX2
+void y4m_filter_42xmpeg2_avx2(unsigned char *_dst, const unsigned char *_src,
+                              int _n);
+void y4m_filter_422_420_avx2(unsigned char *_dst, const unsigned char *_src,
+                             int _stride, int _n);
+void y4m_filter_444_422_avx2(unsigned char *_dst, const unsigned char *_src,
+                             int _n);
+void y4m_filter_411_422_avx2(unsigned char *_dst, const unsigned char *_src,
+                             int _n);
+#endif
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // Y4MINPUT_DSP_H_
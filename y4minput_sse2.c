@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2017, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <emmintrin.h>
+
+#include "y4minput_dsp.h"
+
+/*The filters are computed in unsigned 16 bits: the positive taps (plus the
+   rounding offset) and the negative taps are summed separately, which cannot
+   overflow, and the saturating subtract then clamps negative results to 0.
+  The packs clamp the rest to 255.*/
+
+static INLINE __m128i load_8_to_16(const unsigned char *p) {
+  return _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)p),
+                           _mm_setzero_si128());
+}
+
+static INLINE __m128i round_shift(__m128i pos, __m128i neg) {
+  return _mm_srli_epi16(_mm_subs_epu16(pos, neg), 7);
+}
+
+void y4m_filter_42xmpeg2_sse2(unsigned char *_dst, const unsigned char *_src,
+                              int _n) {
+  const __m128i k4 = _mm_set1_epi16(4);
+  const __m128i k17 = _mm_set1_epi16(17);
+  const __m128i k114 = _mm_set1_epi16(114);
+  const __m128i k35 = _mm_set1_epi16(35);
+  const __m128i k9 = _mm_set1_epi16(9);
+  const __m128i k64 = _mm_set1_epi16(64);
+  int x;
+  for (x = 0; x + 8 <= _n; x += 8) {
+    const __m128i s0 = load_8_to_16(_src + x - 2);
+    const __m128i s1 = load_8_to_16(_src + x - 1);
+    const __m128i s2 = load_8_to_16(_src + x);
+    const __m128i s3 = load_8_to_16(_src + x + 1);
+    const __m128i s4 = load_8_to_16(_src + x + 2);
+    const __m128i s5 = load_8_to_16(_src + x + 3);
+    const __m128i pos = _mm_add_epi16(
+        _mm_add_epi16(_mm_mullo_epi16(s0, k4), _mm_mullo_epi16(s2, k114)),
+        _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(s3, k35), s5), k64));
+    const __m128i neg =
+        _mm_add_epi16(_mm_mullo_epi16(s1, k17), _mm_mullo_epi16(s4, k9));
+    const __m128i res = round_shift(pos, neg);
+    _mm_storel_epi64((__m128i *)(_dst + x), _mm_packus_epi16(res, res));
+  }
+  if (x < _n) y4m_filter_42xmpeg2_c(_dst + x, _src + x, _n - x);
+}
+
+void y4m_filter_422_420_sse2(unsigned char *_dst, const unsigned char *_src,
+                             int _stride, int _n) {
+  const __m128i k3 = _mm_set1_epi16(3);
+  const __m128i k17 = _mm_set1_epi16(17);
+  const __m128i k78 = _mm_set1_epi16(78);
+  const __m128i k64 = _mm_set1_epi16(64);
+  int x;
+  for (x = 0; x + 8 <= _n; x += 8) {
+    const unsigned char *const src = _src + x;
+    const __m128i s0 = load_8_to_16(src - 2 * _stride);
+    const __m128i s1 = load_8_to_16(src - _stride);
+    const __m128i s2 = load_8_to_16(src);
+    const __m128i s3 = load_8_to_16(src + _stride);
+    const __m128i s4 = load_8_to_16(src + 2 * _stride);
+    const __m128i s5 = load_8_to_16(src + 3 * _stride);
+    const __m128i outer = _mm_add_epi16(s0, s5);
+    const __m128i center = _mm_add_epi16(s2, s3);
+    const __m128i pos = _mm_add_epi16(
+        _mm_add_epi16(_mm_mullo_epi16(outer, k3), _mm_mullo_epi16(center, k78)),
+        k64);
+    const __m128i neg = _mm_mullo_epi16(_mm_add_epi16(s1, s4), k17);
+    const __m128i res = round_shift(pos, neg);
+    _mm_storel_epi64((__m128i *)(_dst + x), _mm_packus_epi16(res, res));
+  }
+  if (x < _n) y4m_filter_422_420_c(_dst + x, _src + x, _stride, _n - x);
+}
+
+void y4m_filter_444_422_sse2(unsigned char *_dst, const unsigned char *_src,
+                             int _n) {
+  const __m128i k3 = _mm_set1_epi16(3);
+  const __m128i k17 = _mm_set1_epi16(17);
+  const __m128i k78 = _mm_set1_epi16(78);
+  const __m128i k64 = _mm_set1_epi16(64);
+  const __m128i even_mask = _mm_set1_epi16(0xff);
+  int x;
+  for (x = 0; x + 8 <= _n; x += 8) {
+    /*Split the 16 samples at each of _src[2*x-2], _src[2*x] and _src[2*x+2]
+       into the even and odd taps of 8 outputs.*/
+    const __m128i m = _mm_loadu_si128((const __m128i *)(_src + 2 * x - 2));
+    const __m128i c = _mm_loadu_si128((const __m128i *)(_src + 2 * x));
+    const __m128i p = _mm_loadu_si128((const __m128i *)(_src + 2 * x + 2));
+    const __m128i outer =
+        _mm_add_epi16(_mm_and_si128(m, even_mask), _mm_srli_epi16(p, 8));
+    const __m128i inner =
+        _mm_add_epi16(_mm_srli_epi16(m, 8), _mm_and_si128(p, even_mask));
+    const __m128i center =
+        _mm_add_epi16(_mm_and_si128(c, even_mask), _mm_srli_epi16(c, 8));
+    const __m128i pos = _mm_add_epi16(
+        _mm_add_epi16(_mm_mullo_epi16(outer, k3), _mm_mullo_epi16(center, k78)),
+        k64);
+    const __m128i neg = _mm_mullo_epi16(inner, k17);
+    const __m128i res = round_shift(pos, neg);
+    _mm_storel_epi64((__m128i *)(_dst + x), _mm_packus_epi16(res, res));
+  }
+  if (x < _n) y4m_filter_444_422_c(_dst + x, _src + 2 * x, _n - x);
+}
+
+void y4m_filter_411_422_sse2(unsigned char *_dst, const unsigned char *_src,
+                             int _n) {
+  const __m128i k110 = _mm_set1_epi16(110);
+  const __m128i k18 = _mm_set1_epi16(18);
+  const __m128i k3 = _mm_set1_epi16(3);
+  const __m128i k50 = _mm_set1_epi16(50);
+  const __m128i k86 = _mm_set1_epi16(86);
+  const __m128i k5 = _mm_set1_epi16(5);
+  const __m128i k64 = _mm_set1_epi16(64);
+  int x;
+  for (x = 0; x + 8 <= _n; x += 8) {
+    const __m128i s0 = load_8_to_16(_src + x - 1);
+    const __m128i s1 = load_8_to_16(_src + x);
+    const __m128i s2 = load_8_to_16(_src + x + 1);
+    const __m128i s3 = load_8_to_16(_src + x + 2);
+    const __m128i even = round_shift(
+        _mm_add_epi16(_mm_add_epi16(s0, _mm_mullo_epi16(s1, k110)),
+                      _mm_add_epi16(_mm_mullo_epi16(s2, k18), k64)),
+        s3);
+    const __m128i odd = round_shift(
+        _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(s1, k50),
+                                    _mm_mullo_epi16(s2, k86)),
+                      k64),
+        _mm_add_epi16(_mm_mullo_epi16(s0, k3), _mm_mullo_epi16(s3, k5)));
+    /*Interleave the even and odd outputs.*/
+    _mm_storeu_si128((__m128i *)(_dst + 2 * x),
+                     _mm_packus_epi16(_mm_unpacklo_epi16(even, odd),
+                                      _mm_unpackhi_epi16(even, odd)));
+  }
+  if (x < _n) y4m_filter_411_422_c(_dst + 2 * x, _src + x, _n - x);
+}